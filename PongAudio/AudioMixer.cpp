@@ -0,0 +1,371 @@
+#include "pch.h"
+#include "AudioMixer.h"
+#include "Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PONGAUDIO_SSE2
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		// The scalar and SSE2 kernels do the same float multiply and add per sample and round the
+		// same way, so the output is identical either way.
+		void MixStereoScalar(float* destination, const int16_t* source, size_t frames, float gain)
+		{
+			for (size_t i = 0; i < frames * 2; ++i)
+			{
+				destination[i] += static_cast<float>(source[i]) * gain;
+			}
+		}
+
+		void MixMonoScalar(float* destination, const int16_t* source, size_t frames, float gain)
+		{
+			for (size_t i = 0; i < frames; ++i)
+			{
+				float sample = static_cast<float>(source[i]) * gain;
+				destination[i * 2] += sample;
+				destination[i * 2 + 1] += sample;
+			}
+		}
+
+		void ConvertScalar(int16_t* destination, const float* source, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				float sample = min(max(source[i], -32768.0f), 32767.0f);
+				destination[i] = static_cast<int16_t>(lrintf(sample));
+			}
+		}
+
+#if defined(PONGAUDIO_SSE2)
+		// sign-extends four 16-bit samples to floats
+		inline __m128 WidenLow(__m128i samples)
+		{
+			return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+		}
+
+		inline __m128 WidenHigh(__m128i samples)
+		{
+			return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+		}
+
+		void MixStereo(float* destination, const int16_t* source, size_t frames, float gain)
+		{
+			const __m128 gains = _mm_set1_ps(gain);
+			size_t count = frames * 2;
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+				_mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(WidenLow(samples), gains)));
+				_mm_storeu_ps(destination + i + 4, _mm_add_ps(_mm_loadu_ps(destination + i + 4), _mm_mul_ps(WidenHigh(samples), gains)));
+			}
+
+			MixStereoScalar(destination + i, source + i, (count - i) / 2, gain);
+		}
+
+		void MixMono(float* destination, const int16_t* source, size_t frames, float gain)
+		{
+			const __m128 gains = _mm_set1_ps(gain);
+
+			size_t i = 0;
+			for (; i + 4 <= frames; i += 4)
+			{
+				__m128 samples = _mm_mul_ps(WidenLow(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i))), gains);
+				float* output = destination + i * 2;
+				_mm_storeu_ps(output, _mm_add_ps(_mm_loadu_ps(output), _mm_unpacklo_ps(samples, samples)));
+				_mm_storeu_ps(output + 4, _mm_add_ps(_mm_loadu_ps(output + 4), _mm_unpackhi_ps(samples, samples)));
+			}
+
+			MixMonoScalar(destination + i * 2, source + i, frames - i, gain);
+		}
+
+		// cvtps rounds to nearest even like lrintf, and packs saturates like the clamp
+		void Convert(int16_t* destination, const float* source, size_t count)
+		{
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i low = _mm_cvtps_epi32(_mm_loadu_ps(source + i));
+				__m128i high = _mm_cvtps_epi32(_mm_loadu_ps(source + i + 4));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(low, high));
+			}
+
+			ConvertScalar(destination + i, source + i, count - i);
+		}
+#else
+		void MixStereo(float* destination, const int16_t* source, size_t frames, float gain)
+		{
+			MixStereoScalar(destination, source, frames, gain);
+		}
+
+		void MixMono(float* destination, const int16_t* source, size_t frames, float gain)
+		{
+			MixMonoScalar(destination, source, frames, gain);
+		}
+
+		void Convert(int16_t* destination, const float* source, size_t count)
+		{
+			ConvertScalar(destination, source, count);
+		}
+#endif
+	}
+
+	AudioMixer::AudioMixer(AudioSink& sink, const AudioMixerOptions& options) :
+		mSink(&sink), mOptions(options), mCommands(options.QueueCapacity), mVoices(options.VoiceCount),
+		mMixBuffer(static_cast<size_t>(options.BlockFrames) * AudioSink::Channels), mPosition(0), mClockOffset(0), mClockSynced(false), mSimulationFrame(0),
+		mStopping(false), mFramesMixed(0), mDroppedSounds(0), mStolenVoices(0)
+	{
+		if (options.SampleRate == 0 || options.VoiceCount == 0 || options.BlockFrames == 0)
+		{
+			throw invalid_argument("The mixer needs a sample rate, voices and a block size.");
+		}
+	}
+
+	AudioMixer::~AudioMixer()
+	{
+		Stop();
+	}
+
+	const AudioMixerOptions& AudioMixer::Options() const
+	{
+		return mOptions;
+	}
+
+	AudioMixer::SoundId AudioMixer::AddSound(shared_ptr<const Sound> sound)
+	{
+		if (mThread.joinable())
+		{
+			throw runtime_error("Sounds have to be added before the mixer starts.");
+		}
+		if (sound == nullptr || sound->SampleRate != mOptions.SampleRate)
+		{
+			throw invalid_argument("Sounds have to be at the mixer's sample rate.");
+		}
+
+		mSounds.push_back(move(sound));
+		return static_cast<SoundId>(mSounds.size() - 1);
+	}
+
+	void AudioMixer::Start()
+	{
+		if (!mThread.joinable())
+		{
+			mStopping.store(false, memory_order_relaxed);
+			mThread = thread(&AudioMixer::Run, this);
+		}
+	}
+
+	void AudioMixer::Stop()
+	{
+		if (mThread.joinable())
+		{
+			mStopping.store(true, memory_order_release);
+			mThread.join();
+		}
+	}
+
+	bool AudioMixer::Play(SoundId sound, double simulationSeconds, float gain)
+	{
+		Command command;
+		command.Type = CommandType::Play;
+		command.Sound = sound;
+		command.Gain = gain;
+		command.Seconds = simulationSeconds;
+		if (!Push(command))
+		{
+			mDroppedSounds.fetch_add(1, memory_order_relaxed);
+			return false;
+		}
+		return true;
+	}
+
+	void AudioMixer::Advance(double simulationSeconds)
+	{
+		Command command;
+		command.Type = CommandType::Advance;
+		command.Sound = 0;
+		command.Gain = 0.0f;
+		command.Seconds = simulationSeconds;
+
+		// a full queue only delays the clock; the next Advance carries the same information
+		Push(command);
+	}
+
+	uint64_t AudioMixer::FramesMixed() const
+	{
+		return mFramesMixed.load(memory_order_relaxed);
+	}
+
+	uint64_t AudioMixer::DroppedSounds() const
+	{
+		return mDroppedSounds.load(memory_order_relaxed);
+	}
+
+	uint64_t AudioMixer::StolenVoices() const
+	{
+		return mStolenVoices.load(memory_order_relaxed);
+	}
+
+	bool AudioMixer::Push(const Command& command)
+	{
+		if (mCommands.TryPush(command))
+		{
+			return true;
+		}
+		if (!mOptions.FollowSimulation || !mThread.joinable())
+		{
+			return false;
+		}
+
+		// an offline render loses nothing: wait for the mixer to catch up instead
+		do
+		{
+			this_thread::yield();
+		} while (!mCommands.TryPush(command));
+		return true;
+	}
+
+	void AudioMixer::Run()
+	{
+		vector<int16_t> block(static_cast<size_t>(mOptions.BlockFrames) * AudioSink::Channels);
+		for (;;)
+		{
+			// read before draining, so everything pushed before Stop is still processed
+			bool stopping = mStopping.load(memory_order_acquire);
+			ProcessCommands();
+
+			uint32_t frameCount = mOptions.BlockFrames;
+			if (mOptions.FollowSimulation)
+			{
+				frameCount = static_cast<uint32_t>(min<int64_t>(frameCount, max<int64_t>(mSimulationFrame - mPosition, 0)));
+			}
+
+			if (stopping && (frameCount == 0 || !mOptions.FollowSimulation))
+			{
+				break;
+			}
+			if (frameCount == 0)
+			{
+				this_thread::sleep_for(chrono::milliseconds(1));
+				continue;
+			}
+
+			MixBlock(block.data(), frameCount);
+			mSink->Write(block.data(), frameCount);
+		}
+	}
+
+	void AudioMixer::ProcessCommands()
+	{
+		Command command;
+		while (mCommands.TryPop(command))
+		{
+			if (command.Type == CommandType::Play)
+			{
+				StartVoice(command);
+			}
+			else
+			{
+				mSimulationFrame = ScheduleFrame(command.Seconds);
+			}
+		}
+	}
+
+	int64_t AudioMixer::ScheduleFrame(double simulationSeconds)
+	{
+		int64_t frame = llround(simulationSeconds * mOptions.SampleRate);
+		if (mOptions.FollowSimulation)
+		{
+			return frame;
+		}
+
+		// The simulation clock and the device clock drift apart, and jump apart on a hitch or a
+		// replay seek. Keep one fixed offset between them while everything lands inside the latency
+		// window, and re-anchor so the next sound plays one latency from now once it doesn't.
+		int64_t scheduled = frame + mClockOffset;
+		if (!mClockSynced || scheduled < mPosition || scheduled > mPosition + 2 * static_cast<int64_t>(mOptions.LatencyFrames))
+		{
+			mClockOffset = mPosition + mOptions.LatencyFrames - frame;
+			mClockSynced = true;
+			scheduled = frame + mClockOffset;
+		}
+		return scheduled;
+	}
+
+	void AudioMixer::StartVoice(const Command& command)
+	{
+		if (command.Sound >= mSounds.size())
+		{
+			return;
+		}
+
+		// a free voice if there is one, otherwise the one that has played longest
+		Voice* voice = nullptr;
+		for (Voice& candidate : mVoices)
+		{
+			if (candidate.Source == nullptr)
+			{
+				voice = &candidate;
+				break;
+			}
+			if (voice == nullptr || candidate.StartFrame < voice->StartFrame)
+			{
+				voice = &candidate;
+			}
+		}
+		if (voice->Source != nullptr)
+		{
+			mStolenVoices.fetch_add(1, memory_order_relaxed);
+		}
+
+		voice->Source = mSounds[command.Sound].get();
+		voice->StartFrame = max(ScheduleFrame(command.Seconds), mPosition);
+		voice->Cursor = 0;
+		voice->Gain = command.Gain;
+	}
+
+	void AudioMixer::MixBlock(int16_t* output, uint32_t frameCount)
+	{
+		PONG_PROFILE_SCOPE("Mix");
+
+		fill(mMixBuffer.begin(), mMixBuffer.begin() + static_cast<size_t>(frameCount) * AudioSink::Channels, 0.0f);
+		for (Voice& voice : mVoices)
+		{
+			if (voice.Source == nullptr || voice.StartFrame >= mPosition + frameCount)
+			{
+				continue;
+			}
+
+			// a sound scheduled inside this block starts on its own frame, not the block's first
+			size_t offset = static_cast<size_t>(max<int64_t>(voice.StartFrame - mPosition, 0));
+			size_t frames = min(frameCount - offset, voice.Source->Frames() - voice.Cursor);
+			float* destination = mMixBuffer.data() + offset * AudioSink::Channels;
+			const int16_t* source = voice.Source->Samples.data() + voice.Cursor * voice.Source->Channels;
+			if (voice.Source->Channels == 2)
+			{
+				MixStereo(destination, source, frames, voice.Gain);
+			}
+			else
+			{
+				MixMono(destination, source, frames, voice.Gain);
+			}
+
+			voice.Cursor += frames;
+			if (voice.Cursor == voice.Source->Frames())
+			{
+				voice.Source = nullptr;
+			}
+		}
+
+		Convert(output, mMixBuffer.data(), static_cast<size_t>(frameCount) * AudioSink::Channels);
+		mPosition += frameCount;
+		mFramesMixed.fetch_add(frameCount, memory_order_relaxed);
+	}
+}
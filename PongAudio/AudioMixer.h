@@ -0,0 +1,116 @@
+#pragma once
+
+#include "AudioSink.h"
+#include "AlignedAllocator.h"
+#include "Sound.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Pong
+{
+	struct AudioMixerOptions final
+	{
+		uint32_t SampleRate = 44100;
+		uint32_t VoiceCount = 32;
+		uint32_t BlockFrames = 512;
+
+		// how far behind the simulation the mixer schedules sounds, which has to cover the time
+		// between a step and the mixer seeing its commands
+		uint32_t LatencyFrames = 2048;
+		uint32_t QueueCapacity = 256;
+
+		// only mix as far as Advance has said the simulation has got, and make Play and Advance wait
+		// rather than drop when the queue is full, so an offline render comes out the same on every
+		// run however the threads are scheduled
+		bool FollowSimulation = false;
+	};
+
+	// Plays sounds on its own thread so gameplay never waits on audio. The game thread pushes
+	// timestamped commands into a lock-free queue; the mixer thread starts each sound on the exact
+	// output frame its simulation time maps to, mixes a fixed pool of voices with SIMD and hands
+	// the result to an AudioSink.
+	class AudioMixer final
+	{
+	public:
+		typedef uint32_t SoundId;
+
+		explicit AudioMixer(AudioSink& sink, const AudioMixerOptions& options = AudioMixerOptions());
+		~AudioMixer();
+
+		AudioMixer(const AudioMixer&) = delete;
+		AudioMixer& operator=(const AudioMixer&) = delete;
+
+		const AudioMixerOptions& Options() const;
+
+		// only before Start; every sound has to be at the mixer's sample rate
+		SoundId AddSound(std::shared_ptr<const Sound> sound);
+
+		void Start();
+
+		// with FollowSimulation, finishes mixing up to the last Advance first
+		void Stop();
+
+		// Gameplay thread only. Sounds keep their spacing in simulation time to the sample, however
+		// the steps that made them were batched into frames. Neither ever blocks in real time; Play
+		// returns false when the queue is full and the sound was dropped.
+		bool Play(SoundId sound, double simulationSeconds, float gain = 1.0f);
+		void Advance(double simulationSeconds);
+
+		uint64_t FramesMixed() const;
+		uint64_t DroppedSounds() const;
+		uint64_t StolenVoices() const;
+
+	private:
+		enum class CommandType : uint32_t
+		{
+			Play,
+			Advance,
+		};
+
+		struct Command final
+		{
+			CommandType Type;
+			SoundId Sound;
+			float Gain;
+			double Seconds;
+		};
+
+		struct Voice final
+		{
+			const Sound* Source = nullptr;
+			int64_t StartFrame = 0;
+			size_t Cursor = 0;
+			float Gain = 0.0f;
+		};
+
+		bool Push(const Command& command);
+		void Run();
+		void ProcessCommands();
+		int64_t ScheduleFrame(double simulationSeconds);
+		void StartVoice(const Command& command);
+		void MixBlock(int16_t* output, uint32_t frameCount);
+
+		AudioSink* mSink;
+		AudioMixerOptions mOptions;
+		std::vector<std::shared_ptr<const Sound>> mSounds;
+		SpscQueue<Command> mCommands;
+
+		// everything below belongs to the mixer thread once it has started
+		std::vector<Voice> mVoices;
+		std::vector<float, AlignedAllocator<float, 16>> mMixBuffer;
+		int64_t mPosition;
+		int64_t mClockOffset;
+		bool mClockSynced;
+		int64_t mSimulationFrame;
+
+		std::thread mThread;
+		std::atomic<bool> mStopping;
+		std::atomic<uint64_t> mFramesMixed;
+		std::atomic<uint64_t> mDroppedSounds;
+		std::atomic<uint64_t> mStolenVoices;
+	};
+}
@@ -0,0 +1,128 @@
+#include "pch.h"
+#include "AudioSink.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		// RIFF header, fmt chunk with a plain 16-byte PCM format, and the data chunk's header
+		struct WaveHeader final
+		{
+			char Riff[4];
+			uint32_t RiffSize;
+			char Wave[4];
+			char Fmt[4];
+			uint32_t FmtSize;
+			uint16_t FormatTag;
+			uint16_t Channels;
+			uint32_t SamplesPerSecond;
+			uint32_t AverageBytesPerSecond;
+			uint16_t BlockAlign;
+			uint16_t BitsPerSample;
+			char Data[4];
+			uint32_t DataSize;
+		};
+
+		WaveHeader MakeHeader(uint32_t sampleRate, uint64_t frames)
+		{
+			WaveHeader header;
+			memcpy(header.Riff, "RIFF", 4);
+			memcpy(header.Wave, "WAVE", 4);
+			memcpy(header.Fmt, "fmt ", 4);
+			memcpy(header.Data, "data", 4);
+			header.FmtSize = 16;
+			header.FormatTag = 1;
+			header.Channels = AudioSink::Channels;
+			header.SamplesPerSecond = sampleRate;
+			header.BlockAlign = AudioSink::Channels * sizeof(int16_t);
+			header.AverageBytesPerSecond = sampleRate * header.BlockAlign;
+			header.BitsPerSample = 16;
+
+			// WAVE sizes are 32-bit; a longer file just claims the most it can
+			uint64_t dataSize = min<uint64_t>(frames * header.BlockAlign, UINT32_MAX - sizeof(WaveHeader));
+			header.DataSize = static_cast<uint32_t>(dataSize);
+			header.RiffSize = static_cast<uint32_t>(dataSize + sizeof(WaveHeader) - 8);
+			return header;
+		}
+	}
+
+	NullAudioSink::NullAudioSink(uint32_t sampleRate, bool realTime) :
+		mSampleRate(sampleRate), mRealTime(realTime), mFrames(0)
+	{
+	}
+
+	uint64_t NullAudioSink::Frames() const
+	{
+		return mFrames;
+	}
+
+	void NullAudioSink::Write(const int16_t*, uint32_t frameCount)
+	{
+		if (mFrames == 0)
+		{
+			mStartTime = chrono::steady_clock::now();
+		}
+		mFrames += frameCount;
+
+		if (mRealTime)
+		{
+			// a device takes a block when it has played the one before, so sleep until then
+			auto playedTime = mStartTime + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(static_cast<double>(mFrames - frameCount) / mSampleRate));
+			this_thread::sleep_until(playedTime);
+		}
+	}
+
+	WaveFileSink::WaveFileSink(const string& path, uint32_t sampleRate) :
+		mPath(path), mFile(path, ios::binary), mSampleRate(sampleRate), mFrames(0)
+	{
+		if (!mFile.good())
+		{
+			throw runtime_error("Couldn't open " + path + " for writing.");
+		}
+
+		WaveHeader header = MakeHeader(mSampleRate, 0);
+		mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	WaveFileSink::~WaveFileSink()
+	{
+		try
+		{
+			Close();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	uint64_t WaveFileSink::Frames() const
+	{
+		return mFrames;
+	}
+
+	void WaveFileSink::Write(const int16_t* samples, uint32_t frameCount)
+	{
+		mFile.write(reinterpret_cast<const char*>(samples), static_cast<streamsize>(frameCount) * Channels * sizeof(int16_t));
+		mFrames += frameCount;
+	}
+
+	void WaveFileSink::Close()
+	{
+		if (!mFile.is_open())
+		{
+			return;
+		}
+
+		WaveHeader header = MakeHeader(mSampleRate, mFrames);
+		mFile.seekp(0);
+		mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		bool good = mFile.good();
+		mFile.close();
+		if (!good)
+		{
+			throw runtime_error("Couldn't write " + mPath + ".");
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace Pong
+{
+	// Where the mixer's output goes: interleaved 16-bit stereo at the mixer's sample rate. A sink
+	// for a real device blocks in Write until the device has room, and that is what paces the mixer
+	// thread.
+	class AudioSink
+	{
+	public:
+		static const uint32_t Channels = 2;
+
+		virtual ~AudioSink() = default;
+
+		virtual void Write(const int16_t* samples, uint32_t frameCount) = 0;
+	};
+
+	// Throws the output away. In real time it sleeps like a device would, so the mixer runs at its
+	// normal pace without any audio hardware.
+	class NullAudioSink final : public AudioSink
+	{
+	public:
+		explicit NullAudioSink(uint32_t sampleRate, bool realTime = false);
+
+		uint64_t Frames() const;
+
+		virtual void Write(const int16_t* samples, uint32_t frameCount) override;
+
+	private:
+		uint32_t mSampleRate;
+		bool mRealTime;
+		uint64_t mFrames;
+		std::chrono::steady_clock::time_point mStartTime;
+	};
+
+	// Writes everything to a 16-bit stereo WAVE file, as fast as the mixer produces it.
+	class WaveFileSink final : public AudioSink
+	{
+	public:
+		WaveFileSink(const std::string& path, uint32_t sampleRate);
+		~WaveFileSink();
+
+		WaveFileSink(const WaveFileSink&) = delete;
+		WaveFileSink& operator=(const WaveFileSink&) = delete;
+
+		uint64_t Frames() const;
+
+		virtual void Write(const int16_t* samples, uint32_t frameCount) override;
+
+		// fills in the chunk sizes; the destructor does this too, but can't report a failure
+		void Close();
+
+	private:
+		std::string mPath;
+		std::ofstream mFile;
+		uint32_t mSampleRate;
+		uint64_t mFrames;
+	};
+}
@@ -0,0 +1,57 @@
+#include "pch.h"
+#include "MatchSounds.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const char* const BlipNames[] =
+		{
+			"Audio/PongBlip1.wav",
+			"Audio/PongBlip2.wav",
+			"Audio/PongBlip3.wav",
+			"Audio/PongBlip4.wav",
+			"Audio/PongBlip5.wav",
+			"Audio/PongBlip6.wav",
+		};
+		const char ScoreName[] = "Audio/PongScore.wav";
+		const char GameOverName[] = "Audio/PongGameOver.wav";
+	}
+
+	MatchSounds::MatchSounds(AudioMixer& mixer, const Loader& load, uint32_t seed) :
+		mMixer(&mixer), mRandom(seed), mBlipDistribution(0, BlipCount - 1)
+	{
+		static_assert(sizeof(BlipNames) / sizeof(BlipNames[0]) == BlipCount, "One name per blip.");
+
+		for (size_t i = 0; i < BlipCount; ++i)
+		{
+			mBlips[i] = mixer.AddSound(make_shared<const Sound>(load(BlipNames[i])));
+		}
+		mScoreSound = mixer.AddSound(make_shared<const Sound>(load(ScoreName)));
+		mGameOverSound = mixer.AddSound(make_shared<const Sound>(load(GameOverName)));
+	}
+
+	void MatchSounds::Play(const MatchState& match, double simulationSeconds)
+	{
+		// every blip can play, including the last
+		if (match.Events & MatchEvents::PaddleHit)
+		{
+			mMixer->Play(mBlips[mBlipDistribution(mRandom)], simulationSeconds);
+		}
+		if (match.Events & MatchEvents::WallHit)
+		{
+			mMixer->Play(mBlips[mBlipDistribution(mRandom)], simulationSeconds);
+		}
+
+		if (match.Events & MatchEvents::GameOver)
+		{
+			mMixer->Play(mGameOverSound, simulationSeconds);
+		}
+		else if (match.Events & (MatchEvents::Player1Scored | MatchEvents::Player2Scored))
+		{
+			mMixer->Play(mScoreSound, simulationSeconds);
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "AudioMixer.h"
+#include "MatchState.h"
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace Pong
+{
+	// The game's sounds and which match events play them: a random blip for every hit, and the
+	// score or game over sound when a point ends.
+	class MatchSounds final
+	{
+	public:
+		typedef std::function<Sound(const std::string& name)> Loader;
+
+		// load gets paths relative to the Content directory, like "Audio/PongBlip1.wav"
+		MatchSounds(AudioMixer& mixer, const Loader& load, uint32_t seed);
+
+		void Play(const MatchState& match, double simulationSeconds);
+
+	private:
+		static const size_t BlipCount = 6;
+
+		AudioMixer* mMixer;
+		AudioMixer::SoundId mBlips[BlipCount];
+		AudioMixer::SoundId mScoreSound;
+		AudioMixer::SoundId mGameOverSound;
+
+		std::mt19937 mRandom;
+		std::uniform_int_distribution<size_t> mBlipDistribution;
+	};
+}
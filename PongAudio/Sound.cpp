@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "Sound.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const uint16_t FormatPcm = 1;
+
+		// the first 16 bytes of a WAVEFORMATEX
+		struct PcmFormat final
+		{
+			uint16_t FormatTag;
+			uint16_t Channels;
+			uint32_t SamplesPerSecond;
+			uint32_t AverageBytesPerSecond;
+			uint16_t BlockAlign;
+			uint16_t BitsPerSample;
+		};
+	}
+
+	Sound Sound::Decode(const uint8_t* format, size_t formatSize, const uint8_t* samples, size_t samplesSize, const string& name)
+	{
+		PcmFormat pcm;
+		if (formatSize < sizeof(pcm))
+		{
+			throw runtime_error(name + " has a truncated format.");
+		}
+		memcpy(&pcm, format, sizeof(pcm));
+		if (pcm.FormatTag != FormatPcm || pcm.BitsPerSample != 16 || pcm.Channels < 1 || pcm.Channels > 2)
+		{
+			throw runtime_error(name + " is not 16-bit mono or stereo PCM.");
+		}
+
+		Sound sound;
+		sound.SampleRate = pcm.SamplesPerSecond;
+		sound.Channels = pcm.Channels;
+
+		// drop any partial frame at the end
+		size_t frames = samplesSize / (sizeof(int16_t) * sound.Channels);
+		sound.Samples.resize(frames * sound.Channels);
+		memcpy(sound.Samples.data(), samples, sound.Samples.size() * sizeof(int16_t));
+		return sound;
+	}
+
+	Sound Sound::LoadWave(const string& path)
+	{
+		ifstream file(path, ios::binary);
+		if (!file.good())
+		{
+			throw runtime_error("Couldn't open " + path + ".");
+		}
+		vector<uint8_t> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+		if (data.size() < 12 || memcmp(data.data(), "RIFF", 4) != 0 || memcmp(data.data() + 8, "WAVE", 4) != 0)
+		{
+			throw runtime_error(path + " is not a WAVE file.");
+		}
+
+		const uint8_t* format = nullptr;
+		size_t formatSize = 0;
+		const uint8_t* samples = nullptr;
+		size_t samplesSize = 0;
+		for (size_t position = 12; position + 8 <= data.size();)
+		{
+			uint32_t chunkSize;
+			memcpy(&chunkSize, data.data() + position + 4, sizeof(chunkSize));
+			const uint8_t* chunk = data.data() + position + 8;
+			size_t available = min<size_t>(chunkSize, data.size() - position - 8);
+
+			if (memcmp(data.data() + position, "fmt ", 4) == 0)
+			{
+				format = chunk;
+				formatSize = available;
+			}
+			else if (memcmp(data.data() + position, "data", 4) == 0)
+			{
+				samples = chunk;
+				samplesSize = available;
+			}
+
+			// chunks are padded to an even size
+			position += 8 + static_cast<size_t>(chunkSize) + (chunkSize & 1);
+		}
+
+		if (format == nullptr || samples == nullptr)
+		{
+			throw runtime_error(path + " has no fmt or data chunk.");
+		}
+		return Decode(format, formatSize, samples, samplesSize, path);
+	}
+}
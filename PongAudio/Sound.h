@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	// Decoded 16-bit PCM, one or two channels interleaved. This is all the mixer plays, so every
+	// sound is decoded once at load and never touched again.
+	struct Sound final
+	{
+		uint32_t SampleRate = 0;
+		uint32_t Channels = 0;
+		std::vector<int16_t> Samples;
+
+		size_t Frames() const { return (Channels == 0 ? 0 : Samples.size() / Channels); }
+
+		// a WAVEFORMATEX and its samples, the way a WAVE file's fmt and data chunks hold them;
+		// name is only used in error messages
+		static Sound Decode(const uint8_t* format, size_t formatSize, const uint8_t* samples, size_t samplesSize, const std::string& name);
+
+		static Sound LoadWave(const std::string& path);
+	};
+}
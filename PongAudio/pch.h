@@ -0,0 +1,17 @@
+#pragma once
+
+// Standard
+#include <exception>
+#include <stdexcept>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
@@ -0,0 +1,219 @@
+#include "FixedTimestep.h"
+#include "MatchBatch.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct BenchmarkOptions
+	{
+		uint32_t Matches = 4096;
+		uint32_t Frames = 2000;
+		float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		uint32_t Seed = 1;
+		CollisionMode Collision = CollisionMode::Discrete;
+		AIMode AI = AIMode::Reactive;
+		float AIError = 0.0f;
+		uint32_t ReferenceMatches = 256;
+	};
+
+	BenchmarkOptions ParseOptions(int argc, char* argv[])
+	{
+		BenchmarkOptions options;
+
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--matches") == 0)
+			{
+				options.Matches = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--dt") == 0)
+			{
+				options.ElapsedTime = static_cast<float>(atof(argv[i + 1]));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--collision") == 0)
+			{
+				if (strcmp(argv[i + 1], "discrete") == 0)
+				{
+					options.Collision = CollisionMode::Discrete;
+				}
+				else if (strcmp(argv[i + 1], "swept") == 0)
+				{
+					options.Collision = CollisionMode::Swept;
+				}
+				else
+				{
+					cerr << "Unknown value for --collision: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--ai") == 0)
+			{
+				if (strcmp(argv[i + 1], "reactive") == 0)
+				{
+					options.AI = AIMode::Reactive;
+				}
+				else if (strcmp(argv[i + 1], "predictive") == 0)
+				{
+					options.AI = AIMode::Predictive;
+				}
+				else
+				{
+					cerr << "Unknown value for --ai: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--ai-error") == 0)
+			{
+				options.AIError = static_cast<float>(atof(argv[i + 1]));
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	// Same stand-in player as PongSimDriver, written against the batch columns.
+	void TrackBall(MatchBatch& batch)
+	{
+		const MatchConfig& config = batch.Config();
+		const float* ballY = batch.BallY();
+		const float* paddle1Y = batch.Paddle1Y();
+		const int32_t* gamestates = batch.Gamestates();
+		int32_t* up = batch.Player1Up();
+		int32_t* down = batch.Player1Down();
+		int32_t* start = batch.Start();
+
+		for (size_t i = 0; i < batch.Size(); ++i)
+		{
+			float ballCenterY = ballY[i] + config.BallHeight / 2;
+			up[i] = ballCenterY < paddle1Y[i];
+			down[i] = ballCenterY > paddle1Y[i] + config.PaddleHeight;
+			start[i] = gamestates[i] != static_cast<int32_t>(Gamestate::Playing);
+		}
+	}
+
+	MatchInputs LaneInputs(MatchBatch& batch, size_t index)
+	{
+		MatchInputs inputs;
+		inputs.Player1.Up = batch.Player1Up()[index] != 0;
+		inputs.Player1.Down = batch.Player1Down()[index] != 0;
+		inputs.Start = batch.Start()[index] != 0;
+
+		return inputs;
+	}
+
+	// Steps the batch on the given path and returns match-steps per second. When reference is not
+	// null, the first reference.size() lanes are also stepped through Simulation::Step and checked.
+	double Run(MatchBatch& batch, const BenchmarkOptions& options, vector<MatchState>* reference, bool& matchesReference)
+	{
+		chrono::duration<double> elapsed(0.0);
+		matchesReference = true;
+
+		for (uint32_t frame = 0; frame < options.Frames; ++frame)
+		{
+			TrackBall(batch);
+
+			if (reference != nullptr)
+			{
+				for (size_t i = 0; i < reference->size(); ++i)
+				{
+					Simulation::Step((*reference)[i], LaneInputs(batch, i), options.ElapsedTime);
+				}
+			}
+
+			auto startTime = chrono::steady_clock::now();
+			batch.Step(options.ElapsedTime);
+			elapsed += chrono::steady_clock::now() - startTime;
+
+			if (reference != nullptr)
+			{
+				for (size_t i = 0; i < reference->size(); ++i)
+				{
+					matchesReference = matchesReference && Simulation::SameState((*reference)[i], batch.Match(i));
+				}
+			}
+		}
+
+		return static_cast<double>(batch.Size()) * options.Frames / elapsed.count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options = ParseOptions(argc, argv);
+	MatchConfig config;
+	config.Collision = options.Collision;
+	config.AI = options.AI;
+	config.AIError = options.AIError;
+
+	cout << "Stepping " << options.Matches << " matches for " << options.Frames << " frames on one core" << endl;
+
+	MatchBatch scalarBatch(config, options.Matches, options.Seed);
+	scalarBatch.SetKernelPath(KernelPath::Scalar);
+
+	vector<MatchState> reference;
+	for (uint32_t i = 0; i < min(options.Matches, options.ReferenceMatches); ++i)
+	{
+		reference.push_back(Simulation::CreateMatch(config, options.Seed, i));
+	}
+
+	bool matchesReference;
+	double scalarRate = Run(scalarBatch, options, &reference, matchesReference);
+	cout << left << setw(8) << "Scalar" << fixed << setprecision(1) << setw(10) << scalarRate / 1e6 << "M match-steps/s"
+		<< (matchesReference ? "  (matches Simulation::Step)" : "  (DIVERGES from Simulation::Step)") << endl;
+
+	bool allMatch = matchesReference;
+	for (KernelPath path : { KernelPath::Sse41, KernelPath::Avx2 })
+	{
+		if (!MatchBatch::IsKernelPathSupported(path))
+		{
+			cout << left << setw(8) << MatchBatch::KernelPathName(path) << "not supported on this CPU" << endl;
+			continue;
+		}
+
+		MatchBatch batch(config, options.Matches, options.Seed);
+		batch.SetKernelPath(path);
+
+		bool unused;
+		double rate = Run(batch, options, nullptr, unused);
+
+		bool matchesScalar = true;
+		for (size_t i = 0; i < batch.Size(); ++i)
+		{
+			matchesScalar = matchesScalar && Simulation::SameState(batch.Match(i), scalarBatch.Match(i));
+		}
+		allMatch = allMatch && matchesScalar;
+
+		cout << left << setw(8) << MatchBatch::KernelPathName(path) << fixed << setprecision(1) << setw(10) << rate / 1e6 << "M match-steps/s"
+			<< "  " << setprecision(2) << rate / scalarRate << "x scalar" << (matchesScalar ? "" : "  (DIVERGES from scalar)") << endl;
+	}
+
+	return allMatch ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,317 @@
+#include "BenchmarkReport.h"
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const int32_t FormatVersion = 1;
+
+		struct JsonValue final
+		{
+			enum class Kind { Null, Bool, Number, String, Array, Object };
+
+			Kind Type = Kind::Null;
+			bool Bool = false;
+			double Number = 0.0;
+			string String;
+			vector<JsonValue> Items;
+			map<string, JsonValue> Members;
+
+			const JsonValue& Member(const string& name, Kind type) const
+			{
+				auto member = Members.find(name);
+				if (Type != Kind::Object || member == Members.end() || member->second.Type != type)
+				{
+					throw runtime_error("Benchmark JSON is missing \"" + name + "\".");
+				}
+
+				return member->second;
+			}
+		};
+
+		// enough JSON for reports this tool or a script wrote; \u escapes outside ASCII aren't decoded
+		class JsonParser final
+		{
+		public:
+			explicit JsonParser(const string& text) :
+				mText(text), mPosition(0)
+			{
+			}
+
+			JsonValue ParseDocument()
+			{
+				JsonValue value = ParseValue();
+				SkipWhitespace();
+				if (mPosition != mText.size())
+				{
+					Fail();
+				}
+
+				return value;
+			}
+
+		private:
+			JsonValue ParseValue()
+			{
+				SkipWhitespace();
+				if (mPosition >= mText.size())
+				{
+					Fail();
+				}
+
+				JsonValue value;
+				char next = mText[mPosition];
+				if (next == '{')
+				{
+					value.Type = JsonValue::Kind::Object;
+					++mPosition;
+					if (!Consume('}'))
+					{
+						do
+						{
+							SkipWhitespace();
+							string name = ParseString();
+							Expect(':');
+							value.Members[name] = ParseValue();
+						} while (Consume(','));
+						Expect('}');
+					}
+				}
+				else if (next == '[')
+				{
+					value.Type = JsonValue::Kind::Array;
+					++mPosition;
+					if (!Consume(']'))
+					{
+						do
+						{
+							value.Items.push_back(ParseValue());
+						} while (Consume(','));
+						Expect(']');
+					}
+				}
+				else if (next == '"')
+				{
+					value.Type = JsonValue::Kind::String;
+					value.String = ParseString();
+				}
+				else if (mText.compare(mPosition, 4, "true") == 0 || mText.compare(mPosition, 5, "false") == 0)
+				{
+					value.Type = JsonValue::Kind::Bool;
+					value.Bool = (next == 't');
+					mPosition += (value.Bool ? 4 : 5);
+				}
+				else if (mText.compare(mPosition, 4, "null") == 0)
+				{
+					mPosition += 4;
+				}
+				else
+				{
+					const char* start = mText.c_str() + mPosition;
+					char* end;
+					value.Type = JsonValue::Kind::Number;
+					value.Number = strtod(start, &end);
+					if (end == start)
+					{
+						Fail();
+					}
+					mPosition += static_cast<size_t>(end - start);
+				}
+
+				return value;
+			}
+
+			string ParseString()
+			{
+				if (mPosition >= mText.size() || mText[mPosition] != '"')
+				{
+					Fail();
+				}
+
+				string text;
+				for (++mPosition; mPosition < mText.size() && mText[mPosition] != '"'; ++mPosition)
+				{
+					char next = mText[mPosition];
+					if (next == '\\' && ++mPosition < mText.size())
+					{
+						next = mText[mPosition];
+						switch (next)
+						{
+						case 'n': next = '\n'; break;
+						case 't': next = '\t'; break;
+						case 'r': next = '\r'; break;
+						case 'b': next = '\b'; break;
+						case 'f': next = '\f'; break;
+						case 'u':
+							next = static_cast<char>(strtol(mText.substr(mPosition + 1, 4).c_str(), nullptr, 16));
+							mPosition += 4;
+							break;
+						default: break;
+						}
+					}
+					text += next;
+				}
+
+				if (mPosition >= mText.size())
+				{
+					Fail();
+				}
+				++mPosition;
+
+				return text;
+			}
+
+			void SkipWhitespace()
+			{
+				while (mPosition < mText.size() && (mText[mPosition] == ' ' || mText[mPosition] == '\t' || mText[mPosition] == '\n' || mText[mPosition] == '\r'))
+				{
+					++mPosition;
+				}
+			}
+
+			bool Consume(char expected)
+			{
+				SkipWhitespace();
+				if (mPosition < mText.size() && mText[mPosition] == expected)
+				{
+					++mPosition;
+					return true;
+				}
+
+				return false;
+			}
+
+			void Expect(char expected)
+			{
+				if (!Consume(expected))
+				{
+					Fail();
+				}
+			}
+
+			void Fail() const
+			{
+				throw runtime_error("Benchmark JSON is malformed at offset " + to_string(mPosition) + ".");
+			}
+
+			const string& mText;
+			size_t mPosition;
+		};
+
+		void WriteString(ostream& stream, const string& text)
+		{
+			stream << '"';
+			for (char next : text)
+			{
+				if (next == '"' || next == '\\')
+				{
+					stream << '\\' << next;
+				}
+				else if (static_cast<unsigned char>(next) < 0x20)
+				{
+					stream << "\\u" << hex << setw(4) << setfill('0') << static_cast<int32_t>(next) << dec << setfill(' ');
+				}
+				else
+				{
+					stream << next;
+				}
+			}
+			stream << '"';
+		}
+	}
+
+	void WriteBenchmarkJson(ostream& stream, const BenchmarkReport& report)
+	{
+		// enough digits that reading a report back gives the same doubles
+		stream << setprecision(numeric_limits<double>::max_digits10);
+		stream << "{\n  \"version\": " << FormatVersion << ",\n  \"compiler\": ";
+		WriteString(stream, report.Compiler);
+		stream << ",\n  \"hardware_threads\": " << report.HardwareThreads << ",\n  \"results\": [";
+
+		for (size_t i = 0; i < report.Results.size(); ++i)
+		{
+			const BenchmarkResult& result = report.Results[i];
+			stream << (i == 0 ? "\n" : ",\n") << "    { \"name\": ";
+			WriteString(stream, result.Name);
+			stream << ", \"unit\": ";
+			WriteString(stream, result.Unit);
+			stream << ", \"better\": \"" << (result.HigherIsBetter ? "higher" : "lower") << "\", \"value\": " << result.Value
+				<< ", \"min\": " << result.Min << ", \"max\": " << result.Max << ", \"samples\": " << result.Samples << " }";
+		}
+
+		stream << "\n  ]\n}\n";
+	}
+
+	BenchmarkReport ReadBenchmarkJson(istream& stream)
+	{
+		string text((istreambuf_iterator<char>(stream)), istreambuf_iterator<char>());
+		JsonValue document = JsonParser(text).ParseDocument();
+		if (document.Member("version", JsonValue::Kind::Number).Number != FormatVersion)
+		{
+			throw runtime_error("Benchmark JSON was written by a different report version.");
+		}
+
+		BenchmarkReport report;
+		report.Compiler = document.Member("compiler", JsonValue::Kind::String).String;
+		report.HardwareThreads = static_cast<uint32_t>(document.Member("hardware_threads", JsonValue::Kind::Number).Number);
+		for (const JsonValue& entry : document.Member("results", JsonValue::Kind::Array).Items)
+		{
+			BenchmarkResult result;
+			result.Name = entry.Member("name", JsonValue::Kind::String).String;
+			result.Unit = entry.Member("unit", JsonValue::Kind::String).String;
+			result.HigherIsBetter = (entry.Member("better", JsonValue::Kind::String).String == "higher");
+			result.Value = entry.Member("value", JsonValue::Kind::Number).Number;
+			result.Min = entry.Member("min", JsonValue::Kind::Number).Number;
+			result.Max = entry.Member("max", JsonValue::Kind::Number).Number;
+			result.Samples = static_cast<uint32_t>(entry.Member("samples", JsonValue::Kind::Number).Number);
+			report.Results.push_back(result);
+		}
+
+		return report;
+	}
+
+	vector<BenchmarkComparison> CompareBenchmarks(const BenchmarkReport& baseline, const BenchmarkReport& current, double threshold)
+	{
+		vector<BenchmarkComparison> comparisons;
+		for (const BenchmarkResult& before : baseline.Results)
+		{
+			BenchmarkComparison comparison;
+			comparison.Name = before.Name;
+			comparison.Unit = before.Unit;
+			comparison.Baseline = before.Value;
+			comparison.Missing = true;
+			comparison.UnusableBaseline = !(before.Value > 0.0 && isfinite(before.Value));
+
+			for (const BenchmarkResult& after : current.Results)
+			{
+				if (after.Name == before.Name)
+				{
+					comparison.Current = after.Value;
+					comparison.Missing = false;
+					break;
+				}
+			}
+
+			if (!comparison.Missing && !comparison.UnusableBaseline)
+			{
+				comparison.Change = (before.HigherIsBetter ? before.Value - comparison.Current : comparison.Current - before.Value) / before.Value;
+
+				// written so a NaN result counts as a regression too
+				comparison.Regressed = !(comparison.Change <= threshold);
+			}
+			comparisons.push_back(comparison);
+		}
+
+		return comparisons;
+	}
+}
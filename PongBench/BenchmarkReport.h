@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	struct BenchmarkResult final
+	{
+		std::string Name;
+		std::string Unit;
+		bool HigherIsBetter = false;
+		double Value = 0.0; // the median sample
+		double Min = 0.0;
+		double Max = 0.0;
+		uint32_t Samples = 0;
+	};
+
+	struct BenchmarkReport final
+	{
+		std::string Compiler;
+		uint32_t HardwareThreads = 0;
+		std::vector<BenchmarkResult> Results;
+	};
+
+	struct BenchmarkComparison final
+	{
+		std::string Name;
+		std::string Unit;
+		double Baseline = 0.0;
+		double Current = 0.0;
+		double Change = 0.0; // how much worse, as a fraction of the baseline; negative is better
+		bool Regressed = false;
+		bool Missing = false; // the current report has no result by this name
+		bool UnusableBaseline = false; // the baseline isn't a positive number, so there's nothing to compare against
+	};
+
+	// Results as JSON, one object per benchmark, so other tools and CI can read them without this one:
+	//   { "version": 1, "compiler": "...", "hardware_threads": N,
+	//     "results": [ { "name": "...", "unit": "...", "better": "lower"|"higher",
+	//                    "value": median, "min": ..., "max": ..., "samples": N }, ... ] }
+	void WriteBenchmarkJson(std::ostream& stream, const BenchmarkReport& report);
+	BenchmarkReport ReadBenchmarkJson(std::istream& stream);
+
+	// One comparison for every benchmark in the baseline, in its order. A result regresses when it
+	// is worse than its baseline by more than threshold, a fraction. Benchmarks the current report
+	// lacks come back Missing, and baselines that can't be compared come back UnusableBaseline;
+	// benchmarks only the current report has are left out.
+	std::vector<BenchmarkComparison> CompareBenchmarks(const BenchmarkReport& baseline, const BenchmarkReport& current, double threshold);
+}
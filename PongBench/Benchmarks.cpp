@@ -0,0 +1,275 @@
+#include "Benchmarks.h"
+#include "FixedTimestep.h"
+#include "MatchScene.h"
+#include "PaddleController.h"
+#include "Simulation.h"
+#include "SoftwareRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const size_t PoolSize = 4096;
+		const float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+
+		BenchmarkResult Summarize(const string& name, const string& unit, bool higherIsBetter, vector<double> samples)
+		{
+			sort(samples.begin(), samples.end());
+
+			BenchmarkResult result;
+			result.Name = name;
+			result.Unit = unit;
+			result.HigherIsBetter = higherIsBetter;
+			result.Value = samples[samples.size() / 2];
+			result.Min = samples.front();
+			result.Max = samples.back();
+			result.Samples = static_cast<uint32_t>(samples.size());
+			return result;
+		}
+
+		void Report(ostream& progress, const BenchmarkResult& result)
+		{
+			progress << left << setw(34) << result.Name << right << fixed << setprecision(result.Value < 100.0 ? 2 : 0) << setw(14) << result.Value << " " << left
+				<< setw(10) << result.Unit << right << " (" << setprecision(result.Min < 100.0 ? 2 : 0) << result.Min << " to " << result.Max << ")" << endl;
+		}
+
+		// states from a tracking bot playing the built-in AI, every few frames while the ball is in play
+		vector<MatchState> SamplePlay(const MatchConfig& config, uint32_t seed)
+		{
+			vector<MatchState> pool;
+			pool.reserve(PoolSize);
+
+			TrackingController player1;
+			MatchInputs inputs;
+			for (uint32_t stream = 0; pool.size() < PoolSize; ++stream)
+			{
+				MatchState match = Simulation::CreateMatch(config, seed, stream);
+				for (uint32_t frame = 0; frame < 20000 && pool.size() < PoolSize; ++frame)
+				{
+					inputs.Start = (match.Gamestate != Gamestate::Playing);
+					inputs.Player1 = player1.Control(match, Players::Player1);
+					Simulation::Step(match, inputs, ElapsedTime);
+					if (match.Gamestate == Gamestate::Playing && frame % 5 == 0)
+					{
+						pool.push_back(match);
+					}
+				}
+			}
+
+			return pool;
+		}
+
+		// Nanoseconds a call. A sample is a number of rounds, each one call on every state of a
+		// fresh copy of the pool; only the calls are timed, and the rounds make a sample long enough
+		// that the clock and the odd interruption barely register.
+		BenchmarkResult MeasureMicro(const string& name, const vector<MatchState>& pristine, uint32_t samples, uint32_t rounds, const function<void(MatchState&)>& operation)
+		{
+			vector<MatchState> pool;
+			vector<double> nanoseconds;
+			for (uint32_t sample = 0; sample < samples; ++sample)
+			{
+				chrono::duration<double, nano> elapsed(0.0);
+				for (uint32_t round = 0; round < rounds; ++round)
+				{
+					pool = pristine;
+
+					auto start = chrono::steady_clock::now();
+					for (MatchState& match : pool)
+					{
+						operation(match);
+					}
+					elapsed += chrono::steady_clock::now() - start;
+				}
+				nanoseconds.push_back(elapsed.count() / (static_cast<double>(rounds) * pool.size()));
+			}
+
+			return Summarize(name, "ns/op", false, nanoseconds);
+		}
+
+		// complete games from the serve to GameOver, one after another
+		double PlayFullMatches(const MatchConfig& config, uint32_t seed, uint32_t games)
+		{
+			const uint32_t MaxFramesPerGame = 120 * 60 * 10;
+			TrackingController player1;
+			MatchInputs inputs;
+
+			auto start = chrono::steady_clock::now();
+			for (uint32_t game = 0; game < games; ++game)
+			{
+				MatchState match = Simulation::CreateMatch(config, seed, game);
+				inputs.Start = true;
+				for (uint32_t frame = 0; frame < MaxFramesPerGame && (match.Events & MatchEvents::GameOver) == 0; ++frame)
+				{
+					inputs.Player1 = player1.Control(match, Players::Player1);
+					Simulation::Step(match, inputs, ElapsedTime);
+					inputs.Start = false;
+				}
+			}
+			chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+			return games / elapsed.count();
+		}
+
+		// every match takes a step before any takes the next, as a server hosting them all would
+		double StepConcurrentMatches(const MatchConfig& config, uint32_t seed, uint32_t matchCount, uint32_t frames)
+		{
+			vector<MatchState> matches;
+			matches.reserve(matchCount);
+			for (uint32_t i = 0; i < matchCount; ++i)
+			{
+				matches.push_back(Simulation::CreateMatch(config, seed, i));
+			}
+
+			TrackingController player1;
+			MatchInputs inputs;
+
+			auto start = chrono::steady_clock::now();
+			for (uint32_t frame = 0; frame < frames; ++frame)
+			{
+				for (MatchState& match : matches)
+				{
+					inputs.Start = (match.Gamestate != Gamestate::Playing);
+					inputs.Player1 = player1.Control(match, Players::Player1);
+					Simulation::Step(match, inputs, ElapsedTime);
+				}
+			}
+			chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+			return static_cast<double>(matchCount) * frames / elapsed.count();
+		}
+	}
+
+	vector<BenchmarkResult> RunBenchmarks(const BenchmarkOptions& options, ostream& progress)
+	{
+		vector<BenchmarkResult> results;
+		auto selected = [&options](const string& name)
+		{
+			return options.Filter.empty() || name.find(options.Filter) != string::npos;
+		};
+		auto add = [&results, &progress](const BenchmarkResult& result)
+		{
+			Report(progress, result);
+			results.push_back(result);
+		};
+
+		// the game's own sprite sizes, as the score text needs its font anyway
+		SoftwareRenderer renderer(800, 600);
+		MatchScene scene(renderer, options.ContentDirectory);
+		MatchConfig config;
+		config.BallWidth = scene.BallSize().X;
+		config.BallHeight = scene.BallSize().Y;
+		config.PaddleWidth = scene.PaddleSize().X;
+		config.PaddleHeight = scene.PaddleSize().Y;
+
+		const vector<MatchState> play = SamplePlay(config, options.Seed);
+		const uint32_t samples = max(options.Samples, 1u);
+		const uint32_t rounds = max(static_cast<uint32_t>(40 * options.Scale), 1u);
+
+		if (selected("micro/UpdateBall"))
+		{
+			add(MeasureMicro("micro/UpdateBall", play, samples, rounds, [](MatchState& match) { Simulation::UpdateBall(match, ElapsedTime); }));
+		}
+
+		if (selected("micro/HandleBallPhysics"))
+		{
+			// half the balls pressed against a paddle, so the contact path is timed as well as the miss
+			vector<MatchState> pool = play;
+			for (size_t i = 1; i < pool.size(); i += 2)
+			{
+				PaddleState& paddle = (i % 4 == 1 ? pool[i].Paddle1 : pool[i].Paddle2);
+				pool[i].Ball.Bounds.X = paddle.Bounds.X;
+				pool[i].Ball.Bounds.Y = paddle.Bounds.Y + paddle.Bounds.Height / 2;
+				pool[i].IsIntersecting = false;
+			}
+			add(MeasureMicro("micro/HandleBallPhysics", pool, samples, rounds, [](MatchState& match) { Simulation::HandleBallPhysics(match); }));
+		}
+
+		if (selected("micro/AdjustAIPaddleVelocity"))
+		{
+			add(MeasureMicro("micro/AdjustAIPaddleVelocity", play, samples, rounds, [](MatchState& match) { Simulation::AdjustAIPaddleVelocity(match); }));
+		}
+
+		if (selected("micro/UpdatePlayerScores"))
+		{
+			// a point for one side or the other, never the last, so each call scores and serves again
+			vector<MatchState> pool = play;
+			for (size_t i = 0; i < pool.size(); ++i)
+			{
+				pool[i].Ball.Player1Scored = (i % 2 == 0);
+				pool[i].Ball.Player2Scored = (i % 2 != 0);
+				pool[i].Player1Score = 0;
+				pool[i].Player2Score = 0;
+			}
+			add(MeasureMicro("micro/UpdatePlayerScores", pool, samples, rounds, [](MatchState& match) { Simulation::UpdatePlayerScores(match); }));
+		}
+
+		if (selected("micro/ScoreText"))
+		{
+			// every state shows a different score from the one before it, so each call lays the text out again
+			vector<MatchState> pool = play;
+			for (size_t i = 0; i < pool.size(); ++i)
+			{
+				pool[i].Player1Score = static_cast<int32_t>(i % 10);
+				pool[i].Player2Score = static_cast<int32_t>(i / 10 % 10);
+			}
+			add(MeasureMicro("micro/ScoreText", pool, samples, rounds, [&scene](MatchState& match) { scene.UpdateHud(match, 800.0f, 600.0f); }));
+		}
+
+		if (selected("micro/ResetBall"))
+		{
+			add(MeasureMicro("micro/ResetBall", play, samples, rounds, [](MatchState& match) { Simulation::ResetBall(match); }));
+		}
+
+		if (selected("micro/ChangeGamestate"))
+		{
+			// a finished match starting over: ball, paddles and scores all reset
+			vector<MatchState> pool = play;
+			for (MatchState& match : pool)
+			{
+				match.Gamestate = Gamestate::Gameover;
+			}
+			add(MeasureMicro("micro/ChangeGamestate", pool, samples, rounds, [](MatchState& match) { Simulation::ChangeGamestate(match, Gamestate::Playing); }));
+		}
+
+		const uint32_t macroSamples = max(samples / 5, 1u);
+		if (selected("macro/full-matches"))
+		{
+			uint32_t games = max(static_cast<uint32_t>(200 * options.Scale), 1u);
+			vector<double> rates;
+			for (uint32_t sample = 0; sample < macroSamples; ++sample)
+			{
+				rates.push_back(PlayFullMatches(config, options.Seed, games));
+			}
+			add(Summarize("macro/full-matches", "matches/s", true, rates));
+		}
+
+		// the same number of steps at each size, so only how many matches are in flight changes
+		const uint32_t matchCounts[] = { 1, 1000, 100000 };
+		const double stepsPerSample = 10000000.0 * options.Scale;
+		for (uint32_t matchCount : matchCounts)
+		{
+			string name = "macro/concurrent-" + to_string(matchCount);
+			if (!selected(name))
+			{
+				continue;
+			}
+
+			uint32_t frames = max(static_cast<uint32_t>(stepsPerSample / matchCount), 1u);
+			vector<double> rates;
+			for (uint32_t sample = 0; sample < macroSamples; ++sample)
+			{
+				rates.push_back(StepConcurrentMatches(config, options.Seed, matchCount, frames));
+			}
+			add(Summarize(name, "frames/s", true, rates));
+		}
+
+		return results;
+	}
+}
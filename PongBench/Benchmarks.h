@@ -0,0 +1,26 @@
+#pragma once
+
+#include "BenchmarkReport.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	struct BenchmarkOptions final
+	{
+		std::string ContentDirectory;
+		std::string Filter; // runs only the benchmarks whose names contain this
+		uint32_t Samples = 31; // per micro-benchmark; the macro-benchmarks take a fifth as many
+		double Scale = 1.0; // of the work per sample, for quick runs
+		uint32_t Seed = 1;
+	};
+
+	// The micro-benchmarks time one rule at a time over a pool of states sampled from real play,
+	// restoring the pool between samples so every sample does the same work. The macro-benchmarks
+	// play whole matches: complete games one after another, and 1, 1,000 and 100,000 matches
+	// stepped side by side. Each result is the median sample; progress goes to the stream as
+	// results come in.
+	std::vector<BenchmarkResult> RunBenchmarks(const BenchmarkOptions& options, std::ostream& progress);
+}
@@ -0,0 +1,231 @@
+#include "BenchmarkReport.h"
+#include "Benchmarks.h"
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	void PrintUsage()
+	{
+		cerr << "Usage: PongBench run [--json file] [--filter text] [--samples N] [--quick]" << endl;
+		cerr << "       PongBench compare <baseline.json> <current.json> [--threshold percent] [--allow-missing]" << endl;
+	}
+
+	string CompilerName()
+	{
+#if defined(__clang__)
+		return string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+		return string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+		return "msvc " + to_string(_MSC_VER);
+#else
+		return "unknown";
+#endif
+	}
+
+	int Run(int argc, char* argv[])
+	{
+		BenchmarkOptions options;
+		options.ContentDirectory = PONG_CONTENT_DIRECTORY;
+		string jsonPath;
+
+		for (int i = 2; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--quick") == 0)
+			{
+				options.Samples = 11;
+				options.Scale = 0.1;
+				continue;
+			}
+
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				return EXIT_FAILURE;
+			}
+
+			const char* value = argv[++i];
+			if (strcmp(argv[i - 1], "--json") == 0)
+			{
+				jsonPath = value;
+			}
+			else if (strcmp(argv[i - 1], "--filter") == 0)
+			{
+				options.Filter = value;
+			}
+			else if (strcmp(argv[i - 1], "--samples") == 0)
+			{
+				options.Samples = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--content") == 0)
+			{
+				options.ContentDirectory = value;
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i - 1] << endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+#if defined(PONG_PROFILE)
+		cout << "This build has the profiler compiled in, which slows every rule it times" << endl;
+#endif
+
+		BenchmarkReport report;
+		report.Compiler = CompilerName();
+		report.HardwareThreads = thread::hardware_concurrency();
+		report.Results = RunBenchmarks(options, cout);
+
+		if (!jsonPath.empty())
+		{
+			ofstream stream(jsonPath);
+			WriteBenchmarkJson(stream, report);
+			if (!stream)
+			{
+				cerr << "Couldn't write " << jsonPath << endl;
+				return EXIT_FAILURE;
+			}
+			cout << "Wrote " << report.Results.size() << " results to " << jsonPath << endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	BenchmarkReport Load(const string& path)
+	{
+		ifstream stream(path);
+		if (!stream)
+		{
+			throw runtime_error("Couldn't open " + path + ".");
+		}
+
+		return ReadBenchmarkJson(stream);
+	}
+
+	// Exits nonzero when any benchmark got worse by more than the threshold, so CI can gate on it. A
+	// benchmark that didn't run, or a baseline that can't be compared against, fails the gate too,
+	// unless --allow-missing says a partial report is expected.
+	int Compare(int argc, char* argv[])
+	{
+		double thresholdPercent = 10.0;
+		bool allowMissing = false;
+		for (int i = 4; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--allow-missing") == 0)
+			{
+				allowMissing = true;
+				continue;
+			}
+
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				return EXIT_FAILURE;
+			}
+
+			const char* value = argv[++i];
+			if (strcmp(argv[i - 1], "--threshold") == 0)
+			{
+				thresholdPercent = atof(value);
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i - 1] << endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		BenchmarkReport baseline = Load(argv[2]);
+		BenchmarkReport current = Load(argv[3]);
+		if (baseline.Compiler != current.Compiler)
+		{
+			cout << "The reports come from different compilers (" << baseline.Compiler << " and " << current.Compiler << ")" << endl;
+		}
+
+		vector<BenchmarkComparison> comparisons = CompareBenchmarks(baseline, current, thresholdPercent / 100.0);
+		size_t regressions = 0;
+		size_t missing = 0;
+		size_t unusable = 0;
+		for (const BenchmarkComparison& comparison : comparisons)
+		{
+			if (comparison.Missing || comparison.UnusableBaseline)
+			{
+				cout << left << setw(34) << comparison.Name << right << (comparison.Missing ? "  MISSING from " + string(argv[3]) : "  UNUSABLE baseline") << endl;
+				missing += (comparison.Missing ? 1 : 0);
+				unusable += (!comparison.Missing && comparison.UnusableBaseline ? 1 : 0);
+				continue;
+			}
+
+			cout << left << setw(34) << comparison.Name << right << fixed << setprecision(comparison.Baseline < 100.0 ? 2 : 0) << setw(14) << comparison.Baseline
+				<< " -> " << setw(14) << comparison.Current << " " << left << setw(10) << comparison.Unit << right << setprecision(1) << showpos
+				<< setw(7) << 100.0 * comparison.Change << noshowpos << "% worse" << (comparison.Regressed ? "  REGRESSED" : "") << endl;
+			regressions += (comparison.Regressed ? 1 : 0);
+		}
+
+		bool failed = false;
+		if (baseline.Results.empty())
+		{
+			cout << argv[2] << " has no results to compare against" << endl;
+			failed = true;
+		}
+		if (missing > 0)
+		{
+			cout << missing << " baseline benchmarks are missing from " << argv[3] << (allowMissing ? ", which --allow-missing permits" : "") << endl;
+			failed = failed || !allowMissing;
+		}
+		if (unusable > 0)
+		{
+			cout << unusable << " baseline benchmarks have no usable value in " << argv[2] << endl;
+			failed = true;
+		}
+		if (regressions > 0)
+		{
+			cout << regressions << " of " << comparisons.size() << " benchmarks regressed by more than " << thresholdPercent << "%" << endl;
+			failed = true;
+		}
+
+		if (failed)
+		{
+			return EXIT_FAILURE;
+		}
+
+		cout << "No benchmark regressed by more than " << thresholdPercent << "%" << endl;
+		return EXIT_SUCCESS;
+	}
+}
+
+// Baselines for the rules and the whole match loop: run writes the results as JSON, and compare
+// checks a new run against a saved one.
+int main(int argc, char* argv[])
+{
+	try
+	{
+		if (argc >= 2 && strcmp(argv[1], "run") == 0)
+		{
+			return Run(argc, argv);
+		}
+		else if (argc >= 4 && strcmp(argv[1], "compare") == 0)
+		{
+			return Compare(argc, argv);
+		}
+	}
+	catch (const exception& exception)
+	{
+		cerr << exception.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	PrintUsage();
+	return EXIT_FAILURE;
+}
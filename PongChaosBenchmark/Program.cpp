@@ -0,0 +1,177 @@
+#include "ChaosMatch.h"
+#include "FixedTimestep.h"
+#include "SpatialGrid.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct BenchmarkOptions
+	{
+		uint32_t Steps = 600;
+		uint32_t MaxBalls = 20000;
+		uint32_t PaddlesPerSide = 8;
+		float AreaPerBall = 800.0f * 600.0f / 256.0f; // the density of 256 balls in the game's window
+		bool FixedArena = false;
+		uint32_t Seed = 1;
+	};
+
+	BenchmarkOptions ParseOptions(int argc, char* argv[])
+	{
+		BenchmarkOptions options;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--fixed-arena") == 0)
+			{
+				options.FixedArena = true;
+			}
+			else if (i + 1 < argc && strcmp(argv[i], "--steps") == 0)
+			{
+				options.Steps = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			}
+			else if (i + 1 < argc && strcmp(argv[i], "--max-balls") == 0)
+			{
+				options.MaxBalls = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			}
+			else if (i + 1 < argc && strcmp(argv[i], "--paddles") == 0)
+			{
+				options.PaddlesPerSide = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			}
+			else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	ChaosConfig MakeConfig(const BenchmarkOptions& options, uint32_t ballCount)
+	{
+		// the arena grows with the ball count unless it's fixed, keeping the same crowding
+		ChaosConfig config;
+		config.BallCount = ballCount;
+		config.PaddlesPerSide = options.PaddlesPerSide;
+		config.Player1Control = PaddleControl::BuiltInAI;
+		if (!options.FixedArena)
+		{
+			float scale = max(sqrt(options.AreaPerBall * ballCount / (config.Match.ViewportWidth * config.Match.ViewportHeight)), 1.0f);
+			config.Match.ViewportWidth *= scale;
+			config.Match.ViewportHeight *= scale;
+		}
+
+		return config;
+	}
+
+	// Overlapping ball pairs found by testing every pair, and by the grid's neighbourhood queries.
+	void CountOverlaps(const ChaosMatch& match, uint64_t& bruteForce, uint64_t& grid)
+	{
+		const MatchConfig& config = match.Config().Match;
+		const float* x = match.BallX();
+		const float* y = match.BallY();
+		size_t count = match.BallCount();
+		auto overlaps = [&](size_t a, size_t b)
+		{
+			return fabs(x[a] - x[b]) < config.BallWidth && fabs(y[a] - y[b]) < config.BallHeight;
+		};
+
+		bruteForce = 0;
+		for (size_t a = 0; a < count; ++a)
+		{
+			for (size_t b = a + 1; b < count; ++b)
+			{
+				bruteForce += overlaps(a, b);
+			}
+		}
+
+		SpatialGrid spatialGrid(config.ViewportWidth, config.ViewportHeight, max(config.BallWidth, config.BallHeight));
+		spatialGrid.Build(x, y, count);
+		grid = 0;
+		for (size_t a = 0; a < count; ++a)
+		{
+			int32_t column = static_cast<int32_t>(spatialGrid.Column(x[a]));
+			int32_t row = static_cast<int32_t>(spatialGrid.Row(y[a]));
+			for (int32_t r = max(row - 1, 0); r <= min(row + 1, static_cast<int32_t>(spatialGrid.RowCount()) - 1); ++r)
+			{
+				for (int32_t c = max(column - 1, 0); c <= min(column + 1, static_cast<int32_t>(spatialGrid.ColumnCount()) - 1); ++c)
+				{
+					for (const uint32_t* b = spatialGrid.CellBegin(c, r); b != spatialGrid.CellEnd(c, r); ++b)
+					{
+						grid += (*b > a && overlaps(a, *b));
+					}
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options = ParseOptions(argc, argv);
+	float elapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+	MatchInputs inputs;
+
+	cout << "Stepping multi-ball matches " << options.Steps << " times, " << options.PaddlesPerSide << " paddles a side, "
+		<< (options.FixedArena ? "in the game's arena" : "in an arena scaled to the ball count") << endl;
+	cout << setw(8) << "balls" << setw(14) << "arena" << setw(12) << "ms/step" << setw(14) << "ns/ball" << setw(16) << "contacts/step" << endl;
+
+	bool agreed = true;
+	const uint32_t ballCounts[] = { 100, 250, 500, 1000, 2500, 5000, 10000, 20000, 50000, 100000 };
+	for (uint32_t ballCount : ballCounts)
+	{
+		if (ballCount > options.MaxBalls)
+		{
+			break;
+		}
+
+		ChaosConfig config = MakeConfig(options, ballCount);
+		ChaosMatch match(config, options.Seed);
+
+		// settle the serves off the center line before timing
+		for (uint32_t step = 0; step < 60; ++step)
+		{
+			match.Step(inputs, elapsedTime);
+		}
+
+		uint64_t contacts = 0;
+		auto startTime = chrono::steady_clock::now();
+		for (uint32_t step = 0; step < options.Steps; ++step)
+		{
+			match.Step(inputs, elapsedTime);
+			contacts += match.BallContacts();
+		}
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+		double secondsPerStep = elapsed.count() / options.Steps;
+		ostringstream arena;
+		arena << static_cast<int32_t>(config.Match.ViewportWidth) << "x" << static_cast<int32_t>(config.Match.ViewportHeight);
+		cout << setw(8) << ballCount << setw(14) << arena.str() << fixed << setprecision(3) << setw(12) << secondsPerStep * 1e3
+			<< setprecision(1) << setw(14) << secondsPerStep * 1e9 / ballCount << setw(16) << static_cast<double>(contacts) / options.Steps << endl;
+
+		uint64_t bruteForce;
+		uint64_t grid;
+		CountOverlaps(match, bruteForce, grid);
+		if (bruteForce != grid)
+		{
+			cout << "    the grid found " << grid << " overlapping pairs where testing every pair found " << bruteForce << endl;
+			agreed = false;
+		}
+	}
+
+	return agreed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
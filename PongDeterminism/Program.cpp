@@ -0,0 +1,185 @@
+#include "FixedSimulation.h"
+#include "Simulation.h"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct DeterminismOptions
+	{
+		uint32_t Matches = 16;
+		uint32_t Frames = 20000;
+		uint32_t Seed = 1;
+		string Expect;
+	};
+
+	struct Scenario
+	{
+		const char* Name;
+		MatchConfig Config;
+		float ElapsedTime;
+	};
+
+	DeterminismOptions ParseOptions(int argc, char* argv[])
+	{
+		DeterminismOptions options;
+
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--matches") == 0)
+			{
+				options.Matches = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--expect") == 0)
+			{
+				options.Expect = argv[i + 1];
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	Scenario MakeScenario(const char* name, CollisionMode collision, AIMode ai, float aiError, PaddleControl player2, float elapsedTime)
+	{
+		Scenario scenario;
+		scenario.Name = name;
+		scenario.Config.Physics = PhysicsMode::FixedPoint;
+		scenario.Config.Collision = collision;
+		scenario.Config.AI = ai;
+		scenario.Config.AIError = aiError;
+		scenario.Config.Player2Control = player2;
+		scenario.ElapsedTime = elapsedTime;
+		return scenario;
+	}
+
+	uint32_t NextNoise(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// The controllers in PaddleController read the float copies, which is exactly what this has
+	// to keep out of the match, so the scripted players follow the ball in fixed point and now
+	// and then let go for a while so points get scored.
+	PaddleInputs Track(const FixedBody& paddle, const FixedBody& ball, bool approaching, bool distracted)
+	{
+		PaddleInputs inputs;
+		if (!approaching || distracted)
+		{
+			return inputs;
+		}
+
+		Fixed offset = (ball.Y + ball.Height.Half()) - (paddle.Y + paddle.Height.Half());
+		Fixed tolerance = paddle.Height.Half().Half();
+		inputs.Down = (offset > tolerance);
+		inputs.Up = (offset < -tolerance);
+		return inputs;
+	}
+
+	void Mix(uint64_t& hash, uint64_t value)
+	{
+		hash = (hash ^ value) * 1099511628211ull;
+	}
+
+	string Hex(uint64_t value)
+	{
+		ostringstream text;
+		text << hex << setw(16) << setfill('0') << value;
+		return text.str();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	DeterminismOptions options = ParseOptions(argc, argv);
+
+	// both collision modes, both AIs, and step lengths that aren't a whole number of Q16.16 units
+	const Scenario scenarios[] =
+	{
+		MakeScenario("discrete reactive 120Hz", CollisionMode::Discrete, AIMode::Reactive, 0.0f, PaddleControl::BuiltInAI, 1.0f / 120.0f),
+		MakeScenario("discrete predictive 144Hz", CollisionMode::Discrete, AIMode::Predictive, 0.0f, PaddleControl::BuiltInAI, 1.0f / 144.0f),
+		MakeScenario("swept predictive 60Hz", CollisionMode::Swept, AIMode::Predictive, 40.0f, PaddleControl::BuiltInAI, 1.0f / 60.0f),
+		MakeScenario("swept two players 30Hz", CollisionMode::Swept, AIMode::Reactive, 0.0f, PaddleControl::Inputs, 1.0f / 30.0f),
+	};
+
+	uint64_t combined = 14695981039346656037ull;
+	for (const Scenario& scenario : scenarios)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		uint64_t gamesCompleted = 0;
+		uint64_t points = 0;
+
+		for (uint32_t i = 0; i < options.Matches; ++i)
+		{
+			MatchState match = Simulation::CreateMatch(scenario.Config, options.Seed, i);
+			uint32_t noise = (options.Seed + i) * 2654435761u | 1;
+			bool distracted[2] = { false, false };
+
+			for (uint32_t frame = 0; frame < options.Frames; ++frame)
+			{
+				// a fresh coin every quarter second or so, one in six of them a lapse
+				if (frame % 32 == 0)
+				{
+					distracted[0] = (NextNoise(noise) % 6 == 0);
+					distracted[1] = (NextNoise(noise) % 6 == 0);
+				}
+
+				const FixedMatchState& state = match.FixedState;
+				MatchInputs inputs;
+				inputs.Start = (match.Gamestate != Gamestate::Playing);
+				inputs.Player1 = Track(state.Paddle1, state.Ball, state.Ball.VelocityX < Fixed(), distracted[0]);
+				inputs.Player2 = Track(state.Paddle2, state.Ball, state.Ball.VelocityX > Fixed(), distracted[1]);
+				Simulation::Step(match, inputs, scenario.ElapsedTime);
+
+				Mix(hash, FixedSimulation::StateHash(match));
+				gamesCompleted += ((match.Events & MatchEvents::GameOver) != 0);
+				points += ((match.Events & (MatchEvents::Player1Scored | MatchEvents::Player2Scored)) != 0);
+			}
+		}
+
+		cout << left << setw(28) << scenario.Name << right << setw(8) << points << " points" << setw(7) << gamesCompleted << " games  " << Hex(hash) << endl;
+		Mix(combined, hash);
+	}
+
+	cout << "Combined hash: " << Hex(combined) << endl;
+
+	if (!options.Expect.empty())
+	{
+		if (options.Expect != Hex(combined))
+		{
+			cout << "Expected " << options.Expect << ": this build simulates fixed point matches differently" << endl;
+			return EXIT_FAILURE;
+		}
+		cout << "Matches the expected hash" << endl;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+#include "PongEnvironment.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+	struct BenchmarkOptions
+	{
+		uint32_t Environments = 1024;
+		uint32_t Steps = 5000;
+		uint32_t Threads = 0;
+		uint32_t FrameSkip = 1;
+	};
+
+	BenchmarkOptions ParseOptions(int argc, char* argv[])
+	{
+		BenchmarkOptions options;
+
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--envs") == 0)
+			{
+				options.Environments = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--steps") == 0)
+			{
+				options.Steps = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--threads") == 0)
+			{
+				options.Threads = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--frameskip") == 0)
+			{
+				options.FrameSkip = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	struct RunResult
+	{
+		double StepsPerSecond = 0.0;
+		uint64_t Episodes = 0;
+		double TotalReward = 0.0;
+		vector<float> Observations;
+	};
+
+	// Steps every environment with the same stream of random actions, like an untrained agent.
+	RunResult Run(const BenchmarkOptions& options, uint32_t threadCount)
+	{
+		PongEnvironmentOptions environmentOptions;
+		PongEnvironmentDefaultOptions(&environmentOptions);
+		environmentOptions.Count = options.Environments;
+		environmentOptions.ThreadCount = threadCount;
+		environmentOptions.FrameSkip = options.FrameSkip;
+
+		PongEnvironment* environment = PongEnvironmentCreate(&environmentOptions);
+		if (environment == nullptr)
+		{
+			cerr << PongEnvironmentLastError() << endl;
+			exit(EXIT_FAILURE);
+		}
+
+		// allocated once, like numpy arrays handed in from Python
+		size_t count = options.Environments;
+		RunResult result;
+		result.Observations.resize(count * PongEnvironmentObservationSize());
+		vector<uint32_t> seeds(count);
+		vector<int32_t> actions(count);
+		vector<float> rewards(count);
+		vector<uint8_t> terminated(count);
+		vector<uint8_t> truncated(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			seeds[i] = static_cast<uint32_t>(i + 1);
+		}
+		PongEnvironmentReset(environment, seeds.data(), result.Observations.data());
+
+		minstd_rand generator(1);
+		chrono::duration<double> elapsed(0.0);
+		for (uint32_t step = 0; step < options.Steps; ++step)
+		{
+			for (int32_t& action : actions)
+			{
+				action = static_cast<int32_t>(generator() % PongEnvironmentActionCount());
+			}
+
+			auto startTime = chrono::steady_clock::now();
+			PongEnvironmentStep(environment, actions.data(), result.Observations.data(), rewards.data(), terminated.data(), truncated.data());
+			elapsed += chrono::steady_clock::now() - startTime;
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				result.Episodes += (terminated[i] || truncated[i]);
+				result.TotalReward += rewards[i];
+			}
+		}
+
+		PongEnvironmentDestroy(environment);
+
+		result.StepsPerSecond = static_cast<double>(count) * options.Steps / elapsed.count();
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options = ParseOptions(argc, argv);
+	uint32_t threadCount = (options.Threads == 0 ? max(thread::hardware_concurrency(), 1u) : options.Threads);
+
+	cout << "Stepping " << options.Environments << " environments " << options.Steps << " times" << endl;
+
+	RunResult single = Run(options, 1);
+	cout << left << setw(12) << "1 thread" << fixed << setprecision(2) << setw(8) << single.StepsPerSecond / 1e6 << "M env-steps/s, "
+		<< single.Episodes << " episodes, total reward " << setprecision(0) << single.TotalReward << endl;
+
+	RunResult threaded = Run(options, threadCount);
+	bool matches = (threaded.Observations == single.Observations && threaded.Episodes == single.Episodes && threaded.TotalReward == single.TotalReward);
+	cout << left << setw(12) << (to_string(threadCount) + " threads") << fixed << setprecision(2) << setw(8) << threaded.StepsPerSecond / 1e6 << "M env-steps/s, "
+		<< setprecision(2) << threaded.StepsPerSecond / single.StepsPerSecond << "x" << (matches ? "" : "  (DIVERGES from 1 thread)") << endl;
+
+	return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,114 @@
+#include "PongEnvironment.h"
+#include "VectorEnvironment.h"
+#include <exception>
+#include <memory>
+#include <string>
+
+using namespace Pong;
+using namespace std;
+
+struct PongEnvironment
+{
+	unique_ptr<VectorEnvironment> Environment;
+};
+
+namespace
+{
+	thread_local string LastError;
+
+	// exceptions can't cross the C boundary, so each one becomes a message and a failure code
+	template <typename Function>
+	int32_t Guard(Function function)
+	{
+		try
+		{
+			function();
+			return 0;
+		}
+		catch (const exception& exception)
+		{
+			LastError = exception.what();
+		}
+		catch (...)
+		{
+			LastError = "Unknown error.";
+		}
+
+		return -1;
+	}
+}
+
+void PongEnvironmentDefaultOptions(PongEnvironmentOptions* options)
+{
+	EnvironmentOptions defaults;
+	options->Count = 1;
+	options->ThreadCount = defaults.ThreadCount;
+	options->FrameSkip = defaults.FrameSkip;
+	options->MaxEpisodeFrames = defaults.MaxEpisodeFrames;
+	options->AutoReset = defaults.AutoReset;
+	options->PredictiveAI = (defaults.Config.AI == AIMode::Predictive);
+	options->AIError = defaults.Config.AIError;
+	options->Opponent = nullptr;
+}
+
+uint32_t PongEnvironmentObservationSize(void)
+{
+	return VectorEnvironment::ObservationSize;
+}
+
+uint32_t PongEnvironmentActionCount(void)
+{
+	return PolicyNetwork::ActionCount;
+}
+
+PongEnvironment* PongEnvironmentCreate(const PongEnvironmentOptions* options)
+{
+	unique_ptr<PongEnvironment> environment(new PongEnvironment);
+
+	int32_t result = Guard([&]
+	{
+		EnvironmentOptions environmentOptions;
+		environmentOptions.ThreadCount = options->ThreadCount;
+		environmentOptions.FrameSkip = options->FrameSkip;
+		environmentOptions.MaxEpisodeFrames = options->MaxEpisodeFrames;
+		environmentOptions.AutoReset = (options->AutoReset != 0);
+		environmentOptions.Config.AI = (options->PredictiveAI != 0 ? AIMode::Predictive : AIMode::Reactive);
+		environmentOptions.Config.AIError = options->AIError;
+
+		shared_ptr<const PaddleController> opponent;
+		if (options->Opponent != nullptr && options->Opponent[0] != '\0')
+		{
+			opponent = PaddleController::Create(options->Opponent);
+		}
+
+		environment->Environment = make_unique<VectorEnvironment>(environmentOptions, options->Count, opponent);
+	});
+
+	return (result == 0 ? environment.release() : nullptr);
+}
+
+void PongEnvironmentDestroy(PongEnvironment* environment)
+{
+	delete environment;
+}
+
+int32_t PongEnvironmentReset(PongEnvironment* environment, const uint32_t* seeds, float* observations)
+{
+	return Guard([&]
+	{
+		environment->Environment->Reset(seeds, observations);
+	});
+}
+
+int32_t PongEnvironmentStep(PongEnvironment* environment, const int32_t* actions, float* observations, float* rewards, uint8_t* terminated, uint8_t* truncated)
+{
+	return Guard([&]
+	{
+		environment->Environment->Step(actions, observations, rewards, terminated, truncated);
+	});
+}
+
+const char* PongEnvironmentLastError(void)
+{
+	return LastError.c_str();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// C interface to Pong::VectorEnvironment, for ctypes, cffi or any other foreign function
+// interface. Every buffer is the caller's and is written in place: observations are count rows of
+// PongEnvironmentObservationSize() floats, everything else one entry per match. Functions that can
+// fail return 0 on success and -1 on failure, with the reason in PongEnvironmentLastError().
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(PONG_ENVIRONMENT_EXPORTS)
+#define PONG_ENVIRONMENT_API __declspec(dllexport)
+#else
+#define PONG_ENVIRONMENT_API __declspec(dllimport)
+#endif
+#else
+#define PONG_ENVIRONMENT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	typedef struct PongEnvironment PongEnvironment;
+
+	typedef struct PongEnvironmentOptions
+	{
+		uint32_t Count;
+		uint32_t ThreadCount; /* zero means one per hardware thread */
+		uint32_t FrameSkip;
+		uint32_t MaxEpisodeFrames; /* zero never truncates */
+		int32_t AutoReset;
+		int32_t PredictiveAI; /* the built-in opponent plans intercepts instead of chasing */
+		float AIError;
+		const char* Opponent; /* a PaddleController spec for player 2, or null for the built-in AI */
+	} PongEnvironmentOptions;
+
+	PONG_ENVIRONMENT_API void PongEnvironmentDefaultOptions(PongEnvironmentOptions* options);
+	PONG_ENVIRONMENT_API uint32_t PongEnvironmentObservationSize(void);
+	PONG_ENVIRONMENT_API uint32_t PongEnvironmentActionCount(void);
+
+	/* returns null on failure */
+	PONG_ENVIRONMENT_API PongEnvironment* PongEnvironmentCreate(const PongEnvironmentOptions* options);
+	PONG_ENVIRONMENT_API void PongEnvironmentDestroy(PongEnvironment* environment);
+
+	PONG_ENVIRONMENT_API int32_t PongEnvironmentReset(PongEnvironment* environment, const uint32_t* seeds, float* observations);
+	PONG_ENVIRONMENT_API int32_t PongEnvironmentStep(PongEnvironment* environment, const int32_t* actions, float* observations, float* rewards, uint8_t* terminated, uint8_t* truncated);
+
+	/* the last failure on the calling thread */
+	PONG_ENVIRONMENT_API const char* PongEnvironmentLastError(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,162 +1,37 @@
 #include "pch.h"
 #include "Ball.h"
+#include "MatchScene.h"
 
 using namespace DirectX;
 using namespace Library;
 using namespace std;
-using namespace Microsoft::WRL;
 
 namespace Pong
 {
-	const int Ball::MinBallSpeed = 200;
-	const int Ball::MaxBallSpeed = 300;
-
-	random_device Ball::sDevice;
-	default_random_engine Ball::sGenerator(sDevice());
-	uniform_int_distribution<int> Ball::sBoolDistribution(0, 1);
-	uniform_int_distribution<int> Ball::sSpeedDistribution(MinBallSpeed, MaxBallSpeed);
-
-	Ball::Ball(Game& game) :
-		DrawableGameComponent(game), mBounds(Rectangle::Empty)
-	{
-	}
-
-	const Library::Rectangle& Ball::Bounds() const
+	Ball::Ball(Game& game, MatchScene& scene, const BallState& previousState, const BallState& state, const FixedTimestep& timestep) :
+		DrawableGameComponent(game), mScene(&scene), mPreviousState(&previousState), mState(&state), mTimestep(&timestep)
 	{
-		return mBounds;
 	}
 
-	DirectX::XMFLOAT2& Ball::Velocity()
+	const Library::Point& Ball::TextureSize() const
 	{
-		return mVelocity;
+		return mTextureSize;
 	}
 
 	void Ball::Initialize()
 	{
-		// Load a texture
-		ComPtr<ID3D11Resource> textureResource;
-		wstring textureName = L"Content\\Textures\\Ball.png";
-
-		ThrowIfFailed(CreateWICTextureFromFile(mGame->Direct3DDevice(), textureName.c_str(), textureResource.ReleaseAndGetAddressOf(), mTexture.ReleaseAndGetAddressOf()), "CreateWICTextureFromFile() failed.");
-
-		ComPtr<ID3D11Texture2D> texture;
-		ThrowIfFailed(textureResource.As(&texture), "Invalid ID3D11Resource returned from CreateWICTextureFromFile. Should be a ID3D11Texture2D.");
-
-		mBounds = TextureHelper::GetTextureBounds(texture.Get());
-		mTextureHalfSize.X = mBounds.Width / 2;
-		mTextureHalfSize.Y = mBounds.Height / 2;
-
-		mKeyboard = reinterpret_cast<KeyboardComponent*>(mGame->Services().GetService(KeyboardComponent::TypeIdClass()));
-
-		mPlayer1Scored = false;
-		mPlayer2Scored = false;
-		
-		Reset();
-	}
-
-	void Ball::Update(const Library::GameTime& gameTime)
-	{
-		float elapsedTime = gameTime.ElapsedGameTimeSeconds().count();
-
-		XMFLOAT2 positionDelta(mVelocity.x * elapsedTime, mVelocity.y * elapsedTime);
-		mBounds.X += static_cast<int>(std::round(positionDelta.x));
-		mBounds.Y += static_cast<int>(std::round(positionDelta.y));
-
-		auto& viewport = mGame->Viewport();
-		if (mBounds.X + mBounds.Width >= viewport.Width && mVelocity.x > 0.0f)
-		{
-			mPlayer1Scored = true;			
-		}
-		if (mBounds.X <= 0 && mVelocity.x < 0.0f)
-		{
-			mPlayer2Scored = true;
-		}
-
-		if (mBounds.Y + mBounds.Height >= viewport.Height && mVelocity.y > 0.0f)
-		{
-			mBallHitWall = true;
-			mVelocity.y *= -1;
-		}
-		if (mBounds.Y <= 0 && mVelocity.y < 0.0f)
-		{
-			mBallHitWall = true;
-			mVelocity.y *= -1;
-		}
-
-		
+		// the scene has already loaded the texture
+		Vector2 size = mScene->BallSize();
+		mTextureSize.X = static_cast<int32_t>(size.X);
+		mTextureSize.Y = static_cast<int32_t>(size.Y);
 	}
 
 	void Ball::Draw(const Library::GameTime& gameTime)
 	{
-		UNREFERENCED_PARAMETER(gameTime);
-
-		XMFLOAT2 position(static_cast<float>(mBounds.X), static_cast<float>(mBounds.Y));
-		
 		mColorModifier+=gameTime.ElapsedGameTimeSeconds().count();
-		float r = mColorModifier + 0.5f;
-		float g = mColorModifier;
-		float b = mColorModifier - 0.5f;
-
-		if (r > 1.0f) r -= 1;
-		if (g > 1.0f) g -= 1;
-		if (b > 1.0f) b -= 1;
+		Color color = MatchScene::BallTint(mColorModifier);
 		if (mColorModifier > 1.0f) mColorModifier -= 1;
 
-		DirectX::FXMVECTOR color = XMVectorSet(r,g,b, 1.0);
-		SpriteManager::DrawTexture2D(mTexture.Get(), position, color);
-	}
-
-	bool Ball::DidBallHitWall()
-	{
-		if (mBallHitWall)
-		{
-			mBallHitWall = false;
-			return true;
-		}
-		else
-		{
-			return false;
-		}
-		
-	}
-
-	bool Ball::DidPlayerScore(Library::Players player) const
-	{
-		if (player == Library::Players::Player1)
-		{
-			return DidPlayer1Score();
-		}
-		else
-		{
-			return DidPlayer2Score();
-		}
-
-	}
-
-	bool Ball::DidPlayer1Score() const
-	{
-		return mPlayer1Scored;
-	}
-
-	bool Ball::DidPlayer2Score() const
-	{
-		return mPlayer2Scored;
-	}
-
-	void Ball::Reset()
-	{
-		Library::Rectangle viewportSize(static_cast<int>(mGame->Viewport().TopLeftX), static_cast<int>(mGame->Viewport().TopLeftY), static_cast<int>(mGame->Viewport().Width), static_cast<int>(mGame->Viewport().Height));
-		Point center = viewportSize.Center();
-		mBounds.X = center.X - mTextureHalfSize.X;
-		mBounds.Y = center.Y - mTextureHalfSize.Y;
-
-		mVelocity.x = static_cast<float>(sSpeedDistribution(sGenerator) * (sBoolDistribution(sGenerator) ? 1 : -1));
-		mVelocity.y = static_cast<float>(sSpeedDistribution(sGenerator) * (sBoolDistribution(sGenerator) ? 1 : -1));
-	}
-
-	void Ball::StopMotion()
-	{
-		mVelocity.y = 0;
-		mVelocity.x = 0;
+		mScene->DrawBall(*mPreviousState, *mState, mTimestep->Alpha(), color);
 	}
-}
\ No newline at end of file
+}
@@ -2,65 +2,30 @@
 
 #include "DrawableGameComponent.h"
 #include "Rectangle.h"
-#include <d3d11_2.h>
-#include <DirectXMath.h>
-#include <wrl.h>
-
-namespace Library
-{
-	class KeyboardComponent;
-
-	enum class Players
-	{
-		Player1 = 1,
-		Player2 = 2,
-	};
-}
+#include "MatchState.h"
+#include "FixedTimestep.h"
 
 namespace Pong
 {
+	class MatchScene;
+
 	class Ball final : public Library::DrawableGameComponent
 	{
 	public:
-		Ball(Library::Game& game);
+		Ball(Library::Game& game, MatchScene& scene, const BallState& previousState, const BallState& state, const FixedTimestep& timestep);
 
-		const Library::Rectangle& Bounds() const;
-		DirectX::XMFLOAT2& Velocity();
+		const Library::Point& TextureSize() const;
 
 		virtual void Initialize() override;
-		virtual void Update(const Library::GameTime& gameTime) override;
 		virtual void Draw(const Library::GameTime& gameTime) override;
 
-		void Ball::StopMotion();
-
-		bool DidPlayerScore(Library::Players player) const;
-		bool DidPlayer1Score() const;
-		bool DidPlayer2Score() const;
-
-		bool DidBallHitWall();
-
-		void Reset();
-
 	private:
-		static const int MinBallSpeed;
-		static const int MaxBallSpeed;
-
-		static std::random_device sDevice;
-		static std::default_random_engine sGenerator;
-		static std::uniform_int_distribution<int> sBoolDistribution;
-		static std::uniform_int_distribution<int> sSpeedDistribution;
+		MatchScene* mScene;
+		Library::Point mTextureSize;
+		const BallState* mPreviousState;
+		const BallState* mState;
+		const FixedTimestep* mTimestep;
 
-		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> mTexture;
-		Library::Point mTextureHalfSize;
-		Library::Rectangle mBounds;
-		DirectX::XMFLOAT2 mVelocity;
-		Library::KeyboardComponent* mKeyboard;
-
-		bool mPlayer1Scored;
-		bool mPlayer2Scored;
-		bool mBallHitWall;
-
-		
 		float mColorModifier = 0.5f;
 	};
-}
\ No newline at end of file
+}
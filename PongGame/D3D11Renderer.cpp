@@ -0,0 +1,176 @@
+#include "pch.h"
+#include "D3D11Renderer.h"
+#include "AssetArchive.h"
+
+using namespace std;
+using namespace DirectX;
+using namespace Library;
+using namespace Microsoft::WRL;
+
+namespace Pong
+{
+	namespace
+	{
+		// content paths are ASCII with forward slashes so the same strings work on every backend
+		wstring WindowsPath(const string& path)
+		{
+			wstring windowsPath(path.begin(), path.end());
+			replace(windowsPath.begin(), windowsPath.end(), L'/', L'\\');
+			return windowsPath;
+		}
+	}
+
+	D3D11Renderer::D3D11Renderer(Game& game) :
+		mGame(&game)
+	{
+	}
+
+	Renderer::TextureId D3D11Renderer::LoadTexture(const string& path)
+	{
+		return AddTexture(path, [this, &path]()
+		{
+			Texture texture;
+			ComPtr<ID3D11Resource> textureResource;
+			ThrowIfFailed(CreateWICTextureFromFile(mGame->Direct3DDevice(), WindowsPath(path).c_str(), textureResource.ReleaseAndGetAddressOf(), texture.View.ReleaseAndGetAddressOf()), "CreateWICTextureFromFile() failed.");
+
+			ComPtr<ID3D11Texture2D> texture2D;
+			ThrowIfFailed(textureResource.As(&texture2D), "Invalid ID3D11Resource returned from CreateWICTextureFromFile. Should be a ID3D11Texture2D.");
+
+			Library::Rectangle bounds = TextureHelper::GetTextureBounds(texture2D.Get());
+			texture.Size = Vector2(static_cast<float>(bounds.Width), static_cast<float>(bounds.Height));
+			return texture;
+		});
+	}
+
+	Renderer::FontId D3D11Renderer::LoadFont(const string& path)
+	{
+		return AddFont(path, [this, &path]()
+		{
+			return make_shared<SpriteFont>(mGame->Direct3DDevice(), WindowsPath(path).c_str());
+		});
+	}
+
+	Renderer::TextureId D3D11Renderer::LoadTexture(const AssetArchive& archive, const string& name)
+	{
+		return AddTexture(archive.Path() + ":" + name, [this, &archive, &name]()
+		{
+			// the pixels go to the GPU straight from the mapping
+			AssetArchive::TextureView view = archive.GetTexture(name);
+
+			D3D11_TEXTURE2D_DESC textureDesc = { };
+			textureDesc.Width = view.Width;
+			textureDesc.Height = view.Height;
+			textureDesc.MipLevels = 1;
+			textureDesc.ArraySize = 1;
+			textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			textureDesc.SampleDesc.Count = 1;
+			textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+			textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+			D3D11_SUBRESOURCE_DATA initialData = { };
+			initialData.pSysMem = view.Pixels;
+			initialData.SysMemPitch = view.Width * sizeof(uint32_t);
+
+			ComPtr<ID3D11Texture2D> texture2D;
+			ThrowIfFailed(mGame->Direct3DDevice()->CreateTexture2D(&textureDesc, &initialData, texture2D.ReleaseAndGetAddressOf()), "ID3D11Device::CreateTexture2D() failed.");
+
+			Texture texture;
+			ThrowIfFailed(mGame->Direct3DDevice()->CreateShaderResourceView(texture2D.Get(), nullptr, texture.View.ReleaseAndGetAddressOf()), "ID3D11Device::CreateShaderResourceView() failed.");
+			texture.Size = Vector2(static_cast<float>(view.Width), static_cast<float>(view.Height));
+			return texture;
+		});
+	}
+
+	Renderer::FontId D3D11Renderer::LoadFont(const AssetArchive& archive, const string& name)
+	{
+		return AddFont(archive.Path() + ":" + name, [this, &archive, &name]()
+		{
+			const AssetArchive::Entry& entry = archive.Get(name, AssetType::Font);
+			return make_shared<SpriteFont>(mGame->Direct3DDevice(), entry.Data, entry.Size);
+		});
+	}
+
+	template <typename Create>
+	Renderer::TextureId D3D11Renderer::AddTexture(const string& key, Create create)
+	{
+		{
+			lock_guard<mutex> lock(mMutex);
+			auto existing = mTextureIds.find(key);
+			if (existing != mTextureIds.end())
+			{
+				return existing->second;
+			}
+		}
+
+		// the device creates resources on any thread, so only the bookkeeping is locked
+		Texture texture = create();
+
+		lock_guard<mutex> lock(mMutex);
+		auto existing = mTextureIds.find(key);
+		if (existing != mTextureIds.end())
+		{
+			return existing->second;
+		}
+
+		mTextures.push_back(texture);
+		TextureId id = static_cast<TextureId>(mTextures.size() - 1);
+		mTextureIds.emplace(key, id);
+		return id;
+	}
+
+	template <typename Create>
+	Renderer::FontId D3D11Renderer::AddFont(const string& key, Create create)
+	{
+		{
+			lock_guard<mutex> lock(mMutex);
+			auto existing = mFontIds.find(key);
+			if (existing != mFontIds.end())
+			{
+				return existing->second;
+			}
+		}
+
+		shared_ptr<SpriteFont> font = create();
+
+		lock_guard<mutex> lock(mMutex);
+		auto existing = mFontIds.find(key);
+		if (existing != mFontIds.end())
+		{
+			return existing->second;
+		}
+
+		mFonts.push_back(font);
+		FontId id = static_cast<FontId>(mFonts.size() - 1);
+		mFontIds.emplace(key, id);
+		return id;
+	}
+
+	Vector2 D3D11Renderer::TextureSize(TextureId texture) const
+	{
+		return mTextures.at(texture).Size;
+	}
+
+	Vector2 D3D11Renderer::MeasureString(FontId font, const wchar_t* text) const
+	{
+		XMFLOAT2 size;
+		XMStoreFloat2(&size, mFonts.at(font)->MeasureString(text));
+		return Vector2(size.x, size.y);
+	}
+
+	void D3D11Renderer::Clear(const Color& color)
+	{
+		const float clearColor[4] = { color.R, color.G, color.B, color.A };
+		mGame->Direct3DDeviceContext()->ClearRenderTargetView(mGame->RenderTargetView(), clearColor);
+		mGame->Direct3DDeviceContext()->ClearDepthStencilView(mGame->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	}
+
+	void D3D11Renderer::DrawTexture(TextureId texture, const Vector2& position, const Color& tint)
+	{
+		SpriteManager::DrawTexture2D(mTextures.at(texture).View.Get(), XMFLOAT2(position.X, position.Y), XMVectorSet(tint.R, tint.G, tint.B, tint.A));
+	}
+
+	void D3D11Renderer::DrawString(FontId font, const wchar_t* text, const Vector2& position)
+	{
+		SpriteManager::DrawString(mFonts.at(font), text, XMFLOAT2(position.X, position.Y));
+	}
+}
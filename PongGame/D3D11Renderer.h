@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Renderer.h"
+#include <d3d11_2.h>
+#include <wrl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Library
+{
+	class Game;
+}
+
+namespace DirectX
+{
+	class SpriteFont;
+}
+
+namespace Pong
+{
+	// The GPU backend: textures through WIC, text through DirectX::SpriteFont, and everything drawn
+	// with SpriteManager into the game's own render target. Loading is safe from several threads at
+	// once; drawing belongs to the thread that owns the device context.
+	class D3D11Renderer final : public Renderer
+	{
+	public:
+		explicit D3D11Renderer(Library::Game& game);
+
+		virtual TextureId LoadTexture(const std::string& path) override;
+		virtual FontId LoadFont(const std::string& path) override;
+		virtual TextureId LoadTexture(const AssetArchive& archive, const std::string& name) override;
+		virtual FontId LoadFont(const AssetArchive& archive, const std::string& name) override;
+
+		virtual Vector2 TextureSize(TextureId texture) const override;
+		virtual Vector2 MeasureString(FontId font, const wchar_t* text) const override;
+
+		virtual void Clear(const Color& color) override;
+		virtual void DrawTexture(TextureId texture, const Vector2& position, const Color& tint) override;
+		virtual void DrawString(FontId font, const wchar_t* text, const Vector2& position) override;
+
+	private:
+		struct Texture final
+		{
+			Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> View;
+			Vector2 Size;
+		};
+
+		template <typename Create>
+		TextureId AddTexture(const std::string& key, Create create);
+		template <typename Create>
+		FontId AddFont(const std::string& key, Create create);
+
+		Library::Game* mGame;
+		std::mutex mMutex;
+		std::vector<Texture> mTextures;
+		std::vector<std::shared_ptr<DirectX::SpriteFont>> mFonts;
+		std::map<std::string, TextureId> mTextureIds;
+		std::map<std::string, FontId> mFontIds;
+	};
+}
@@ -0,0 +1,38 @@
+#include "pch.h"
+#include "DynamicSoundSink.h"
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace DirectX;
+
+namespace Pong
+{
+	DynamicSoundSink::DynamicSoundSink(AudioEngine& engine, uint32_t sampleRate, uint32_t blockFrames, uint32_t bufferCount) :
+		mBuffers(bufferCount, vector<int16_t>(static_cast<size_t>(blockFrames) * Channels)), mNextBuffer(0)
+	{
+		// buffers are submitted from the mixer thread, so there's nothing to do when the engine asks
+		mInstance = make_unique<DynamicSoundEffectInstance>(&engine, [](DynamicSoundEffectInstance*) { }, static_cast<int>(sampleRate), static_cast<int>(Channels));
+		mInstance->Play();
+	}
+
+	DynamicSoundSink::~DynamicSoundSink()
+	{
+		mInstance->Stop();
+	}
+
+	void DynamicSoundSink::Write(const int16_t* samples, uint32_t frameCount)
+	{
+		while (mInstance->GetPendingBufferCount() >= static_cast<int>(mBuffers.size()))
+		{
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+
+		vector<int16_t>& buffer = mBuffers[mNextBuffer];
+		mNextBuffer = (mNextBuffer + 1) % mBuffers.size();
+
+		size_t count = min(static_cast<size_t>(frameCount) * Channels, buffer.size());
+		copy(samples, samples + count, buffer.begin());
+		mInstance->SubmitBuffer(reinterpret_cast<const uint8_t*>(buffer.data()), count * sizeof(int16_t));
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "AudioSink.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace DirectX
+{
+	class AudioEngine;
+	class DynamicSoundEffectInstance;
+}
+
+namespace Pong
+{
+	// Feeds the mixer's blocks to XAudio2 through a DirectX::DynamicSoundEffectInstance. Write
+	// waits while every buffer is still queued on the voice, which keeps the mixer thread only a
+	// few blocks ahead of what's playing.
+	class DynamicSoundSink final : public AudioSink
+	{
+	public:
+		DynamicSoundSink(DirectX::AudioEngine& engine, uint32_t sampleRate, uint32_t blockFrames, uint32_t bufferCount = 3);
+		~DynamicSoundSink();
+
+		DynamicSoundSink(const DynamicSoundSink&) = delete;
+		DynamicSoundSink& operator=(const DynamicSoundSink&) = delete;
+
+		virtual void Write(const int16_t* samples, uint32_t frameCount) override;
+
+	private:
+		std::unique_ptr<DirectX::DynamicSoundEffectInstance> mInstance;
+
+		// XAudio2 reads a submitted buffer in place until it has played, so each one is reused
+		// only once the voice has let go of it
+		std::vector<std::vector<int16_t>> mBuffers;
+		size_t mNextBuffer;
+	};
+}
@@ -0,0 +1,225 @@
+#include "pch.h"
+#include "FramePresenter.h"
+#include <dxgi1_5.h>
+
+using namespace std;
+using namespace Library;
+using namespace Microsoft::WRL;
+
+namespace Pong
+{
+	namespace
+	{
+		ComPtr<IDXGIFactory2> GetFactory(ID3D11Device* device)
+		{
+			ComPtr<IDXGIDevice> dxgiDevice;
+			ThrowIfFailed(device->QueryInterface(IID_PPV_ARGS(dxgiDevice.ReleaseAndGetAddressOf())), "ID3D11Device::QueryInterface() failed.");
+
+			ComPtr<IDXGIAdapter> adapter;
+			ThrowIfFailed(dxgiDevice->GetAdapter(adapter.ReleaseAndGetAddressOf()), "IDXGIDevice::GetAdapter() failed.");
+
+			ComPtr<IDXGIFactory2> factory;
+			ThrowIfFailed(adapter->GetParent(IID_PPV_ARGS(factory.ReleaseAndGetAddressOf())), "IDXGIAdapter::GetParent() failed.");
+			return factory;
+		}
+	}
+
+	FramePresenter::FramePresenter(ID3D11Device* device, const PresentSettings& settings) :
+		mDevice(device), mSettings(settings), mTearingSupported(false), mFrameLatencyWaitable(nullptr), mFrameStart(0.0), mLastPresent(0.0),
+		mLastLatency(0.0), mRefreshSeconds(1.0 / 60.0), mLastSyncRefreshCount(0), mLastSyncTicks(0)
+	{
+		QueryPerformanceFrequency(&mFrequency);
+
+		if (mSettings.Mode == PresentMode::Tearing)
+		{
+			ComPtr<IDXGIFactory5> factory;
+			BOOL allowTearing = FALSE;
+			if (SUCCEEDED(GetFactory(device).As(&factory)) && SUCCEEDED(factory->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))))
+			{
+				mTearingSupported = (allowTearing != FALSE);
+			}
+			if (!mTearingSupported)
+			{
+				OutputDebugStringA("This system doesn't allow tearing; frames still present without waiting, but the compositor syncs them.\n");
+			}
+		}
+		else if (mSettings.Mode == PresentMode::Limited)
+		{
+			mLimiter = make_unique<FrameLimiter>(mSettings.FrameLimit);
+
+			// the framework's swap chain can't be waited on, but the device can stop queueing more than a frame
+			ComPtr<IDXGIDevice1> dxgiDevice;
+			if (SUCCEEDED(mDevice.As(&dxgiDevice)))
+			{
+				dxgiDevice->SetMaximumFrameLatency(1);
+			}
+		}
+	}
+
+	FramePresenter::~FramePresenter()
+	{
+		if (mFrameLatencyWaitable != nullptr)
+		{
+			CloseHandle(mFrameLatencyWaitable);
+		}
+	}
+
+	PresentMode FramePresenter::Mode() const
+	{
+		return mSettings.Mode;
+	}
+
+	bool FramePresenter::NeedsOwnSwapChain() const
+	{
+		return mSettings.Mode == PresentMode::Waitable || mSettings.Mode == PresentMode::Tearing;
+	}
+
+	void FramePresenter::CreateSwapChain(HWND window, UINT width, UINT height, ComPtr<IDXGISwapChain1>& swapChain, ComPtr<ID3D11RenderTargetView>& renderTargetView)
+	{
+		// flip model has no multisampled back buffers; sprites don't need them
+		DXGI_SWAP_CHAIN_DESC1 swapChainDesc = { 0 };
+		swapChainDesc.Width = width;
+		swapChainDesc.Height = height;
+		swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		swapChainDesc.SampleDesc.Count = 1;
+		swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+		swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+		if (mSettings.Mode == PresentMode::Waitable)
+		{
+			swapChainDesc.BufferCount = 2;
+			swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+		}
+		else
+		{
+			// a spare buffer, so a finished frame never waits for one to come back from the display
+			swapChainDesc.BufferCount = 3;
+			swapChainDesc.Flags = (mTearingSupported ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
+		}
+
+		ComPtr<IDXGIFactory2> factory = GetFactory(mDevice.Get());
+		ThrowIfFailed(factory->CreateSwapChainForHwnd(mDevice.Get(), window, &swapChainDesc, nullptr, nullptr, swapChain.ReleaseAndGetAddressOf()), "IDXGIFactory2::CreateSwapChainForHwnd() failed.");
+
+		if (mSettings.Mode == PresentMode::Waitable)
+		{
+			ComPtr<IDXGISwapChain2> swapChain2;
+			ThrowIfFailed(swapChain.As(&swapChain2), "IDXGISwapChain2 is unavailable.");
+			ThrowIfFailed(swapChain2->SetMaximumFrameLatency(1), "IDXGISwapChain2::SetMaximumFrameLatency() failed.");
+			mFrameLatencyWaitable = swapChain2->GetFrameLatencyWaitableObject();
+		}
+
+		ComPtr<ID3D11Texture2D> backBuffer;
+		ThrowIfFailed(swapChain->GetBuffer(0, IID_PPV_ARGS(backBuffer.ReleaseAndGetAddressOf())), "IDXGISwapChain1::GetBuffer() failed.");
+		ThrowIfFailed(mDevice->CreateRenderTargetView(backBuffer.Get(), nullptr, renderTargetView.ReleaseAndGetAddressOf()), "ID3D11Device::CreateRenderTargetView() failed.");
+	}
+
+	void FramePresenter::WaitForFrame()
+	{
+		if (mFrameLatencyWaitable != nullptr)
+		{
+			// signalled once the frame before last has gone to the display
+			WaitForSingleObjectEx(mFrameLatencyWaitable, 1000, TRUE);
+		}
+		else if (mLimiter != nullptr)
+		{
+			mLimiter->Wait();
+		}
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		mFrameStart = Seconds(now.QuadPart);
+	}
+
+	HRESULT FramePresenter::Present(IDXGISwapChain* swapChain)
+	{
+		bool synced = (mSettings.Mode == PresentMode::Vsync || mSettings.Mode == PresentMode::Waitable);
+		UINT flags = (mSettings.Mode == PresentMode::Tearing && mTearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0);
+		HRESULT hr = swapChain->Present(synced ? 1 : 0, flags);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		double presented = Seconds(now.QuadPart);
+		mLastLatency = EstimateDisplayTime(swapChain, presented) - mFrameStart;
+		if (mLastPresent > 0.0)
+		{
+			mStats.Record(presented - mLastPresent, mLastLatency);
+		}
+		mLastPresent = presented;
+
+		return hr;
+	}
+
+	double FramePresenter::LastLatencySeconds() const
+	{
+		return mLastLatency;
+	}
+
+	string FramePresenter::Report() const
+	{
+		FrameTimingSummary summary = mStats.Summarize();
+		ostringstream report;
+		report << "Present mode " << ModeName(mSettings.Mode);
+		if (mLimiter != nullptr)
+		{
+			report << " at " << mLimiter->FramesPerSecond() << " fps";
+		}
+		report << ": " << summary.Frames << " frames, frame time " << fixed << setprecision(2) << 1000.0 * summary.MeanFrameSeconds << " ms (stddev "
+			<< 1000.0 * summary.FrameDeviationSeconds << ", worst " << 1000.0 * summary.MaxFrameSeconds << "), estimated display latency "
+			<< 1000.0 * summary.MeanLatencySeconds << " ms (worst " << 1000.0 * summary.MaxLatencySeconds << ")\n";
+		return report.str();
+	}
+
+	const char* FramePresenter::ModeName(PresentMode mode)
+	{
+		switch (mode)
+		{
+		case PresentMode::Waitable:
+			return "waitable";
+		case PresentMode::Tearing:
+			return "tearing";
+		case PresentMode::Limited:
+			return "limited";
+		default:
+			return "vsync";
+		}
+	}
+
+	double FramePresenter::Seconds(LONGLONG ticks) const
+	{
+		return static_cast<double>(ticks) / static_cast<double>(mFrequency.QuadPart);
+	}
+
+	double FramePresenter::EstimateDisplayTime(IDXGISwapChain* swapChain, double presented)
+	{
+		bool synced = (mSettings.Mode == PresentMode::Vsync || mSettings.Mode == PresentMode::Waitable);
+
+		// a frame presented without vsync starts scanning out straight away
+		DXGI_FRAME_STATISTICS statistics;
+		UINT lastPresentCount;
+		if (!synced || FAILED(swapChain->GetFrameStatistics(&statistics)) || FAILED(swapChain->GetLastPresentCount(&lastPresentCount)) || statistics.SyncQPCTime.QuadPart == 0)
+		{
+			// without statistics, as for a windowed blt-model swap chain, a synced frame is a
+			// vertical blank away at the soonest
+			return presented + (synced ? mRefreshSeconds : 0.0);
+		}
+
+		// the refresh period from how far apart the vertical blanks have been
+		if (mLastSyncTicks != 0 && statistics.SyncRefreshCount > mLastSyncRefreshCount)
+		{
+			mRefreshSeconds = Seconds(statistics.SyncQPCTime.QuadPart - mLastSyncTicks) / (statistics.SyncRefreshCount - mLastSyncRefreshCount);
+		}
+		mLastSyncTicks = statistics.SyncQPCTime.QuadPart;
+		mLastSyncRefreshCount = statistics.SyncRefreshCount;
+
+		// statistics.PresentCount went out at SyncQPCTime, and each frame queued behind it takes another refresh
+		double displayed = Seconds(statistics.SyncQPCTime.QuadPart) + (lastPresentCount - statistics.PresentCount) * mRefreshSeconds;
+		if (displayed < presented)
+		{
+			displayed += ceil((presented - displayed) / mRefreshSeconds) * mRefreshSeconds;
+		}
+		return displayed;
+	}
+}
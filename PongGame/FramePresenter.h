@@ -0,0 +1,72 @@
+#pragma once
+
+#include "FramePacing.h"
+#include <memory>
+#include <string>
+
+namespace Pong
+{
+	enum class PresentMode
+	{
+		Vsync, // Present(1, 0) on the framework's swap chain, up to three frames queued
+		Waitable, // flip model, one frame queued, and Update waits until the swap chain can take another
+		Tearing, // flip model, presenting the moment a frame is done without waiting for the vertical blank
+		Limited, // the framework's swap chain with one frame queued, presenting at FrameLimit without vsync
+	};
+
+	struct PresentSettings final
+	{
+		PresentMode Mode = PresentMode::Vsync;
+		double FrameLimit = 120.0; // frames a second, for Limited
+	};
+
+	// Decides when a frame starts and how it goes to the screen. The modes other than Vsync trade
+	// the framework's deep present queue for less time between reading the keys and showing the
+	// result; Waitable and Tearing need a flip-model swap chain, which the presenter makes to
+	// replace the framework's. Every frame it records the frame time and an estimate of when the
+	// frame reaches the display, from the swap chain's frame statistics where it has them.
+	class FramePresenter final
+	{
+	public:
+		FramePresenter(ID3D11Device* device, const PresentSettings& settings);
+		~FramePresenter();
+
+		FramePresenter(const FramePresenter&) = delete;
+		FramePresenter& operator=(const FramePresenter&) = delete;
+
+		PresentMode Mode() const;
+
+		// the old swap chain has to be gone first: a window only ever has one flip-model swap chain
+		bool NeedsOwnSwapChain() const;
+		void CreateSwapChain(HWND window, UINT width, UINT height, Microsoft::WRL::ComPtr<IDXGISwapChain1>& swapChain,
+			Microsoft::WRL::ComPtr<ID3D11RenderTargetView>& renderTargetView);
+
+		// at the top of Update, so the keys are read as late as the mode allows
+		void WaitForFrame();
+		HRESULT Present(IDXGISwapChain* swapChain);
+
+		double LastLatencySeconds() const;
+		std::string Report() const;
+
+		static const char* ModeName(PresentMode mode);
+
+	private:
+		double Seconds(LONGLONG ticks) const;
+		double EstimateDisplayTime(IDXGISwapChain* swapChain, double presented);
+
+		Microsoft::WRL::ComPtr<ID3D11Device> mDevice;
+		PresentSettings mSettings;
+		bool mTearingSupported;
+		HANDLE mFrameLatencyWaitable;
+		std::unique_ptr<FrameLimiter> mLimiter;
+
+		LARGE_INTEGER mFrequency;
+		double mFrameStart;
+		double mLastPresent;
+		double mLastLatency;
+		double mRefreshSeconds;
+		UINT mLastSyncRefreshCount;
+		LONGLONG mLastSyncTicks;
+		FrameTimingStats mStats;
+	};
+}
@@ -2,52 +2,28 @@
 
 #include "DrawableGameComponent.h"
 #include "Rectangle.h"
-#include <d3d11_2.h>
-#include <DirectXMath.h>
-#include <wrl.h>
-
-namespace Library
-{
-	class KeyboardComponent;
-}
+#include "MatchState.h"
+#include "FixedTimestep.h"
 
 namespace Pong
 {
+	class MatchScene;
+
 	class Paddle final : public Library::DrawableGameComponent
 	{
 	public:
-		Paddle(Library::Game& game);
+		Paddle(Library::Game& game, MatchScene& scene, const PaddleState& previousState, const PaddleState& state, const FixedTimestep& timestep);
 
-		const Library::Rectangle& Bounds() const;
-		DirectX::XMFLOAT2& Velocity();
+		const Library::Point& TextureSize() const;
 
 		virtual void Initialize() override;
-		virtual void SetPlayer(int mPlayer);
-		virtual void Update(const Library::GameTime& gameTime) override;
-		void AIControl(float elapsedTime);
-		void HumanControl(float elapsedTime);
 		virtual void Draw(const Library::GameTime& gameTime) override;
 
-		void Reset();
-		void ResetVelocity();
-		void StopMotion();
-
 	private:
-		static const float PaddleSpeed;
-		static const int WallOffset;
-
-		static std::random_device sDevice;
-		static std::default_random_engine sGenerator;
-		static std::uniform_int_distribution<int> sBoolDistribution;
-		static std::uniform_int_distribution<int> sSpeedDistribution;
-
-		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> mTexture;
-		Library::Point mTextureHalfSize;
-		Library::Rectangle mBounds;
-		DirectX::XMFLOAT2 mVelocity;
-		Library::KeyboardComponent* mKeyboard;
-		
-		int mPlayer = 1;
-
+		MatchScene* mScene;
+		Library::Point mTextureSize;
+		const PaddleState* mPreviousState;
+		const PaddleState* mState;
+		const FixedTimestep* mTimestep;
 	};
-}
\ No newline at end of file
+}
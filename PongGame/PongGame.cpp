@@ -2,6 +2,10 @@
 #include "PongGame.h"
 #include "Ball.h"
 #include "Paddle.h"
+#include "RawKeyboard.h"
+#include "Simulation.h"
+#include "Profiler.h"
+#include "TaskPool.h"
 
 using namespace std;
 using namespace DirectX;
@@ -10,20 +14,32 @@ using namespace Microsoft::WRL;
 
 namespace Pong
 {
-	const XMVECTORF32 PongGame::BackgroundColor = Colors::SteelBlue;
-	const int MAXSCORE = 3;
+	// DirectX::Colors::SteelBlue
+	const Color PongGame::BackgroundColor(0.274509817f, 0.509803951f, 0.705882370f, 1.0f);
 
-	PongGame::PongGame(function<void*()> getWindowCallback, function<void(SIZE&)> getRenderTargetSizeCallback) :
-		Game(getWindowCallback, getRenderTargetSizeCallback)
+	// PongPack's output; without it the game loads the loose files in Content
+	const string PongGame::ArchivePath = "Content.pak";
+
+	// PongPolicy's output; without it player 2 is the built-in AI
+	const string PongGame::PolicyPath = "Policy.pongpolicy";
+
+	PongGame::PongGame(function<void*()> getWindowCallback, function<void(SIZE&)> getRenderTargetSizeCallback, const string& replayPath, const NetplaySettings& netplay, uint32_t chaosBallCount,
+		bool threadedSimulation, const PresentSettings& present, const string& telemetryPath) :
+		Game(getWindowCallback, getRenderTargetSizeCallback), mPresentSettings(present), mGetWindow(getWindowCallback), mNetplaySettings(netplay),
+		mChaosBallCount(chaosBallCount), mReplayPath(replayPath), mTelemetryPath(telemetryPath), mThreadedSimulation(threadedSimulation)
 	{
 	}
 
 	void PongGame::Initialize()
 	{
+		mStartTime = chrono::steady_clock::now();
+
 		SpriteManager::Initialize(*this);		
 		
 		BlendStates::Initialize(mDirect3DDevice.Get());
 
+		mRenderer = make_unique<D3D11Renderer>(*this);
+
 		mKeyboard = make_shared<KeyboardComponent>(*this);
 		mComponents.push_back(mKeyboard);
 		mServices.AddService(KeyboardComponent::TypeIdClass(), mKeyboard.get());
@@ -31,312 +47,652 @@ namespace Pong
 		mAudio = make_shared<AudioEngineComponent>(*this);
 		mComponents.push_back(mAudio);
 		mServices.AddService(AudioEngineComponent::TypeIdClass(), mAudio.get());
-				
-		mBall = make_shared<Ball>(*this);
-		mComponents.push_back(mBall);
-
-		mPaddle1 = make_shared<Paddle>(*this);
-		mComponents.push_back(mPaddle1);
-
-		mPaddle2 = make_shared<Paddle>(*this);
-		mPaddle2->SetPlayer(2);
-		mComponents.push_back(mPaddle2);
-
-		// Add the sound effects and font
-		mBlip[0] = std::make_unique<SoundEffect>(mAudio->AudioEngine().get(), L"Content\\Audio\\PongBlip1.wav");
-		mBlip[1] = std::make_unique<SoundEffect>(mAudio->AudioEngine().get(), L"Content\\Audio\\PongBlip2.wav");
-		mBlip[2] = std::make_unique<SoundEffect>(mAudio->AudioEngine().get(), L"Content\\Audio\\PongBlip3.wav");
-		mBlip[3] = std::make_unique<SoundEffect>(mAudio->AudioEngine().get(), L"Content\\Audio\\PongBlip4.wav");
-		mBlip[4] = std::make_unique<SoundEffect>(mAudio->AudioEngine().get(), L"Content\\Audio\\PongBlip5.wav");
-		mBlip[5] = std::make_unique<SoundEffect>(mAudio->AudioEngine().get(), L"Content\\Audio\\PongBlip6.wav");
-		mGameOverSound = std::make_unique<SoundEffect>(mAudio->AudioEngine().get(), L"Content\\Audio\\PongGameOver.wav");
-		mScoreSound = std::make_unique<SoundEffect>(mAudio->AudioEngine().get(), L"Content\\Audio\\PongScore.wav");
-		mFont = make_shared<SpriteFont>(mDirect3DDevice.Get(), L"Content\\Fonts\\Arial_36_Regular.spritefont");
-		mSmallFont = make_shared<SpriteFont>(mDirect3DDevice.Get(), L"Content\\Fonts\\Arial_14_Regular.spritefont");
-		
-		srand((unsigned int)time(NULL));	
 
 		Game::Initialize();
-		FreezeMotion();
+
+		mPresenter = make_unique<FramePresenter>(Direct3DDevice(), mPresentSettings);
+		if (mPresenter->NeedsOwnSwapChain())
+		{
+			// the framework's swap chain and its target have to go before the window can have another
+			Direct3DDeviceContext()->OMSetRenderTargets(0, nullptr, nullptr);
+			mRenderTargetView.Reset();
+			mSwapChain.Reset();
+			Direct3DDeviceContext()->Flush();
+
+			ComPtr<IDXGISwapChain1> swapChain;
+			ComPtr<ID3D11RenderTargetView> renderTargetView;
+			mPresenter->CreateSwapChain(reinterpret_cast<HWND>(mGetWindow()), static_cast<UINT>(mViewport.Width), static_cast<UINT>(mViewport.Height), swapChain, renderTargetView);
+			ThrowIfFailed(swapChain.As(&mSwapChain), "The presenter's swap chain doesn't fit the game's.");
+			ThrowIfFailed(renderTargetView.As(&mRenderTargetView), "The presenter's render target doesn't fit the game's.");
+		}
+
+		// the sink's voice is made here with the audio engine; the sounds are added while loading
+		AudioMixerOptions mixerOptions;
+		mAudioSink = make_unique<DynamicSoundSink>(*mAudio->AudioEngine(), mixerOptions.SampleRate, mixerOptions.BlockFrames);
+		mMixer = make_unique<AudioMixer>(*mAudioSink, mixerOptions);
+
+		// the window shows straight away; the textures, fonts and sounds load on other threads
+		mLoading = async(launch::async, [this]() { LoadContent(); });
 	}
 
 	void PongGame::Shutdown()
 	{
+		if (mLoading.valid())
+		{
+			mLoading.wait();
+		}
+
+		// the simulation thread records and queues sounds, so it stops before any of them go
+		if (mSimulation != nullptr)
+		{
+			mSimulation->Stop();
+			mSimulation->Acquire();
+			const SimulationThreadStats& stats = mSimulation->Snapshot().Stats;
+			double intervals = static_cast<double>(max<uint64_t>(stats.Steps, 2) - 1);
+			double meanInterval = stats.StepIntervalSum / intervals;
+			ostringstream message;
+			message << "Simulation thread: " << stats.Steps << " steps, " << stats.LateSteps << " late, " << stats.DroppedSteps << " dropped, interval "
+				<< fixed << setprecision(3) << 1000.0 * meanInterval << " ms (stddev " << 1000.0 * sqrt(max(stats.StepIntervalSquares / intervals - meanInterval * meanInterval, 0.0))
+				<< ", worst " << 1000.0 * stats.MaxStepInterval << "), input to snapshot " << 1000.0 * stats.InputLatencySum / max<uint64_t>(stats.Steps, 1)
+				<< " ms (worst " << 1000.0 * stats.MaxInputLatency << ")\n";
+			OutputDebugStringA(message.str().c_str());
+		}
+		mSimulation.reset();
+		mRawKeyboard.reset();
+
+		// the mixer thread writes to the sink, and the sink's voice belongs to the audio engine
+		mSounds.reset();
+		mMixer.reset();
+		mAudioSink.reset();
+
+		if (mRecorder != nullptr)
+		{
+			mRecorder->Finish();
+		}
+
+		if (mTelemetry != nullptr)
+		{
+			try
+			{
+				mTelemetry->Close();
+				ostringstream message;
+				message << "Telemetry: " << mTelemetry->EventsWritten() << " events, " << mTelemetry->Dropped() << " dropped, written to " << mTelemetryPath << "\n";
+				OutputDebugStringA(message.str().c_str());
+			}
+			catch (const exception& error)
+			{
+				// a full disk shouldn't cost the rest of shutdown
+				OutputDebugStringA(error.what());
+			}
+		}
+
+		if (mNetplay != nullptr && mNetplay->Connected())
+		{
+			const RollbackStats& stats = mNetplay->Session().Stats();
+			ostringstream message;
+			message << "Netplay: " << stats.FramesAdvanced << " frames, " << stats.Stalls << " stalls, " << stats.Rollbacks << " rollbacks resimulating "
+				<< stats.ResimulatedFrames << " frames (deepest " << stats.MaxRollbackDepth << ", worst " << fixed << setprecision(3)
+				<< 1000.0 * stats.MaxResimulationSeconds << " ms), " << mNetplay->PacketsSent() << " packets sent, " << mNetplay->PacketsReceived() << " received\n";
+			OutputDebugStringA(message.str().c_str());
+		}
+		mNetplay.reset();
+
+		if (mPresenter != nullptr)
+		{
+			OutputDebugStringA(mPresenter->Report().c_str());
+		}
+		mPresenter.reset();
+
+		mScene.reset();
+		mRenderer.reset();
+		mArchive.reset();
+
 		BlendStates::Shutdown();
 		SpriteManager::Shutdown();
 	}
 
-	void PongGame::Update(const GameTime &gameTime)
+	void PongGame::LoadContent()
 	{
-		HandleKeyboardInput();
+		PONG_PROFILE_SCOPE("LoadContent");
 
-		if (mGamestate == Gamestate::Initial)
+		LoadScene();
+
+		random_device device;
+		mSounds = make_unique<MatchSounds>(*mMixer, [this](const string& name) { return LoadSound(name); }, device());
+	}
+
+	void PongGame::LoadScene()
+	{
+		if (GetFileAttributesA(ArchivePath.c_str()) == INVALID_FILE_ATTRIBUTES)
 		{
-			ShowDirectionsText();
-			ShowLogoText();
+			// loose files go through WIC, which needs COM on this thread
+			ThrowIfFailed(CoInitializeEx(nullptr, COINIT_MULTITHREADED), "CoInitializeEx() failed.");
+			try
+			{
+				mScene = make_unique<MatchScene>(*mRenderer, "Content");
+			}
+			catch (...)
+			{
+				CoUninitialize();
+				throw;
+			}
+			CoUninitialize();
+			return;
 		}
-		if (mGamestate == Gamestate::Playing)
-		{
-			HandleBallPhysics();
-			AdjustAIPaddleVelocity(gameTime);
-			UpdatePlayerScores();
-		}		
-		if (mGamestate == Gamestate::Gameover)
+
+		// one mapping instead of a dozen opens, and nothing left to decode: every texture and font
+		// goes to the device in parallel, then the scene finds them already loaded
+		mArchive = make_unique<AssetArchive>(ArchivePath);
 		{
-			ShowGameOver();
-			ShowDirectionsText();
+			TaskPool pool;
+			for (const AssetArchive::Entry& entry : mArchive->Entries())
+			{
+				const AssetArchive::Entry* asset = &entry;
+				if (asset->Type == AssetType::Texture)
+				{
+					pool.Submit([this, asset]() { mRenderer->LoadTexture(*mArchive, asset->Name); });
+				}
+				else if (asset->Type == AssetType::Font)
+				{
+					pool.Submit([this, asset]() { mRenderer->LoadFont(*mArchive, asset->Name); });
+				}
+			}
+			pool.Wait();
 		}
-
-		Game::Update(gameTime);
+		mScene = make_unique<MatchScene>(*mRenderer, *mArchive);
 	}
 
-	void PongGame::Draw(const GameTime &gameTime)
+	void PongGame::FinishLoading()
 	{
-		mDirect3DDeviceContext->ClearRenderTargetView(mRenderTargetView.Get(), reinterpret_cast<const float*>(&BackgroundColor));
-		mDirect3DDeviceContext->ClearDepthStencilView(mDepthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+		// rethrows anything the loader threw
+		mLoading.get();
 
-		Game::Draw(gameTime);
+		// the components draw through the scene, which now has the textures and fonts
+		mBall = make_shared<Ball>(*this, *mScene, mPreviousMatch.Ball, mMatch.Ball, mTimestep);
+		mPaddle1 = make_shared<Paddle>(*this, *mScene, mPreviousMatch.Paddle1, mMatch.Paddle1, mTimestep);
+		mPaddle2 = make_shared<Paddle>(*this, *mScene, mPreviousMatch.Paddle2, mMatch.Paddle2, mTimestep);
 
-		if (mGamestate == Gamestate::Initial)
+		// multi-ball still reads the texture sizes from the components, but draws everything itself
+		if (mChaosBallCount == 0)
 		{
-			SpriteManager::DrawString(mFont, mPongText.c_str(), mPongTextPosition);
-			SpriteManager::DrawString(mSmallFont, mDirectionsText.c_str(), mDirectionsTextPosition);
+			mComponents.push_back(mBall);
+			mComponents.push_back(mPaddle1);
+			mComponents.push_back(mPaddle2);
 		}
-		else if (mGamestate == Gamestate::Playing)
+
+		mBall->Initialize();
+		mPaddle1->Initialize();
+		mPaddle2->Initialize();
+
+		// the mixer thread plays every sound from here on; gameplay only queues them
+		mMixer->Start();
+
+		random_device device;
+
+		// the simulation takes its arena from the window and the loaded textures
+		MatchConfig config;
+		config.ViewportWidth = mViewport.Width;
+		config.ViewportHeight = mViewport.Height;
+		config.BallWidth = static_cast<float>(mBall->TextureSize().X);
+		config.BallHeight = static_cast<float>(mBall->TextureSize().Y);
+		config.PaddleWidth = static_cast<float>(mPaddle1->TextureSize().X);
+		config.PaddleHeight = static_cast<float>(mPaddle1->TextureSize().Y);
+
+		if (mChaosBallCount != 0)
 		{
-			SpriteManager::DrawString(mFont, mPlayer1ScoreText.c_str(), mPlayer1ScoreTextPosition);
-			SpriteManager::DrawString(mFont, mPlayer2ScoreText.c_str(), mPlayer2ScoreTextPosition);
+			ChaosConfig chaosConfig;
+			chaosConfig.Match = config;
+			chaosConfig.BallCount = mChaosBallCount;
+			mChaos = make_unique<ChaosMatch>(chaosConfig, device());
+
+			// the hud shows multi-ball's scores through a match that's always playing
+			mMatch = Simulation::CreateMatch(config, 0);
+			mMatch.Gamestate = Gamestate::Playing;
 		}
-		else if (mGamestate == Gamestate::Gameover)
+		else if (mNetplaySettings.Enabled)
 		{
-			SpriteManager::DrawString(mFont, mGameOverText.c_str(), mGameOverTextPosition);
-			SpriteManager::DrawString(mSmallFont, mDirectionsText.c_str(), mDirectionsTextPosition);
-		}
+			// the host picks the seed and both sides simulate the whole match; nothing is recorded
+			auto channel = make_shared<UdpChannel>(mNetplaySettings.Role == NetplayRole::Host ? mNetplaySettings.Port : 0);
+			if (mNetplaySettings.Role == NetplayRole::Join)
+			{
+				channel->Connect(mNetplaySettings.Address, mNetplaySettings.Port);
+			}
 
-		HRESULT hr = mSwapChain->Present(1, 0);
+			RollbackOptions options;
+			options.StepSeconds = mTimestep.StepSeconds();
+			mNetplay = make_unique<NetplayPeer>(channel, mNetplaySettings.Role, config, device(), options);
 
-		// If the device was removed either by a disconnection or a driver upgrade, we must recreate all device resources.
-		if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+			config.Player2Control = PaddleControl::Inputs;
+			mMatch = Simulation::CreateMatch(config, 0);
+		}
+		else if (mReplayPath.empty())
 		{
-			HandleDeviceLost();
+			if (GetFileAttributesA(PolicyPath.c_str()) != INVALID_FILE_ATTRIBUTES)
+			{
+				// the policy presses player 2's keys, so replays record its choices like a player's
+				mOpponent = PaddleController::Create("policy:" + PolicyPath);
+				config.Player2Control = PaddleControl::Inputs;
+			}
+
+			uint32_t seed = device();
+			mMatch = Simulation::CreateMatch(config, seed);
+			StartRecording(config, seed);
+			StartTelemetry();
 		}
 		else
 		{
-			ThrowIfFailed(hr, "IDXGISwapChain::Present() failed.");
+			mReplay = make_unique<ReplayReader>(mReplayPath);
+			mReplayCursor = make_unique<ReplayCursor>(mReplay->Seek(0));
+			mMatch = mReplayCursor->Match();
 		}
-	}
 
-	void PongGame::Exit()
-	{
-		PostQuitMessage(0);
-	}
+		mPreviousMatch = mMatch;
+		mTimestep.Reset();
 
-	void PongGame::ChangeGameState(Gamestate newGamestate)
-	{
-		if (mGamestate == Gamestate::Initial || mGamestate == Gamestate::Gameover)
+		// the raw keyboard plays everything but a replay, which only seeks with the keyboard component
+		if (mReplayCursor == nullptr)
 		{
-			// transitioning to playing
-			Game::Initialize();
-			mPlayer1Score = 0;
-			mPlayer2Score = 0;
+			mInputEvents = make_unique<InputEventQueue>();
+			mRawKeyboard = make_unique<RawKeyboard>(*mInputEvents, mGetWindow);
 		}
-		else if (mGamestate == Gamestate::Playing)
+
+		// only a local match moves to its own thread; replays seek, and netplay and multi-ball step in Update
+		if (mThreadedSimulation && mReplayCursor == nullptr && mNetplay == nullptr && mChaos == nullptr)
 		{
-			// transitioning to gameover
-			FreezeMotion();
-			MakeGameOverSound();
+			mSimulation = make_unique<SimulationThread>(mMatch, mTimestep.StepSeconds(),
+				[this](const MatchState& match)
+				{
+					uint64_t eventTime;
+					return SampleKeyboard(match, Profiler::Now(), eventTime);
+				},
+				[this](const MatchState& previous, const MatchInputs& inputs, const MatchState& match)
+				{
+					// the simulation thread is the only gameplay thread from here on
+					if (mRecorder != nullptr)
+					{
+						mRecorder->Record(previous, inputs);
+					}
+					if (mTelemetryObserver != nullptr)
+					{
+						mTelemetryObserver->Observe(match, mTimestep.StepSeconds(), *mTelemetryStream);
+					}
+					mSoundClock += mTimestep.StepSeconds();
+					mSounds->Play(match, mSoundClock);
+					mMixer->Advance(mSoundClock);
+				});
+			mSimulation->Start();
 		}
 
-		mGamestate = newGamestate;
+		chrono::duration<double, milli> startup = chrono::steady_clock::now() - mStartTime;
+		ostringstream message;
+		message << "Content ready " << fixed << setprecision(1) << startup.count() << " ms after startup (" << (mArchive != nullptr ? ArchivePath : "loose files") << ")\n";
+		OutputDebugStringA(message.str().c_str());
 	}
 
-	bool PongGame::IsBallAboveAIPaddle()
+	Sound PongGame::LoadSound(const string& name) const
 	{
-		return mBall->Bounds().Bottom() < mPaddle2->Bounds().Top();
-	}
+		if (mArchive == nullptr)
+		{
+			return Sound::LoadWave("Content/" + name);
+		}
 
-	bool PongGame::IsBallBelowAIPaddle()
-	{
-		return mBall->Bounds().Top() > mPaddle2->Bounds().Bottom();
+		// already split into format and PCM in the archive
+		AssetArchive::SoundView sound = mArchive->GetSound(name);
+		return Sound::Decode(sound.Format, sound.FormatSize, sound.Samples, sound.SamplesSize, name);
 	}
 
-	void PongGame::HandleKeyboardInput()
+	void PongGame::Update(const GameTime &gameTime)
 	{
-		if (mKeyboard->WasKeyPressedThisFrame(Keys::Escape))
 		{
-			Exit();
+			// waiting here rather than after Present means the keys are read as close to the display as the mode allows
+			PONG_PROFILE_SCOPE("WaitForFrame");
+			mPresenter->WaitForFrame();
 		}
 
-		if (mGamestate != Gamestate::Playing)
+		PONG_PROFILE_SCOPE("Update");
+
+		if (mLoading.valid())
 		{
-			if (mKeyboard->WasKeyPressedThisFrame(Keys::Space))
+			if (mLoading.wait_for(chrono::seconds(0)) != future_status::ready)
 			{
-				ChangeGameState(Gamestate::Playing);
+				// nothing to simulate yet, but the window still answers
+				if (mKeyboard->WasKeyPressedThisFrame(Keys::Escape))
+				{
+					Exit();
+				}
+				Game::Update(gameTime);
+				return;
 			}
+			FinishLoading();
 		}
-	}
 
-	void PongGame::HandleBallPhysics()
-	{
-		bool paddle1Intersects = mBall->Bounds().Intersects(mPaddle1->Bounds());
-		bool paddle2Intersects = mBall->Bounds().Intersects(mPaddle2->Bounds());
+		HandleKeyboardInput();
 
-		// Did the ball hit a paddle?		
-		if (paddle1Intersects || paddle2Intersects)
+		if (mSimulation != nullptr)
 		{
-			if (paddle2Intersects)
+			// the simulation thread has already stepped; draw between its last two states
+			mSimulation->Acquire();
+			const SimulationSnapshot& snapshot = mSimulation->Snapshot();
+			mPreviousMatch = snapshot.Previous;
+			mMatch = snapshot.Match;
+			if (snapshot.Inputs.Start || (mMatch.Events & (MatchEvents::Player1Scored | MatchEvents::Player2Scored | MatchEvents::GameOver)) != 0)
 			{
-				mPaddle2->Velocity().y = 0.0f;
+				mPreviousMatch = mMatch;
 			}
+			mTimestep.SetAlpha(mSimulation->Alpha());
+		}
+
+		// the simulation runs at a fixed rate; Draw interpolates between the last two steps
+		uint32_t steps = (mSimulation == nullptr ? mTimestep.Advance(gameTime.ElapsedGameTimeSeconds().count()) : 0);
 
-			if (!mIsIntersecting)
+		// each step takes the keys up to when it ends in real time, which for all but the last is
+		// somewhere before now
+		const double StepNanoseconds = 1e9 * mTimestep.StepSeconds();
+		uint64_t stepEnd = Profiler::Now() - static_cast<uint64_t>((mTimestep.Alpha() + steps) * StepNanoseconds);
+		for (uint32_t step = 0; step < steps; ++step)
+		{
+			PONG_PROFILE_SCOPE("Step");
+
+			stepEnd += static_cast<uint64_t>(StepNanoseconds);
+			uint64_t eventTime;
+			MatchInputs inputs = SampleKeyboard(mMatch, stepEnd, eventTime);
+#if defined(PONG_PROFILE)
+			if (mUnpresentedEventTime == 0)
 			{
-				mBall->Velocity().x *= -1.0f;
+				mUnpresentedEventTime = eventTime;
+			}
+#endif
 
-				// this makes it so velocity only changes the one time
-				mIsIntersecting = true;
+			mPreviousMatch = mMatch;
+			if (mChaos != nullptr)
+			{
+				mChaos->Step(inputs, mTimestep.StepSeconds());
+				mMatch.Player1Score = mChaos->Player1Score();
+				mMatch.Player2Score = mChaos->Player2Score();
+				mMatch.Events = mChaos->Events();
+			}
+			else if (mNetplay != nullptr)
+			{
+				// the keyboard plays whichever paddle this side controls; a rollback may move the match more than a step
+				if (!mNetplay->Update(inputs.Player1, inputs.Start))
+				{
+					continue;
+				}
+				mMatch = mNetplay->Session().Match();
+			}
+			else if (mReplayCursor != nullptr)
+			{
+				if (mReplayCursor->AtEnd())
+				{
+					break;
+				}
+
+				inputs = mReplayCursor->Inputs();
+				mReplayCursor->Step();
+				mMatch = mReplayCursor->Match();
+			}
+			else
+			{
+				if (mRecorder != nullptr)
+				{
+					mRecorder->Record(mMatch, inputs);
+				}
+				Simulation::Step(mMatch, inputs, mTimestep.StepSeconds());
+				if (mTelemetryObserver != nullptr)
+				{
+					mTelemetryObserver->Observe(mMatch, mTimestep.StepSeconds(), *mTelemetryStream);
+				}
+			}
 
-				MakeBlip();
+			// don't slide the ball back to the center after a point or a new game
+			if (inputs.Start || (mMatch.Events & (MatchEvents::Player1Scored | MatchEvents::Player2Scored | MatchEvents::GameOver)) != 0)
+			{
+				mPreviousMatch = mMatch;
 			}
+
+			mSoundClock += mTimestep.StepSeconds();
+			mSounds->Play(mMatch, mSoundClock);
 		}
-		else
+		if (mSimulation == nullptr)
 		{
-			mIsIntersecting = false;
+			mMixer->Advance(mSoundClock);
 		}
 
-		// Did the ball hit a wall?
-		if (mBall->DidBallHitWall()) MakeBlip();
+		{
+			// only re-measures when a score changes or the window has been resized
+			PONG_PROFILE_SCOPE("Hud");
+			mScene->UpdateHud(mMatch, mViewport.Width, mViewport.Height);
+		}
+
+#if defined(PONG_PROFILE)
+		UpdateProfileText(gameTime.ElapsedGameTimeSeconds().count());
+#endif
+
+		{
+			PONG_PROFILE_SCOPE("Components");
+			Game::Update(gameTime);
+		}
 	}
 
-	void PongGame::AdjustAIPaddleVelocity(const GameTime &gameTime)
+	void PongGame::Draw(const GameTime &gameTime)
 	{
-		// don't attempt to follow if the ball is going the other way
-		if (mBall->Velocity().x < 0 || int(gameTime.TotalGameTimeSeconds().count()) % mAIDelay == 0)
+		PONG_PROFILE_SCOPE("Draw");
+
+		if (mPresenter->NeedsOwnSwapChain())
 		{
-			mPaddle2->Velocity().y = 0.0f;
+			// flip model unbinds the back buffer at every Present
+			ID3D11RenderTargetView* renderTarget = RenderTargetView();
+			Direct3DDeviceContext()->OMSetRenderTargets(1, &renderTarget, nullptr);
+			Direct3DDeviceContext()->RSSetViewports(1, &mViewport);
 		}
-		else if (IsBallBelowAIPaddle() && mPaddle2->Velocity().y <= 0)
+
+		mRenderer->Clear(BackgroundColor);
+
+		// just the background until the content has loaded
+		if (!mLoading.valid())
 		{
-			mPaddle2->ResetVelocity();			
+			Game::Draw(gameTime);
+			if (mChaos != nullptr)
+			{
+				mChaosColorModifier += static_cast<float>(gameTime.ElapsedGameTimeSeconds().count());
+				mChaosColorModifier -= floor(mChaosColorModifier);
+				mScene->DrawChaos(*mChaos, mTimestep.Alpha(), mChaosColorModifier);
+			}
+			mScene->DrawHud(mMatch);
+
+#if defined(PONG_PROFILE)
+			if (mShowProfile)
+			{
+				mRenderer->DrawString(mScene->SmallFont(), mProfileText.c_str(), mProfileTextPosition);
+			}
+#endif
 		}
-		else if (IsBallAboveAIPaddle() && mPaddle2->Velocity().y >= 0)
-		{
-			mPaddle2->ResetVelocity();
-			mPaddle2->Velocity().y *= -1;
-		}		
-	}
 
-	void PongGame::ShowGameOver()
-	{
-		XMFLOAT2 tempViewportSize(mViewport.Width, mViewport.Height);
-		XMVECTOR viewportSize = XMLoadFloat2(&tempViewportSize);
+		PONG_PROFILE_SCOPE("Present");
+		HRESULT hr = mPresenter->Present(mSwapChain.Get());
 
-		// display the game over text
-		XMVECTOR messageSize = mFont->MeasureString(mGameOverText.c_str());
-		XMStoreFloat2(&mGameOverTextPosition, (viewportSize - messageSize) / 2);
-		mGameOverTextPosition.y -= XMVectorGetY(messageSize);		
+#if defined(PONG_PROFILE)
+		// from the first key change this frame shows to Present letting go, which waits for the
+		// vertical blank the frame goes out on
+		if (mUnpresentedEventTime != 0)
+		{
+			uint64_t now = Profiler::Now();
+			Profiler::Instance().Record("InputToPhoton", mUnpresentedEventTime, now - mUnpresentedEventTime);
+			mUnpresentedEventTime = 0;
+		}
+		if (SUCCEEDED(hr))
+		{
+			// an estimate from the swap chain's frame statistics, from WaitForFrame to the display
+			uint64_t now = Profiler::Now();
+			Profiler::Instance().Record("DisplayLatency", now, static_cast<uint64_t>(1e9 * mPresenter->LastLatencySeconds()));
+		}
+#endif
+
+		// If the device was removed either by a disconnection or a driver upgrade, we must recreate all device resources.
+		if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+		{
+			HandleDeviceLost();
+		}
+		else
+		{
+			ThrowIfFailed(hr, "IDXGISwapChain::Present() failed.");
+		}
 	}
 
-	void PongGame::ShowDirectionsText()
+	void PongGame::Exit()
 	{
-		XMFLOAT2 tempViewportSize(mViewport.Width, mViewport.Height);
-		XMVECTOR viewportSize = XMLoadFloat2(&tempViewportSize);
-
-		// display the directions text
-		XMVECTOR messageSize = mSmallFont->MeasureString(mDirectionsText.c_str());
-		XMVECTOR gameOverMessageSize = mFont->MeasureString(mGameOverText.c_str());
-		XMStoreFloat2(&mDirectionsTextPosition, (viewportSize - messageSize) / 2);
-		mDirectionsTextPosition.y -= (XMVectorGetY(messageSize) - (XMVectorGetY(gameOverMessageSize) * 1.05f));
+		PostQuitMessage(0);
 	}
 
-	void PongGame::ShowLogoText()
+	void PongGame::HandleKeyboardInput()
 	{
-		XMFLOAT2 tempViewportSize(mViewport.Width, mViewport.Height);
-		XMVECTOR viewportSize = XMLoadFloat2(&tempViewportSize);
+		PONG_PROFILE_SCOPE("Input");
 
-		// display the game over text
-		XMVECTOR messageSize = mFont->MeasureString(mPongText.c_str());
-		XMStoreFloat2(&mPongTextPosition, (viewportSize - messageSize) / 2);
-		mPongTextPosition.y -= XMVectorGetY(messageSize);
-	}
-	
-	void PongGame::FreezeMotion()
-	{
-		mPaddle1->StopMotion();
-		mPaddle2->StopMotion();
-		mBall->StopMotion();
-	}
+		if (mKeyboard->WasKeyPressedThisFrame(Keys::Escape))
+		{
+			Exit();
+		}
 
-	void PongGame::UpdatePlayerScores()
-	{
-		// did a player score?
-		if (mBall->DidPlayerScore(Library::Players::Player1))
+#if defined(PONG_PROFILE)
+		if (mKeyboard->WasKeyPressedThisFrame(Keys::F3))
 		{
-			MakeScoreSound();
-			mPlayer1Score++;
-			if (mPlayer1Score < MAXSCORE)
-			{
-				MakeScoreSound();
-				mBall->Initialize();
-			}
-			else
-			{
-				ChangeGameState(Gamestate::Gameover);				
-			}
+			mShowProfile = !mShowProfile;
+			mProfileRefreshSeconds = 0.0;
 		}
-		else if (mBall->DidPlayerScore(Library::Players::Player2))
+		if (mKeyboard->WasKeyPressedThisFrame(Keys::F4))
 		{
-			mPlayer2Score++;
-			if (mPlayer2Score < MAXSCORE)
+			WriteProfileTrace();
+		}
+#endif
+
+		if (mReplayCursor != nullptr)
+		{
+			// left and right skip through the replay, everything else comes from the file
+			if (mKeyboard->WasKeyPressedThisFrame(Keys::Left))
 			{
-				MakeScoreSound();
-				mBall->Initialize();
+				SeekReplay(-10.0);
 			}
-			else
+			if (mKeyboard->WasKeyPressedThisFrame(Keys::Right))
 			{
-				ChangeGameState(Gamestate::Gameover);
+				SeekReplay(10.0);
 			}
 		}
+	}
+
+	MatchInputs PongGame::SampleKeyboard(const MatchState& match, uint64_t until, uint64_t& eventTime)
+	{
+		// the paddle and start keys come from the raw keyboard's events rather than the component,
+		// which only sees the keys once a frame
+		MatchInputs inputs;
+		eventTime = 0;
+		if (mInputEvents != nullptr)
+		{
+			InputSample sample = mInputEvents->Sample(until);
+			inputs.Player1 = sample.Paddle;
+			inputs.Start = sample.Start && match.Gamestate != Gamestate::Playing;
+			eventTime = sample.FirstEventTime;
+		}
+
+		if (mOpponent != nullptr)
+		{
+			inputs.Player2 = mOpponent->Control(match, Players::Player2);
+		}
 
-		XMFLOAT2 tempViewportSize(mViewport.Width, mViewport.Height);
-		XMVECTOR viewportSize = XMLoadFloat2(&tempViewportSize);
+		return inputs;
+	}
 
-		// update the score texts
-		wostringstream subMessageStream1;
-		subMessageStream1 << mPlayer1Score;
+	void PongGame::StartRecording(const MatchConfig& config, uint32_t seed)
+	{
+		// every session is kept as Replays\<local time>.pongreplay
+		CreateDirectory(L"Replays", nullptr);
 
-		wostringstream subMessageStream2;
-		subMessageStream2 << mPlayer2Score;
-		
-		// update player 1 text
-		mPlayer1ScoreText = subMessageStream1.str();
-		XMVECTOR messageSize = mFont->MeasureString(mPlayer1ScoreText.c_str());
-		XMStoreFloat2(&mPlayer1ScoreTextPosition, (viewportSize - messageSize) / 2);
-		mPlayer1ScoreTextPosition.x -= 150;
-		mPlayer1ScoreTextPosition.y = 50;
-
-		// update player 2 text
-		mPlayer2ScoreText = subMessageStream2.str();
-		messageSize = mFont->MeasureString(mPlayer2ScoreText.c_str());
-		XMStoreFloat2(&mPlayer2ScoreTextPosition, (viewportSize - messageSize) / 2);
-		mPlayer2ScoreTextPosition.x += 150;
-		mPlayer2ScoreTextPosition.y = 50;
+		time_t now = time(nullptr);
+		tm localTime;
+		localtime_s(&localTime, &now);
+
+		ostringstream path;
+		path << "Replays\\" << put_time(&localTime, "%Y%m%d-%H%M%S") << ".pongreplay";
+		try
+		{
+			mRecorder = make_unique<ReplayWriter>(path.str(), config, seed, mTimestep.StepSeconds());
+		}
+		catch (const exception& error)
+		{
+			// losing the recording shouldn't stop anyone playing
+			OutputDebugStringA(error.what());
+		}
 	}
 
-	void PongGame::MakeBlip()
+	void PongGame::StartTelemetry()
 	{
-		int32_t chooseBlip = rand() % 5;
-		mBlip[chooseBlip]->Play();
+		if (mTelemetryPath.empty())
+		{
+			return;
+		}
+
+		try
+		{
+			mTelemetry = make_unique<TelemetryLog>(mTelemetryPath, TelemetryOverflow::Drop);
+			mTelemetryStream = &mTelemetry->OpenStream();
+			mTelemetryObserver = make_unique<TelemetryObserver>(mMatch, 0);
+		}
+		catch (const exception& error)
+		{
+			// like the recording, telemetry is never worth stopping the game for
+			OutputDebugStringA(error.what());
+		}
 	}
 
-	void PongGame::MakeGameOverSound()
+	void PongGame::SeekReplay(double offsetSeconds)
 	{
-		mGameOverSound->Play();
+		double frame = mReplayCursor->Frame() + offsetSeconds / mReplay->Header().StepSeconds;
+		frame = max(0.0, min(frame, static_cast<double>(mReplay->FrameCount())));
+
+		*mReplayCursor = mReplay->Seek(static_cast<uint64_t>(frame));
+		mMatch = mReplayCursor->Match();
+		mPreviousMatch = mMatch;
 	}
 
-	void PongGame::MakeScoreSound()
+#if defined(PONG_PROFILE)
+	void PongGame::UpdateProfileText(double elapsedSeconds)
 	{
-		mScoreSound->Play();
+		// the summary sorts every sample in the ring, so only rebuild it a few times a second
+		mProfileRefreshSeconds -= elapsedSeconds;
+		if (!mShowProfile || mProfileRefreshSeconds > 0.0)
+		{
+			return;
+		}
+		mProfileRefreshSeconds = 0.25;
+
+		wostringstream text;
+		text << fixed << setprecision(3) << L"phase  p50 ms  p99 ms  max ms";
+		for (const PhaseSummary& phase : Profiler::Instance().Summarize())
+		{
+			text << L"\n" << phase.Name << L"  " << phase.P50Milliseconds << L"  " << phase.P99Milliseconds << L"  " << phase.MaxMilliseconds;
+		}
+		mProfileText = text.str();
 	}
 
-}
\ No newline at end of file
+	void PongGame::WriteProfileTrace()
+	{
+		// Traces\<local time>.json, for chrome://tracing or Perfetto
+		CreateDirectory(L"Traces", nullptr);
+
+		time_t now = time(nullptr);
+		tm localTime;
+		localtime_s(&localTime, &now);
+
+		ostringstream path;
+		path << "Traces\\" << put_time(&localTime, "%Y%m%d-%H%M%S") << ".json";
+		ofstream trace(path.str());
+		if (trace.good())
+		{
+			Profiler::Instance().WriteChromeTrace(trace);
+		}
+		else
+		{
+			OutputDebugStringA(("Couldn't write " + path.str()).c_str());
+		}
+	}
+#endif
+}
@@ -2,6 +2,26 @@
 
 #include "Game.h"
 #include "Rectangle.h"
+#include "MatchState.h"
+#include "MatchInputs.h"
+#include "FixedTimestep.h"
+#include "InputEvents.h"
+#include "RawKeyboard.h"
+#include "Replay.h"
+#include "PaddleController.h"
+#include "NetplayPeer.h"
+#include "ChaosMatch.h"
+#include "SimulationThread.h"
+#include "Telemetry.h"
+#include "D3D11Renderer.h"
+#include "FramePresenter.h"
+#include "MatchScene.h"
+#include "AssetArchive.h"
+#include "AudioMixer.h"
+#include "MatchSounds.h"
+#include "DynamicSoundSink.h"
+#include <chrono>
+#include <future>
 
 namespace Library
 {
@@ -10,20 +30,29 @@ namespace Library
 
 namespace Pong
 {
-	enum class Gamestate
-	{
-		Initial = 1,
-		Playing = 2,
-		Gameover = 3,
-	};
-
 	class Ball;
 	class Paddle;
 
+	// A two-player match over UDP: the host listens on Port and plays player 1, the joiner
+	// connects to Address:Port and plays player 2.
+	struct NetplaySettings final
+	{
+		bool Enabled = false;
+		NetplayRole Role = NetplayRole::Host;
+		std::string Address;
+		uint16_t Port = 7000;
+	};
+
 	class PongGame : public Library::Game
 	{
 	public:
-		PongGame(std::function<void*()> getWindowCallback, std::function<void(SIZE&)> getRenderTargetSizeCallback);
+		// with a replay path the game plays that replay back instead of taking the keyboard
+		// a chaos ball count other than zero plays multi-ball instead of a normal match
+		// a threaded simulation runs a local match on its own thread instead of in Update
+		// with a telemetry path a local match's gameplay events are logged to that file
+		PongGame(std::function<void*()> getWindowCallback, std::function<void(SIZE&)> getRenderTargetSizeCallback, const std::string& replayPath = std::string(),
+			const NetplaySettings& netplay = NetplaySettings(), uint32_t chaosBallCount = 0, bool threadedSimulation = false,
+			const PresentSettings& present = PresentSettings(), const std::string& telemetryPath = std::string());
 
 		virtual void Initialize() override;
 		virtual void Shutdown() override;
@@ -31,50 +60,95 @@ namespace Pong
 		virtual void Draw(const Library::GameTime& gameTime) override;
 
 	private:
+		void LoadContent();
+		void LoadScene();
+		void FinishLoading();
+		Sound LoadSound(const std::string& name) const;
 		void Exit();
-		void MakeBlip();
-		void MakeGameOverSound();
-		void MakeScoreSound();
-		void UpdatePlayerScores();
-		void ShowGameOver();
-		void AdjustAIPaddleVelocity(const Library::GameTime& gameTime);
-		void HandleBallPhysics();
 		void HandleKeyboardInput();
-		void FreezeMotion();
-		void ShowDirectionsText();
-		void ShowLogoText();
-		void ChangeGameState(Gamestate newGamestate);
-		bool IsBallAboveAIPaddle();
-		bool IsBallBelowAIPaddle();
+		MatchInputs SampleKeyboard(const MatchState& match, uint64_t until, uint64_t& eventTime);
+		void StartRecording(const MatchConfig& config, uint32_t seed);
+		void StartTelemetry();
+		void SeekReplay(double offsetSeconds);
+#if defined(PONG_PROFILE)
+		void UpdateProfileText(double elapsedSeconds);
+		void WriteProfileTrace();
+#endif
 
-		static const DirectX::XMVECTORF32 BackgroundColor;
+		static const Color BackgroundColor;
+		static const std::string ArchivePath;
+		static const std::string PolicyPath;
 
 		std::shared_ptr<Library::AudioEngineComponent> mAudio;
-		std::unique_ptr<DirectX::SoundEffect> mBlip[6];
-		std::unique_ptr<DirectX::SoundEffect> mScoreSound;
-		std::unique_ptr<DirectX::SoundEffect> mGameOverSound;
+		std::unique_ptr<DynamicSoundSink> mAudioSink;
+		std::unique_ptr<AudioMixer> mMixer;
+		std::unique_ptr<MatchSounds> mSounds;
+
+		// simulation time for the mixer, which never goes backwards even when a replay seeks
+		double mSoundClock = 0.0;
 		std::shared_ptr<Library::KeyboardComponent> mKeyboard;
 		std::shared_ptr<Ball> mBall;
 		std::shared_ptr<Paddle> mPaddle1;
 		std::shared_ptr<Paddle> mPaddle2;
-		std::shared_ptr<DirectX::SpriteFont> mFont;
-		std::shared_ptr<DirectX::SpriteFont> mSmallFont;
-		std::wstring mPlayer1ScoreText;
-		std::wstring mPlayer2ScoreText;
-	    const std::wstring mGameOverText = L"Game Over!";
-		const std::wstring mPongText = L"PONG";
-		const std::wstring mDirectionsText = L"Press SPACEBAR to play";
-		DirectX::XMFLOAT2 mPlayer1ScoreTextPosition;
-		DirectX::XMFLOAT2 mPlayer2ScoreTextPosition;
-		DirectX::XMFLOAT2 mGameOverTextPosition;		
-		DirectX::XMFLOAT2 mPongTextPosition;
-		DirectX::XMFLOAT2 mDirectionsTextPosition;
-
-		int32_t mPlayer1Score = 0;
-		int32_t mPlayer2Score = 0;
-		bool mIsIntersecting = false;
-		static const int32_t mAIDelay = 3; // this more or less dictates difficulty
-
-		Gamestate mGamestate = Gamestate::Initial;
+		std::unique_ptr<D3D11Renderer> mRenderer;
+
+		// when each frame starts and how it goes out; it may have replaced the framework's swap chain
+		PresentSettings mPresentSettings;
+		std::unique_ptr<FramePresenter> mPresenter;
+		std::unique_ptr<MatchScene> mScene;
+
+		// the content loads on other threads while the window is already up; Update picks it up
+		std::unique_ptr<AssetArchive> mArchive;
+		std::future<void> mLoading;
+		std::chrono::steady_clock::time_point mStartTime;
+
+		MatchState mMatch;
+		MatchState mPreviousMatch;
+		FixedTimestep mTimestep;
+
+		// the paddle and start keys, stamped as they arrive; Escape and the rest go through mKeyboard
+		std::function<void*()> mGetWindow;
+		std::unique_ptr<InputEventQueue> mInputEvents;
+		std::unique_ptr<RawKeyboard> mRawKeyboard;
+
+		// a learned opponent from PongPolicy, when one sits next to the executable
+		std::unique_ptr<PaddleController> mOpponent;
+
+		// netplay replaces the opponent and the recorder; the peer owns the match while it runs
+		NetplaySettings mNetplaySettings;
+		std::unique_ptr<NetplayPeer> mNetplay;
+
+		// multi-ball draws straight through the scene; mMatch only carries its scores and events
+		uint32_t mChaosBallCount;
+		std::unique_ptr<ChaosMatch> mChaos;
+		float mChaosColorModifier = 0.0f;
+
+		std::string mReplayPath;
+		std::unique_ptr<ReplayWriter> mRecorder;
+		std::unique_ptr<ReplayReader> mReplay;
+		std::unique_ptr<ReplayCursor> mReplayCursor;
+
+		// only local matches, which are the ones stepped one at a time from the start; the log drops
+		// events rather than ever hold up a step
+		std::string mTelemetryPath;
+		std::unique_ptr<TelemetryLog> mTelemetry;
+		TelemetryStream* mTelemetryStream = nullptr;
+		std::unique_ptr<TelemetryObserver> mTelemetryObserver;
+
+		// with its own thread the simulation reads the keyboard, records and queues sounds there;
+		// Update only picks up the newest snapshot to draw
+		bool mThreadedSimulation;
+		std::unique_ptr<SimulationThread> mSimulation;
+
+#if defined(PONG_PROFILE)
+		// F3 shows the per-phase timings, F4 writes a trace of the last few seconds
+		bool mShowProfile = false;
+		double mProfileRefreshSeconds = 0.0;
+		std::wstring mProfileText;
+		Vector2 mProfileTextPosition = Vector2(10.0f, 10.0f);
+
+		// the first key change simulated since the last Present, for InputToPhoton
+		uint64_t mUnpresentedEventTime = 0;
+#endif
 	};
 }
\ No newline at end of file
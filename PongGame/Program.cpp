@@ -12,7 +12,80 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR command
 #endif	
 
 	UNREFERENCED_PARAMETER(previousInstance);
-	UNREFERENCED_PARAMETER(commandLine);
+
+	// "Pong.exe <file>" plays a recorded match back
+	string replayPath(commandLine);
+	replayPath.erase(remove(replayPath.begin(), replayPath.end(), '"'), replayPath.end());
+
+	// "Pong.exe --host <port>" waits for a second player, "Pong.exe --join <address>:<port>" is that
+	// player, "Pong.exe --chaos <balls>" plays multi-ball, "Pong.exe --threaded" simulates on its own
+	// thread, "Pong.exe --present waitable|tearing|vsync" or "--frame-limit <fps>" chooses how
+	// frames are paced, and "Pong.exe --telemetry <file>" logs gameplay events for PongTelemetry;
+	// options can be combined
+	NetplaySettings netplay;
+	uint32_t chaosBallCount = 0;
+	bool threadedSimulation = false;
+	PresentSettings present;
+	string telemetryPath;
+	if (replayPath.compare(0, 2, "--") == 0)
+	{
+		istringstream arguments(replayPath);
+		string option;
+		string target;
+		while (arguments >> option)
+		{
+			if (option == "--threaded")
+			{
+				threadedSimulation = true;
+				continue;
+			}
+			if (!(arguments >> target))
+			{
+				break;
+			}
+
+			if (option == "--chaos")
+			{
+				chaosBallCount = static_cast<uint32_t>(stoul(target));
+			}
+			else if (option == "--host" || option == "--join")
+			{
+				netplay.Enabled = true;
+				netplay.Role = (option == "--host" ? NetplayRole::Host : NetplayRole::Join);
+
+				size_t colon = target.rfind(':');
+				netplay.Address = target.substr(0, colon);
+				if (netplay.Role == NetplayRole::Host || colon != string::npos)
+				{
+					netplay.Port = static_cast<uint16_t>(stoul(netplay.Role == NetplayRole::Host ? target : target.substr(colon + 1)));
+				}
+			}
+			else if (option == "--present")
+			{
+				present.Mode = (target == "waitable" ? PresentMode::Waitable : target == "tearing" ? PresentMode::Tearing : PresentMode::Vsync);
+			}
+			else if (option == "--frame-limit")
+			{
+				present.Mode = PresentMode::Limited;
+				present.FrameLimit = stod(target);
+			}
+			else if (option == "--telemetry")
+			{
+				telemetryPath = target;
+			}
+		}
+		replayPath.clear();
+	}
+
+	// resolved before the working directory moves to the executable
+	for (string* path : { &replayPath, &telemetryPath })
+	{
+		char fullPath[MAX_PATH];
+		if (!path->empty() && GetFullPathNameA(path->c_str(), MAX_PATH, fullPath, nullptr) != 0)
+		{
+			*path = fullPath;
+		}
+	}
 
 	const SIZE RenderTargetSize = { 800, 600 };
 
@@ -37,7 +110,7 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR command
 		return reinterpret_cast<void*>(windowHandle);
 	};
 
-	PongGame game(getWindow, getRenderTargetSize);
+	PongGame game(getWindow, getRenderTargetSize, replayPath, netplay, chaosBallCount, threadedSimulation, present, telemetryPath);
 	game.UpdateRenderTargetSize();
 	game.Initialize();
 	
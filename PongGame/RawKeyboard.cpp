@@ -0,0 +1,127 @@
+#include "pch.h"
+#include "RawKeyboard.h"
+#include "InputEvents.h"
+#include "Profiler.h"
+#include <future>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const wchar_t* const WindowClassName = L"PongRawKeyboard";
+
+		uint32_t KeyFlag(USHORT virtualKey)
+		{
+			switch (virtualKey)
+			{
+			case VK_UP:
+				return InputKeys::Up;
+			case VK_DOWN:
+				return InputKeys::Down;
+			case VK_SPACE:
+				return InputKeys::Start;
+			default:
+				return 0;
+			}
+		}
+	}
+
+	RawKeyboard::RawKeyboard(InputEventQueue& events, function<void*()> getWindowCallback) :
+		mEvents(&events), mGetWindow(getWindowCallback), mKeys(0), mThreadId(0)
+	{
+		// the thread has to have its message queue before the destructor can post to it
+		promise<void> started;
+		future<void> ready = started.get_future();
+		mThread = thread([this, &started]() { Run([&started]() { started.set_value(); }); });
+		ready.get();
+	}
+
+	RawKeyboard::~RawKeyboard()
+	{
+		PostThreadMessage(mThreadId.load(), WM_QUIT, 0, 0);
+		mThread.join();
+	}
+
+	void RawKeyboard::Run(function<void()> ready)
+	{
+		// a message-only window is all raw input needs to deliver to
+		HINSTANCE instance = GetModuleHandle(nullptr);
+		WNDCLASSEXW windowClass = { 0 };
+		windowClass.cbSize = sizeof(windowClass);
+		windowClass.lpfnWndProc = DefWindowProcW;
+		windowClass.hInstance = instance;
+		windowClass.lpszClassName = WindowClassName;
+		RegisterClassExW(&windowClass);
+		HWND window = CreateWindowExW(0, WindowClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, instance, nullptr);
+
+		// input sink, because the keys go to the game's window rather than this one
+		RAWINPUTDEVICE device = { 0 };
+		device.usUsagePage = 0x01; // generic desktop
+		device.usUsage = 0x06; // keyboard
+		device.dwFlags = RIDEV_INPUTSINK;
+		device.hwndTarget = window;
+		bool registered = (window != nullptr && RegisterRawInputDevices(&device, 1, sizeof(device)) != FALSE);
+		if (!registered)
+		{
+			OutputDebugStringA("Raw keyboard input is unavailable; the paddle won't move.\n");
+		}
+
+		MSG message;
+		PeekMessage(&message, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+		mThreadId = GetCurrentThreadId();
+		ready();
+
+		while (GetMessage(&message, nullptr, 0, 0) > 0)
+		{
+			if (message.message == WM_INPUT)
+			{
+				RAWINPUT input;
+				UINT size = sizeof(input);
+				if (GetRawInputData(reinterpret_cast<HRAWINPUT>(message.lParam), RID_INPUT, &input, &size, sizeof(RAWINPUTHEADER)) != static_cast<UINT>(-1)
+					&& input.header.dwType == RIM_TYPEKEYBOARD)
+				{
+					Update(KeyFlag(input.data.keyboard.VKey), (input.data.keyboard.Flags & RI_KEY_BREAK) == 0);
+				}
+			}
+			DispatchMessage(&message);
+		}
+
+		if (registered)
+		{
+			device.dwFlags = RIDEV_REMOVE;
+			device.hwndTarget = nullptr;
+			RegisterRawInputDevices(&device, 1, sizeof(device));
+		}
+		if (window != nullptr)
+		{
+			DestroyWindow(window);
+		}
+		UnregisterClassW(WindowClassName, instance);
+	}
+
+	void RawKeyboard::Update(uint32_t key, bool pressed)
+	{
+		uint32_t keys = mKeys;
+		if (GetForegroundWindow() != reinterpret_cast<HWND>(mGetWindow()))
+		{
+			keys = 0;
+		}
+		else if (pressed)
+		{
+			keys |= key;
+		}
+		else
+		{
+			keys &= ~key;
+		}
+
+		// held keys repeat, but only a change is news
+		if (keys != mKeys)
+		{
+			mKeys = keys;
+			mEvents->Push(Profiler::Now(), keys);
+		}
+	}
+}
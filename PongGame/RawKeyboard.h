@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+namespace Pong
+{
+	class InputEventQueue;
+
+	// Listens to the keyboard through raw input on a thread of its own, so a key is stamped with
+	// the moment Windows delivers it rather than whenever the game loop next gets to its messages.
+	// Only changes to the game's keys go into the queue, and only while the game's window has the
+	// focus; losing it lets go of everything.
+	class RawKeyboard final
+	{
+	public:
+		RawKeyboard(InputEventQueue& events, std::function<void*()> getWindowCallback);
+		~RawKeyboard();
+
+		RawKeyboard(const RawKeyboard&) = delete;
+		RawKeyboard& operator=(const RawKeyboard&) = delete;
+
+	private:
+		void Run(std::function<void()> ready);
+		void Update(uint32_t key, bool pressed);
+
+		InputEventQueue* mEvents;
+		std::function<void*()> mGetWindow;
+		uint32_t mKeys;
+		std::atomic<uint32_t> mThreadId;
+		std::thread mThread;
+	};
+}
@@ -0,0 +1,162 @@
+#include "AudioMixer.h"
+#include "AudioSink.h"
+#include "FixedTimestep.h"
+#include "MatchSounds.h"
+#include "PaddleController.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct MixdownOptions
+	{
+		string ContentDirectory = PONG_CONTENT_DIRECTORY;
+		uint32_t Frames = 120 * 60;
+		uint32_t Seed = 1;
+		uint32_t Voices = 32;
+		bool RealTime = false;
+		string OutputPath;
+	};
+
+	MixdownOptions ParseOptions(int argc, char* argv[])
+	{
+		MixdownOptions options;
+
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--content") == 0)
+			{
+				options.ContentDirectory = argv[i + 1];
+			}
+			else if (strcmp(argv[i], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--voices") == 0)
+			{
+				options.Voices = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--realtime") == 0)
+			{
+				options.RealTime = (strcmp(argv[i + 1], "on") == 0);
+			}
+			else if (strcmp(argv[i], "--out") == 0)
+			{
+				options.OutputPath = argv[i + 1];
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	// Plays the tracking bot against the built-in AI and sends the match's sounds through the
+	// mixer thread, into a WAVE file or nowhere.
+	int Run(const MixdownOptions& options)
+	{
+		unique_ptr<AudioSink> sink;
+		AudioMixerOptions mixerOptions;
+		mixerOptions.VoiceCount = options.Voices;
+		if (options.OutputPath.empty())
+		{
+			sink = make_unique<NullAudioSink>(mixerOptions.SampleRate, options.RealTime);
+		}
+		else
+		{
+			sink = make_unique<WaveFileSink>(options.OutputPath, mixerOptions.SampleRate);
+		}
+
+		// in real time the mixer keeps pace with the sink like it does in the game; otherwise it
+		// follows the simulation exactly and the file is the same on every run
+		mixerOptions.FollowSimulation = !options.RealTime;
+		AudioMixer mixer(*sink, mixerOptions);
+		MatchSounds sounds(mixer, [&options](const string& name) { return Sound::LoadWave(options.ContentDirectory + "/" + name); }, options.Seed);
+
+		MatchConfig config;
+		MatchState match = Simulation::CreateMatch(config, options.Seed);
+		TrackingController player1;
+		MatchInputs inputs;
+		const float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		const double TailSeconds = 3.0;
+
+		auto startTime = chrono::steady_clock::now();
+		mixer.Start();
+
+		uint64_t events = 0;
+		double simulationSeconds = 0.0;
+		for (uint32_t frame = 0; frame < options.Frames; ++frame)
+		{
+			inputs.Start = (match.Gamestate != Gamestate::Playing);
+			inputs.Player1 = player1.Control(match, Players::Player1);
+			Simulation::Step(match, inputs, ElapsedTime);
+			simulationSeconds += ElapsedTime;
+
+			if (match.Events != MatchEvents::None)
+			{
+				++events;
+				sounds.Play(match, simulationSeconds);
+			}
+			mixer.Advance(simulationSeconds);
+
+			if (options.RealTime)
+			{
+				this_thread::sleep_until(startTime + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(simulationSeconds)));
+			}
+		}
+
+		// let the last sounds ring out
+		mixer.Advance(simulationSeconds + TailSeconds);
+		if (options.RealTime)
+		{
+			this_thread::sleep_for(chrono::duration<double>(TailSeconds));
+		}
+		mixer.Stop();
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+		double mixedSeconds = static_cast<double>(mixer.FramesMixed()) / mixerOptions.SampleRate;
+		cout << "Mixed " << mixedSeconds << " s of audio for " << events << " frames with events in " << elapsed.count() << " s ("
+			<< mixedSeconds / elapsed.count() << "x real time), " << mixer.StolenVoices() << " voices stolen, " << mixer.DroppedSounds() << " sounds dropped" << endl;
+
+		if (!options.OutputPath.empty())
+		{
+			static_cast<WaveFileSink&>(*sink).Close();
+			cout << "Wrote " << options.OutputPath << endl;
+		}
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return Run(ParseOptions(argc, argv));
+	}
+	catch (const exception& error)
+	{
+		cerr << error.what() << endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,237 @@
+#include "NetplayPeer.h"
+#include "PacketChannel.h"
+#include "PaddleController.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace Pong;
+
+namespace
+{
+	struct NetplayOptions
+	{
+		uint32_t Frames = 3600;
+		LinkConditions Link;
+		RollbackOptions Rollback;
+		uint16_t Port = 7000;
+		uint32_t Seed = 1;
+		PhysicsMode Physics = PhysicsMode::Float;
+		bool Realtime = false;
+
+		// one side beatable, so points, re-serves and game over all happen under rollback
+		string HostBot = "track";
+		string JoinBot = "classic:2";
+	};
+
+	NetplayOptions ParseOptions(int argc, char* argv[])
+	{
+		NetplayOptions options;
+		options.Link.LatencySeconds = 0.05;
+		options.Link.JitterSeconds = 0.02;
+		options.Link.LossRate = 0.05f;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--realtime") == 0)
+			{
+				options.Realtime = true;
+				continue;
+			}
+
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			const char* value = argv[++i];
+			if (strcmp(argv[i - 1], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--latency") == 0)
+			{
+				options.Link.LatencySeconds = strtod(value, nullptr) / 1000.0;
+			}
+			else if (strcmp(argv[i - 1], "--jitter") == 0)
+			{
+				options.Link.JitterSeconds = strtod(value, nullptr) / 1000.0;
+			}
+			else if (strcmp(argv[i - 1], "--loss") == 0)
+			{
+				options.Link.LossRate = strtof(value, nullptr);
+			}
+			else if (strcmp(argv[i - 1], "--delay") == 0)
+			{
+				options.Rollback.InputDelay = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--rollback") == 0)
+			{
+				options.Rollback.MaxRollback = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--port") == 0)
+			{
+				options.Port = static_cast<uint16_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--host-bot") == 0)
+			{
+				options.HostBot = value;
+			}
+			else if (strcmp(argv[i - 1], "--join-bot") == 0)
+			{
+				options.JoinBot = value;
+			}
+			else if (strcmp(argv[i - 1], "--physics") == 0)
+			{
+				if (strcmp(value, "float") == 0)
+				{
+					options.Physics = PhysicsMode::Float;
+				}
+				else if (strcmp(value, "fixed") == 0)
+				{
+					options.Physics = PhysicsMode::FixedPoint;
+				}
+				else
+				{
+					cerr << "Unknown value for --physics: " << value << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i - 1] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	// What a player at this peer would press: whatever the bot says, and serve when the match is waiting.
+	bool PlayFrame(NetplayPeer& peer, const PaddleController& bot)
+	{
+		PaddleInputs inputs;
+		bool start = false;
+		if (peer.Connected())
+		{
+			const MatchState& match = peer.Session().Match();
+			Players player = peer.Session().LocalPlayer();
+			inputs = bot.Control(match, player);
+			start = (match.Gamestate != Gamestate::Playing);
+		}
+
+		return peer.Update(inputs, start);
+	}
+
+	bool IsSettled(const NetplayPeer& peer, uint32_t frames)
+	{
+		return peer.Connected() && peer.Session().Frame() >= frames && peer.Session().RemoteFrame() >= peer.Session().Frame();
+	}
+
+	void PrintStats(const string& name, const NetplayPeer& peer, const LossyChannel& channel, float stepSeconds)
+	{
+		const RollbackStats& stats = peer.Session().Stats();
+		double averageMilliseconds = (stats.Rollbacks > 0 ? 1000.0 * stats.ResimulationSeconds / stats.Rollbacks : 0.0);
+
+		cout << name << ": " << stats.FramesAdvanced << " frames, " << stats.Stalls << " stalls, " << stats.Rollbacks << " rollbacks ("
+			<< fixed << setprecision(1) << 100.0 * stats.Rollbacks / max<uint64_t>(stats.FramesAdvanced, 1) << "% of frames), "
+			<< stats.ResimulatedFrames << " frames resimulated, deepest " << stats.MaxRollbackDepth << endl;
+		cout << "    resimulation " << setprecision(4) << averageMilliseconds << " ms average, " << 1000.0 * stats.MaxResimulationSeconds << " ms worst ("
+			<< setprecision(2) << 100.0 * stats.MaxResimulationSeconds / stepSeconds << "% of the frame budget); "
+			<< peer.PacketsSent() << " packets sent, " << channel.PacketsDropped() << " dropped, " << peer.PacketsReceived() << " received" << endl;
+	}
+}
+
+// Plays a netplay match between two bots in this process, over real UDP sockets on localhost
+// with simulated latency, jitter and loss, then checks both sides ended with the same match.
+int main(int argc, char* argv[])
+{
+	NetplayOptions options = ParseOptions(argc, argv);
+	float stepSeconds = options.Rollback.StepSeconds;
+
+	// the virtual clock runs the match as fast as it can; --realtime waits out every frame
+	double virtualTime = 0.0;
+	auto startTime = chrono::steady_clock::now();
+	function<double()> clock = [&]
+	{
+		return options.Realtime ? chrono::duration<double>(chrono::steady_clock::now() - startTime).count() : virtualTime;
+	};
+
+	try
+	{
+		auto hostSocket = make_shared<UdpChannel>(options.Port);
+		auto joinSocket = make_shared<UdpChannel>();
+		joinSocket->Connect("127.0.0.1", hostSocket->LocalPort());
+
+		auto hostChannel = make_shared<LossyChannel>(hostSocket, options.Link, options.Seed, clock);
+		auto joinChannel = make_shared<LossyChannel>(joinSocket, options.Link, options.Seed + 1, clock);
+
+		MatchConfig config;
+		config.Physics = options.Physics;
+		NetplayPeer host(hostChannel, NetplayRole::Host, config, options.Seed, options.Rollback);
+		NetplayPeer joiner(joinChannel, NetplayRole::Join, config, 0, RollbackOptions());
+		unique_ptr<PaddleController> hostBot = PaddleController::Create(options.HostBot);
+		unique_ptr<PaddleController> joinBot = PaddleController::Create(options.JoinBot);
+
+		cout << "Playing " << options.Frames << " frames over localhost with " << 1000.0 * options.Link.LatencySeconds << " ms latency, "
+			<< 1000.0 * options.Link.JitterSeconds << " ms jitter and " << 100.0f * options.Link.LossRate << "% loss" << endl;
+
+		// once a side has played every frame it only listens, until the other confirms them all
+		uint32_t tickLimit = options.Frames * 20 + 600;
+		uint32_t tick = 0;
+		for (; tick < tickLimit && !(IsSettled(host, options.Frames) && IsSettled(joiner, options.Frames)); ++tick)
+		{
+			for (NetplayPeer* peer : { &host, &joiner })
+			{
+				if (peer->Connected() && peer->Session().Frame() >= options.Frames)
+				{
+					peer->Poll();
+				}
+				else
+				{
+					PlayFrame(*peer, (peer == &host ? *hostBot : *joinBot));
+				}
+			}
+
+			virtualTime += stepSeconds;
+			if (options.Realtime)
+			{
+				this_thread::sleep_until(startTime + chrono::duration<double>(virtualTime));
+			}
+		}
+
+		if (!IsSettled(host, options.Frames) || !IsSettled(joiner, options.Frames))
+		{
+			cerr << "The peers never caught up with each other." << endl;
+			return EXIT_FAILURE;
+		}
+
+		const MatchState& hostMatch = host.Session().Match();
+		uint64_t hostChecksum = RollbackSession::Checksum(hostMatch);
+		uint64_t joinChecksum = RollbackSession::Checksum(joiner.Session().Match());
+
+		cout << "Finished in " << tick << " ticks at " << hostMatch.Player1Score << " - " << hostMatch.Player2Score << endl;
+		PrintStats("Host", host, *hostChannel, stepSeconds);
+		PrintStats("Joiner", joiner, *joinChannel, stepSeconds);
+		cout << "Checksums " << hex << setw(16) << setfill('0') << hostChecksum << " and " << setw(16) << joinChecksum
+			<< (hostChecksum == joinChecksum ? ", in sync" : ", DESYNCED") << dec << endl;
+
+		return hostChecksum == joinChecksum ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	catch (const exception& error)
+	{
+		cerr << error.what() << endl;
+		return EXIT_FAILURE;
+	}
+}
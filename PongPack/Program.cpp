@@ -0,0 +1,227 @@
+#include "AssetArchive.h"
+#include "BitmapFont.h"
+#include "Png.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	void PrintUsage()
+	{
+		cerr << "Usage: PongPack [<content directory> <archive>]" << endl;
+	}
+
+	bool EndsWith(const string& text, const string& suffix)
+	{
+		return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	vector<uint8_t> ReadFile(const string& path)
+	{
+		ifstream file(path, ios::binary);
+		if (!file.good())
+		{
+			throw runtime_error("Couldn't open " + path + ".");
+		}
+		return vector<uint8_t>((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	}
+
+	// every file under directory, as paths relative to it with forward slashes
+	void ListFiles(const string& directory, const string& prefix, vector<string>& files)
+	{
+#if defined(_WIN32)
+		WIN32_FIND_DATAA data;
+		HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &data);
+		if (find == INVALID_HANDLE_VALUE)
+		{
+			throw runtime_error("Couldn't list " + directory + ".");
+		}
+		do
+		{
+			string name = data.cFileName;
+			if (name == "." || name == "..")
+			{
+				continue;
+			}
+			if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			{
+				ListFiles(directory + "\\" + name, prefix + name + "/", files);
+			}
+			else
+			{
+				files.push_back(prefix + name);
+			}
+		} while (FindNextFileA(find, &data));
+		FindClose(find);
+#else
+		DIR* handle = opendir(directory.c_str());
+		if (handle == nullptr)
+		{
+			throw runtime_error("Couldn't list " + directory + ".");
+		}
+		while (dirent* entry = readdir(handle))
+		{
+			string name = entry->d_name;
+			if (name == "." || name == "..")
+			{
+				continue;
+			}
+
+			struct stat status;
+			if (stat((directory + "/" + name).c_str(), &status) != 0)
+			{
+				continue;
+			}
+			if (S_ISDIR(status.st_mode))
+			{
+				ListFiles(directory + "/" + name, prefix + name + "/", files);
+			}
+			else
+			{
+				files.push_back(prefix + name);
+			}
+		}
+		closedir(handle);
+#endif
+	}
+
+	// the fmt and data chunks of a RIFF WAVE file, the same pair DirectX::SoundEffect keeps
+	vector<uint8_t> PackSound(const vector<uint8_t>& file, const string& name)
+	{
+		if (file.size() < 12 || memcmp(file.data(), "RIFF", 4) != 0 || memcmp(file.data() + 8, "WAVE", 4) != 0)
+		{
+			throw runtime_error(name + " is not a WAVE file.");
+		}
+
+		const uint8_t* format = nullptr;
+		size_t formatSize = 0;
+		const uint8_t* samples = nullptr;
+		size_t samplesSize = 0;
+		for (size_t position = 12; position + 8 <= file.size();)
+		{
+			uint32_t chunkSize;
+			memcpy(&chunkSize, file.data() + position + 4, sizeof(chunkSize));
+			const uint8_t* chunk = file.data() + position + 8;
+			size_t available = min<size_t>(chunkSize, file.size() - position - 8);
+
+			if (memcmp(file.data() + position, "fmt ", 4) == 0)
+			{
+				format = chunk;
+				formatSize = available;
+			}
+			else if (memcmp(file.data() + position, "data", 4) == 0)
+			{
+				samples = chunk;
+				samplesSize = available;
+			}
+
+			// chunks are padded to an even size
+			position += 8 + static_cast<size_t>(chunkSize) + (chunkSize & 1);
+		}
+
+		if (format == nullptr || samples == nullptr)
+		{
+			throw runtime_error(name + " has no fmt or data chunk.");
+		}
+		return AssetArchive::SoundPayload(format, formatSize, samples, samplesSize);
+	}
+
+	const char* TypeName(AssetType type)
+	{
+		switch (type)
+		{
+		case AssetType::Texture:
+			return "texture";
+		case AssetType::Font:
+			return "font";
+		case AssetType::Sound:
+			return "sound";
+		default:
+			return "raw";
+		}
+	}
+
+	// Decodes everything the game loads at startup so it can come straight out of the mapping:
+	// PNGs to RGBA, sprite fonts to uncompressed RGBA, WAVs to their format and PCM samples.
+	int Pack(const string& contentDirectory, const string& archivePath)
+	{
+		auto startTime = chrono::steady_clock::now();
+
+		vector<string> files;
+		ListFiles(contentDirectory, "", files);
+		sort(files.begin(), files.end());
+
+		AssetArchiveWriter writer;
+		for (const string& name : files)
+		{
+			string path = contentDirectory + "/" + name;
+			vector<uint8_t> payload;
+			AssetType type;
+			if (EndsWith(name, ".png"))
+			{
+				type = AssetType::Texture;
+				payload = AssetArchive::TexturePayload(Png::Load(path));
+			}
+			else if (EndsWith(name, ".spritefont"))
+			{
+				type = AssetType::Font;
+				payload = BitmapFont(path).Serialize();
+			}
+			else if (EndsWith(name, ".wav"))
+			{
+				type = AssetType::Sound;
+				payload = PackSound(ReadFile(path), name);
+			}
+			else
+			{
+				type = AssetType::Raw;
+				payload = ReadFile(path);
+			}
+
+			cout << name << ": " << TypeName(type) << ", " << payload.size() << " bytes" << endl;
+			writer.Add(name, type, move(payload));
+		}
+		writer.Write(archivePath);
+
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+		cout << "Packed " << files.size() << " assets into " << archivePath << " in " << elapsed.count() << " s" << endl;
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 1 && argc != 3)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		return (argc == 3 ? Pack(argv[1], argv[2]) : Pack(PONG_CONTENT_DIRECTORY, "Content.pak"));
+	}
+	catch (const exception& error)
+	{
+		cerr << error.what() << endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,272 @@
+#include "PolicyTrainer.h"
+#include "MatchBatch.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const float Beta1 = 0.9f;
+		const float Beta2 = 0.999f;
+		const float Epsilon = 1e-8f;
+
+		// gradients and Adam moments, shaped like the layer they train
+		struct LayerTraining final
+		{
+			vector<float> WeightGradient;
+			vector<float> BiasGradient;
+			vector<float> WeightMoment;
+			vector<float> WeightVelocity;
+			vector<float> BiasMoment;
+			vector<float> BiasVelocity;
+
+			explicit LayerTraining(const PolicyLayer& layer) :
+				WeightGradient(layer.Weights.size()), BiasGradient(layer.Biases.size()),
+				WeightMoment(layer.Weights.size()), WeightVelocity(layer.Weights.size()),
+				BiasMoment(layer.Biases.size()), BiasVelocity(layer.Biases.size())
+			{
+			}
+		};
+
+		void AdamStep(vector<float>& parameters, vector<float>& gradients, vector<float>& moments, vector<float>& velocities, float scale, float stepSize)
+		{
+			for (size_t i = 0; i < parameters.size(); ++i)
+			{
+				float gradient = gradients[i] * scale;
+				moments[i] = Beta1 * moments[i] + (1.0f - Beta1) * gradient;
+				velocities[i] = Beta2 * velocities[i] + (1.0f - Beta2) * gradient * gradient;
+				parameters[i] -= stepSize * moments[i] / (sqrt(velocities[i]) + Epsilon);
+				gradients[i] = 0.0f;
+			}
+		}
+	}
+
+	PolicyTrainer::PolicyTrainer(const TrainerOptions& options) :
+		mOptions(options)
+	{
+		if (options.Matches == 0 || options.Rounds == 0 || options.SampleInterval == 0 || options.BatchSize == 0)
+		{
+			throw invalid_argument("Training needs at least one match, round, sample and batch.");
+		}
+
+		if (options.Config.Player2Control != PaddleControl::BuiltInAI)
+		{
+			throw invalid_argument("Training plays against the built-in AI.");
+		}
+	}
+
+	PolicyNetwork PolicyTrainer::Train(ostream& log)
+	{
+		PolicyNetwork network(mOptions.HiddenWidths, mOptions.Seed);
+
+		for (uint32_t round = 0; round < mOptions.Rounds; ++round)
+		{
+			Collect(round == 0 ? nullptr : &network, round, log);
+			Fit(network, log);
+		}
+
+		return network;
+	}
+
+	PolicyAction PolicyTrainer::TeacherAction(const MatchConfig& config, float ballX, float ballY, float velocityX, float velocityY, float paddleY)
+	{
+		// player 1's mirror of the predictive AI: meet an approaching ball, otherwise wait in the middle
+		float targetY = config.ViewportHeight / 2;
+		if (velocityX < 0.0f)
+		{
+			BallState ball;
+			ball.Bounds = Rect(ballX, ballY, config.BallWidth, config.BallHeight);
+			ball.Velocity = Vector2(velocityX, velocityY);
+			targetY = Simulation::PredictInterceptY(config, ball, config.PaddleWallOffset + config.PaddleWidth) + config.BallHeight / 2;
+		}
+
+		float velocity = Simulation::SteerAIPaddle(config, paddleY, targetY);
+		return (velocity < 0.0f ? PolicyAction::Up : (velocity > 0.0f ? PolicyAction::Down : PolicyAction::Stay));
+	}
+
+	void PolicyTrainer::Collect(const PolicyNetwork* network, uint32_t round, ostream& log)
+	{
+		const MatchConfig& config = mOptions.Config;
+		MatchBatch batch(config, mOptions.Matches, mOptions.Seed + round * mOptions.Matches);
+		size_t stride = batch.Size();
+		vector<float> features(PolicyNetwork::FeatureCount * stride);
+		vector<int32_t> actions(stride);
+		KernelPath path = MatchBatch::BestKernelPath();
+
+		uint64_t pointsWon = 0;
+		uint64_t pointsLost = 0;
+		size_t samplesBefore = mLabels.size();
+
+		for (uint32_t frame = 0; frame < mOptions.FramesPerRound; ++frame)
+		{
+			PolicyNetwork::BatchFeatures(batch, features.data(), stride);
+			if (network != nullptr)
+			{
+				network->Evaluate(features.data(), stride, batch.Size(), actions.data(), path);
+			}
+
+			bool sample = (frame % mOptions.SampleInterval == 0);
+			for (size_t i = 0; i < batch.Size(); ++i)
+			{
+				bool playing = (batch.Gamestates()[i] == static_cast<int32_t>(Gamestate::Playing));
+				PolicyAction teacher = TeacherAction(config, batch.BallX()[i], batch.BallY()[i], batch.BallVelocityX()[i], batch.BallVelocityY()[i], batch.Paddle1Y()[i]);
+				PolicyAction action = (network != nullptr ? static_cast<PolicyAction>(actions[i]) : teacher);
+
+				if (sample && playing)
+				{
+					for (uint32_t k = 0; k < PolicyNetwork::FeatureCount; ++k)
+					{
+						mFeatures.push_back(features[k * stride + i]);
+					}
+					mLabels.push_back(static_cast<int32_t>(teacher));
+				}
+
+				batch.Player1Up()[i] = (action == PolicyAction::Up);
+				batch.Player1Down()[i] = (action == PolicyAction::Down);
+				batch.Start()[i] = !playing;
+			}
+
+			batch.Step(mOptions.ElapsedTime);
+
+			for (size_t i = 0; i < batch.Size(); ++i)
+			{
+				uint32_t events = batch.Events()[i];
+				pointsWon += ((events & MatchEvents::Player1Scored) != 0);
+				pointsLost += ((events & MatchEvents::Player2Scored) != 0);
+			}
+		}
+
+		log << "Round " << round + 1 << ": " << (network != nullptr ? "network" : "teacher") << " won " << pointsWon << " points and lost " << pointsLost
+			<< ", " << mLabels.size() - samplesBefore << " new samples (" << mLabels.size() << " in all)" << endl;
+	}
+
+	void PolicyTrainer::Fit(PolicyNetwork& network, ostream& log)
+	{
+		vector<PolicyLayer>& layers = network.Layers();
+		vector<LayerTraining> training;
+		for (const PolicyLayer& layer : layers)
+		{
+			training.emplace_back(layer);
+		}
+
+		// activations[0] is the features, activations[l + 1] what layer l put out
+		vector<vector<float>> activations(layers.size() + 1);
+		vector<vector<float>> deltas(layers.size());
+		activations[0].resize(PolicyNetwork::FeatureCount);
+		for (size_t l = 0; l < layers.size(); ++l)
+		{
+			activations[l + 1].resize(layers[l].OutputCount);
+			deltas[l].resize(layers[l].OutputCount);
+		}
+
+		vector<size_t> order(mLabels.size());
+		iota(order.begin(), order.end(), 0);
+		minstd_rand generator(mOptions.Seed);
+		uint32_t step = 0;
+
+		for (uint32_t epoch = 0; epoch < mOptions.Epochs; ++epoch)
+		{
+			shuffle(order.begin(), order.end(), generator);
+			double loss = 0.0;
+
+			for (size_t start = 0; start < order.size(); start += mOptions.BatchSize)
+			{
+				size_t end = min(order.size(), start + mOptions.BatchSize);
+				for (size_t n = start; n < end; ++n)
+				{
+					size_t sample = order[n];
+					copy_n(mFeatures.begin() + sample * PolicyNetwork::FeatureCount, PolicyNetwork::FeatureCount, activations[0].begin());
+
+					for (size_t l = 0; l < layers.size(); ++l)
+					{
+						const PolicyLayer& layer = layers[l];
+						for (uint32_t o = 0; o < layer.OutputCount; ++o)
+						{
+							float sum = layer.Biases[o];
+							for (uint32_t j = 0; j < layer.InputCount; ++j)
+							{
+								sum += layer.Weights[o * layer.InputCount + j] * activations[l][j];
+							}
+							activations[l + 1][o] = (l + 1 < layers.size() ? max(sum, 0.0f) : sum);
+						}
+					}
+
+					// softmax cross-entropy against the teacher's action
+					vector<float>& logits = activations.back();
+					float largest = *max_element(logits.begin(), logits.end());
+					float total = 0.0f;
+					for (float logit : logits)
+					{
+						total += exp(logit - largest);
+					}
+					int32_t label = mLabels[sample];
+					for (uint32_t a = 0; a < PolicyNetwork::ActionCount; ++a)
+					{
+						deltas.back()[a] = exp(logits[a] - largest) / total - (static_cast<int32_t>(a) == label ? 1.0f : 0.0f);
+					}
+					loss += std::log(total) - (logits[label] - largest);
+
+					for (size_t l = layers.size(); l-- > 0;)
+					{
+						const PolicyLayer& layer = layers[l];
+						LayerTraining& gradients = training[l];
+						for (uint32_t o = 0; o < layer.OutputCount; ++o)
+						{
+							float delta = deltas[l][o];
+							gradients.BiasGradient[o] += delta;
+							for (uint32_t j = 0; j < layer.InputCount; ++j)
+							{
+								gradients.WeightGradient[o * layer.InputCount + j] += delta * activations[l][j];
+							}
+						}
+
+						if (l > 0)
+						{
+							for (uint32_t j = 0; j < layer.InputCount; ++j)
+							{
+								float sum = 0.0f;
+								for (uint32_t o = 0; o < layer.OutputCount; ++o)
+								{
+									sum += layer.Weights[o * layer.InputCount + j] * deltas[l][o];
+								}
+								deltas[l - 1][j] = (activations[l][j] > 0.0f ? sum : 0.0f);
+							}
+						}
+					}
+				}
+
+				++step;
+				float scale = 1.0f / static_cast<float>(end - start);
+				float stepSize = mOptions.LearningRate * sqrt(1.0f - pow(Beta2, static_cast<float>(step))) / (1.0f - pow(Beta1, static_cast<float>(step)));
+				for (size_t l = 0; l < layers.size(); ++l)
+				{
+					AdamStep(layers[l].Weights, training[l].WeightGradient, training[l].WeightMoment, training[l].WeightVelocity, scale, stepSize);
+					AdamStep(layers[l].Biases, training[l].BiasGradient, training[l].BiasMoment, training[l].BiasVelocity, scale, stepSize);
+				}
+			}
+
+			log << "  epoch " << epoch + 1 << ": loss " << loss / max<size_t>(order.size(), 1) << endl;
+		}
+
+		log << "  agrees with the teacher on " << 100.0f * Accuracy(network) << "% of samples" << endl;
+	}
+
+	float PolicyTrainer::Accuracy(const PolicyNetwork& network) const
+	{
+		// the samples are stored row by row, which is a stride of one for a single paddle
+		size_t agreed = 0;
+		for (size_t sample = 0; sample < mLabels.size(); ++sample)
+		{
+			agreed += (static_cast<int32_t>(network.Decide(mFeatures.data() + sample * PolicyNetwork::FeatureCount)) == mLabels[sample]);
+		}
+
+		return static_cast<float>(agreed) / static_cast<float>(max<size_t>(mLabels.size(), 1));
+	}
+}
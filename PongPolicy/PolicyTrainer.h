@@ -0,0 +1,49 @@
+#pragma once
+
+#include "FixedTimestep.h"
+#include "MatchConfig.h"
+#include "PolicyNetwork.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace Pong
+{
+	struct TrainerOptions final
+	{
+		std::vector<uint32_t> HiddenWidths = { 32, 32 };
+		uint32_t Matches = 512; // lanes in the MatchBatch that collects states
+		uint32_t Rounds = 4; // the teacher plays the first round, the network every one after
+		uint32_t FramesPerRound = 3000;
+		uint32_t SampleInterval = 6; // frames between samples from each lane
+		uint32_t Epochs = 3;
+		uint32_t BatchSize = 256;
+		float LearningRate = 0.003f;
+		float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		uint32_t Seed = 1;
+		MatchConfig Config;
+	};
+
+	// Teaches a PolicyNetwork to play player 1 by imitating a teacher that steers for the
+	// predicted intercept. After the first round the network plays and the teacher only labels the
+	// states it reaches (DAgger), so the network learns to recover from its own mistakes. Every
+	// round plays a whole MatchBatch of games with the network evaluated in one batched call per step.
+	class PolicyTrainer final
+	{
+	public:
+		explicit PolicyTrainer(const TrainerOptions& options);
+
+		PolicyNetwork Train(std::ostream& log);
+
+		static PolicyAction TeacherAction(const MatchConfig& config, float ballX, float ballY, float velocityX, float velocityY, float paddleY);
+
+	private:
+		void Collect(const PolicyNetwork* network, uint32_t round, std::ostream& log);
+		void Fit(PolicyNetwork& network, std::ostream& log);
+		float Accuracy(const PolicyNetwork& network) const;
+
+		TrainerOptions mOptions;
+		std::vector<float> mFeatures; // FeatureCount floats per sample
+		std::vector<int32_t> mLabels;
+	};
+}
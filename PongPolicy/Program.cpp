@@ -0,0 +1,282 @@
+#include "MatchBatch.h"
+#include "PolicyNetwork.h"
+#include "PolicyTrainer.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct PolicyOptions
+	{
+		TrainerOptions Training;
+		uint32_t Matches = 4096;
+		uint32_t Frames = 20000;
+		uint32_t Count = 65536;
+		uint32_t Iterations = 200;
+	};
+
+	void PrintUsage()
+	{
+		cerr << "Usage: PongPolicy train <file> [--hidden 32,32] [--matches N] [--rounds N] [--frames N] [--epochs N] [--seed N]" << endl;
+		cerr << "       PongPolicy bench <file> [--count N] [--iterations N]" << endl;
+		cerr << "       PongPolicy play <file> [--matches N] [--frames N] [--seed N] [--ai reactive|predictive] [--ai-error pixels]" << endl;
+	}
+
+	vector<uint32_t> ParseWidths(const char* text)
+	{
+		vector<uint32_t> widths;
+		const char* position = text;
+		while (*position != '\0')
+		{
+			char* end;
+			unsigned long width = strtoul(position, &end, 10);
+			if (end == position)
+			{
+				break;
+			}
+
+			widths.push_back(static_cast<uint32_t>(width));
+			position = (*end == ',' ? end + 1 : end);
+		}
+
+		return widths;
+	}
+
+	PolicyOptions ParseOptions(int argc, char* argv[])
+	{
+		PolicyOptions options;
+
+		for (int i = 3; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--hidden") == 0)
+			{
+				options.Training.HiddenWidths = ParseWidths(argv[i + 1]);
+			}
+			else if (strcmp(argv[i], "--matches") == 0)
+			{
+				options.Matches = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+				options.Training.Matches = options.Matches;
+			}
+			else if (strcmp(argv[i], "--rounds") == 0)
+			{
+				options.Training.Rounds = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+				options.Training.FramesPerRound = options.Frames;
+			}
+			else if (strcmp(argv[i], "--epochs") == 0)
+			{
+				options.Training.Epochs = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				options.Training.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--count") == 0)
+			{
+				options.Count = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--iterations") == 0)
+			{
+				options.Iterations = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--ai") == 0)
+			{
+				if (strcmp(argv[i + 1], "reactive") == 0)
+				{
+					options.Training.Config.AI = AIMode::Reactive;
+				}
+				else if (strcmp(argv[i + 1], "predictive") == 0)
+				{
+					options.Training.Config.AI = AIMode::Predictive;
+				}
+				else
+				{
+					cerr << "Unknown value for --ai: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--ai-error") == 0)
+			{
+				options.Training.Config.AIError = static_cast<float>(atof(argv[i + 1]));
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	int Train(const string& path, const PolicyOptions& options)
+	{
+		auto startTime = chrono::steady_clock::now();
+		PolicyTrainer trainer(options.Training);
+		PolicyNetwork network = trainer.Train(cout);
+		network.Save(path);
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+		cout << "Wrote " << path << " after " << elapsed.count() << " s" << endl;
+		return EXIT_SUCCESS;
+	}
+
+	// Times every supported kernel path on the same features and checks they all agree with scalar.
+	int Bench(const string& path, const PolicyOptions& options)
+	{
+		PolicyNetwork network(path);
+		size_t count = options.Count;
+
+		// features spread over the ranges real matches produce
+		minstd_rand generator(1);
+		uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+		vector<float> features(PolicyNetwork::FeatureCount * count);
+		for (float& feature : features)
+		{
+			feature = distribution(generator);
+		}
+
+		cout << "Evaluating " << count << " paddles " << options.Iterations << " times on one core" << endl;
+
+		vector<int32_t> reference(count);
+		network.Evaluate(features.data(), count, count, reference.data(), KernelPath::Scalar);
+
+		bool allMatch = true;
+		double scalarRate = 0.0;
+		for (KernelPath kernelPath : { KernelPath::Scalar, KernelPath::Sse41, KernelPath::Avx2 })
+		{
+			if (!MatchBatch::IsKernelPathSupported(kernelPath))
+			{
+				cout << left << setw(8) << MatchBatch::KernelPathName(kernelPath) << "not supported on this CPU" << endl;
+				continue;
+			}
+
+			vector<int32_t> actions(count);
+			auto startTime = chrono::steady_clock::now();
+			for (uint32_t iteration = 0; iteration < options.Iterations; ++iteration)
+			{
+				network.Evaluate(features.data(), count, count, actions.data(), kernelPath);
+			}
+			chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+			double rate = static_cast<double>(count) * options.Iterations / elapsed.count();
+			scalarRate = (kernelPath == KernelPath::Scalar ? rate : scalarRate);
+			bool matches = (actions == reference);
+			allMatch = allMatch && matches;
+
+			cout << left << setw(8) << MatchBatch::KernelPathName(kernelPath) << fixed << setprecision(1) << setw(10) << rate / 1e6 << "M evaluations/s"
+				<< "  " << setprecision(2) << rate / scalarRate << "x scalar" << (matches ? "" : "  (DIVERGES from scalar)") << endl;
+		}
+
+		return allMatch ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// The network plays player 1 of a whole batch against the built-in AI.
+	int Play(const string& path, const PolicyOptions& options)
+	{
+		PolicyNetwork network(path);
+		MatchBatch batch(options.Training.Config, options.Matches, options.Training.Seed);
+		size_t stride = batch.Size();
+		vector<float> features(PolicyNetwork::FeatureCount * stride);
+		vector<int32_t> actions(stride);
+		KernelPath kernelPath = MatchBatch::BestKernelPath();
+
+		uint64_t pointsWon = 0;
+		uint64_t pointsLost = 0;
+		uint64_t gamesWon = 0;
+		uint64_t gamesLost = 0;
+		chrono::duration<double> policyTime(0.0);
+
+		for (uint32_t frame = 0; frame < options.Frames; ++frame)
+		{
+			PolicyNetwork::BatchFeatures(batch, features.data(), stride);
+			auto startTime = chrono::steady_clock::now();
+			network.Evaluate(features.data(), stride, batch.Size(), actions.data(), kernelPath);
+			policyTime += chrono::steady_clock::now() - startTime;
+
+			for (size_t i = 0; i < batch.Size(); ++i)
+			{
+				batch.Player1Up()[i] = (actions[i] == static_cast<int32_t>(PolicyAction::Up));
+				batch.Player1Down()[i] = (actions[i] == static_cast<int32_t>(PolicyAction::Down));
+				batch.Start()[i] = (batch.Gamestates()[i] != static_cast<int32_t>(Gamestate::Playing));
+			}
+
+			batch.Step(options.Training.ElapsedTime);
+
+			for (size_t i = 0; i < batch.Size(); ++i)
+			{
+				uint32_t events = batch.Events()[i];
+				pointsWon += ((events & MatchEvents::Player1Scored) != 0);
+				pointsLost += ((events & MatchEvents::Player2Scored) != 0);
+				if (events & MatchEvents::GameOver)
+				{
+					bool won = batch.Player1Score()[i] > batch.Player2Score()[i];
+					gamesWon += won;
+					gamesLost += !won;
+				}
+			}
+		}
+
+		uint64_t evaluations = static_cast<uint64_t>(batch.Size()) * options.Frames;
+		cout << "Points won " << pointsWon << ", lost " << pointsLost << "; games won " << gamesWon << ", lost " << gamesLost << endl;
+		cout << evaluations << " policy evaluations on " << MatchBatch::KernelPathName(kernelPath) << " at "
+			<< fixed << setprecision(1) << evaluations / policyTime.count() / 1e6 << "M evaluations/s" << endl;
+
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	string command = argv[1];
+	string path = argv[2];
+	PolicyOptions options = ParseOptions(argc, argv);
+
+	try
+	{
+		if (command == "train")
+		{
+			return Train(path, options);
+		}
+		else if (command == "bench")
+		{
+			return Bench(path, options);
+		}
+		else if (command == "play")
+		{
+			return Play(path, options);
+		}
+	}
+	catch (const exception& exception)
+	{
+		cerr << exception.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	PrintUsage();
+	return EXIT_FAILURE;
+}
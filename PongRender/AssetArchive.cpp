@@ -0,0 +1,251 @@
+#include "pch.h"
+#include "AssetArchive.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const char Magic[4] = { 'P', 'P', 'A', 'K' };
+		const uint32_t Version = 1;
+
+		struct ArchiveHeader final
+		{
+			char Magic[4];
+			uint32_t Version;
+			uint32_t EntryCount;
+			uint32_t Alignment;
+			uint64_t TableOffset;
+			uint64_t NamesOffset;
+		};
+
+		struct TableEntry final
+		{
+			uint32_t Type;
+			uint32_t NameOffset;
+			uint32_t NameSize;
+			uint32_t Reserved;
+			uint64_t Offset;
+			uint64_t Size;
+		};
+
+		void PadTo(vector<uint8_t>& output, size_t alignment)
+		{
+			output.resize((output.size() + alignment - 1) / alignment * alignment, 0);
+		}
+
+		template <typename T>
+		void Append(vector<uint8_t>& output, const T& value)
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+			output.insert(output.end(), bytes, bytes + sizeof(T));
+		}
+	}
+
+	const uint32_t AssetArchive::Alignment = 64;
+
+	AssetArchive::AssetArchive(const string& path) :
+		mPath(path), mFile(path)
+	{
+		ArchiveHeader header;
+		if (mFile.Size() < sizeof(header))
+		{
+			throw runtime_error(path + " is too small to be an asset archive.");
+		}
+		memcpy(&header, mFile.Data(), sizeof(header));
+		if (memcmp(header.Magic, Magic, sizeof(Magic)) != 0 || header.Version != Version)
+		{
+			throw runtime_error(path + " is not a version " + to_string(Version) + " asset archive.");
+		}
+
+		size_t size = mFile.Size();
+		if (header.TableOffset > size || (size - header.TableOffset) / sizeof(TableEntry) < header.EntryCount || header.NamesOffset > size)
+		{
+			throw runtime_error(path + " has a corrupt table of contents.");
+		}
+
+		mEntries.reserve(header.EntryCount);
+		for (uint32_t i = 0; i < header.EntryCount; ++i)
+		{
+			TableEntry tableEntry;
+			memcpy(&tableEntry, mFile.Data() + header.TableOffset + i * sizeof(TableEntry), sizeof(tableEntry));
+			if (tableEntry.Offset > size || tableEntry.Size > size - tableEntry.Offset ||
+				tableEntry.NameOffset > size - header.NamesOffset || tableEntry.NameSize > size - header.NamesOffset - tableEntry.NameOffset)
+			{
+				throw runtime_error(path + " has an entry outside the file.");
+			}
+
+			Entry entry;
+			entry.Name.assign(reinterpret_cast<const char*>(mFile.Data() + header.NamesOffset + tableEntry.NameOffset), tableEntry.NameSize);
+			entry.Type = static_cast<AssetType>(tableEntry.Type);
+			entry.Data = mFile.Data() + tableEntry.Offset;
+			entry.Size = static_cast<size_t>(tableEntry.Size);
+			mEntries.push_back(move(entry));
+		}
+
+		if (!is_sorted(mEntries.begin(), mEntries.end(), [](const Entry& left, const Entry& right) { return left.Name < right.Name; }))
+		{
+			throw runtime_error(path + " has an unsorted table of contents.");
+		}
+	}
+
+	const string& AssetArchive::Path() const
+	{
+		return mPath;
+	}
+
+	const vector<AssetArchive::Entry>& AssetArchive::Entries() const
+	{
+		return mEntries;
+	}
+
+	const AssetArchive::Entry* AssetArchive::Find(const string& name) const
+	{
+		auto entry = lower_bound(mEntries.begin(), mEntries.end(), name, [](const Entry& left, const string& right) { return left.Name < right; });
+		return (entry != mEntries.end() && entry->Name == name ? &*entry : nullptr);
+	}
+
+	const AssetArchive::Entry& AssetArchive::Get(const string& name, AssetType type) const
+	{
+		const Entry* entry = Find(name);
+		if (entry == nullptr || entry->Type != type)
+		{
+			throw runtime_error("The asset archive has no " + name + " of the expected type.");
+		}
+		return *entry;
+	}
+
+	AssetArchive::TextureView AssetArchive::GetTexture(const string& name) const
+	{
+		const Entry& entry = Get(name, AssetType::Texture);
+
+		TextureHeader header;
+		if (entry.Size < sizeof(header))
+		{
+			throw runtime_error(name + " is a truncated texture.");
+		}
+		memcpy(&header, entry.Data, sizeof(header));
+		if ((entry.Size - sizeof(header)) / 4 / max(header.Width, 1u) < header.Height)
+		{
+			throw runtime_error(name + " is a truncated texture.");
+		}
+
+		TextureView texture;
+		texture.Width = header.Width;
+		texture.Height = header.Height;
+		texture.Pixels = reinterpret_cast<const uint32_t*>(entry.Data + sizeof(header));
+		return texture;
+	}
+
+	AssetArchive::SoundView AssetArchive::GetSound(const string& name) const
+	{
+		const Entry& entry = Get(name, AssetType::Sound);
+
+		SoundHeader header;
+		if (entry.Size < sizeof(header))
+		{
+			throw runtime_error(name + " is a truncated sound.");
+		}
+		memcpy(&header, entry.Data, sizeof(header));
+		if (header.FormatSize > entry.Size - sizeof(header) || header.SamplesOffset > entry.Size || header.SamplesSize > entry.Size - header.SamplesOffset)
+		{
+			throw runtime_error(name + " is a truncated sound.");
+		}
+
+		SoundView sound;
+		sound.Format = entry.Data + sizeof(header);
+		sound.FormatSize = header.FormatSize;
+		sound.Samples = entry.Data + header.SamplesOffset;
+		sound.SamplesSize = header.SamplesSize;
+		return sound;
+	}
+
+	vector<uint8_t> AssetArchive::TexturePayload(const Image& image)
+	{
+		TextureHeader header = { };
+		header.Width = image.Width;
+		header.Height = image.Height;
+
+		vector<uint8_t> payload(sizeof(header) + image.Pixels.size() * sizeof(uint32_t));
+		memcpy(payload.data(), &header, sizeof(header));
+		memcpy(payload.data() + sizeof(header), image.Pixels.data(), image.Pixels.size() * sizeof(uint32_t));
+		return payload;
+	}
+
+	vector<uint8_t> AssetArchive::SoundPayload(const uint8_t* format, size_t formatSize, const uint8_t* samples, size_t samplesSize)
+	{
+		// the samples start on a 16-byte boundary so they can be read with aligned loads
+		SoundHeader header = { };
+		header.FormatSize = static_cast<uint32_t>(formatSize);
+		header.SamplesOffset = static_cast<uint32_t>((sizeof(header) + formatSize + 15) / 16 * 16);
+		header.SamplesSize = static_cast<uint32_t>(samplesSize);
+
+		vector<uint8_t> payload(header.SamplesOffset + samplesSize, 0);
+		memcpy(payload.data(), &header, sizeof(header));
+		memcpy(payload.data() + sizeof(header), format, formatSize);
+		memcpy(payload.data() + header.SamplesOffset, samples, samplesSize);
+		return payload;
+	}
+
+	void AssetArchiveWriter::Add(const string& name, AssetType type, vector<uint8_t> payload)
+	{
+		PendingEntry entry;
+		entry.Name = name;
+		entry.Type = type;
+		entry.Payload = move(payload);
+		mEntries.push_back(move(entry));
+	}
+
+	void AssetArchiveWriter::Write(const string& path) const
+	{
+		vector<const PendingEntry*> sorted;
+		for (const PendingEntry& entry : mEntries)
+		{
+			sorted.push_back(&entry);
+		}
+		sort(sorted.begin(), sorted.end(), [](const PendingEntry* left, const PendingEntry* right) { return left->Name < right->Name; });
+
+		vector<uint8_t> output(sizeof(ArchiveHeader), 0);
+		vector<TableEntry> table;
+		string names;
+		for (const PendingEntry* entry : sorted)
+		{
+			PadTo(output, AssetArchive::Alignment);
+
+			TableEntry tableEntry;
+			tableEntry.Type = static_cast<uint32_t>(entry->Type);
+			tableEntry.NameOffset = static_cast<uint32_t>(names.size());
+			tableEntry.NameSize = static_cast<uint32_t>(entry->Name.size());
+			tableEntry.Reserved = 0;
+			tableEntry.Offset = output.size();
+			tableEntry.Size = entry->Payload.size();
+			table.push_back(tableEntry);
+
+			names += entry->Name;
+			output.insert(output.end(), entry->Payload.begin(), entry->Payload.end());
+		}
+
+		PadTo(output, AssetArchive::Alignment);
+		ArchiveHeader header;
+		memcpy(header.Magic, Magic, sizeof(Magic));
+		header.Version = Version;
+		header.EntryCount = static_cast<uint32_t>(table.size());
+		header.Alignment = AssetArchive::Alignment;
+		header.TableOffset = output.size();
+		for (const TableEntry& tableEntry : table)
+		{
+			Append(output, tableEntry);
+		}
+		header.NamesOffset = output.size();
+		output.insert(output.end(), names.begin(), names.end());
+		memcpy(output.data(), &header, sizeof(header));
+
+		ofstream file(path, ios::binary);
+		file.write(reinterpret_cast<const char*>(output.data()), static_cast<streamsize>(output.size()));
+		if (!file.good())
+		{
+			throw runtime_error("Couldn't write " + path + ".");
+		}
+	}
+}
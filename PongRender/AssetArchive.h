@@ -0,0 +1,113 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "Image.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	enum class AssetType : uint32_t
+	{
+		Raw = 0,
+		Texture = 1,
+		Font = 2,
+		Sound = 3,
+	};
+
+	// A Texture payload is this header followed by Width * Height RGBA pixels.
+	struct TextureHeader final
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t Reserved[2];
+	};
+
+	// A Sound payload is this header, the WAVEFORMATEX bytes, then the samples at SamplesOffset.
+	// Font payloads are .spritefont files whose texture is already expanded to R8G8B8A8.
+	struct SoundHeader final
+	{
+		uint32_t FormatSize;
+		uint32_t SamplesOffset;
+		uint32_t SamplesSize;
+		uint32_t Reserved;
+	};
+
+	// One file holding every asset, already decoded, with each payload aligned so it can be handed
+	// straight to the GPU or the audio engine from the mapping. Layout: a header, the payloads, a
+	// table of contents sorted by name, then the names.
+	class AssetArchive final
+	{
+	public:
+		static const uint32_t Alignment;
+
+		struct Entry final
+		{
+			std::string Name;
+			AssetType Type;
+			const uint8_t* Data;
+			size_t Size;
+		};
+
+		// a Texture payload's pixels, still in the mapping
+		struct TextureView final
+		{
+			uint32_t Width;
+			uint32_t Height;
+			const uint32_t* Pixels;
+		};
+
+		// a Sound payload's WAVEFORMATEX and samples, still in the mapping
+		struct SoundView final
+		{
+			const uint8_t* Format;
+			size_t FormatSize;
+			const uint8_t* Samples;
+			size_t SamplesSize;
+		};
+
+		explicit AssetArchive(const std::string& path);
+
+		AssetArchive(const AssetArchive&) = delete;
+		AssetArchive& operator=(const AssetArchive&) = delete;
+
+		const std::string& Path() const;
+		const std::vector<Entry>& Entries() const;
+
+		// nullptr when there's no such asset
+		const Entry* Find(const std::string& name) const;
+
+		// throws std::runtime_error when the asset is missing or of another type
+		const Entry& Get(const std::string& name, AssetType type) const;
+		TextureView GetTexture(const std::string& name) const;
+		SoundView GetSound(const std::string& name) const;
+
+		// the payloads PongPack writes for decoded assets
+		static std::vector<uint8_t> TexturePayload(const Image& image);
+		static std::vector<uint8_t> SoundPayload(const uint8_t* format, size_t formatSize, const uint8_t* samples, size_t samplesSize);
+
+	private:
+		std::string mPath;
+		MappedFile mFile;
+		std::vector<Entry> mEntries;
+	};
+
+	class AssetArchiveWriter final
+	{
+	public:
+		void Add(const std::string& name, AssetType type, std::vector<uint8_t> payload);
+		void Write(const std::string& path) const;
+
+	private:
+		struct PendingEntry final
+		{
+			std::string Name;
+			AssetType Type;
+			std::vector<uint8_t> Payload;
+		};
+
+		std::vector<PendingEntry> mEntries;
+	};
+}
@@ -0,0 +1,281 @@
+#include "pch.h"
+#include "BitmapFont.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const char Magic[8] = { 'D', 'X', 'T', 'K', 'f', 'o', 'n', 't' };
+
+		// the DXGI_FORMAT values MakeSpriteFont writes
+		const uint32_t FormatR8G8B8A8 = 28;
+		const uint32_t FormatBC2 = 74;
+		const uint32_t FormatB8G8R8A8 = 87;
+
+		class Reader final
+		{
+		public:
+			Reader(const uint8_t* data, size_t size) : mData(data), mSize(size), mPosition(0) { }
+
+			const uint8_t* Bytes(size_t count)
+			{
+				if (mSize - mPosition < count)
+				{
+					throw runtime_error("Truncated sprite font.");
+				}
+				const uint8_t* bytes = mData + mPosition;
+				mPosition += count;
+				return bytes;
+			}
+
+			template <typename T>
+			T Read()
+			{
+				T value;
+				memcpy(&value, Bytes(sizeof(T)), sizeof(T));
+				return value;
+			}
+
+		private:
+			const uint8_t* mData;
+			size_t mSize;
+			size_t mPosition;
+		};
+
+		template <typename T>
+		void Write(vector<uint8_t>& output, const T& value)
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+			output.insert(output.end(), bytes, bytes + sizeof(T));
+		}
+
+		uint32_t Expand565(uint16_t color)
+		{
+			uint32_t r = (color >> 11) & 0x1F;
+			uint32_t g = (color >> 5) & 0x3F;
+			uint32_t b = color & 0x1F;
+			return ((r << 3) | (r >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((b << 3) | (b >> 2)) << 16);
+		}
+
+		uint32_t Mix(uint32_t major, uint32_t minor)
+		{
+			uint32_t mixed = 0;
+			for (uint32_t shift = 0; shift < 24; shift += 8)
+			{
+				mixed |= ((((major >> shift) & 0xFF) * 2 + ((minor >> shift) & 0xFF)) / 3) << shift;
+			}
+			return mixed;
+		}
+
+		// BC2: 64 bits of explicit 4-bit alpha, then a BC1 colour block always in four-colour mode
+		void DecodeBC2(const uint8_t* data, uint32_t stride, Image& image)
+		{
+			for (uint32_t blockY = 0; blockY < (image.Height + 3) / 4; ++blockY)
+			{
+				const uint8_t* block = data + static_cast<size_t>(blockY) * stride;
+				for (uint32_t blockX = 0; blockX < (image.Width + 3) / 4; ++blockX, block += 16)
+				{
+					uint64_t alpha;
+					memcpy(&alpha, block, sizeof(alpha));
+					uint16_t color0;
+					uint16_t color1;
+					uint32_t indices;
+					memcpy(&color0, block + 8, sizeof(color0));
+					memcpy(&color1, block + 10, sizeof(color1));
+					memcpy(&indices, block + 12, sizeof(indices));
+
+					uint32_t palette[4];
+					palette[0] = Expand565(color0);
+					palette[1] = Expand565(color1);
+					palette[2] = Mix(palette[0], palette[1]);
+					palette[3] = Mix(palette[1], palette[0]);
+
+					for (uint32_t i = 0; i < 16; ++i)
+					{
+						uint32_t x = blockX * 4 + i % 4;
+						uint32_t y = blockY * 4 + i / 4;
+						if (x < image.Width && y < image.Height)
+						{
+							uint32_t a = static_cast<uint32_t>((alpha >> (i * 4)) & 0xF) * 17;
+							image.Row(y)[x] = palette[(indices >> (i * 2)) & 3] | (a << 24);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	BitmapFont::BitmapFont(const string& path)
+	{
+		ifstream file(path, ios::binary);
+		if (!file.good())
+		{
+			throw runtime_error("Couldn't open " + path + ".");
+		}
+		vector<uint8_t> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+		Parse(data.data(), data.size(), path);
+	}
+
+	BitmapFont::BitmapFont(const uint8_t* data, size_t size, const string& name)
+	{
+		Parse(data, size, name);
+	}
+
+	vector<uint8_t> BitmapFont::Serialize() const
+	{
+		vector<uint8_t> output(Magic, Magic + sizeof(Magic));
+		Write(output, static_cast<uint32_t>(mGlyphs.size()));
+		for (const Glyph& glyph : mGlyphs)
+		{
+			Write(output, glyph.Character);
+			Write(output, glyph.Left);
+			Write(output, glyph.Top);
+			Write(output, glyph.Right);
+			Write(output, glyph.Bottom);
+			Write(output, glyph.XOffset);
+			Write(output, glyph.YOffset);
+			Write(output, glyph.XAdvance);
+		}
+		Write(output, mLineSpacing);
+		Write(output, mDefaultCharacter);
+
+		Write(output, mTexture.Width);
+		Write(output, mTexture.Height);
+		Write(output, FormatR8G8B8A8);
+		Write(output, mTexture.Width * 4);
+		Write(output, mTexture.Height);
+		const uint8_t* pixels = reinterpret_cast<const uint8_t*>(mTexture.Pixels.data());
+		output.insert(output.end(), pixels, pixels + mTexture.Pixels.size() * sizeof(uint32_t));
+		return output;
+	}
+
+	void BitmapFont::Parse(const uint8_t* data, size_t size, const string& name)
+	{
+		Reader reader(data, size);
+		if (memcmp(reader.Bytes(sizeof(Magic)), Magic, sizeof(Magic)) != 0)
+		{
+			throw runtime_error(name + " is not a sprite font.");
+		}
+
+		uint32_t glyphCount = reader.Read<uint32_t>();
+		mGlyphs.resize(glyphCount);
+		for (Glyph& glyph : mGlyphs)
+		{
+			glyph.Character = reader.Read<uint32_t>();
+			glyph.Left = reader.Read<int32_t>();
+			glyph.Top = reader.Read<int32_t>();
+			glyph.Right = reader.Read<int32_t>();
+			glyph.Bottom = reader.Read<int32_t>();
+			glyph.XOffset = reader.Read<float>();
+			glyph.YOffset = reader.Read<float>();
+			glyph.XAdvance = reader.Read<float>();
+		}
+		if (!is_sorted(mGlyphs.begin(), mGlyphs.end(), [](const Glyph& left, const Glyph& right) { return left.Character < right.Character; }))
+		{
+			throw runtime_error(name + " has unsorted glyphs.");
+		}
+
+		mLineSpacing = reader.Read<float>();
+		mDefaultCharacter = reader.Read<uint32_t>();
+
+		uint32_t width = reader.Read<uint32_t>();
+		uint32_t height = reader.Read<uint32_t>();
+		uint32_t format = reader.Read<uint32_t>();
+		uint32_t stride = reader.Read<uint32_t>();
+		uint32_t rows = reader.Read<uint32_t>();
+		const uint8_t* pixels = reader.Bytes(static_cast<size_t>(stride) * rows);
+
+		mTexture = Image(width, height);
+		if (format == FormatBC2)
+		{
+			if (rows < (height + 3) / 4 || stride < (width + 3) / 4 * 16)
+			{
+				throw runtime_error(name + " has a truncated texture.");
+			}
+			DecodeBC2(pixels, stride, mTexture);
+		}
+		else if (format == FormatR8G8B8A8 || format == FormatB8G8R8A8)
+		{
+			if (rows < height || stride < width * 4)
+			{
+				throw runtime_error(name + " has a truncated texture.");
+			}
+			for (uint32_t y = 0; y < height; ++y)
+			{
+				memcpy(mTexture.Row(y), pixels + static_cast<size_t>(y) * stride, width * 4);
+				if (format == FormatB8G8R8A8)
+				{
+					for (uint32_t x = 0; x < width; ++x)
+					{
+						uint32_t pixel = mTexture.Row(y)[x];
+						mTexture.Row(y)[x] = (pixel & 0xFF00FF00) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16);
+					}
+				}
+			}
+		}
+		else
+		{
+			throw runtime_error(name + " uses an unsupported texture format.");
+		}
+
+		for (const Glyph& glyph : mGlyphs)
+		{
+			if (glyph.Left < 0 || glyph.Top < 0 || glyph.Right < glyph.Left || glyph.Bottom < glyph.Top ||
+				static_cast<uint32_t>(glyph.Right) > width || static_cast<uint32_t>(glyph.Bottom) > height)
+			{
+				throw runtime_error(name + " has a glyph outside its texture.");
+			}
+		}
+	}
+
+	const Image& BitmapFont::Texture() const
+	{
+		return mTexture;
+	}
+
+	float BitmapFont::LineSpacing() const
+	{
+		return mLineSpacing;
+	}
+
+	const BitmapFont::Glyph& BitmapFont::FindGlyph(wchar_t character) const
+	{
+		auto compare = [](const Glyph& glyph, uint32_t value) { return glyph.Character < value; };
+
+		auto glyph = lower_bound(mGlyphs.begin(), mGlyphs.end(), static_cast<uint32_t>(character), compare);
+		if (glyph != mGlyphs.end() && glyph->Character == static_cast<uint32_t>(character))
+		{
+			return *glyph;
+		}
+
+		if (mDefaultCharacter != 0)
+		{
+			glyph = lower_bound(mGlyphs.begin(), mGlyphs.end(), mDefaultCharacter, compare);
+			if (glyph != mGlyphs.end() && glyph->Character == mDefaultCharacter)
+			{
+				return *glyph;
+			}
+		}
+
+		throw out_of_range("Character not in sprite font.");
+	}
+
+	Vector2 BitmapFont::MeasureString(const wchar_t* text) const
+	{
+		// the same extents DirectX::SpriteFont::MeasureString reports
+		Vector2 size;
+		ForEachGlyph(text, [this, &size](const Glyph& glyph, float x, float y)
+		{
+			float width = static_cast<float>(glyph.Right - glyph.Left);
+			float height = static_cast<float>(glyph.Bottom - glyph.Top) + glyph.YOffset;
+			height = (iswspace(static_cast<wint_t>(glyph.Character)) ? mLineSpacing : max(height, mLineSpacing));
+
+			size.X = max(size.X, x + width);
+			size.Y = max(size.Y, y + height);
+		});
+
+		return size;
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Image.h"
+#include "Vector2.h"
+#include <algorithm>
+#include <cstdint>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	// A DirectXTK .spritefont file, as MakeSpriteFont writes it: glyph rectangles and bearings plus
+	// one texture holding every glyph. The texture is decoded to RGBA once at load.
+	class BitmapFont final
+	{
+	public:
+		struct Glyph final
+		{
+			uint32_t Character;
+			int32_t Left;
+			int32_t Top;
+			int32_t Right;
+			int32_t Bottom;
+			float XOffset;
+			float YOffset;
+			float XAdvance;
+		};
+
+		explicit BitmapFont(const std::string& path);
+
+		// a .spritefont already in memory; name is only used in error messages
+		BitmapFont(const uint8_t* data, size_t size, const std::string& name);
+
+		// the same font as a .spritefont with an uncompressed R8G8B8A8 texture, which both backends
+		// can use without decoding anything
+		std::vector<uint8_t> Serialize() const;
+
+		const Image& Texture() const;
+		float LineSpacing() const;
+
+		const Glyph& FindGlyph(wchar_t character) const;
+		Vector2 MeasureString(const wchar_t* text) const;
+
+		// calls action(glyph, x, y) for every visible glyph, with the same spacing rules as
+		// DirectX::SpriteFont so both backends put text in the same place
+		template <typename Action>
+		void ForEachGlyph(const wchar_t* text, Action action) const;
+
+	private:
+		void Parse(const uint8_t* data, size_t size, const std::string& name);
+
+		std::vector<Glyph> mGlyphs;
+		float mLineSpacing;
+		uint32_t mDefaultCharacter;
+		Image mTexture;
+	};
+
+	template <typename Action>
+	void BitmapFont::ForEachGlyph(const wchar_t* text, Action action) const
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		for (const wchar_t* character = text; *character != L'\0'; ++character)
+		{
+			if (*character == L'\r')
+			{
+				continue;
+			}
+			if (*character == L'\n')
+			{
+				x = 0.0f;
+				y += mLineSpacing;
+				continue;
+			}
+
+			const Glyph& glyph = FindGlyph(*character);
+			x = std::max(x + glyph.XOffset, 0.0f);
+
+			int32_t width = glyph.Right - glyph.Left;
+			int32_t height = glyph.Bottom - glyph.Top;
+			if (!std::iswspace(static_cast<std::wint_t>(*character)) || width > 1 || height > 1)
+			{
+				action(glyph, x, y);
+			}
+			x += width + glyph.XAdvance;
+		}
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace Pong
+{
+	// Straight RGBA with each channel in [0, 1], the same as the tints SpriteBatch takes.
+	struct Color final
+	{
+		float R;
+		float G;
+		float B;
+		float A;
+
+		Color() : R(0.0f), G(0.0f), B(0.0f), A(0.0f) { }
+		Color(float r, float g, float b, float a) : R(r), G(g), B(b), A(a) { }
+
+		static Color White() { return Color(1.0f, 1.0f, 1.0f, 1.0f); }
+	};
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Pong
+{
+	// Decoded assets keyed by path. Each path is loaded once and shared for as long as anyone holds
+	// a handle; when the last handle goes the asset is freed and the next Load reads it again.
+	template <typename T>
+	class ContentCache final
+	{
+	public:
+		ContentCache() = default;
+		ContentCache(const ContentCache&) = delete;
+		ContentCache& operator=(const ContentCache&) = delete;
+
+		// load(path) runs at most once per path while the asset is alive, even with several threads
+		// asking; it runs outside the cache's lock, so different paths decode in parallel and a second
+		// caller for the same path waits for the first. If load throws, every waiting caller gets the
+		// exception and the next Load tries again.
+		template <typename Loader>
+		std::shared_ptr<const T> Load(const std::string& path, Loader load);
+
+		// paths with an asset still alive or being loaded
+		size_t Size() const;
+
+	private:
+		struct Entry final
+		{
+			std::weak_ptr<const T> Asset;
+			std::shared_future<std::shared_ptr<const T>> Pending; // valid while a Load is decoding it
+		};
+
+		mutable std::mutex mMutex;
+		mutable std::map<std::string, Entry> mEntries;
+	};
+
+	template <typename T>
+	template <typename Loader>
+	std::shared_ptr<const T> ContentCache<T>::Load(const std::string& path, Loader load)
+	{
+		std::promise<std::shared_ptr<const T>> loaded;
+		std::shared_future<std::shared_ptr<const T>> pending;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			Entry& entry = mEntries[path];
+			std::shared_ptr<const T> asset = entry.Asset.lock();
+			if (asset != nullptr)
+			{
+				return asset;
+			}
+			if (entry.Pending.valid())
+			{
+				pending = entry.Pending;
+			}
+			else
+			{
+				entry.Pending = loaded.get_future().share();
+			}
+		}
+
+		// someone else is decoding it
+		if (pending.valid())
+		{
+			return pending.get();
+		}
+
+		std::shared_ptr<const T> asset;
+		try
+		{
+			asset = std::make_shared<const T>(load(path));
+		}
+		catch (...)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mEntries[path].Pending = std::shared_future<std::shared_ptr<const T>>();
+			}
+			loaded.set_exception(std::current_exception());
+			throw;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			Entry& entry = mEntries[path];
+			entry.Asset = asset;
+			entry.Pending = std::shared_future<std::shared_ptr<const T>>();
+		}
+		loaded.set_value(asset);
+
+		return asset;
+	}
+
+	template <typename T>
+	size_t ContentCache<T>::Size() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		for (auto entry = mEntries.begin(); entry != mEntries.end();)
+		{
+			bool dead = (entry->second.Asset.expired() && !entry->second.Pending.valid());
+			entry = (dead ? mEntries.erase(entry) : std::next(entry));
+		}
+		return mEntries.size();
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Pong
+{
+	// 8-bit RGBA pixels, rows top to bottom with no padding. Each pixel is one uint32_t with red in
+	// the lowest byte, which is the byte order PNG and R8G8B8A8 textures use on little-endian targets.
+	struct Image final
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<uint32_t> Pixels;
+
+		Image() = default;
+		Image(uint32_t width, uint32_t height) : Width(width), Height(height), Pixels(static_cast<size_t>(width) * height) { }
+
+		uint32_t* Row(uint32_t y) { return Pixels.data() + static_cast<size_t>(y) * Width; }
+		const uint32_t* Row(uint32_t y) const { return Pixels.data() + static_cast<size_t>(y) * Width; }
+	};
+}
@@ -0,0 +1,202 @@
+#include "pch.h"
+#include "MatchScene.h"
+#include "AssetArchive.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const wchar_t GameOverText[] = L"Game Over!";
+		const wchar_t PongText[] = L"PONG";
+		const wchar_t DirectionsText[] = L"Press SPACEBAR to play";
+
+		// relative to the Content directory, which is also how PongPack names them
+		const char BallTexturePath[] = "Textures/Ball.png";
+		const char PaddleTexturePath[] = "Textures/Paddle.png";
+		const char FontPath[] = "Fonts/Arial_36_Regular.spritefont";
+		const char SmallFontPath[] = "Fonts/Arial_14_Regular.spritefont";
+	}
+
+	MatchScene::MatchScene(Renderer& renderer, const string& contentDirectory) :
+		MatchScene(renderer,
+			renderer.LoadTexture(contentDirectory + "/" + BallTexturePath),
+			renderer.LoadTexture(contentDirectory + "/" + PaddleTexturePath),
+			renderer.LoadFont(contentDirectory + "/" + FontPath),
+			renderer.LoadFont(contentDirectory + "/" + SmallFontPath))
+	{
+	}
+
+	MatchScene::MatchScene(Renderer& renderer, const AssetArchive& archive) :
+		MatchScene(renderer,
+			renderer.LoadTexture(archive, BallTexturePath),
+			renderer.LoadTexture(archive, PaddleTexturePath),
+			renderer.LoadFont(archive, FontPath),
+			renderer.LoadFont(archive, SmallFontPath))
+	{
+	}
+
+	MatchScene::MatchScene(Renderer& renderer, Renderer::TextureId ballTexture, Renderer::TextureId paddleTexture, Renderer::FontId font, Renderer::FontId smallFont) :
+		mRenderer(&renderer), mBallTexture(ballTexture), mPaddleTexture(paddleTexture), mFont(font), mSmallFont(smallFont), mLayout(renderer)
+	{
+		// the logo and game over text sit a line above the center, the directions just under the game over text
+		TextLayout::Element gameOverText;
+		gameOverText.Font = mFont;
+		gameOverText.Text = GameOverText;
+		gameOverText.Pivot = Vector2(0.5f, 1.5f);
+		mGameOverTextId = mLayout.Add(gameOverText);
+
+		TextLayout::Element pongText = gameOverText;
+		pongText.Text = PongText;
+		mPongTextId = mLayout.Add(pongText);
+
+		TextLayout::Element directionsText;
+		directionsText.Font = mSmallFont;
+		directionsText.Text = DirectionsText;
+		directionsText.Pivot = Vector2(0.5f, 1.5f);
+		directionsText.StackedOn = mGameOverTextId;
+		directionsText.Spacing = 1.05f;
+		mDirectionsTextId = mLayout.Add(directionsText);
+	}
+
+	Vector2 MatchScene::BallSize() const
+	{
+		return mRenderer->TextureSize(mBallTexture);
+	}
+
+	Vector2 MatchScene::PaddleSize() const
+	{
+		return mRenderer->TextureSize(mPaddleTexture);
+	}
+
+	Renderer::FontId MatchScene::SmallFont() const
+	{
+		return mSmallFont;
+	}
+
+	Color MatchScene::BallTint(float colorModifier)
+	{
+		float r = colorModifier + 0.5f;
+		float g = colorModifier;
+		float b = colorModifier - 0.5f;
+
+		if (r > 1.0f) r -= 1;
+		if (g > 1.0f) g -= 1;
+		if (b > 1.0f) b -= 1;
+
+		return Color(r, g, b, 1.0f);
+	}
+
+	void MatchScene::DrawBall(const BallState& previousState, const BallState& state, float alpha, const Color& tint)
+	{
+		// draw between the last two simulation steps so motion stays smooth at any refresh rate
+		Rect bounds = Rect::Lerp(previousState.Bounds, state.Bounds, alpha);
+		mRenderer->DrawTexture(mBallTexture, Vector2(bounds.X, bounds.Y), tint);
+	}
+
+	void MatchScene::DrawPaddle(const PaddleState& previousState, const PaddleState& state, float alpha)
+	{
+		Rect bounds = Rect::Lerp(previousState.Bounds, state.Bounds, alpha);
+		mRenderer->DrawTexture(mPaddleTexture, Vector2(bounds.X, bounds.Y), Color::White());
+	}
+
+	void MatchScene::UpdateHud(const MatchState& match, float viewportWidth, float viewportHeight)
+	{
+		mLayout.Update(viewportWidth, viewportHeight);
+
+		if (match.Gamestate == Gamestate::Playing)
+		{
+			bool viewportChanged = (viewportWidth != mScoreViewportSize.X || viewportHeight != mScoreViewportSize.Y);
+			mScoreViewportSize = Vector2(viewportWidth, viewportHeight);
+
+			UpdateScoreText(mPlayer1ScoreText, match.Player1Score, -150.0f, viewportChanged);
+			UpdateScoreText(mPlayer2ScoreText, match.Player2Score, 150.0f, viewportChanged);
+		}
+	}
+
+	void MatchScene::DrawHud(const MatchState& match)
+	{
+		if (match.Gamestate == Gamestate::Initial)
+		{
+			mLayout.Draw(mPongTextId);
+			mLayout.Draw(mDirectionsTextId);
+		}
+		else if (match.Gamestate == Gamestate::Playing)
+		{
+			mRenderer->DrawString(mFont, mPlayer1ScoreText.Text, mPlayer1ScoreText.Position);
+			mRenderer->DrawString(mFont, mPlayer2ScoreText.Text, mPlayer2ScoreText.Position);
+		}
+		else if (match.Gamestate == Gamestate::Gameover)
+		{
+			mLayout.Draw(mGameOverTextId);
+			mLayout.Draw(mDirectionsTextId);
+		}
+	}
+
+	void MatchScene::Draw(const MatchState& previousMatch, const MatchState& match, float alpha, const Color& ballTint, float viewportWidth, float viewportHeight)
+	{
+		// the same order the game's components draw in
+		DrawBall(previousMatch.Ball, match.Ball, alpha, ballTint);
+		DrawPaddle(previousMatch.Paddle1, match.Paddle1, alpha);
+		DrawPaddle(previousMatch.Paddle2, match.Paddle2, alpha);
+
+		UpdateHud(match, viewportWidth, viewportHeight);
+		DrawHud(match);
+	}
+
+	void MatchScene::DrawChaos(const ChaosMatch& match, float alpha, float colorModifier)
+	{
+		const float* previousX = match.PreviousBallX();
+		const float* previousY = match.PreviousBallY();
+		const float* x = match.BallX();
+		const float* y = match.BallY();
+		for (size_t i = 0; i < match.BallCount(); ++i)
+		{
+			// the golden ratio spreads neighbouring balls' colours around the cycle
+			float modifier = colorModifier + 0.618034f * static_cast<float>(i % 1024);
+			Color tint = BallTint(modifier - floor(modifier));
+			mRenderer->DrawTexture(mBallTexture, Vector2(previousX[i] + (x[i] - previousX[i]) * alpha, previousY[i] + (y[i] - previousY[i]) * alpha), tint);
+		}
+
+		const float* paddleX = match.PaddleX();
+		const float* previousPaddleY = match.PreviousPaddleY();
+		const float* paddleY = match.PaddleY();
+		for (size_t i = 0; i < match.PaddleCount(); ++i)
+		{
+			mRenderer->DrawTexture(mPaddleTexture, Vector2(paddleX[i], previousPaddleY[i] + (paddleY[i] - previousPaddleY[i]) * alpha), Color::White());
+		}
+	}
+
+	void MatchScene::UpdateScoreText(ScoreText& scoreText, int32_t score, float offset, bool viewportChanged)
+	{
+		if (score == scoreText.Score && !viewportChanged)
+		{
+			return;
+		}
+
+		if (score != scoreText.Score)
+		{
+			// written backwards into the fixed buffer so play never touches the heap for text
+			wchar_t digits[ScoreText::Capacity];
+			size_t count = 0;
+			uint32_t remaining = static_cast<uint32_t>(max(score, 0));
+			do
+			{
+				digits[count++] = static_cast<wchar_t>(L'0' + remaining % 10);
+				remaining /= 10;
+			} while (remaining != 0);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				scoreText.Text[i] = digits[count - 1 - i];
+			}
+			scoreText.Text[count] = L'\0';
+			scoreText.Score = score;
+		}
+
+		Vector2 messageSize = mRenderer->MeasureString(mFont, scoreText.Text);
+		scoreText.Position.X = (mScoreViewportSize.X - messageSize.X) / 2 + offset;
+		scoreText.Position.Y = 50;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ChaosMatch.h"
+#include "MatchState.h"
+#include "Renderer.h"
+#include "TextLayout.h"
+#include <string>
+
+namespace Pong
+{
+	class AssetArchive;
+
+	// Draws a match through any Renderer: the ball, the paddles and the text over them. The game
+	// draws the sprites from its components and the text itself; headless tools call Draw.
+	class MatchScene final
+	{
+	public:
+		// loads the textures and fonts from the game's Content directory
+		MatchScene(Renderer& renderer, const std::string& contentDirectory);
+
+		// the same assets from an archive PongPack made of the Content directory
+		MatchScene(Renderer& renderer, const AssetArchive& archive);
+
+		MatchScene(const MatchScene&) = delete;
+		MatchScene& operator=(const MatchScene&) = delete;
+
+		Vector2 BallSize() const;
+		Vector2 PaddleSize() const;
+		Renderer::FontId SmallFont() const;
+
+		// the ball's colour cycle, from a modifier that wraps after passing 1
+		static Color BallTint(float colorModifier);
+
+		void DrawBall(const BallState& previousState, const BallState& state, float alpha, const Color& tint);
+		void DrawPaddle(const PaddleState& previousState, const PaddleState& state, float alpha);
+
+		// only re-measures when a score or the viewport has changed, so it never allocates during play
+		void UpdateHud(const MatchState& match, float viewportWidth, float viewportHeight);
+		void DrawHud(const MatchState& match);
+
+		void Draw(const MatchState& previousMatch, const MatchState& match, float alpha, const Color& ballTint, float viewportWidth, float viewportHeight);
+
+		// every ball and paddle of a multi-ball match, each ball a step along the colour cycle
+		void DrawChaos(const ChaosMatch& match, float alpha, float colorModifier);
+
+	private:
+		MatchScene(Renderer& renderer, Renderer::TextureId ballTexture, Renderer::TextureId paddleTexture, Renderer::FontId font, Renderer::FontId smallFont);
+
+		// a score's digits and where they're drawn
+		struct ScoreText final
+		{
+			static const size_t Capacity = 12;
+
+			wchar_t Text[Capacity] = { };
+			int32_t Score = -1;
+			Vector2 Position;
+		};
+
+		void UpdateScoreText(ScoreText& scoreText, int32_t score, float offset, bool viewportChanged);
+
+		Renderer* mRenderer;
+		Renderer::TextureId mBallTexture;
+		Renderer::TextureId mPaddleTexture;
+		Renderer::FontId mFont;
+		Renderer::FontId mSmallFont;
+
+		TextLayout mLayout;
+		TextLayout::ElementId mGameOverTextId;
+		TextLayout::ElementId mPongTextId;
+		TextLayout::ElementId mDirectionsTextId;
+
+		ScoreText mPlayer1ScoreText;
+		ScoreText mPlayer2ScoreText;
+		Vector2 mScoreViewportSize;
+	};
+}
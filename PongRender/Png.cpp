@@ -0,0 +1,582 @@
+#include "pch.h"
+#include "Png.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+		class BitReader final
+		{
+		public:
+			BitReader(const uint8_t* data, size_t size) :
+				mData(data), mSize(size), mPosition(0), mBits(0), mBitCount(0)
+			{
+			}
+
+			uint32_t Bits(uint32_t count)
+			{
+				while (mBitCount < count)
+				{
+					if (mPosition == mSize)
+					{
+						throw runtime_error("Truncated deflate stream.");
+					}
+					mBits |= static_cast<uint32_t>(mData[mPosition++]) << mBitCount;
+					mBitCount += 8;
+				}
+
+				uint32_t value = mBits & ((1u << count) - 1);
+				mBits >>= count;
+				mBitCount -= count;
+				return value;
+			}
+
+			// stored blocks start on a byte boundary; whole bytes are only ever fetched on demand
+			void AlignToByte()
+			{
+				mBits = 0;
+				mBitCount = 0;
+			}
+
+		private:
+			const uint8_t* mData;
+			size_t mSize;
+			size_t mPosition;
+			uint32_t mBits;
+			uint32_t mBitCount;
+		};
+
+		// canonical Huffman code as counts per length plus symbols in code order
+		struct Huffman final
+		{
+			uint16_t Counts[16];
+			uint16_t Symbols[288];
+		};
+
+		void BuildHuffman(Huffman& huffman, const uint8_t* lengths, uint32_t count)
+		{
+			fill(begin(huffman.Counts), end(huffman.Counts), static_cast<uint16_t>(0));
+			for (uint32_t symbol = 0; symbol < count; ++symbol)
+			{
+				++huffman.Counts[lengths[symbol]];
+			}
+			huffman.Counts[0] = 0;
+
+			uint16_t offsets[16];
+			offsets[1] = 0;
+			for (uint32_t length = 1; length < 15; ++length)
+			{
+				offsets[length + 1] = offsets[length] + huffman.Counts[length];
+			}
+
+			for (uint32_t symbol = 0; symbol < count; ++symbol)
+			{
+				if (lengths[symbol] != 0)
+				{
+					huffman.Symbols[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+				}
+			}
+		}
+
+		uint32_t DecodeSymbol(BitReader& reader, const Huffman& huffman)
+		{
+			int32_t code = 0;
+			int32_t first = 0;
+			int32_t index = 0;
+			for (uint32_t length = 1; length < 16; ++length)
+			{
+				code |= static_cast<int32_t>(reader.Bits(1));
+				int32_t count = huffman.Counts[length];
+				if (code - first < count)
+				{
+					return huffman.Symbols[index + code - first];
+				}
+				index += count;
+				first = (first + count) << 1;
+				code <<= 1;
+			}
+
+			throw runtime_error("Invalid Huffman code in deflate stream.");
+		}
+
+		const uint16_t LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		const uint8_t LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		const uint16_t DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		const uint8_t DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		void InflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances, vector<uint8_t>& output)
+		{
+			for (;;)
+			{
+				uint32_t symbol = DecodeSymbol(reader, literals);
+				if (symbol < 256)
+				{
+					output.push_back(static_cast<uint8_t>(symbol));
+				}
+				else if (symbol == 256)
+				{
+					return;
+				}
+				else
+				{
+					symbol -= 257;
+					if (symbol >= 29)
+					{
+						throw runtime_error("Invalid length in deflate stream.");
+					}
+					uint32_t length = LengthBase[symbol] + reader.Bits(LengthExtra[symbol]);
+
+					uint32_t distanceSymbol = DecodeSymbol(reader, distances);
+					if (distanceSymbol >= 30)
+					{
+						throw runtime_error("Invalid distance in deflate stream.");
+					}
+					size_t distance = DistanceBase[distanceSymbol] + reader.Bits(DistanceExtra[distanceSymbol]);
+					if (distance > output.size())
+					{
+						throw runtime_error("Deflate distance reaches before the start of the stream.");
+					}
+
+					// byte by byte, since the copy may overlap what it's writing
+					size_t from = output.size() - distance;
+					for (uint32_t i = 0; i < length; ++i)
+					{
+						output.push_back(output[from + i]);
+					}
+				}
+			}
+		}
+
+		void ReadDynamicCodes(BitReader& reader, Huffman& literals, Huffman& distances)
+		{
+			static const uint8_t Order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+			uint32_t literalCount = reader.Bits(5) + 257;
+			uint32_t distanceCount = reader.Bits(5) + 1;
+			uint32_t codeLengthCount = reader.Bits(4) + 4;
+
+			uint8_t lengths[320] = { };
+			for (uint32_t i = 0; i < codeLengthCount; ++i)
+			{
+				lengths[Order[i]] = static_cast<uint8_t>(reader.Bits(3));
+			}
+
+			Huffman codeLengths;
+			BuildHuffman(codeLengths, lengths, 19);
+
+			uint32_t index = 0;
+			fill(begin(lengths), end(lengths), static_cast<uint8_t>(0));
+			while (index < literalCount + distanceCount)
+			{
+				uint32_t symbol = DecodeSymbol(reader, codeLengths);
+				if (symbol < 16)
+				{
+					lengths[index++] = static_cast<uint8_t>(symbol);
+					continue;
+				}
+
+				uint8_t repeated = 0;
+				uint32_t repeat;
+				if (symbol == 16)
+				{
+					if (index == 0)
+					{
+						throw runtime_error("Deflate code lengths repeat nothing.");
+					}
+					repeated = lengths[index - 1];
+					repeat = 3 + reader.Bits(2);
+				}
+				else if (symbol == 17)
+				{
+					repeat = 3 + reader.Bits(3);
+				}
+				else
+				{
+					repeat = 11 + reader.Bits(7);
+				}
+
+				if (index + repeat > literalCount + distanceCount)
+				{
+					throw runtime_error("Too many deflate code lengths.");
+				}
+				while (repeat-- > 0)
+				{
+					lengths[index++] = repeated;
+				}
+			}
+
+			BuildHuffman(literals, lengths, literalCount);
+			BuildHuffman(distances, lengths + literalCount, distanceCount);
+		}
+
+		Huffman BuildFixedCode(uint32_t count)
+		{
+			uint8_t lengths[288];
+			if (count == 288)
+			{
+				fill(lengths, lengths + 144, static_cast<uint8_t>(8));
+				fill(lengths + 144, lengths + 256, static_cast<uint8_t>(9));
+				fill(lengths + 256, lengths + 280, static_cast<uint8_t>(7));
+				fill(lengths + 280, lengths + 288, static_cast<uint8_t>(8));
+			}
+			else
+			{
+				fill(lengths, lengths + count, static_cast<uint8_t>(5));
+			}
+
+			Huffman huffman;
+			BuildHuffman(huffman, lengths, count);
+			return huffman;
+		}
+
+		// literal/length and distance codes for fixed-Huffman blocks, built once on first use
+		const pair<Huffman, Huffman>& FixedCodes()
+		{
+			static const pair<Huffman, Huffman> sCodes(BuildFixedCode(288), BuildFixedCode(30));
+			return sCodes;
+		}
+
+		vector<uint8_t> Inflate(const uint8_t* data, size_t size)
+		{
+			// zlib wrapper: a two byte header we only sanity check, and an Adler-32 we don't
+			if (size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20) != 0)
+			{
+				throw runtime_error("Unsupported zlib stream.");
+			}
+
+			BitReader reader(data + 2, size - 2);
+			vector<uint8_t> output;
+			bool finalBlock = false;
+			while (!finalBlock)
+			{
+				finalBlock = (reader.Bits(1) == 1);
+				uint32_t type = reader.Bits(2);
+				if (type == 0)
+				{
+					reader.AlignToByte();
+					uint32_t length = reader.Bits(16);
+					uint32_t inverse = reader.Bits(16);
+					if ((length ^ 0xFFFF) != inverse)
+					{
+						throw runtime_error("Corrupt stored deflate block.");
+					}
+					for (uint32_t i = 0; i < length; ++i)
+					{
+						output.push_back(static_cast<uint8_t>(reader.Bits(8)));
+					}
+				}
+				else if (type == 1)
+				{
+					InflateBlock(reader, FixedCodes().first, FixedCodes().second, output);
+				}
+				else if (type == 2)
+				{
+					Huffman literals;
+					Huffman distances;
+					ReadDynamicCodes(reader, literals, distances);
+					InflateBlock(reader, literals, distances, output);
+				}
+				else
+				{
+					throw runtime_error("Invalid deflate block type.");
+				}
+			}
+
+			return output;
+		}
+
+		uint32_t ReadBigEndian(const uint8_t* data)
+		{
+			return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+		}
+
+		void WriteBigEndian(vector<uint8_t>& output, uint32_t value)
+		{
+			output.push_back(static_cast<uint8_t>(value >> 24));
+			output.push_back(static_cast<uint8_t>(value >> 16));
+			output.push_back(static_cast<uint8_t>(value >> 8));
+			output.push_back(static_cast<uint8_t>(value));
+		}
+
+		uint32_t Crc32(const uint8_t* data, size_t size)
+		{
+			static const vector<uint32_t> sTable = []()
+			{
+				vector<uint32_t> table(256);
+				for (uint32_t n = 0; n < 256; ++n)
+				{
+					uint32_t c = n;
+					for (int k = 0; k < 8; ++k)
+					{
+						c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					}
+					table[n] = c;
+				}
+				return table;
+			}();
+
+			uint32_t crc = 0xFFFFFFFFu;
+			for (size_t i = 0; i < size; ++i)
+			{
+				crc = sTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+			}
+			return crc ^ 0xFFFFFFFFu;
+		}
+
+		void WriteChunk(vector<uint8_t>& output, const char* type, const vector<uint8_t>& data)
+		{
+			WriteBigEndian(output, static_cast<uint32_t>(data.size()));
+			size_t start = output.size();
+			output.insert(output.end(), type, type + 4);
+			output.insert(output.end(), data.begin(), data.end());
+			WriteBigEndian(output, Crc32(output.data() + start, output.size() - start));
+		}
+
+		uint8_t Paeth(uint8_t left, uint8_t up, uint8_t upLeft)
+		{
+			int32_t estimate = static_cast<int32_t>(left) + up - upLeft;
+			int32_t toLeft = abs(estimate - left);
+			int32_t toUp = abs(estimate - up);
+			int32_t toUpLeft = abs(estimate - upLeft);
+			if (toLeft <= toUp && toLeft <= toUpLeft)
+			{
+				return left;
+			}
+			return (toUp <= toUpLeft ? up : upLeft);
+		}
+	}
+
+	Image Png::Load(const string& path)
+	{
+		ifstream file(path, ios::binary);
+		if (!file.good())
+		{
+			throw runtime_error("Couldn't open " + path + ".");
+		}
+
+		vector<uint8_t> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+		return Decode(data.data(), data.size());
+	}
+
+	Image Png::Decode(const uint8_t* data, size_t size)
+	{
+		if (size < sizeof(Signature) || memcmp(data, Signature, sizeof(Signature)) != 0)
+		{
+			throw runtime_error("Not a PNG file.");
+		}
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint8_t colorType = 0;
+		vector<uint8_t> palette;
+		vector<uint8_t> transparency;
+		vector<uint8_t> compressed;
+
+		size_t position = sizeof(Signature);
+		for (;;)
+		{
+			if (size - position < 12)
+			{
+				throw runtime_error("Truncated PNG file.");
+			}
+			uint32_t length = ReadBigEndian(data + position);
+			const uint8_t* type = data + position + 4;
+			const uint8_t* chunk = data + position + 8;
+			if (length > size - position - 12)
+			{
+				throw runtime_error("Truncated PNG file.");
+			}
+
+			if (memcmp(type, "IHDR", 4) == 0)
+			{
+				if (length < 13)
+				{
+					throw runtime_error("Corrupt PNG header.");
+				}
+				width = ReadBigEndian(chunk);
+				height = ReadBigEndian(chunk + 4);
+				colorType = chunk[9];
+				if (chunk[8] != 8 || chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0 || (colorType != 0 && colorType != 2 && colorType != 3 && colorType != 4 && colorType != 6))
+				{
+					throw runtime_error("Only 8-bit, non-interlaced PNG files are supported.");
+				}
+			}
+			else if (memcmp(type, "PLTE", 4) == 0)
+			{
+				palette.assign(chunk, chunk + length);
+			}
+			else if (memcmp(type, "tRNS", 4) == 0)
+			{
+				transparency.assign(chunk, chunk + length);
+			}
+			else if (memcmp(type, "IDAT", 4) == 0)
+			{
+				compressed.insert(compressed.end(), chunk, chunk + length);
+			}
+			else if (memcmp(type, "IEND", 4) == 0)
+			{
+				break;
+			}
+			position += length + 12;
+		}
+
+		static const uint32_t Channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+		uint32_t channels = Channels[colorType];
+		size_t stride = static_cast<size_t>(width) * channels;
+		if (width == 0 || height == 0)
+		{
+			throw runtime_error("PNG file has no header or no pixels.");
+		}
+
+		vector<uint8_t> filtered = Inflate(compressed.data(), compressed.size());
+		if (filtered.size() < (stride + 1) * height)
+		{
+			throw runtime_error("PNG pixel data is truncated.");
+		}
+
+		// undo each row's filter in place, then expand the row to RGBA
+		Image image(width, height);
+		vector<uint8_t> previous(stride, 0);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			uint8_t filter = filtered[y * (stride + 1)];
+			uint8_t* row = filtered.data() + y * (stride + 1) + 1;
+			for (size_t x = 0; x < stride; ++x)
+			{
+				uint8_t left = (x >= channels ? row[x - channels] : 0);
+				uint8_t up = previous[x];
+				uint8_t upLeft = (x >= channels ? previous[x - channels] : 0);
+				switch (filter)
+				{
+				case 0:
+					break;
+				case 1:
+					row[x] = static_cast<uint8_t>(row[x] + left);
+					break;
+				case 2:
+					row[x] = static_cast<uint8_t>(row[x] + up);
+					break;
+				case 3:
+					row[x] = static_cast<uint8_t>(row[x] + (left + up) / 2);
+					break;
+				case 4:
+					row[x] = static_cast<uint8_t>(row[x] + Paeth(left, up, upLeft));
+					break;
+				default:
+					throw runtime_error("Invalid PNG row filter.");
+				}
+			}
+			previous.assign(row, row + stride);
+
+			uint32_t* pixels = image.Row(y);
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				const uint8_t* source = row + x * channels;
+				uint32_t r, g, b, a = 255;
+				switch (colorType)
+				{
+				case 0:
+					r = g = b = source[0];
+					break;
+				case 2:
+					r = source[0];
+					g = source[1];
+					b = source[2];
+					break;
+				case 3:
+					if (source[0] * 3u + 2 >= palette.size())
+					{
+						throw runtime_error("PNG palette index out of range.");
+					}
+					r = palette[source[0] * 3];
+					g = palette[source[0] * 3 + 1];
+					b = palette[source[0] * 3 + 2];
+					a = (source[0] < transparency.size() ? transparency[source[0]] : 255);
+					break;
+				case 4:
+					r = g = b = source[0];
+					a = source[1];
+					break;
+				default:
+					r = source[0];
+					g = source[1];
+					b = source[2];
+					a = source[3];
+					break;
+				}
+				pixels[x] = r | (g << 8) | (b << 16) | (a << 24);
+			}
+		}
+
+		return image;
+	}
+
+	void Png::Save(const string& path, const Image& image)
+	{
+		// each row is a filter byte of 0 followed by the pixels as they are in memory
+		size_t stride = static_cast<size_t>(image.Width) * 4;
+		vector<uint8_t> raw;
+		raw.reserve((stride + 1) * image.Height);
+		for (uint32_t y = 0; y < image.Height; ++y)
+		{
+			raw.push_back(0);
+			const uint32_t* row = image.Row(y);
+			for (uint32_t x = 0; x < image.Width; ++x)
+			{
+				raw.push_back(static_cast<uint8_t>(row[x]));
+				raw.push_back(static_cast<uint8_t>(row[x] >> 8));
+				raw.push_back(static_cast<uint8_t>(row[x] >> 16));
+				raw.push_back(static_cast<uint8_t>(row[x] >> 24));
+			}
+		}
+
+		vector<uint8_t> zlib = { 0x78, 0x01 };
+		const size_t MaxStoredBlock = 65535;
+		size_t offset = 0;
+		do
+		{
+			size_t length = min(MaxStoredBlock, raw.size() - offset);
+			zlib.push_back(offset + length == raw.size() ? 1 : 0);
+			zlib.push_back(static_cast<uint8_t>(length));
+			zlib.push_back(static_cast<uint8_t>(length >> 8));
+			zlib.push_back(static_cast<uint8_t>(~length));
+			zlib.push_back(static_cast<uint8_t>(~length >> 8));
+			zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+			offset += length;
+		} while (offset < raw.size());
+
+		uint32_t a = 1;
+		uint32_t b = 0;
+		for (uint8_t byte : raw)
+		{
+			a = (a + byte) % 65521;
+			b = (b + a) % 65521;
+		}
+		WriteBigEndian(zlib, (b << 16) | a);
+
+		vector<uint8_t> header;
+		WriteBigEndian(header, image.Width);
+		WriteBigEndian(header, image.Height);
+		header.push_back(8);
+		header.push_back(6);
+		header.push_back(0);
+		header.push_back(0);
+		header.push_back(0);
+
+		vector<uint8_t> output(Signature, Signature + sizeof(Signature));
+		WriteChunk(output, "IHDR", header);
+		WriteChunk(output, "IDAT", zlib);
+		WriteChunk(output, "IEND", vector<uint8_t>());
+
+		ofstream file(path, ios::binary);
+		file.write(reinterpret_cast<const char*>(output.data()), static_cast<streamsize>(output.size()));
+		if (!file.good())
+		{
+			throw runtime_error("Couldn't write " + path + ".");
+		}
+	}
+}
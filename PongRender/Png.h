@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Image.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Pong
+{
+	// Just enough PNG for the game's content and for writing rendered frames: 8-bit greyscale,
+	// RGB, palette and RGBA images without interlacing. Saved files are RGBA with stored (uncompressed)
+	// deflate blocks, which any decoder reads and which need no compressor here.
+	class Png final
+	{
+	public:
+		Png() = delete;
+		Png(const Png&) = delete;
+		Png& operator=(const Png&) = delete;
+
+		static Image Load(const std::string& path);
+		static Image Decode(const uint8_t* data, size_t size);
+		static void Save(const std::string& path, const Image& image);
+	};
+}
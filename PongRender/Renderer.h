@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Color.h"
+#include "Vector2.h"
+#include <cstdint>
+#include <string>
+
+namespace Pong
+{
+	class AssetArchive;
+
+	// Everything the game draws goes through here: whole textures at a position, optionally tinted,
+	// and strings in a sprite font. The D3D11 backend draws with SpriteManager; SoftwareRenderer
+	// draws into memory so frames can be rendered without a GPU.
+	class Renderer
+	{
+	public:
+		typedef uint32_t TextureId;
+		typedef uint32_t FontId;
+
+		virtual ~Renderer() = default;
+
+		// loading the same path twice returns the same id
+		virtual TextureId LoadTexture(const std::string& path) = 0;
+		virtual FontId LoadFont(const std::string& path) = 0;
+
+		// the same from a packed archive, by the asset's path inside it; the archive has to outlive the renderer
+		virtual TextureId LoadTexture(const AssetArchive& archive, const std::string& name) = 0;
+		virtual FontId LoadFont(const AssetArchive& archive, const std::string& name) = 0;
+
+		virtual Vector2 TextureSize(TextureId texture) const = 0;
+		virtual Vector2 MeasureString(FontId font, const wchar_t* text) const = 0;
+
+		virtual void Clear(const Color& color) = 0;
+		virtual void DrawTexture(TextureId texture, const Vector2& position, const Color& tint) = 0;
+		virtual void DrawString(FontId font, const wchar_t* text, const Vector2& position) = 0;
+	};
+}
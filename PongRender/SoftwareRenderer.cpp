@@ -0,0 +1,244 @@
+#include "pch.h"
+#include "SoftwareRenderer.h"
+#include "AssetArchive.h"
+#include "ContentCache.h"
+#include "Png.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PONGRENDER_SSE2
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		ContentCache<Image>& Images()
+		{
+			static ContentCache<Image> sImages;
+			return sImages;
+		}
+
+		ContentCache<BitmapFont>& Fonts()
+		{
+			static ContentCache<BitmapFont> sFonts;
+			return sFonts;
+		}
+
+		uint32_t PackChannel(float value)
+		{
+			return static_cast<uint32_t>(min(max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+
+		uint32_t Pack(const Color& color)
+		{
+			return PackChannel(color.R) | (PackChannel(color.G) << 8) | (PackChannel(color.B) << 16) | (PackChannel(color.A) << 24);
+		}
+
+		// x * y / 255, rounded; exact for 8-bit inputs and cheap in 16-bit lanes
+		uint32_t Multiply(uint32_t x, uint32_t y)
+		{
+			uint32_t product = x * y + 128;
+			return (product + (product >> 8)) >> 8;
+		}
+
+		// destination = source * tint + destination * (1 - source alpha * tint alpha)
+		void BlendRowScalar(uint32_t* destination, const uint32_t* source, int32_t count, uint32_t tint)
+		{
+			for (int32_t i = 0; i < count; ++i)
+			{
+				uint32_t tinted[4];
+				for (uint32_t channel = 0; channel < 4; ++channel)
+				{
+					tinted[channel] = Multiply((source[i] >> (channel * 8)) & 0xFF, (tint >> (channel * 8)) & 0xFF);
+				}
+
+				uint32_t blended = 0;
+				for (uint32_t channel = 0; channel < 4; ++channel)
+				{
+					uint32_t value = tinted[channel] + Multiply((destination[i] >> (channel * 8)) & 0xFF, 255 - tinted[3]);
+					blended |= min(value, 255u) << (channel * 8);
+				}
+				destination[i] = blended;
+			}
+		}
+
+#if defined(PONGRENDER_SSE2)
+		// two pixels per 128-bit register once widened to 16-bit lanes, with the same rounding as Multiply
+		inline __m128i Multiply(__m128i x, __m128i y)
+		{
+			__m128i product = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+		}
+
+		inline __m128i BroadcastAlpha(__m128i pixels)
+		{
+			return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		}
+
+		inline __m128i BlendHalf(__m128i source, __m128i destination, __m128i tint)
+		{
+			__m128i tinted = Multiply(source, tint);
+			__m128i inverseAlpha = _mm_sub_epi16(_mm_set1_epi16(255), BroadcastAlpha(tinted));
+			return _mm_add_epi16(tinted, Multiply(destination, inverseAlpha));
+		}
+
+		void BlendRow(uint32_t* destination, const uint32_t* source, int32_t count, uint32_t tint)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i tints = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int32_t>(tint)), zero);
+
+			int32_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i sourcePixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+				__m128i destinationPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+
+				__m128i low = BlendHalf(_mm_unpacklo_epi8(sourcePixels, zero), _mm_unpacklo_epi8(destinationPixels, zero), tints);
+				__m128i high = BlendHalf(_mm_unpackhi_epi8(sourcePixels, zero), _mm_unpackhi_epi8(destinationPixels, zero), tints);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+			}
+
+			BlendRowScalar(destination + i, source + i, count - i, tint);
+		}
+#else
+		void BlendRow(uint32_t* destination, const uint32_t* source, int32_t count, uint32_t tint)
+		{
+			BlendRowScalar(destination, source, count, tint);
+		}
+#endif
+	}
+
+	SoftwareRenderer::SoftwareRenderer(uint32_t width, uint32_t height) :
+		mFramebuffer(width, height)
+	{
+	}
+
+	const Image& SoftwareRenderer::Framebuffer() const
+	{
+		return mFramebuffer;
+	}
+
+	Renderer::TextureId SoftwareRenderer::LoadTexture(const string& path)
+	{
+		return AddTexture(path, [](const string& imagePath) { return Png::Load(imagePath); });
+	}
+
+	Renderer::FontId SoftwareRenderer::LoadFont(const string& path)
+	{
+		return AddFont(path, [](const string& fontPath) { return BitmapFont(fontPath); });
+	}
+
+	Renderer::TextureId SoftwareRenderer::LoadTexture(const AssetArchive& archive, const string& name)
+	{
+		// archive assets share the caches with loose files, keyed so they can't collide with a path
+		return AddTexture(archive.Path() + ":" + name, [&archive, &name](const string&)
+		{
+			AssetArchive::TextureView texture = archive.GetTexture(name);
+			Image image(texture.Width, texture.Height);
+			memcpy(image.Pixels.data(), texture.Pixels, image.Pixels.size() * sizeof(uint32_t));
+			return image;
+		});
+	}
+
+	Renderer::FontId SoftwareRenderer::LoadFont(const AssetArchive& archive, const string& name)
+	{
+		return AddFont(archive.Path() + ":" + name, [&archive, &name](const string&)
+		{
+			const AssetArchive::Entry& entry = archive.Get(name, AssetType::Font);
+			return BitmapFont(entry.Data, entry.Size, name);
+		});
+	}
+
+	template <typename Loader>
+	Renderer::TextureId SoftwareRenderer::AddTexture(const string& key, Loader load)
+	{
+		auto existing = mTextureIds.find(key);
+		if (existing != mTextureIds.end())
+		{
+			return existing->second;
+		}
+
+		mTextures.push_back(Images().Load(key, load));
+		TextureId texture = static_cast<TextureId>(mTextures.size() - 1);
+		mTextureIds.emplace(key, texture);
+		return texture;
+	}
+
+	template <typename Loader>
+	Renderer::FontId SoftwareRenderer::AddFont(const string& key, Loader load)
+	{
+		auto existing = mFontIds.find(key);
+		if (existing != mFontIds.end())
+		{
+			return existing->second;
+		}
+
+		mFonts.push_back(Fonts().Load(key, load));
+		FontId font = static_cast<FontId>(mFonts.size() - 1);
+		mFontIds.emplace(key, font);
+		return font;
+	}
+
+	Vector2 SoftwareRenderer::TextureSize(TextureId texture) const
+	{
+		const Image& image = *mTextures.at(texture);
+		return Vector2(static_cast<float>(image.Width), static_cast<float>(image.Height));
+	}
+
+	Vector2 SoftwareRenderer::MeasureString(FontId font, const wchar_t* text) const
+	{
+		return mFonts.at(font)->MeasureString(text);
+	}
+
+	void SoftwareRenderer::Clear(const Color& color)
+	{
+		fill(mFramebuffer.Pixels.begin(), mFramebuffer.Pixels.end(), Pack(color));
+	}
+
+	void SoftwareRenderer::DrawTexture(TextureId texture, const Vector2& position, const Color& tint)
+	{
+		const Image& image = *mTextures.at(texture);
+		Blit(image, 0, 0, static_cast<int32_t>(image.Width), static_cast<int32_t>(image.Height), position.X, position.Y, Pack(tint));
+	}
+
+	void SoftwareRenderer::DrawString(FontId font, const wchar_t* text, const Vector2& position)
+	{
+		const BitmapFont& bitmapFont = *mFonts.at(font);
+		const Image& texture = bitmapFont.Texture();
+		const uint32_t white = 0xFFFFFFFF;
+
+		bitmapFont.ForEachGlyph(text, [&](const BitmapFont::Glyph& glyph, float x, float y)
+		{
+			Blit(texture, glyph.Left, glyph.Top, glyph.Right - glyph.Left, glyph.Bottom - glyph.Top, position.X + x, position.Y + y + glyph.YOffset, white);
+		});
+	}
+
+	void SoftwareRenderer::Blit(const Image& source, int32_t sourceX, int32_t sourceY, int32_t width, int32_t height, float x, float y, uint32_t tint)
+	{
+		// snap to the nearest pixel, then clip against the framebuffer
+		int32_t left = static_cast<int32_t>(floor(x + 0.5f));
+		int32_t top = static_cast<int32_t>(floor(y + 0.5f));
+
+		int32_t clipLeft = max(0, -left);
+		int32_t clipTop = max(0, -top);
+		int32_t clipRight = max(0, left + width - static_cast<int32_t>(mFramebuffer.Width));
+		int32_t clipBottom = max(0, top + height - static_cast<int32_t>(mFramebuffer.Height));
+
+		int32_t columns = width - clipLeft - clipRight;
+		int32_t rows = height - clipTop - clipBottom;
+		if (columns <= 0 || rows <= 0)
+		{
+			return;
+		}
+
+		for (int32_t row = 0; row < rows; ++row)
+		{
+			uint32_t* destination = mFramebuffer.Row(static_cast<uint32_t>(top + clipTop + row)) + left + clipLeft;
+			const uint32_t* pixels = source.Row(static_cast<uint32_t>(sourceY + clipTop + row)) + sourceX + clipLeft;
+			BlendRow(destination, pixels, columns, tint);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "BitmapFont.h"
+#include "Image.h"
+#include "Renderer.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	// Draws into an RGBA framebuffer in memory, for rendering without a GPU. Sprites are placed on
+	// whole pixels and blended the way SpriteBatch's default premultiplied-alpha state does, with
+	// integer arithmetic so every build produces the same bytes. Decoded textures and fonts are
+	// shared by every SoftwareRenderer in the process, so extra renderers cost only a framebuffer.
+	class SoftwareRenderer final : public Renderer
+	{
+	public:
+		SoftwareRenderer(uint32_t width, uint32_t height);
+
+		const Image& Framebuffer() const;
+
+		virtual TextureId LoadTexture(const std::string& path) override;
+		virtual FontId LoadFont(const std::string& path) override;
+		virtual TextureId LoadTexture(const AssetArchive& archive, const std::string& name) override;
+		virtual FontId LoadFont(const AssetArchive& archive, const std::string& name) override;
+
+		virtual Vector2 TextureSize(TextureId texture) const override;
+		virtual Vector2 MeasureString(FontId font, const wchar_t* text) const override;
+
+		virtual void Clear(const Color& color) override;
+		virtual void DrawTexture(TextureId texture, const Vector2& position, const Color& tint) override;
+		virtual void DrawString(FontId font, const wchar_t* text, const Vector2& position) override;
+
+	private:
+		template <typename Loader>
+		TextureId AddTexture(const std::string& key, Loader load);
+		template <typename Loader>
+		FontId AddFont(const std::string& key, Loader load);
+
+		void Blit(const Image& source, int32_t sourceX, int32_t sourceY, int32_t width, int32_t height, float x, float y, uint32_t tint);
+
+		Image mFramebuffer;
+		std::vector<std::shared_ptr<const Image>> mTextures;
+		std::vector<std::shared_ptr<const BitmapFont>> mFonts;
+		std::map<std::string, TextureId> mTextureIds;
+		std::map<std::string, FontId> mFontIds;
+	};
+}
@@ -0,0 +1,77 @@
+#include "pch.h"
+#include "TextLayout.h"
+
+using namespace std;
+
+namespace Pong
+{
+	const TextLayout::ElementId TextLayout::NoElement = static_cast<TextLayout::ElementId>(-1);
+
+	TextLayout::TextLayout(Renderer& renderer) :
+		mRenderer(&renderer)
+	{
+	}
+
+	TextLayout::ElementId TextLayout::Add(const Element& element)
+	{
+		if (element.Text == nullptr)
+		{
+			throw invalid_argument("A layout element needs text.");
+		}
+
+		// only earlier elements, so one pass in order places everything
+		if (element.StackedOn != NoElement && element.StackedOn >= mElements.size())
+		{
+			throw invalid_argument("A layout element can only stack on an earlier element.");
+		}
+
+		PlacedElement placed;
+		placed.Source = element;
+		mElements.push_back(placed);
+		mValid = false;
+
+		return mElements.size() - 1;
+	}
+
+	void TextLayout::Invalidate()
+	{
+		mValid = false;
+	}
+
+	void TextLayout::Update(float viewportWidth, float viewportHeight)
+	{
+		if (mValid && viewportWidth == mViewportSize.X && viewportHeight == mViewportSize.Y)
+		{
+			return;
+		}
+
+		mViewportSize = Vector2(viewportWidth, viewportHeight);
+
+		for (PlacedElement& element : mElements)
+		{
+			const Element& source = element.Source;
+
+			element.Size = mRenderer->MeasureString(source.Font, source.Text);
+			element.Position.X = viewportWidth * source.Anchor.X - element.Size.X * source.Pivot.X;
+			element.Position.Y = viewportHeight * source.Anchor.Y - element.Size.Y * source.Pivot.Y;
+
+			if (source.StackedOn != NoElement)
+			{
+				element.Position.Y += mElements[source.StackedOn].Size.Y * source.Spacing;
+			}
+		}
+
+		mValid = true;
+	}
+
+	const Vector2& TextLayout::Position(ElementId id) const
+	{
+		return mElements.at(id).Position;
+	}
+
+	void TextLayout::Draw(ElementId id) const
+	{
+		const PlacedElement& element = mElements.at(id);
+		mRenderer->DrawString(element.Source.Font, element.Source.Text, element.Position);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Renderer.h"
+#include "Vector2.h"
+#include <cstddef>
+#include <vector>
+
+namespace Pong
+{
+	// Retained-mode layout for text that doesn't change. Each element is measured and placed once,
+	// then only again when the viewport size changes or Invalidate is called (after a font reload),
+	// so drawing it costs nothing beyond the draw itself.
+	class TextLayout final
+	{
+	public:
+		typedef size_t ElementId;
+
+		struct Element final
+		{
+			Renderer::FontId Font = 0;
+
+			// not copied, so it has to outlive the layout
+			const wchar_t* Text = nullptr;
+
+			// a point in the viewport, as a fraction of its size
+			Vector2 Anchor = Vector2(0.5f, 0.5f);
+
+			// the point in the measured text that sits on the anchor, as a fraction of the text's size
+			Vector2 Pivot = Vector2(0.5f, 0.5f);
+
+			// stacks the element Spacing times an earlier element's height further down
+			ElementId StackedOn = NoElement;
+			float Spacing = 0.0f;
+		};
+
+		static const ElementId NoElement;
+
+		explicit TextLayout(Renderer& renderer);
+
+		ElementId Add(const Element& element);
+		void Invalidate();
+
+		// cheap when nothing has changed
+		void Update(float viewportWidth, float viewportHeight);
+
+		const Vector2& Position(ElementId id) const;
+		void Draw(ElementId id) const;
+
+	private:
+		struct PlacedElement final
+		{
+			Element Source;
+			Vector2 Size;
+			Vector2 Position;
+		};
+
+		Renderer* mRenderer;
+		std::vector<PlacedElement> mElements;
+		Vector2 mViewportSize;
+		bool mValid = false;
+	};
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Standard
+#include <exception>
+#include <stdexcept>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
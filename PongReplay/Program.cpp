@@ -0,0 +1,246 @@
+#include "FixedTimestep.h"
+#include "PaddleController.h"
+#include "Replay.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct RecordOptions
+	{
+		uint32_t Frames = 120 * 60 * 10;
+		float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		uint32_t Seed = 1;
+		uint32_t KeyframeInterval = ReplayWriter::DefaultKeyframeInterval;
+		CollisionMode Collision = CollisionMode::Discrete;
+		AIMode AI = AIMode::Reactive;
+		float AIError = 0.0f;
+		PhysicsMode Physics = PhysicsMode::Float;
+	};
+
+	void PrintUsage()
+	{
+		cerr << "Usage: PongReplay record <file> [--frames N] [--dt seconds] [--seed N] [--keyframes N] [--collision swept|discrete] [--ai reactive|predictive] [--ai-error pixels] [--physics float|fixed]" << endl;
+		cerr << "       PongReplay verify <file>" << endl;
+		cerr << "       PongReplay seek <file> <frame>" << endl;
+	}
+
+	RecordOptions ParseRecordOptions(int argc, char* argv[])
+	{
+		RecordOptions options;
+
+		for (int i = 3; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--dt") == 0)
+			{
+				options.ElapsedTime = static_cast<float>(atof(argv[i + 1]));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--keyframes") == 0)
+			{
+				options.KeyframeInterval = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--collision") == 0)
+			{
+				if (strcmp(argv[i + 1], "discrete") == 0)
+				{
+					options.Collision = CollisionMode::Discrete;
+				}
+				else if (strcmp(argv[i + 1], "swept") == 0)
+				{
+					options.Collision = CollisionMode::Swept;
+				}
+				else
+				{
+					cerr << "Unknown value for --collision: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--ai") == 0)
+			{
+				if (strcmp(argv[i + 1], "reactive") == 0)
+				{
+					options.AI = AIMode::Reactive;
+				}
+				else if (strcmp(argv[i + 1], "predictive") == 0)
+				{
+					options.AI = AIMode::Predictive;
+				}
+				else
+				{
+					cerr << "Unknown value for --ai: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--ai-error") == 0)
+			{
+				options.AIError = static_cast<float>(atof(argv[i + 1]));
+			}
+			else if (strcmp(argv[i], "--physics") == 0)
+			{
+				if (strcmp(argv[i + 1], "float") == 0)
+				{
+					options.Physics = PhysicsMode::Float;
+				}
+				else if (strcmp(argv[i + 1], "fixed") == 0)
+				{
+					options.Physics = PhysicsMode::FixedPoint;
+				}
+				else
+				{
+					cerr << "Unknown value for --physics: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	// Records the tracking bot against the built-in AI, pressing SPACEBAR whenever a match is over.
+	int Record(const string& path, const RecordOptions& options)
+	{
+		MatchConfig config;
+		config.Collision = options.Collision;
+		config.AI = options.AI;
+		config.AIError = options.AIError;
+		config.Physics = options.Physics;
+		MatchState match = Simulation::CreateMatch(config, options.Seed);
+		ReplayWriter writer(path, config, options.Seed, options.ElapsedTime, options.KeyframeInterval);
+
+		TrackingController player1;
+		MatchInputs inputs;
+		for (uint32_t frame = 0; frame < options.Frames; ++frame)
+		{
+			inputs.Start = (match.Gamestate != Gamestate::Playing);
+			inputs.Player1 = player1.Control(match, Players::Player1);
+			writer.Record(match, inputs);
+			Simulation::Step(match, inputs, options.ElapsedTime);
+		}
+		writer.Finish();
+
+		cout << "Recorded " << writer.FrameCount() << " frames to " << path << " (final score " << match.Player1Score << "-" << match.Player2Score << ")" << endl;
+		return EXIT_SUCCESS;
+	}
+
+	// Re-simulates the whole replay against its keyframes, then checks that seeking lands on the
+	// same state as playing straight through.
+	int Verify(const string& path)
+	{
+		ReplayReader reader(path);
+		uint64_t frameCount = reader.FrameCount();
+		cout << frameCount << " frames, " << reader.KeyframeCount() << " keyframes, " << reader.FileSize() << " bytes ("
+			<< static_cast<double>(reader.FileSize()) / max<uint64_t>(frameCount, 1) << " bytes per frame)" << endl;
+
+		const uint64_t SeekChecks = 16;
+		uint64_t seekFailures = 0;
+		chrono::duration<double> seekTime(0.0);
+
+		auto startTime = chrono::steady_clock::now();
+		ReplayCursor cursor = reader.Seek(0);
+		for (uint64_t check = 1; check <= SeekChecks; ++check)
+		{
+			uint64_t frame = frameCount * check / SeekChecks;
+			while (cursor.Frame() < frame)
+			{
+				cursor.Step();
+			}
+
+			auto seekStart = chrono::steady_clock::now();
+			ReplayCursor seeked = reader.Seek(frame);
+			seekTime += chrono::steady_clock::now() - seekStart;
+			if (!Simulation::SameState(seeked.Match(), cursor.Match()))
+			{
+				cerr << "Seeking to frame " << frame << " disagrees with playing through" << endl;
+				++seekFailures;
+			}
+		}
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+		if (!cursor.MatchesKeyframes())
+		{
+			cerr << "Replay diverges from its keyframes at frame " << cursor.MismatchFrame() << endl;
+			return EXIT_FAILURE;
+		}
+
+		const MatchState& match = cursor.Match();
+		cout << "Replayed to a " << match.Player1Score << "-" << match.Player2Score << " score in " << elapsed.count() << " s; every keyframe matches" << endl;
+		cout << "Average seek: " << seekTime.count() / SeekChecks * 1e6 << " us" << endl;
+
+		return seekFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	int Seek(const string& path, uint64_t frame)
+	{
+		ReplayReader reader(path);
+
+		auto startTime = chrono::steady_clock::now();
+		ReplayCursor cursor = reader.Seek(frame);
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+		const MatchState& match = cursor.Match();
+		cout << "Frame " << cursor.Frame() << " (" << match.TotalTime << " s): score " << match.Player1Score << "-" << match.Player2Score
+			<< ", ball at " << match.Ball.Bounds.X << "," << match.Ball.Bounds.Y << endl;
+		cout << "Seek took " << elapsed.count() * 1e6 << " us" << endl;
+
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		if (strcmp(argv[1], "record") == 0)
+		{
+			return Record(argv[2], ParseRecordOptions(argc, argv));
+		}
+		else if (strcmp(argv[1], "verify") == 0)
+		{
+			return Verify(argv[2]);
+		}
+		else if (strcmp(argv[1], "seek") == 0 && argc == 4)
+		{
+			return Seek(argv[2], strtoull(argv[3], nullptr, 10));
+		}
+	}
+	catch (const exception& error)
+	{
+		cerr << error.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	PrintUsage();
+	return EXIT_FAILURE;
+}
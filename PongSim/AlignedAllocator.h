@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+namespace Pong
+{
+	// Minimal allocator so SoA columns can be loaded with aligned SIMD instructions.
+	template <typename T, std::size_t Alignment>
+	class AlignedAllocator
+	{
+	public:
+		using value_type = T;
+
+		template <typename U>
+		struct rebind
+		{
+			using other = AlignedAllocator<U, Alignment>;
+		};
+
+		AlignedAllocator() = default;
+
+		template <typename U>
+		AlignedAllocator(const AlignedAllocator<U, Alignment>&) { }
+
+		T* allocate(std::size_t count)
+		{
+			std::size_t size = (count * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+#if defined(_MSC_VER)
+			void* memory = _aligned_malloc(size, Alignment);
+#else
+			void* memory = nullptr;
+			if (posix_memalign(&memory, Alignment, size) != 0)
+			{
+				memory = nullptr;
+			}
+#endif
+			if (memory == nullptr)
+			{
+				throw std::bad_alloc();
+			}
+
+			return static_cast<T*>(memory);
+		}
+
+		void deallocate(T* memory, std::size_t)
+		{
+#if defined(_MSC_VER)
+			_aligned_free(memory);
+#else
+			free(memory);
+#endif
+		}
+
+		template <typename U>
+		bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+		template <typename U>
+		bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+	};
+
+	template <typename T>
+	using AlignedVector = std::vector<T, AlignedAllocator<T, 32>>;
+}
@@ -0,0 +1,384 @@
+#include "pch.h"
+#include "ChaosMatch.h"
+#include "Profiler.h"
+#include "Simulation.h"
+#include <limits>
+
+using namespace std;
+
+namespace Pong
+{
+	ChaosMatch::ChaosMatch(const ChaosConfig& config, uint32_t seed) :
+		mConfig(config), mGenerator(seed, 0),
+		mGrid(config.Match.ViewportWidth, config.Match.ViewportHeight, max(config.Match.BallWidth, config.Match.BallHeight)),
+		mLaneHeight(config.Match.ViewportHeight / max(config.PaddlesPerSide, 1u)),
+		mBallX(config.BallCount), mBallY(config.BallCount), mPreviousBallX(config.BallCount), mPreviousBallY(config.BallCount),
+		mBallVelocityX(config.BallCount), mBallVelocityY(config.BallCount)
+	{
+		if (config.PaddlesPerSide == 0)
+		{
+			throw invalid_argument("Each side needs at least one paddle.");
+		}
+		if (config.Match.Physics != PhysicsMode::Float)
+		{
+			throw invalid_argument("Chaos matches only run floating point physics.");
+		}
+
+		const MatchConfig& match = config.Match;
+		size_t paddleCount = 2 * static_cast<size_t>(config.PaddlesPerSide);
+		mPaddleX.resize(paddleCount);
+		mPaddleY.resize(paddleCount);
+		mPaddleTargetY.resize(paddleCount);
+		mPaddleTargetTime.resize(paddleCount);
+
+		for (size_t i = 0; i < paddleCount; ++i)
+		{
+			// each paddle starts in the middle of its lane, facing the center like a normal match's
+			size_t lane = i % config.PaddlesPerSide;
+			float laneCenter = (lane + 0.5f) * mLaneHeight;
+			mPaddleX[i] = (PaddlePlayer(i) == Players::Player1 ? match.PaddleWallOffset : match.ViewportWidth - match.PaddleWallOffset);
+			mPaddleY[i] = laneCenter - match.PaddleHeight / 2;
+			mPaddleTargetY[i] = laneCenter;
+		}
+		mPreviousPaddleY = mPaddleY;
+
+		for (size_t i = 0; i < mBallX.size(); ++i)
+		{
+			ServeBall(i);
+		}
+	}
+
+	const ChaosConfig& ChaosMatch::Config() const
+	{
+		return mConfig;
+	}
+
+	size_t ChaosMatch::BallCount() const
+	{
+		return mBallX.size();
+	}
+
+	size_t ChaosMatch::PaddleCount() const
+	{
+		return mPaddleX.size();
+	}
+
+	int32_t ChaosMatch::Player1Score() const
+	{
+		return mPlayer1Score;
+	}
+
+	int32_t ChaosMatch::Player2Score() const
+	{
+		return mPlayer2Score;
+	}
+
+	uint32_t ChaosMatch::Events() const
+	{
+		return mEvents;
+	}
+
+	uint64_t ChaosMatch::BallContacts() const
+	{
+		return mBallContacts;
+	}
+
+	const float* ChaosMatch::BallX() const
+	{
+		return mBallX.data();
+	}
+
+	const float* ChaosMatch::BallY() const
+	{
+		return mBallY.data();
+	}
+
+	const float* ChaosMatch::PreviousBallX() const
+	{
+		return mPreviousBallX.data();
+	}
+
+	const float* ChaosMatch::PreviousBallY() const
+	{
+		return mPreviousBallY.data();
+	}
+
+	const float* ChaosMatch::BallVelocityX() const
+	{
+		return mBallVelocityX.data();
+	}
+
+	const float* ChaosMatch::BallVelocityY() const
+	{
+		return mBallVelocityY.data();
+	}
+
+	const float* ChaosMatch::PaddleX() const
+	{
+		return mPaddleX.data();
+	}
+
+	const float* ChaosMatch::PaddleY() const
+	{
+		return mPaddleY.data();
+	}
+
+	const float* ChaosMatch::PreviousPaddleY() const
+	{
+		return mPreviousPaddleY.data();
+	}
+
+	Players ChaosMatch::PaddlePlayer(size_t index) const
+	{
+		return (index < mConfig.PaddlesPerSide ? Players::Player1 : Players::Player2);
+	}
+
+	void ChaosMatch::Step(const MatchInputs& inputs, float elapsedTime)
+	{
+		PONG_PROFILE_SCOPE("ChaosMatch::Step");
+		mEvents = MatchEvents::None;
+		mBallContacts = 0;
+
+		// plain copies of the columns, so drawing between steps needs nothing per ball
+		copy(mBallX.begin(), mBallX.end(), mPreviousBallX.begin());
+		copy(mBallY.begin(), mBallY.end(), mPreviousBallY.begin());
+		copy(mPaddleY.begin(), mPaddleY.end(), mPreviousPaddleY.begin());
+
+		MovePaddles(inputs, elapsedTime);
+		MoveBalls(elapsedTime);
+
+		{
+			PONG_PROFILE_SCOPE("SpatialGrid::Build");
+			mGrid.Build(mBallX.data(), mBallY.data(), mBallX.size());
+		}
+
+		CollideWithPaddles();
+		if (mConfig.BallCollisions)
+		{
+			CollideBalls();
+		}
+	}
+
+	void ChaosMatch::ServeBall(size_t index)
+	{
+		const MatchConfig& config = mConfig.Match;
+
+		// from anywhere on the center line, so a crowd of serves doesn't start in one pile; the top
+		// 24 bits of a word make an exact float in [0, 1), the same under every standard library
+		uint32_t block[MatchRandom::BlockSize];
+		mGenerator.NextBlock(block);
+		mBallX[index] = config.ViewportWidth / 2 - config.BallWidth / 2;
+		mBallY[index] = static_cast<float>(block[0] >> 8) / 16777216.0f * (config.ViewportHeight - config.BallHeight);
+
+		// drawn from the serve, not slid back across the arena
+		mPreviousBallX[index] = mBallX[index];
+		mPreviousBallY[index] = mBallY[index];
+
+		Vector2 velocity = Simulation::ServeVelocity(config, mGenerator);
+		mBallVelocityX[index] = velocity.X;
+		mBallVelocityY[index] = velocity.Y;
+	}
+
+	void ChaosMatch::MovePaddles(const MatchInputs& inputs, float elapsedTime)
+	{
+		const MatchConfig& config = mConfig.Match;
+
+		for (size_t i = 0; i < mPaddleY.size(); ++i)
+		{
+			Players player = PaddlePlayer(i);
+			PaddleControl control = (player == Players::Player1 ? mConfig.Player1Control : config.Player2Control);
+
+			float velocity;
+			if (control == PaddleControl::BuiltInAI)
+			{
+				velocity = Simulation::SteerAIPaddle(config, mPaddleY[i], mPaddleTargetY[i]);
+			}
+			else
+			{
+				const PaddleInputs& paddleInputs = (player == Players::Player1 ? inputs.Player1 : inputs.Player2);
+				velocity = (paddleInputs.Down ? config.PaddleSpeed : 0.0f) - (paddleInputs.Up ? config.PaddleSpeed : 0.0f);
+			}
+
+			// a paddle stays in its lane, even when the lane is shorter than the paddle
+			size_t lane = i % mConfig.PaddlesPerSide;
+			float top = lane * mLaneHeight;
+			float bottom = max(top, (lane + 1) * mLaneHeight - config.PaddleHeight);
+			mPaddleY[i] = min(max(mPaddleY[i] + velocity * elapsedTime, top), bottom);
+		}
+	}
+
+	void ChaosMatch::MoveBalls(float elapsedTime)
+	{
+		PONG_PROFILE_SCOPE("ChaosMatch::MoveBalls");
+		const MatchConfig& config = mConfig.Match;
+		float bottom = config.ViewportHeight - config.BallHeight;
+		float right = config.ViewportWidth - config.BallWidth;
+		float player1PlaneX = config.PaddleWallOffset + config.PaddleWidth;
+		float player2PlaneX = config.ViewportWidth - config.PaddleWallOffset - config.BallWidth;
+		uint32_t events = MatchEvents::None;
+
+		fill(mPaddleTargetTime.begin(), mPaddleTargetTime.end(), numeric_limits<float>::infinity());
+
+		for (size_t i = 0; i < mBallX.size(); ++i)
+		{
+			mBallX[i] += mBallVelocityX[i] * elapsedTime;
+			mBallY[i] += mBallVelocityY[i] * elapsedTime;
+
+			if ((mBallY[i] >= bottom && mBallVelocityY[i] > 0.0f) || (mBallY[i] <= 0.0f && mBallVelocityY[i] < 0.0f))
+			{
+				mBallVelocityY[i] *= -1.0f;
+				events |= MatchEvents::WallHit;
+			}
+
+			if (mBallX[i] >= right && mBallVelocityX[i] > 0.0f)
+			{
+				++mPlayer1Score;
+				events |= MatchEvents::Player1Scored;
+				ServeBall(i);
+			}
+			else if (mBallX[i] <= 0.0f && mBallVelocityX[i] < 0.0f)
+			{
+				++mPlayer2Score;
+				events |= MatchEvents::Player2Scored;
+				ServeBall(i);
+			}
+
+			// each AI paddle heads for whichever ball reaches its lane first
+			bool towardPlayer1 = (mBallVelocityX[i] < 0.0f);
+			float planeX = (towardPlayer1 ? player1PlaneX : player2PlaneX);
+			float time = (mBallVelocityX[i] != 0.0f ? (planeX - mBallX[i]) / mBallVelocityX[i] : -1.0f);
+			if (time >= 0.0f)
+			{
+				BallState ball;
+				ball.Bounds = Rect(mBallX[i], mBallY[i], config.BallWidth, config.BallHeight);
+				ball.Velocity = Vector2(mBallVelocityX[i], mBallVelocityY[i]);
+				float targetY = Simulation::PredictInterceptY(config, ball, planeX) + config.BallHeight / 2;
+
+				size_t lane = min(static_cast<size_t>(max(targetY, 0.0f) / mLaneHeight), static_cast<size_t>(mConfig.PaddlesPerSide - 1));
+				size_t paddle = (towardPlayer1 ? lane : mConfig.PaddlesPerSide + lane);
+				if (time < mPaddleTargetTime[paddle])
+				{
+					mPaddleTargetTime[paddle] = time;
+					mPaddleTargetY[paddle] = targetY;
+				}
+			}
+		}
+
+		mEvents |= events;
+	}
+
+	void ChaosMatch::CollideWithPaddles()
+	{
+		PONG_PROFILE_SCOPE("ChaosMatch::CollideWithPaddles");
+		const MatchConfig& config = mConfig.Match;
+
+		for (size_t p = 0; p < mPaddleX.size(); ++p)
+		{
+			Rect paddle(mPaddleX[p], mPaddleY[p], config.PaddleWidth, config.PaddleHeight);
+			bool player1 = (PaddlePlayer(p) == Players::Player1);
+
+			// balls are filed by their top-left corner, so one touching the paddle is filed up to a ball's size above and left of it
+			uint32_t firstColumn = mGrid.Column(paddle.Left() - config.BallWidth);
+			uint32_t lastColumn = mGrid.Column(paddle.Right());
+			uint32_t firstRow = mGrid.Row(paddle.Top() - config.BallHeight);
+			uint32_t lastRow = mGrid.Row(paddle.Bottom());
+
+			for (uint32_t row = firstRow; row <= lastRow; ++row)
+			{
+				for (uint32_t column = firstColumn; column <= lastColumn; ++column)
+				{
+					for (const uint32_t* ball = mGrid.CellBegin(column, row); ball != mGrid.CellEnd(column, row); ++ball)
+					{
+						// only the face that looks at the center bounces, as in a normal match
+						float& velocityX = mBallVelocityX[*ball];
+						bool approaching = (player1 ? velocityX < 0.0f : velocityX > 0.0f);
+						if (approaching && paddle.Intersects(Rect(mBallX[*ball], mBallY[*ball], config.BallWidth, config.BallHeight)))
+						{
+							velocityX *= -1.0f;
+							mEvents |= MatchEvents::PaddleHit;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void ChaosMatch::CollideBalls()
+	{
+		PONG_PROFILE_SCOPE("ChaosMatch::CollideBalls");
+
+		// each pair is tested once: the rest of the ball's own cell, then the four neighbours ahead of it
+		const int32_t neighbourColumns[] = { 1, -1, 0, 1 };
+		const int32_t neighbourRows[] = { 0, 1, 1, 1 };
+		int32_t columnCount = static_cast<int32_t>(mGrid.ColumnCount());
+		int32_t rowCount = static_cast<int32_t>(mGrid.RowCount());
+
+		for (int32_t row = 0; row < rowCount; ++row)
+		{
+			for (int32_t column = 0; column < columnCount; ++column)
+			{
+				const uint32_t* cellEnd = mGrid.CellEnd(column, row);
+				for (const uint32_t* first = mGrid.CellBegin(column, row); first != cellEnd; ++first)
+				{
+					for (const uint32_t* second = first + 1; second != cellEnd; ++second)
+					{
+						CollideBallPair(*first, *second);
+					}
+
+					for (size_t n = 0; n < 4; ++n)
+					{
+						int32_t neighbourColumn = column + neighbourColumns[n];
+						int32_t neighbourRow = row + neighbourRows[n];
+						if (neighbourColumn < 0 || neighbourColumn >= columnCount || neighbourRow >= rowCount)
+						{
+							continue;
+						}
+
+						const uint32_t* neighbourEnd = mGrid.CellEnd(neighbourColumn, neighbourRow);
+						for (const uint32_t* second = mGrid.CellBegin(neighbourColumn, neighbourRow); second != neighbourEnd; ++second)
+						{
+							CollideBallPair(*first, *second);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void ChaosMatch::CollideBallPair(uint32_t first, uint32_t second)
+	{
+		const MatchConfig& config = mConfig.Match;
+		float offsetX = mBallX[second] - mBallX[first];
+		float offsetY = mBallY[second] - mBallY[first];
+		float overlapX = config.BallWidth - fabs(offsetX);
+		float overlapY = config.BallHeight - fabs(offsetY);
+		if (overlapX <= 0.0f || overlapY <= 0.0f)
+		{
+			return;
+		}
+
+		// equal masses swap their velocities along the axis they overlap least on, then part
+		if (overlapX < overlapY)
+		{
+			float direction = (offsetX < 0.0f ? -1.0f : 1.0f);
+			if ((mBallVelocityX[second] - mBallVelocityX[first]) * direction < 0.0f)
+			{
+				swap(mBallVelocityX[first], mBallVelocityX[second]);
+			}
+			mBallX[first] -= direction * overlapX / 2;
+			mBallX[second] += direction * overlapX / 2;
+		}
+		else
+		{
+			float direction = (offsetY < 0.0f ? -1.0f : 1.0f);
+			if ((mBallVelocityY[second] - mBallVelocityY[first]) * direction < 0.0f)
+			{
+				swap(mBallVelocityY[first], mBallVelocityY[second]);
+			}
+			mBallY[first] -= direction * overlapY / 2;
+			mBallY[second] += direction * overlapY / 2;
+		}
+
+		++mBallContacts;
+	}
+}
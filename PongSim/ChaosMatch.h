@@ -0,0 +1,90 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+#include "MatchConfig.h"
+#include "MatchInputs.h"
+#include "MatchState.h"
+#include "SpatialGrid.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pong
+{
+	struct ChaosConfig final
+	{
+		MatchConfig Match; // the arena, sizes and speeds; only Player2Control of the control settings is read
+		uint32_t BallCount = 64;
+		uint32_t PaddlesPerSide = 3; // each guards an equal horizontal lane of its side
+		bool BallCollisions = true;
+		PaddleControl Player1Control = PaddleControl::Inputs;
+	};
+
+	// Multi-ball mode: any number of balls and paddles in one arena, kept in contiguous columns
+	// rather than one object each. Every step files the balls in a SpatialGrid, so ball-paddle
+	// and ball-ball contacts only test neighbours and the cost per ball stays flat however many
+	// there are. A ball that leaves the arena scores for the other side and is served again from
+	// the center line; the match never ends.
+	//
+	// Player 1's paddles all follow player 1's inputs, and player 2's player 2's, unless they are
+	// the built-in AI, where each paddle chases the ball that will reach its lane first.
+	class ChaosMatch final
+	{
+	public:
+		ChaosMatch(const ChaosConfig& config, uint32_t seed);
+
+		const ChaosConfig& Config() const;
+		std::size_t BallCount() const;
+		std::size_t PaddleCount() const;
+		int32_t Player1Score() const;
+		int32_t Player2Score() const;
+		uint32_t Events() const; // MatchEvents from the last step
+		uint64_t BallContacts() const; // ball-ball contacts resolved in the last step
+
+		void Step(const MatchInputs& inputs, float elapsedTime);
+
+		// where everything was before the last step, for drawing between steps
+		const float* BallX() const;
+		const float* BallY() const;
+		const float* PreviousBallX() const;
+		const float* PreviousBallY() const;
+		const float* BallVelocityX() const;
+		const float* BallVelocityY() const;
+
+		// player 1's paddles come first
+		const float* PaddleX() const;
+		const float* PaddleY() const;
+		const float* PreviousPaddleY() const;
+		Players PaddlePlayer(std::size_t index) const;
+
+	private:
+		void ServeBall(std::size_t index);
+		void MovePaddles(const MatchInputs& inputs, float elapsedTime);
+		void MoveBalls(float elapsedTime);
+		void CollideWithPaddles();
+		void CollideBalls();
+		void CollideBallPair(uint32_t first, uint32_t second);
+
+		ChaosConfig mConfig;
+		MatchRandom mGenerator;
+		SpatialGrid mGrid;
+		int32_t mPlayer1Score = 0;
+		int32_t mPlayer2Score = 0;
+		uint32_t mEvents = 0;
+		uint64_t mBallContacts = 0;
+		float mLaneHeight;
+
+		AlignedVector<float> mBallX;
+		AlignedVector<float> mBallY;
+		AlignedVector<float> mPreviousBallX;
+		AlignedVector<float> mPreviousBallY;
+		AlignedVector<float> mBallVelocityX;
+		AlignedVector<float> mBallVelocityY;
+
+		std::vector<float> mPaddleX;
+		std::vector<float> mPaddleY;
+		std::vector<float> mPreviousPaddleY;
+		std::vector<float> mPaddleTargetY; // where each AI paddle is heading
+		std::vector<float> mPaddleTargetTime; // how soon the ball it's heading for arrives
+	};
+}
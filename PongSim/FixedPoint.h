@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace Pong
+{
+	// Q16.16 fixed point: integer arithmetic only, so every compiler and CPU gets the same bits.
+	// Products round to nearest, with halves away from zero, and quotients truncate toward zero,
+	// both defined in terms of 64-bit integer division so nothing depends on how a compiler
+	// shifts negative numbers.
+	struct Fixed final
+	{
+		static const int32_t FractionBits = 16;
+		static const int32_t One = 1 << FractionBits;
+
+		int32_t Raw;
+
+		Fixed() : Raw(0) { }
+
+		static Fixed FromRaw(int32_t raw) { Fixed value; value.Raw = raw; return value; }
+		static Fixed FromInt(int32_t value) { return FromRaw(value * One); }
+
+		// exact in double, so the only rounding is the one explicit step
+		static Fixed FromFloat(float value) { return FromRaw(static_cast<int32_t>(std::floor(static_cast<double>(value) * One + 0.5))); }
+		float ToFloat() const { return static_cast<float>(Raw) / One; }
+
+		Fixed Half() const { return FromRaw(Raw / 2); }
+
+		Fixed operator-() const { return FromRaw(-Raw); }
+		Fixed operator+(Fixed other) const { return FromRaw(Raw + other.Raw); }
+		Fixed operator-(Fixed other) const { return FromRaw(Raw - other.Raw); }
+		Fixed& operator+=(Fixed other) { Raw += other.Raw; return *this; }
+		Fixed& operator-=(Fixed other) { Raw -= other.Raw; return *this; }
+
+		Fixed operator*(Fixed other) const
+		{
+			int64_t product = static_cast<int64_t>(Raw) * other.Raw;
+			return FromRaw(static_cast<int32_t>((product + (product >= 0 ? One / 2 : -One / 2)) / One));
+		}
+
+		Fixed operator/(Fixed other) const
+		{
+			return FromRaw(static_cast<int32_t>(static_cast<int64_t>(Raw) * One / other.Raw));
+		}
+
+		bool operator==(Fixed other) const { return Raw == other.Raw; }
+		bool operator!=(Fixed other) const { return Raw != other.Raw; }
+		bool operator<(Fixed other) const { return Raw < other.Raw; }
+		bool operator<=(Fixed other) const { return Raw <= other.Raw; }
+		bool operator>(Fixed other) const { return Raw > other.Raw; }
+		bool operator>=(Fixed other) const { return Raw >= other.Raw; }
+	};
+}
@@ -0,0 +1,567 @@
+#include "pch.h"
+#include "FixedSimulation.h"
+#include "Profiler.h"
+#include "Simulation.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		struct FixedConfig final
+		{
+			Fixed ViewportWidth;
+			Fixed ViewportHeight;
+			Fixed BallWidth;
+			Fixed BallHeight;
+			Fixed PaddleWidth;
+			Fixed PaddleHeight;
+			Fixed PaddleWallOffset;
+			Fixed PaddleSpeed;
+			Fixed AIError;
+
+			explicit FixedConfig(const MatchConfig& config) :
+				ViewportWidth(Fixed::FromFloat(config.ViewportWidth)), ViewportHeight(Fixed::FromFloat(config.ViewportHeight)),
+				BallWidth(Fixed::FromFloat(config.BallWidth)), BallHeight(Fixed::FromFloat(config.BallHeight)),
+				PaddleWidth(Fixed::FromFloat(config.PaddleWidth)), PaddleHeight(Fixed::FromFloat(config.PaddleHeight)),
+				PaddleWallOffset(Fixed::FromFloat(config.PaddleWallOffset)), PaddleSpeed(Fixed::FromFloat(config.PaddleSpeed)),
+				AIError(Fixed::FromFloat(config.AIError))
+			{
+			}
+		};
+
+		Fixed Max(Fixed left, Fixed right)
+		{
+			return (left < right ? right : left);
+		}
+
+		bool Intersects(const FixedBody& left, const FixedBody& right)
+		{
+			return right.X < left.X + left.Width && left.X < right.X + right.Width && right.Y < left.Y + left.Height && left.Y < right.Y + right.Height;
+		}
+
+		void ResetBall(MatchState& match, const FixedConfig& config)
+		{
+			FixedBody& ball = match.FixedState.Ball;
+
+			match.Ball.Player1Scored = false;
+			match.Ball.Player2Scored = false;
+			ball.X = config.ViewportWidth.Half() - config.BallWidth.Half();
+			ball.Y = config.ViewportHeight.Half() - config.BallHeight.Half();
+
+			// whole pixels a second, which convert exactly
+			Vector2 velocity = Simulation::ServeVelocity(match.Config, match.Generator);
+			ball.VelocityX = Fixed::FromFloat(velocity.X);
+			ball.VelocityY = Fixed::FromFloat(velocity.Y);
+			match.AIPlanDirection = 0;
+		}
+
+		void ResetPaddle(const MatchConfig& matchConfig, const FixedConfig& config, const PaddleState& player, FixedBody& paddle)
+		{
+			paddle.VelocityX = Fixed();
+			paddle.VelocityY = (Simulation::IsAIPaddle(matchConfig, player) ? Fixed() : config.PaddleSpeed);
+			paddle.X = (player.Player == Players::Player1 ? config.PaddleWallOffset : config.ViewportWidth - config.PaddleWallOffset);
+			paddle.Y = config.ViewportHeight.Half() - config.PaddleHeight.Half();
+		}
+
+		void FreezeMotion(FixedMatchState& state)
+		{
+			state.Paddle1.VelocityX = state.Paddle1.VelocityY = Fixed();
+			state.Paddle2.VelocityX = state.Paddle2.VelocityY = Fixed();
+			state.Ball.VelocityX = state.Ball.VelocityY = Fixed();
+		}
+
+		void ChangeGamestate(MatchState& match, const FixedConfig& config, Gamestate newGamestate)
+		{
+			if (match.Gamestate == Gamestate::Initial || match.Gamestate == Gamestate::Gameover)
+			{
+				// transitioning to playing
+				ResetBall(match, config);
+				ResetPaddle(match.Config, config, match.Paddle1, match.FixedState.Paddle1);
+				ResetPaddle(match.Config, config, match.Paddle2, match.FixedState.Paddle2);
+				match.Player1Score = 0;
+				match.Player2Score = 0;
+				match.Events |= MatchEvents::GameStarted;
+			}
+			else if (match.Gamestate == Gamestate::Playing)
+			{
+				// transitioning to gameover
+				FreezeMotion(match.FixedState);
+				match.Events |= MatchEvents::GameOver;
+			}
+
+			match.Gamestate = newGamestate;
+		}
+
+		void HandleBallPhysics(MatchState& match)
+		{
+			FixedMatchState& state = match.FixedState;
+			bool discrete = (match.Config.Collision == CollisionMode::Discrete);
+			bool paddle1Intersects = discrete && Intersects(state.Ball, state.Paddle1);
+			bool paddle2Intersects = discrete && Intersects(state.Ball, state.Paddle2);
+
+			if (paddle1Intersects || paddle2Intersects)
+			{
+				if (paddle2Intersects && Simulation::IsAIPaddle(match.Config, match.Paddle2))
+				{
+					state.Paddle2.VelocityY = Fixed();
+				}
+
+				if (!match.IsIntersecting)
+				{
+					state.Ball.VelocityX = -state.Ball.VelocityX;
+					match.IsIntersecting = true;
+					match.Events |= MatchEvents::PaddleHit;
+				}
+			}
+			else
+			{
+				match.IsIntersecting = false;
+			}
+
+			if (match.Ball.HitWall)
+			{
+				match.Ball.HitWall = false;
+				match.Events |= MatchEvents::WallHit;
+			}
+		}
+
+		void AdjustAIPaddleVelocity(MatchState& match, const FixedConfig& config)
+		{
+			const FixedBody& ball = match.FixedState.Ball;
+			FixedBody& paddle = match.FixedState.Paddle2;
+			int32_t seconds = static_cast<int32_t>(match.FixedState.TotalTime / Fixed::One);
+
+			if (ball.VelocityX < Fixed() || seconds % match.Config.AIDelay == 0)
+			{
+				paddle.VelocityY = Fixed();
+			}
+			else if (ball.Y > paddle.Y + paddle.Height && paddle.VelocityY <= Fixed())
+			{
+				paddle.VelocityY = config.PaddleSpeed;
+			}
+			else if (ball.Y + ball.Height < paddle.Y && paddle.VelocityY >= Fixed())
+			{
+				paddle.VelocityY = -config.PaddleSpeed;
+			}
+		}
+
+		Fixed PredictInterceptY(const FixedConfig& config, const FixedBody& ball, Fixed planeX)
+		{
+			Fixed time = (ball.VelocityX != Fixed() ? (planeX - ball.X) / ball.VelocityX : Fixed());
+			time = Max(time, Fixed());
+
+			// far past the arena on a long flight, so the fold is done in 64 bits
+			int64_t travel = static_cast<int64_t>(ball.VelocityY.Raw) * time.Raw;
+			int64_t y = ball.Y.Raw + (travel + (travel >= 0 ? Fixed::One / 2 : -Fixed::One / 2)) / Fixed::One;
+
+			int64_t span = (config.ViewportHeight - config.BallHeight).Raw;
+			int64_t phase = y % (2 * span);
+			if (phase < 0)
+			{
+				phase += 2 * span;
+			}
+
+			return Fixed::FromRaw(static_cast<int32_t>(phase > span ? 2 * span - phase : phase));
+		}
+
+		Fixed PlanAITarget(const FixedConfig& config, const FixedBody& ball, MatchRandom& generator)
+		{
+			if (ball.VelocityX <= Fixed())
+			{
+				return config.ViewportHeight.Half();
+			}
+
+			Fixed planeX = config.ViewportWidth - config.PaddleWallOffset - config.BallWidth;
+			Fixed targetY = PredictInterceptY(config, ball, planeX) + config.BallHeight.Half();
+
+			if (config.AIError > Fixed())
+			{
+				// anywhere from -AIError to AIError, by where the draw falls in the generator's range
+				int64_t range = MatchRandom::max();
+				int64_t draw = generator();
+				targetY += Fixed::FromRaw(static_cast<int32_t>((2 * draw - range) * config.AIError.Raw / range));
+			}
+
+			return targetY;
+		}
+
+		Fixed SteerAIPaddle(const FixedConfig& config, Fixed paddleY, Fixed targetY)
+		{
+			Fixed offset = targetY - (paddleY + config.PaddleHeight.Half());
+			Fixed tolerance = config.PaddleHeight.Half().Half();
+
+			if (offset > tolerance)
+			{
+				return config.PaddleSpeed;
+			}
+			else if (offset < -tolerance)
+			{
+				return -config.PaddleSpeed;
+			}
+
+			return Fixed();
+		}
+
+		void AdjustPredictiveAIPaddleVelocity(MatchState& match, const FixedConfig& config)
+		{
+			FixedMatchState& state = match.FixedState;
+			int32_t direction = (state.Ball.VelocityX > Fixed()) - (state.Ball.VelocityX < Fixed());
+			if (direction != match.AIPlanDirection)
+			{
+				state.AITargetY = PlanAITarget(config, state.Ball, match.Generator);
+				match.AIPlanDirection = direction;
+			}
+
+			state.Paddle2.VelocityY = SteerAIPaddle(config, state.Paddle2.Y, state.AITargetY);
+		}
+
+		void UpdatePlayerScores(MatchState& match, const FixedConfig& config)
+		{
+			if (match.Ball.Player1Scored)
+			{
+				match.Events |= MatchEvents::Player1Scored;
+				match.Player1Score++;
+				if (match.Player1Score < match.Config.MaxScore)
+				{
+					ResetBall(match, config);
+				}
+				else
+				{
+					ChangeGamestate(match, config, Gamestate::Gameover);
+				}
+			}
+			else if (match.Ball.Player2Scored)
+			{
+				match.Events |= MatchEvents::Player2Scored;
+				match.Player2Score++;
+				if (match.Player2Score < match.Config.MaxScore)
+				{
+					ResetBall(match, config);
+				}
+				else
+				{
+					ChangeGamestate(match, config, Gamestate::Gameover);
+				}
+			}
+		}
+
+		void CheckBallBounds(MatchState& match, const FixedConfig& config)
+		{
+			FixedBody& ball = match.FixedState.Ball;
+
+			if (ball.X + ball.Width >= config.ViewportWidth && ball.VelocityX > Fixed())
+			{
+				match.Ball.Player1Scored = true;
+			}
+			if (ball.X <= Fixed() && ball.VelocityX < Fixed())
+			{
+				match.Ball.Player2Scored = true;
+			}
+
+			if (ball.Y + ball.Height >= config.ViewportHeight && ball.VelocityY > Fixed())
+			{
+				match.Ball.HitWall = true;
+				ball.VelocityY = -ball.VelocityY;
+			}
+			if (ball.Y <= Fixed() && ball.VelocityY < Fixed())
+			{
+				match.Ball.HitWall = true;
+				ball.VelocityY = -ball.VelocityY;
+			}
+		}
+
+		void UpdateBall(MatchState& match, const FixedConfig& config, Fixed elapsed)
+		{
+			FixedBody& ball = match.FixedState.Ball;
+			ball.X += ball.VelocityX * elapsed;
+			ball.Y += ball.VelocityY * elapsed;
+
+			CheckBallBounds(match, config);
+		}
+
+		// where a paddle is a fraction of the way through the step
+		Fixed PaddleYAt(const FixedBody& start, const FixedBody& end, Fixed elapsed, Fixed time)
+		{
+			Fixed fraction = (elapsed > Fixed() ? time / elapsed : Fixed::FromInt(1));
+			return start.Y + (end.Y - start.Y) * fraction;
+		}
+
+		void SweepBall(MatchState& match, const FixedConfig& config, Fixed elapsed, const FixedBody& paddle1Start, const FixedBody& paddle2Start)
+		{
+			FixedMatchState& state = match.FixedState;
+			FixedBody& ball = state.Ball;
+			const FixedBody& paddle1 = state.Paddle1;
+			const FixedBody& paddle2 = state.Paddle2;
+			Fixed remainingTime = elapsed;
+
+			// the same sweep as Simulation::SweepBall, contact by contact
+			for (int32_t contact = 0; contact <= match.Config.MaxSweepContacts; ++contact)
+			{
+				Fixed x = ball.X;
+				Fixed y = ball.Y;
+				Fixed velocityX = ball.VelocityX;
+				Fixed velocityY = ball.VelocityY;
+				Fixed hitTime = remainingTime;
+				int32_t surface = 0; // 1 wall, 2 paddle 1, 3 paddle 2
+
+				if (velocityY > Fixed())
+				{
+					Fixed time = Max((config.ViewportHeight - ball.Height - y) / velocityY, Fixed());
+					if (time < hitTime)
+					{
+						hitTime = time;
+						surface = 1;
+					}
+				}
+				else if (velocityY < Fixed())
+				{
+					Fixed time = Max(-y / velocityY, Fixed());
+					if (time < hitTime)
+					{
+						hitTime = time;
+						surface = 1;
+					}
+				}
+
+				if (velocityX < Fixed())
+				{
+					Fixed face = paddle1.X + paddle1.Width;
+					if (x >= face)
+					{
+						Fixed time = (face - x) / velocityX;
+						Fixed contactY = y + velocityY * time;
+						Fixed paddleY = PaddleYAt(paddle1Start, paddle1, elapsed, elapsed - remainingTime + time);
+						if (time < hitTime && paddleY < contactY + ball.Height && contactY < paddleY + paddle1.Height)
+						{
+							hitTime = time;
+							surface = 2;
+						}
+					}
+				}
+				else if (velocityX > Fixed())
+				{
+					Fixed face = paddle2.X - ball.Width;
+					if (x <= face)
+					{
+						Fixed time = (face - x) / velocityX;
+						Fixed contactY = y + velocityY * time;
+						Fixed paddleY = PaddleYAt(paddle2Start, paddle2, elapsed, elapsed - remainingTime + time);
+						if (time < hitTime && paddleY < contactY + ball.Height && contactY < paddleY + paddle2.Height)
+						{
+							hitTime = time;
+							surface = 3;
+						}
+					}
+				}
+
+				ball.X = x + velocityX * hitTime;
+				ball.Y = y + velocityY * hitTime;
+				remainingTime -= hitTime;
+
+				if (surface == 0)
+				{
+					break;
+				}
+				else if (surface == 1)
+				{
+					ball.VelocityY = -ball.VelocityY;
+					match.Events |= MatchEvents::WallHit;
+				}
+				else
+				{
+					ball.VelocityX = -ball.VelocityX;
+					match.Events |= MatchEvents::PaddleHit;
+					if (surface == 3 && Simulation::IsAIPaddle(match.Config, match.Paddle2))
+					{
+						state.Paddle2.VelocityY = Fixed();
+					}
+				}
+			}
+		}
+
+		void UpdateHumanPaddle(const FixedConfig& config, FixedBody& paddle, const PaddleInputs& inputs, Fixed elapsed)
+		{
+			bool atBottomBoundary = (paddle.Y + paddle.Height >= config.ViewportHeight);
+			bool atTopBoundary = (paddle.Y <= Fixed());
+
+			if (inputs.Up && !atTopBoundary)
+			{
+				paddle.Y -= paddle.VelocityY * elapsed;
+			}
+			if (inputs.Down && !atBottomBoundary)
+			{
+				paddle.Y += paddle.VelocityY * elapsed;
+			}
+		}
+
+		void UpdateAIPaddle(const FixedConfig& config, FixedBody& paddle, Fixed elapsed)
+		{
+			paddle.Y += paddle.VelocityY * elapsed;
+
+			if (paddle.Y + paddle.Height >= config.ViewportHeight && paddle.VelocityY > Fixed())
+			{
+				paddle.Y = config.ViewportHeight - paddle.Height;
+			}
+			if (paddle.Y <= Fixed() && paddle.VelocityY < Fixed())
+			{
+				paddle.Y = Fixed();
+			}
+		}
+
+		void UpdatePaddle2(MatchState& match, const FixedConfig& config, const MatchInputs& inputs, Fixed elapsed)
+		{
+			if (Simulation::IsAIPaddle(match.Config, match.Paddle2))
+			{
+				UpdateAIPaddle(config, match.FixedState.Paddle2, elapsed);
+			}
+			else
+			{
+				UpdateHumanPaddle(config, match.FixedState.Paddle2, inputs.Player2, elapsed);
+			}
+		}
+
+		void StoreBody(const FixedBody& body, Rect& bounds, Vector2& velocity)
+		{
+			bounds = Rect(body.X.ToFloat(), body.Y.ToFloat(), body.Width.ToFloat(), body.Height.ToFloat());
+			velocity = Vector2(body.VelocityX.ToFloat(), body.VelocityY.ToFloat());
+		}
+
+		// the float copies everything else reads
+		void Store(MatchState& match)
+		{
+			const FixedMatchState& state = match.FixedState;
+			StoreBody(state.Ball, match.Ball.Bounds, match.Ball.Velocity);
+			StoreBody(state.Paddle1, match.Paddle1.Bounds, match.Paddle1.Velocity);
+			StoreBody(state.Paddle2, match.Paddle2.Bounds, match.Paddle2.Velocity);
+			match.TotalTime = static_cast<double>(state.TotalTime) / Fixed::One;
+			match.AITargetY = state.AITargetY.ToFloat();
+		}
+
+		// FNV-1a over whole values, so the hash doesn't depend on struct padding
+		struct Hasher final
+		{
+			uint64_t Value = 14695981039346656037ull;
+
+			void Add(int64_t value)
+			{
+				for (int32_t byte = 0; byte < 8; ++byte)
+				{
+					Value = (Value ^ static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * byte))) * 1099511628211ull;
+				}
+			}
+
+			void Add(const FixedBody& body)
+			{
+				Add(body.X.Raw);
+				Add(body.Y.Raw);
+				Add(body.Width.Raw);
+				Add(body.Height.Raw);
+				Add(body.VelocityX.Raw);
+				Add(body.VelocityY.Raw);
+			}
+		};
+	}
+
+	void FixedSimulation::Reset(MatchState& match)
+	{
+		FixedConfig config(match.Config);
+		FixedMatchState& state = match.FixedState;
+		state = FixedMatchState();
+		state.Ball.Width = config.BallWidth;
+		state.Ball.Height = config.BallHeight;
+		state.Paddle1.Width = state.Paddle2.Width = config.PaddleWidth;
+		state.Paddle1.Height = state.Paddle2.Height = config.PaddleHeight;
+
+		ResetBall(match, config);
+		ResetPaddle(match.Config, config, match.Paddle1, state.Paddle1);
+		ResetPaddle(match.Config, config, match.Paddle2, state.Paddle2);
+		FreezeMotion(state);
+		Store(match);
+	}
+
+	void FixedSimulation::Step(MatchState& match, const MatchInputs& inputs, float elapsedTime)
+	{
+		PONG_PROFILE_SCOPE("FixedSimulation::Step");
+		FixedConfig config(match.Config);
+		FixedMatchState& state = match.FixedState;
+		Fixed elapsed = Fixed::FromFloat(elapsedTime);
+		match.Events = MatchEvents::None;
+		state.TotalTime += elapsed.Raw;
+
+		if (match.Gamestate != Gamestate::Playing && inputs.Start)
+		{
+			ChangeGamestate(match, config, Gamestate::Playing);
+		}
+
+		if (match.Gamestate == Gamestate::Playing)
+		{
+			HandleBallPhysics(match);
+			if (Simulation::IsAIPaddle(match.Config, match.Paddle2))
+			{
+				if (match.Config.AI == AIMode::Predictive)
+				{
+					AdjustPredictiveAIPaddleVelocity(match, config);
+				}
+				else
+				{
+					AdjustAIPaddleVelocity(match, config);
+				}
+			}
+			UpdatePlayerScores(match, config);
+		}
+
+		Fixed startX = state.Ball.X;
+		if (match.Config.Collision == CollisionMode::Swept)
+		{
+			FixedBody paddle1Start = state.Paddle1;
+			FixedBody paddle2Start = state.Paddle2;
+			UpdateHumanPaddle(config, state.Paddle1, inputs.Player1, elapsed);
+			UpdatePaddle2(match, config, inputs, elapsed);
+			SweepBall(match, config, elapsed, paddle1Start, paddle2Start);
+			CheckBallBounds(match, config);
+		}
+		else
+		{
+			UpdateBall(match, config, elapsed);
+			UpdateHumanPaddle(config, state.Paddle1, inputs.Player1, elapsed);
+			UpdatePaddle2(match, config, inputs, elapsed);
+		}
+
+		Fixed paddle1Face = state.Paddle1.X + state.Paddle1.Width;
+		Fixed paddle2Face = state.Paddle2.X - state.Ball.Width;
+		if (startX >= paddle1Face && state.Ball.X < paddle1Face)
+		{
+			match.Events |= MatchEvents::PassedPaddle1;
+		}
+		if (startX < paddle2Face && state.Ball.X >= paddle2Face)
+		{
+			match.Events |= MatchEvents::PassedPaddle2;
+		}
+
+		Store(match);
+	}
+
+	uint64_t FixedSimulation::StateHash(const MatchState& match)
+	{
+		const FixedMatchState& state = match.FixedState;
+		Hasher hasher;
+		hasher.Add(state.Ball);
+		hasher.Add(state.Paddle1);
+		hasher.Add(state.Paddle2);
+		hasher.Add(state.TotalTime);
+		hasher.Add(state.AITargetY.Raw);
+		hasher.Add(match.Player1Score);
+		hasher.Add(match.Player2Score);
+		hasher.Add(static_cast<int64_t>(match.Gamestate));
+		hasher.Add(match.Ball.Player1Scored | match.Ball.Player2Scored << 1 | match.Ball.HitWall << 2 | match.IsIntersecting << 3);
+		hasher.Add(match.AIPlanDirection);
+		hasher.Add(match.Events);
+		hasher.Add(match.Generator.Seed());
+		hasher.Add(match.Generator.Stream());
+		hasher.Add(static_cast<int64_t>(match.Generator.Counter()));
+
+		return hasher.Value;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "MatchState.h"
+#include "MatchInputs.h"
+
+namespace Pong
+{
+	// Simulation's rules over FixedMatchState, for PhysicsMode::FixedPoint. Simulation hands
+	// over to this, so callers only ever go through Simulation. Nothing in a step depends on how a
+	// float rounds: the config and step length convert exactly, serves are whole numbers, and the
+	// AI's delay runs off the fixed clock. Two builds that agree on StateHash after the same
+	// inputs have simulated the same match.
+	class FixedSimulation final
+	{
+	public:
+		FixedSimulation() = delete;
+		FixedSimulation(const FixedSimulation&) = delete;
+		FixedSimulation& operator=(const FixedSimulation&) = delete;
+
+		// for CreateMatch, after it has set up the players
+		static void Reset(MatchState& match);
+		static void Step(MatchState& match, const MatchInputs& inputs, float elapsedTime);
+
+		// everything a step reads or writes, leaving out the float copies
+		static uint64_t StateHash(const MatchState& match);
+	};
+}
@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "FixedTimestep.h"
+
+using namespace std;
+
+namespace Pong
+{
+	const float FixedTimestep::DefaultStepsPerSecond = 120.0f;
+	const uint32_t FixedTimestep::DefaultMaxStepsPerAdvance = 8;
+
+	FixedTimestep::FixedTimestep(float stepsPerSecond, uint32_t maxStepsPerAdvance) :
+		mStepSeconds(1.0 / stepsPerSecond), mAccumulator(0.0), mMaxStepsPerAdvance(maxStepsPerAdvance)
+	{
+		if (stepsPerSecond <= 0.0f || maxStepsPerAdvance == 0)
+		{
+			throw invalid_argument("FixedTimestep needs a positive step rate and step budget.");
+		}
+	}
+
+	float FixedTimestep::StepSeconds() const
+	{
+		return static_cast<float>(mStepSeconds);
+	}
+
+	float FixedTimestep::Alpha() const
+	{
+		return static_cast<float>(mAccumulator / mStepSeconds);
+	}
+
+	uint32_t FixedTimestep::Advance(float elapsedSeconds)
+	{
+		mAccumulator += elapsedSeconds;
+
+		uint32_t steps = static_cast<uint32_t>(mAccumulator / mStepSeconds);
+		if (steps > mMaxStepsPerAdvance)
+		{
+			// after a long stall, drop the backlog instead of spiralling
+			steps = mMaxStepsPerAdvance;
+			mAccumulator = 0.0;
+		}
+		else
+		{
+			mAccumulator -= steps * mStepSeconds;
+		}
+
+		return steps;
+	}
+
+	void FixedTimestep::Reset()
+	{
+		mAccumulator = 0.0;
+	}
+
+	void FixedTimestep::SetAlpha(float alpha)
+	{
+		mAccumulator = alpha * mStepSeconds;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Pong
+{
+	// Accumulates real frame time and hands out a whole number of fixed-length simulation steps,
+	// so gameplay runs the same no matter how fast the display refreshes. Alpha is how far the
+	// renderer is between the last two simulated states.
+	class FixedTimestep final
+	{
+	public:
+		static const float DefaultStepsPerSecond;
+		static const uint32_t DefaultMaxStepsPerAdvance;
+
+		explicit FixedTimestep(float stepsPerSecond = DefaultStepsPerSecond, uint32_t maxStepsPerAdvance = DefaultMaxStepsPerAdvance);
+
+		float StepSeconds() const;
+		float Alpha() const;
+
+		uint32_t Advance(float elapsedSeconds);
+		void Reset();
+
+		// for a simulation stepped elsewhere, such as on a SimulationThread
+		void SetAlpha(float alpha);
+
+	private:
+		double mStepSeconds;
+		double mAccumulator;
+		uint32_t mMaxStepsPerAdvance;
+	};
+}
@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "FramePacing.h"
+#include <thread>
+
+using namespace std;
+
+namespace Pong
+{
+	void FrameTimingStats::Record(double frameSeconds, double latencySeconds)
+	{
+		++mFrames;
+		mFrameSum += frameSeconds;
+		mFrameSquares += frameSeconds * frameSeconds;
+		mMaxFrame = max(mMaxFrame, frameSeconds);
+		mLatencySum += latencySeconds;
+		mMaxLatency = max(mMaxLatency, latencySeconds);
+	}
+
+	FrameTimingSummary FrameTimingStats::Summarize() const
+	{
+		FrameTimingSummary summary;
+		summary.Frames = mFrames;
+		if (mFrames == 0)
+		{
+			return summary;
+		}
+
+		double count = static_cast<double>(mFrames);
+		summary.MeanFrameSeconds = mFrameSum / count;
+		summary.FrameDeviationSeconds = sqrt(max(mFrameSquares / count - summary.MeanFrameSeconds * summary.MeanFrameSeconds, 0.0));
+		summary.MaxFrameSeconds = mMaxFrame;
+		summary.MeanLatencySeconds = mLatencySum / count;
+		summary.MaxLatencySeconds = mMaxLatency;
+		return summary;
+	}
+
+	FrameLimiter::FrameLimiter(double framesPerSecond) :
+		mPeriod(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(1.0 / framesPerSecond))), mStarted(false)
+	{
+		if (!(framesPerSecond > 0.0))
+		{
+			throw invalid_argument("A frame limiter needs a positive frame rate.");
+		}
+	}
+
+	double FrameLimiter::FramesPerSecond() const
+	{
+		return 1.0 / chrono::duration<double>(mPeriod).count();
+	}
+
+	void FrameLimiter::Wait()
+	{
+		const chrono::milliseconds SpinTime(1);
+		auto now = chrono::steady_clock::now();
+		if (!mStarted || now - mDueTime > mPeriod)
+		{
+			mStarted = true;
+			mDueTime = now + mPeriod;
+			return;
+		}
+
+		while (now < mDueTime)
+		{
+			if (mDueTime - now > SpinTime)
+			{
+				this_thread::sleep_for(mDueTime - now - SpinTime);
+			}
+			else
+			{
+				this_thread::yield();
+			}
+			now = chrono::steady_clock::now();
+		}
+		mDueTime += mPeriod;
+	}
+}
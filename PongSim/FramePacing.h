@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace Pong
+{
+	struct FrameTimingSummary final
+	{
+		uint64_t Frames = 0;
+		double MeanFrameSeconds = 0.0;
+		double FrameDeviationSeconds = 0.0;
+		double MaxFrameSeconds = 0.0;
+		double MeanLatencySeconds = 0.0;
+		double MaxLatencySeconds = 0.0;
+	};
+
+	// Running frame-time and display-latency figures, cheap enough to keep for every frame of a
+	// session. Latency is whatever the caller measures from, to when it expects the frame on screen.
+	class FrameTimingStats final
+	{
+	public:
+		void Record(double frameSeconds, double latencySeconds);
+		FrameTimingSummary Summarize() const;
+
+	private:
+		uint64_t mFrames = 0;
+		double mFrameSum = 0.0;
+		double mFrameSquares = 0.0;
+		double mMaxFrame = 0.0;
+		double mLatencySum = 0.0;
+		double mMaxLatency = 0.0;
+	};
+
+	// Holds a loop to a fixed rate by waiting out what's left of each frame. Like SimulationThread
+	// it sleeps to within a millisecond and yields for the rest; a frame that runs long restarts
+	// the schedule instead of rushing the next ones.
+	class FrameLimiter final
+	{
+	public:
+		explicit FrameLimiter(double framesPerSecond);
+
+		double FramesPerSecond() const;
+		void Wait();
+
+	private:
+		std::chrono::steady_clock::duration mPeriod;
+		std::chrono::steady_clock::time_point mDueTime;
+		bool mStarted;
+	};
+}
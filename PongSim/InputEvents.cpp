@@ -0,0 +1,66 @@
+#include "pch.h"
+#include "InputEvents.h"
+
+using namespace std;
+
+namespace Pong
+{
+	const size_t InputEventQueue::DefaultCapacity;
+
+	InputEventQueue::InputEventQueue(size_t capacity) :
+		mEvents(capacity), mEventsDropped(0), mKeys(0), mPending(), mHasPending(false)
+	{
+	}
+
+	void InputEventQueue::Push(uint64_t time, uint32_t keys)
+	{
+		InputEvent event;
+		event.Time = time;
+		event.Keys = keys;
+		if (!mEvents.TryPush(event))
+		{
+			mEventsDropped.fetch_add(1, memory_order_relaxed);
+		}
+	}
+
+	uint64_t InputEventQueue::EventsDropped() const
+	{
+		return mEventsDropped.load(memory_order_relaxed);
+	}
+
+	InputSample InputEventQueue::Sample(uint64_t until)
+	{
+		InputSample sample;
+		uint32_t held = mKeys;
+		uint32_t pressed = 0;
+
+		while (mHasPending || mEvents.TryPop(mPending))
+		{
+			if (mPending.Time > until)
+			{
+				// it belongs to a later step
+				mHasPending = true;
+				break;
+			}
+			mHasPending = false;
+
+			if (sample.FirstEventTime == 0)
+			{
+				sample.FirstEventTime = mPending.Time;
+			}
+			pressed |= mPending.Keys & ~mKeys;
+			held |= mPending.Keys;
+			mKeys = mPending.Keys;
+		}
+
+		sample.Paddle.Up = (held & InputKeys::Up) != 0;
+		sample.Paddle.Down = (held & InputKeys::Down) != 0;
+		sample.Start = (pressed & InputKeys::Start) != 0;
+		return sample;
+	}
+
+	uint32_t InputEventQueue::Keys() const
+	{
+		return mKeys;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "MatchInputs.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pong
+{
+	namespace InputKeys
+	{
+		enum Flags : uint32_t
+		{
+			Up = 1 << 0,
+			Down = 1 << 1,
+			Start = 1 << 2,
+		};
+	}
+
+	// Every key that is down from Time on, in nanoseconds on Profiler::Now's clock.
+	struct InputEvent final
+	{
+		uint64_t Time = 0;
+		uint32_t Keys = 0;
+	};
+
+	// What the keys did over one simulation step.
+	struct InputSample final
+	{
+		PaddleInputs Paddle; // held at any point in the step, so a tap shorter than a step still moves it
+		bool Start = false; // pressed during the step
+		uint64_t FirstEventTime = 0; // the earliest change the step saw, or zero when nothing changed
+	};
+
+	// Carries timestamped key changes from whichever thread hears about them to the simulation,
+	// through an SpscQueue so the producer never waits. The simulation asks for each step's keys
+	// by the time the step ends, so a frame that runs several steps hands each one the presses
+	// that happened during it rather than whatever was down when the frame started.
+	class InputEventQueue final
+	{
+	public:
+		static const size_t DefaultCapacity = 256;
+
+		explicit InputEventQueue(size_t capacity = DefaultCapacity);
+
+		InputEventQueue(const InputEventQueue&) = delete;
+		InputEventQueue& operator=(const InputEventQueue&) = delete;
+
+		// producer only; a change that doesn't fit is dropped and counted, and the next one catches up
+		void Push(uint64_t time, uint32_t keys);
+		uint64_t EventsDropped() const;
+
+		// consumer only; every change up to until, which shouldn't go backwards between calls
+		InputSample Sample(uint64_t until);
+		uint32_t Keys() const;
+
+	private:
+		SpscQueue<InputEvent> mEvents;
+		std::atomic<uint64_t> mEventsDropped;
+
+		// the consumer's view: what was down at the end of the last sample, and the first change
+		// that belongs to a later one
+		uint32_t mKeys;
+		InputEvent mPending;
+		bool mHasPending;
+	};
+}
@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+#if defined(_WIN32)
+	MappedFile::MappedFile(const string& path) :
+		mData(nullptr), mSize(0), mFile(INVALID_HANDLE_VALUE), mMapping(nullptr)
+	{
+		mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (mFile == INVALID_HANDLE_VALUE)
+		{
+			throw runtime_error("Could not open " + path + ".");
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(mFile, &size))
+		{
+			CloseHandle(mFile);
+			throw runtime_error("Could not read the size of " + path + ".");
+		}
+
+		mSize = static_cast<size_t>(size.QuadPart);
+		if (mSize == 0)
+		{
+			// an empty file can't be mapped, and there is nothing to read anyway
+			return;
+		}
+
+		mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		mData = (mMapping != nullptr ? static_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr);
+		if (mData == nullptr)
+		{
+			if (mMapping != nullptr)
+			{
+				CloseHandle(mMapping);
+			}
+			CloseHandle(mFile);
+			throw runtime_error("Could not map " + path + ".");
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (mData != nullptr)
+		{
+			UnmapViewOfFile(mData);
+			CloseHandle(mMapping);
+		}
+		CloseHandle(mFile);
+	}
+#else
+	MappedFile::MappedFile(const string& path) :
+		mData(nullptr), mSize(0)
+	{
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			throw runtime_error("Could not open " + path + ".");
+		}
+
+		struct stat status;
+		if (fstat(file, &status) != 0)
+		{
+			close(file);
+			throw runtime_error("Could not read the size of " + path + ".");
+		}
+
+		mSize = static_cast<size_t>(status.st_size);
+		if (mSize > 0)
+		{
+			void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+			if (data == MAP_FAILED)
+			{
+				close(file);
+				throw runtime_error("Could not map " + path + ".");
+			}
+			mData = static_cast<const uint8_t*>(data);
+		}
+
+		// the mapping keeps its own reference to the file
+		close(file);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (mData != nullptr)
+		{
+			munmap(const_cast<uint8_t*>(mData), mSize);
+		}
+	}
+#endif
+
+	const uint8_t* MappedFile::Data() const
+	{
+		return mData;
+	}
+
+	size_t MappedFile::Size() const
+	{
+		return mSize;
+	}
+}
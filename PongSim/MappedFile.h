@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Pong
+{
+	// Read-only view of a whole file through the OS page cache. Throws std::runtime_error when the
+	// file can't be opened or mapped.
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const uint8_t* Data() const;
+		size_t Size() const;
+
+	private:
+		const uint8_t* mData;
+		size_t mSize;
+#if defined(_WIN32)
+		void* mFile;
+		void* mMapping;
+#endif
+	};
+}
@@ -0,0 +1,504 @@
+#include "pch.h"
+#include "MatchBatch.h"
+#include "MatchBatchKernels.h"
+#include "Profiler.h"
+#include "Simulation.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		bool CpuSupports(KernelPath path)
+		{
+#if defined(PONGSIM_X86_KERNELS)
+#if defined(_MSC_VER)
+			int registers[4];
+			__cpuid(registers, 0);
+			int maxLeaf = registers[0];
+
+			__cpuid(registers, 1);
+			bool sse41 = (registers[2] & (1 << 19)) != 0;
+			bool osxsave = (registers[2] & (1 << 27)) != 0;
+			bool avx = (registers[2] & (1 << 28)) != 0;
+			if (path == KernelPath::Sse41)
+			{
+				return sse41;
+			}
+
+			if (maxLeaf < 7 || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			{
+				return false;
+			}
+
+			__cpuidex(registers, 7, 0);
+			return (registers[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return path == KernelPath::Sse41 ? __builtin_cpu_supports("sse4.1") != 0 : __builtin_cpu_supports("avx2") != 0;
+#endif
+#else
+			static_cast<void>(path);
+			return false;
+#endif
+		}
+	}
+
+	MatchBatch::MatchBatch(const MatchConfig& config, size_t size, uint32_t seed) :
+		mConfig(config), mSize(size), mPaddedSize((size + LaneAlignment - 1) / LaneAlignment * LaneAlignment),
+		mKernelPath(BestKernelPath()),
+		mBallX(mPaddedSize), mBallY(mPaddedSize), mBallVelocityX(mPaddedSize), mBallVelocityY(mPaddedSize),
+		mPaddle1Y(mPaddedSize), mPaddle2Y(mPaddedSize), mPaddle1VelocityY(mPaddedSize), mPaddle2VelocityY(mPaddedSize),
+		mPlayer1Score(mPaddedSize), mPlayer2Score(mPaddedSize), mGamestate(mPaddedSize, static_cast<int32_t>(Gamestate::Initial)),
+		mFlags(mPaddedSize), mEvents(mPaddedSize), mPlayer1Up(mPaddedSize), mPlayer1Down(mPaddedSize), mStart(mPaddedSize),
+		mAITargetY(mPaddedSize), mAIPlanDirection(mPaddedSize), mPendingScores(mPaddedSize)
+	{
+		if (config.Player2Control != PaddleControl::BuiltInAI)
+		{
+			throw invalid_argument("MatchBatch only runs matches against the built-in AI.");
+		}
+		if (config.Physics != PhysicsMode::Float)
+		{
+			throw invalid_argument("MatchBatch only runs floating point physics.");
+		}
+
+		mGenerators.reserve(mSize);
+		for (size_t i = 0; i < mSize; ++i)
+		{
+			MatchState match = Simulation::CreateMatch(config, seed, static_cast<uint32_t>(i));
+			mGenerators.push_back(match.Generator);
+			SetMatch(i, match);
+		}
+
+		mServeLanes.reserve(mSize);
+		mStartedLanes.reserve(mSize);
+		mServeSeeds.resize(mSize);
+		mServeStreams.resize(mSize);
+		mServeBlocks.resize(mSize);
+		for (vector<uint32_t>& words : mServeWords)
+		{
+			words.resize(mSize);
+		}
+
+		// padding lanes sit frozen in the Initial state so the kernels can ignore them
+		for (size_t i = mSize; i < mPaddedSize; ++i)
+		{
+			mBallY[i] = config.ViewportHeight / 2;
+			mPaddle1Y[i] = config.ViewportHeight / 2;
+			mPaddle2Y[i] = config.ViewportHeight / 2;
+		}
+	}
+
+	size_t MatchBatch::Size() const
+	{
+		return mSize;
+	}
+
+	const MatchConfig& MatchBatch::Config() const
+	{
+		return mConfig;
+	}
+
+	double MatchBatch::TotalTime() const
+	{
+		return mTotalTime;
+	}
+
+	bool MatchBatch::IsKernelPathSupported(KernelPath path)
+	{
+		return path == KernelPath::Scalar || CpuSupports(path);
+	}
+
+	KernelPath MatchBatch::BestKernelPath()
+	{
+		if (IsKernelPathSupported(KernelPath::Avx2))
+		{
+			return KernelPath::Avx2;
+		}
+
+		return IsKernelPathSupported(KernelPath::Sse41) ? KernelPath::Sse41 : KernelPath::Scalar;
+	}
+
+	const char* MatchBatch::KernelPathName(KernelPath path)
+	{
+		switch (path)
+		{
+		case KernelPath::Avx2:
+			return "AVX2";
+
+		case KernelPath::Sse41:
+			return "SSE4.1";
+
+		default:
+			return "Scalar";
+		}
+	}
+
+	KernelPath MatchBatch::GetKernelPath() const
+	{
+		return mKernelPath;
+	}
+
+	void MatchBatch::SetKernelPath(KernelPath path)
+	{
+		if (!IsKernelPathSupported(path))
+		{
+			throw runtime_error(string(KernelPathName(path)) + " kernels are not supported on this CPU.");
+		}
+
+		mKernelPath = path;
+	}
+
+	void MatchBatch::Step(float elapsedTime)
+	{
+		PONG_PROFILE_SCOPE("MatchBatch::Step");
+
+		mTotalTime += elapsedTime;
+
+		for (size_t i = 0; i < mSize; ++i)
+		{
+			if (mStart[i] && mGamestate[i] != static_cast<int32_t>(Gamestate::Playing))
+			{
+				StartMatch(i);
+			}
+		}
+		ServeBalls();
+
+		BatchKernelArgs args;
+		args.Count = mPaddedSize;
+		args.BallX = mBallX.data();
+		args.BallY = mBallY.data();
+		args.BallVelocityX = mBallVelocityX.data();
+		args.BallVelocityY = mBallVelocityY.data();
+		args.Paddle1Y = mPaddle1Y.data();
+		args.Paddle2Y = mPaddle2Y.data();
+		args.Paddle1VelocityY = mPaddle1VelocityY.data();
+		args.Paddle2VelocityY = mPaddle2VelocityY.data();
+		args.Gamestate = mGamestate.data();
+		args.Flags = mFlags.data();
+		args.Events = mEvents.data();
+		args.Player1Up = mPlayer1Up.data();
+		args.Player1Down = mPlayer1Down.data();
+		args.ViewportWidth = mConfig.ViewportWidth;
+		args.ViewportHeight = mConfig.ViewportHeight;
+		args.BallWidth = mConfig.BallWidth;
+		args.BallHeight = mConfig.BallHeight;
+		args.PaddleWidth = mConfig.PaddleWidth;
+		args.PaddleHeight = mConfig.PaddleHeight;
+		args.Paddle1X = mConfig.PaddleWallOffset;
+		args.Paddle2X = mConfig.ViewportWidth - mConfig.PaddleWallOffset;
+		args.PaddleSpeed = mConfig.PaddleSpeed;
+		args.ElapsedTime = elapsedTime;
+		args.AIIdle = static_cast<int32_t>(mTotalTime) % mConfig.AIDelay == 0;
+		args.Swept = (mConfig.Collision == CollisionMode::Swept);
+		args.MaxSweepContacts = mConfig.MaxSweepContacts;
+
+		size_t pendingCount;
+		switch (mKernelPath)
+		{
+		case KernelPath::Avx2:
+			pendingCount = BatchKernels::ResolveContactsAvx2(args, mPendingScores.data());
+			break;
+
+		case KernelPath::Sse41:
+			pendingCount = BatchKernels::ResolveContactsSse41(args, mPendingScores.data());
+			break;
+
+		default:
+			pendingCount = BatchKernels::ResolveContactsScalar(args, mPendingScores.data());
+			break;
+		}
+
+		// after the kernels have cleared the previous step's events
+		for (uint32_t lane : mStartedLanes)
+		{
+			mEvents[lane] |= MatchEvents::GameStarted;
+		}
+		mStartedLanes.clear();
+
+		// the kernels always run the reactive AI; the predictive one overrides it before any scoring
+		if (mConfig.AI == AIMode::Predictive)
+		{
+			AdjustPredictiveAIPaddleVelocity();
+		}
+
+		// scoring is rare, so it stays scalar; the serves it leads to are drawn together
+		for (size_t i = 0; i < pendingCount; ++i)
+		{
+			UpdatePlayerScores(mPendingScores[i]);
+		}
+		ServeBalls();
+
+		switch (mKernelPath)
+		{
+		case KernelPath::Avx2:
+			BatchKernels::IntegrateAvx2(args);
+			break;
+
+		case KernelPath::Sse41:
+			BatchKernels::IntegrateSse41(args);
+			break;
+
+		default:
+			BatchKernels::IntegrateScalar(args);
+			break;
+		}
+	}
+
+	MatchState MatchBatch::Match(size_t index) const
+	{
+		assert(index < mSize);
+
+		MatchState match;
+		match.Config = mConfig;
+		match.Ball.Bounds = Rect(mBallX[index], mBallY[index], mConfig.BallWidth, mConfig.BallHeight);
+		match.Ball.Velocity = Vector2(mBallVelocityX[index], mBallVelocityY[index]);
+		match.Ball.Player1Scored = (mFlags[index] & BallFlags::Player1Scored) != 0;
+		match.Ball.Player2Scored = (mFlags[index] & BallFlags::Player2Scored) != 0;
+		match.Ball.HitWall = (mFlags[index] & BallFlags::HitWall) != 0;
+		match.Paddle1.Bounds = Rect(mConfig.PaddleWallOffset, mPaddle1Y[index], mConfig.PaddleWidth, mConfig.PaddleHeight);
+		match.Paddle1.Velocity = Vector2(0.0f, mPaddle1VelocityY[index]);
+		match.Paddle1.Player = Players::Player1;
+		match.Paddle2.Bounds = Rect(mConfig.ViewportWidth - mConfig.PaddleWallOffset, mPaddle2Y[index], mConfig.PaddleWidth, mConfig.PaddleHeight);
+		match.Paddle2.Velocity = Vector2(0.0f, mPaddle2VelocityY[index]);
+		match.Paddle2.Player = Players::Player2;
+		match.Player1Score = mPlayer1Score[index];
+		match.Player2Score = mPlayer2Score[index];
+		match.IsIntersecting = (mFlags[index] & BallFlags::IsIntersecting) != 0;
+		match.Gamestate = static_cast<Gamestate>(mGamestate[index]);
+		match.TotalTime = mTotalTime;
+		match.Events = mEvents[index];
+		if (index < mGenerators.size())
+		{
+			match.Generator = mGenerators[index];
+		}
+		match.AITargetY = mAITargetY[index];
+		match.AIPlanDirection = mAIPlanDirection[index];
+
+		return match;
+	}
+
+	void MatchBatch::SetMatch(size_t index, const MatchState& match)
+	{
+		assert(index < mSize);
+
+		mBallX[index] = match.Ball.Bounds.X;
+		mBallY[index] = match.Ball.Bounds.Y;
+		mBallVelocityX[index] = match.Ball.Velocity.X;
+		mBallVelocityY[index] = match.Ball.Velocity.Y;
+		mPaddle1Y[index] = match.Paddle1.Bounds.Y;
+		mPaddle2Y[index] = match.Paddle2.Bounds.Y;
+		mPaddle1VelocityY[index] = match.Paddle1.Velocity.Y;
+		mPaddle2VelocityY[index] = match.Paddle2.Velocity.Y;
+		mPlayer1Score[index] = match.Player1Score;
+		mPlayer2Score[index] = match.Player2Score;
+		mGamestate[index] = static_cast<int32_t>(match.Gamestate);
+		uint32_t flags = BallFlags::None;
+		if (match.Ball.Player1Scored) flags |= BallFlags::Player1Scored;
+		if (match.Ball.Player2Scored) flags |= BallFlags::Player2Scored;
+		if (match.Ball.HitWall) flags |= BallFlags::HitWall;
+		if (match.IsIntersecting) flags |= BallFlags::IsIntersecting;
+		mFlags[index] = flags;
+		mEvents[index] = match.Events;
+		if (index < mGenerators.size())
+		{
+			mGenerators[index] = match.Generator;
+		}
+		mAITargetY[index] = match.AITargetY;
+		mAIPlanDirection[index] = match.AIPlanDirection;
+	}
+
+	int32_t* MatchBatch::Player1Up()
+	{
+		return mPlayer1Up.data();
+	}
+
+	int32_t* MatchBatch::Player1Down()
+	{
+		return mPlayer1Down.data();
+	}
+
+	int32_t* MatchBatch::Start()
+	{
+		return mStart.data();
+	}
+
+	const float* MatchBatch::BallX() const
+	{
+		return mBallX.data();
+	}
+
+	const float* MatchBatch::BallY() const
+	{
+		return mBallY.data();
+	}
+
+	const float* MatchBatch::BallVelocityX() const
+	{
+		return mBallVelocityX.data();
+	}
+
+	const float* MatchBatch::BallVelocityY() const
+	{
+		return mBallVelocityY.data();
+	}
+
+	const float* MatchBatch::Paddle1Y() const
+	{
+		return mPaddle1Y.data();
+	}
+
+	const float* MatchBatch::Paddle2Y() const
+	{
+		return mPaddle2Y.data();
+	}
+
+	const float* MatchBatch::Paddle1VelocityY() const
+	{
+		return mPaddle1VelocityY.data();
+	}
+
+	const float* MatchBatch::Paddle2VelocityY() const
+	{
+		return mPaddle2VelocityY.data();
+	}
+
+	const int32_t* MatchBatch::Player1Score() const
+	{
+		return mPlayer1Score.data();
+	}
+
+	const int32_t* MatchBatch::Player2Score() const
+	{
+		return mPlayer2Score.data();
+	}
+
+	const int32_t* MatchBatch::Gamestates() const
+	{
+		return mGamestate.data();
+	}
+
+	const uint32_t* MatchBatch::Events() const
+	{
+		return mEvents.data();
+	}
+
+	void MatchBatch::StartMatch(size_t index)
+	{
+		ResetBall(index);
+		mPaddle1Y[index] = mConfig.ViewportHeight / 2 - mConfig.PaddleHeight / 2;
+		mPaddle1VelocityY[index] = mConfig.PaddleSpeed;
+		mPaddle2Y[index] = mConfig.ViewportHeight / 2 - mConfig.PaddleHeight / 2;
+		mPaddle2VelocityY[index] = 0.0f;
+		mPlayer1Score[index] = 0;
+		mPlayer2Score[index] = 0;
+		mGamestate[index] = static_cast<int32_t>(Gamestate::Playing);
+		mStartedLanes.push_back(static_cast<uint32_t>(index));
+	}
+
+	void MatchBatch::ResetBall(size_t index)
+	{
+		mFlags[index] &= ~(BallFlags::Player1Scored | BallFlags::Player2Scored);
+		mBallX[index] = mConfig.ViewportWidth / 2 - mConfig.BallWidth / 2;
+		mBallY[index] = mConfig.ViewportHeight / 2 - mConfig.BallHeight / 2;
+		mAIPlanDirection[index] = 0;
+		mServeLanes.push_back(static_cast<uint32_t>(index));
+	}
+
+	void MatchBatch::ServeBalls()
+	{
+		size_t count = mServeLanes.size();
+		if (count == 0)
+		{
+			return;
+		}
+
+		// every lane draws its own stream's next block, so batching the draws changes nothing
+		for (size_t i = 0; i < count; ++i)
+		{
+			MatchRandom& generator = mGenerators[mServeLanes[i]];
+			mServeSeeds[i] = generator.Seed();
+			mServeStreams[i] = generator.Stream();
+			mServeBlocks[i] = generator.TakeBlock();
+		}
+
+		uint32_t* const words[MatchRandom::BlockSize] = { mServeWords[0].data(), mServeWords[1].data(), mServeWords[2].data(), mServeWords[3].data() };
+		MatchRandom::Blocks(count, mServeSeeds.data(), mServeStreams.data(), mServeBlocks.data(), words);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint32_t block[MatchRandom::BlockSize] = { words[0][i], words[1][i], words[2][i], words[3][i] };
+			Vector2 velocity = Simulation::ServeVelocity(mConfig, block);
+			mBallVelocityX[mServeLanes[i]] = velocity.X;
+			mBallVelocityY[mServeLanes[i]] = velocity.Y;
+		}
+
+		mServeLanes.clear();
+	}
+
+	void MatchBatch::AdjustPredictiveAIPaddleVelocity()
+	{
+		PONG_PROFILE_SCOPE("MatchBatch::AdjustPredictiveAIPaddleVelocity");
+
+		// a plan is needed only when a lane's ball turns around, so planning stays scalar and rare
+		for (size_t i = 0; i < mSize; ++i)
+		{
+			int32_t direction = Simulation::BallDirection(mBallVelocityX[i]);
+			if (mGamestate[i] == static_cast<int32_t>(Gamestate::Playing) && direction != mAIPlanDirection[i])
+			{
+				BallState ball;
+				ball.Bounds = Rect(mBallX[i], mBallY[i], mConfig.BallWidth, mConfig.BallHeight);
+				ball.Velocity = Vector2(mBallVelocityX[i], mBallVelocityY[i]);
+				mAITargetY[i] = Simulation::PlanAITarget(mConfig, ball, mGenerators[i]);
+				mAIPlanDirection[i] = direction;
+			}
+		}
+
+		// Simulation::SteerAIPaddle written out so the compiler can vectorize it
+		const float halfHeight = mConfig.PaddleHeight / 2;
+		const float tolerance = mConfig.PaddleHeight / 4;
+		const float speed = mConfig.PaddleSpeed;
+		const int32_t playing = static_cast<int32_t>(Gamestate::Playing);
+		for (size_t i = 0; i < mPaddedSize; ++i)
+		{
+			float offset = mAITargetY[i] - (mPaddle2Y[i] + halfHeight);
+			float velocity = (offset > tolerance ? speed : (offset < -tolerance ? -speed : 0.0f));
+			mPaddle2VelocityY[i] = (mGamestate[i] == playing ? velocity : mPaddle2VelocityY[i]);
+		}
+	}
+
+	void MatchBatch::UpdatePlayerScores(size_t index)
+	{
+		int32_t* score;
+		if (mFlags[index] & BallFlags::Player1Scored)
+		{
+			mEvents[index] |= MatchEvents::Player1Scored;
+			score = &mPlayer1Score[index];
+		}
+		else
+		{
+			mEvents[index] |= MatchEvents::Player2Scored;
+			score = &mPlayer2Score[index];
+		}
+
+		if (++(*score) < mConfig.MaxScore)
+		{
+			ResetBall(index);
+		}
+		else
+		{
+			// transitioning to gameover
+			mBallVelocityX[index] = 0.0f;
+			mBallVelocityY[index] = 0.0f;
+			mPaddle1VelocityY[index] = 0.0f;
+			mPaddle2VelocityY[index] = 0.0f;
+			mEvents[index] |= MatchEvents::GameOver;
+			mGamestate[index] = static_cast<int32_t>(Gamestate::Gameover);
+		}
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+#include "MatchState.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pong
+{
+	enum class KernelPath
+	{
+		Scalar = 0,
+		Sse41 = 1,
+		Avx2 = 2,
+	};
+
+	// Per-lane ball bookkeeping that MatchState keeps as separate bools.
+	namespace BallFlags
+	{
+		enum Flags : uint32_t
+		{
+			None = 0,
+			Player1Scored = 1 << 0,
+			Player2Scored = 1 << 1,
+			HitWall = 1 << 2,
+			IsIntersecting = 1 << 3,
+		};
+	}
+
+	// Many matches kept in structure-of-arrays form and stepped in lockstep. Every lane plays by
+	// exactly the rules of Simulation::Step; the SIMD kernels only change how many lanes are
+	// processed per instruction. Inputs are written straight into the Player1Up/Player1Down/Start
+	// columns before each Step.
+	class MatchBatch final
+	{
+	public:
+		static const std::size_t LaneAlignment = 8;
+
+		MatchBatch(const MatchConfig& config, std::size_t size, uint32_t seed);
+
+		std::size_t Size() const;
+		const MatchConfig& Config() const;
+		double TotalTime() const;
+
+		static bool IsKernelPathSupported(KernelPath path);
+		static KernelPath BestKernelPath();
+		static const char* KernelPathName(KernelPath path);
+		KernelPath GetKernelPath() const;
+		void SetKernelPath(KernelPath path);
+
+		void Step(float elapsedTime);
+
+		MatchState Match(std::size_t index) const;
+		void SetMatch(std::size_t index, const MatchState& match);
+
+		int32_t* Player1Up();
+		int32_t* Player1Down();
+		int32_t* Start();
+
+		const float* BallX() const;
+		const float* BallY() const;
+		const float* BallVelocityX() const;
+		const float* BallVelocityY() const;
+		const float* Paddle1Y() const;
+		const float* Paddle2Y() const;
+		const float* Paddle1VelocityY() const;
+		const float* Paddle2VelocityY() const;
+		const int32_t* Player1Score() const;
+		const int32_t* Player2Score() const;
+		const int32_t* Gamestates() const;
+		const uint32_t* Events() const;
+
+	private:
+		void StartMatch(std::size_t index);
+		void ResetBall(std::size_t index);
+		void ServeBalls();
+		void UpdatePlayerScores(std::size_t index);
+		void AdjustPredictiveAIPaddleVelocity();
+
+		MatchConfig mConfig;
+		std::size_t mSize;
+		std::size_t mPaddedSize;
+		double mTotalTime = 0.0;
+		KernelPath mKernelPath;
+
+		AlignedVector<float> mBallX;
+		AlignedVector<float> mBallY;
+		AlignedVector<float> mBallVelocityX;
+		AlignedVector<float> mBallVelocityY;
+		AlignedVector<float> mPaddle1Y;
+		AlignedVector<float> mPaddle2Y;
+		AlignedVector<float> mPaddle1VelocityY;
+		AlignedVector<float> mPaddle2VelocityY;
+		AlignedVector<int32_t> mPlayer1Score;
+		AlignedVector<int32_t> mPlayer2Score;
+		AlignedVector<int32_t> mGamestate;
+		AlignedVector<uint32_t> mFlags;
+		AlignedVector<uint32_t> mEvents;
+		AlignedVector<int32_t> mPlayer1Up;
+		AlignedVector<int32_t> mPlayer1Down;
+		AlignedVector<int32_t> mStart;
+		AlignedVector<float> mAITargetY;
+		AlignedVector<int32_t> mAIPlanDirection;
+		std::vector<MatchRandom> mGenerators;
+		std::vector<uint32_t> mPendingScores;
+		std::vector<uint32_t> mStartedLanes;
+
+		// lanes ResetBall has centred, waiting for ServeBalls to draw their velocities together
+		std::vector<uint32_t> mServeLanes;
+		std::vector<uint32_t> mServeSeeds;
+		std::vector<uint32_t> mServeStreams;
+		std::vector<uint64_t> mServeBlocks;
+		std::vector<uint32_t> mServeWords[MatchRandom::BlockSize];
+	};
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PONGSIM_X86_KERNELS
+#endif
+
+namespace Pong
+{
+	// Column pointers and per-step constants handed to the batch kernels. Count is always a
+	// multiple of MatchBatch::LaneAlignment and every column is 32-byte aligned.
+	struct BatchKernelArgs final
+	{
+		std::size_t Count;
+
+		float* BallX;
+		float* BallY;
+		float* BallVelocityX;
+		float* BallVelocityY;
+		float* Paddle1Y;
+		float* Paddle2Y;
+		float* Paddle1VelocityY;
+		float* Paddle2VelocityY;
+		const int32_t* Gamestate;
+		uint32_t* Flags;
+		uint32_t* Events;
+		const int32_t* Player1Up;
+		const int32_t* Player1Down;
+
+		float ViewportWidth;
+		float ViewportHeight;
+		float BallWidth;
+		float BallHeight;
+		float PaddleWidth;
+		float PaddleHeight;
+		float Paddle1X;
+		float Paddle2X;
+		float PaddleSpeed;
+		float ElapsedTime;
+		bool AIIdle;
+		bool Swept;
+		int32_t MaxSweepContacts;
+	};
+
+	// Each path implements the two halves of Simulation::Step that touch every lane. Contacts covers
+	// HandleBallPhysics and AdjustAIPaddleVelocity and returns the lanes that need UpdatePlayerScores;
+	// Integrate covers UpdateBall (including SweepBall), the paddle updates and the PassedPaddle events.
+	namespace BatchKernels
+	{
+		std::size_t ResolveContactsScalar(const BatchKernelArgs& args, uint32_t* pendingScores);
+		void IntegrateScalar(const BatchKernelArgs& args);
+
+		std::size_t ResolveContactsSse41(const BatchKernelArgs& args, uint32_t* pendingScores);
+		void IntegrateSse41(const BatchKernelArgs& args);
+
+		std::size_t ResolveContactsAvx2(const BatchKernelArgs& args, uint32_t* pendingScores);
+		void IntegrateAvx2(const BatchKernelArgs& args);
+	}
+}
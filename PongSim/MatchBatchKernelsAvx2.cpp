@@ -0,0 +1,299 @@
+#include "pch.h"
+#include "MatchBatchKernels.h"
+#include "MatchBatch.h"
+
+#if defined(PONGSIM_X86_KERNELS)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+	namespace BatchKernels
+	{
+#if defined(PONGSIM_X86_KERNELS)
+		namespace
+		{
+			inline __m256i HasBits(__m256i value, __m256i bits)
+			{
+				return _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_and_si256(value, bits), _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+			}
+
+			// Simulation::SweepBall on eight lanes, after the paddles have moved from their start positions.
+			// Lanes leave the loop once they reach a step with no contact, exactly where the scalar loop breaks.
+			inline void SweepBall(const BatchKernelArgs& args, size_t i, __m256 paddle1StartY, __m256 paddle2StartY, __m256& x, __m256& y, __m256& velocityX, __m256& velocityY)
+			{
+				const __m256 zero = _mm256_setzero_ps();
+				const __m256 signMask = _mm256_set1_ps(-0.0f);
+				const __m256 ballHeight = _mm256_set1_ps(args.BallHeight);
+				const __m256 paddleHeight = _mm256_set1_ps(args.PaddleHeight);
+				const __m256 floorY = _mm256_set1_ps(args.ViewportHeight - args.BallHeight);
+				const __m256 paddle1Face = _mm256_set1_ps(args.Paddle1X + args.PaddleWidth);
+				const __m256 paddle2Face = _mm256_set1_ps(args.Paddle2X - args.BallWidth);
+				const __m256i wallSurface = _mm256_set1_epi32(1);
+				const __m256i paddle1Surface = _mm256_set1_epi32(2);
+				const __m256i paddle2Surface = _mm256_set1_epi32(3);
+				const __m256 elapsedTime = _mm256_set1_ps(args.ElapsedTime);
+				const __m256 paddle1Travel = _mm256_sub_ps(_mm256_load_ps(args.Paddle1Y + i), paddle1StartY);
+				const __m256 paddle2Travel = _mm256_sub_ps(_mm256_load_ps(args.Paddle2Y + i), paddle2StartY);
+				__m256 remainingTime = elapsedTime;
+				__m256 active = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				__m256i events = _mm256_load_si256(reinterpret_cast<const __m256i*>(args.Events + i));
+				__m256 paddle2VelocityY = _mm256_load_ps(args.Paddle2VelocityY + i);
+
+				for (int32_t contact = 0; contact <= args.MaxSweepContacts; ++contact)
+				{
+					__m256 hitTime = remainingTime;
+					__m256i surface = _mm256_setzero_si256();
+
+					__m256 down = _mm256_cmp_ps(velocityY, zero, _CMP_GT_OQ);
+					__m256 up = _mm256_cmp_ps(velocityY, zero, _CMP_LT_OQ);
+					// max(zero, time) keeps std::max's handling of -0.0f
+					__m256 downTime = _mm256_max_ps(zero, _mm256_div_ps(_mm256_sub_ps(floorY, y), velocityY));
+					__m256 upTime = _mm256_max_ps(zero, _mm256_div_ps(_mm256_xor_ps(y, signMask), velocityY));
+					__m256 wallTime = _mm256_blendv_ps(upTime, downTime, down);
+					__m256 wall = _mm256_and_ps(_mm256_or_ps(down, up), _mm256_cmp_ps(wallTime, hitTime, _CMP_LT_OQ));
+					hitTime = _mm256_blendv_ps(hitTime, wallTime, wall);
+					surface = _mm256_blendv_epi8(surface, wallSurface, _mm256_castps_si256(wall));
+
+					__m256 paddle1Time = _mm256_div_ps(_mm256_sub_ps(paddle1Face, x), velocityX);
+					__m256 paddle1ContactY = _mm256_add_ps(y, _mm256_mul_ps(velocityY, paddle1Time));
+					__m256 paddle1Y = _mm256_add_ps(paddle1StartY, _mm256_mul_ps(paddle1Travel, _mm256_div_ps(_mm256_add_ps(_mm256_sub_ps(elapsedTime, remainingTime), paddle1Time), elapsedTime)));
+					__m256 paddle1 = _mm256_and_ps(
+						_mm256_and_ps(_mm256_cmp_ps(velocityX, zero, _CMP_LT_OQ), _mm256_cmp_ps(x, paddle1Face, _CMP_GE_OQ)),
+						_mm256_and_ps(_mm256_cmp_ps(paddle1Time, hitTime, _CMP_LT_OQ),
+							_mm256_and_ps(_mm256_cmp_ps(paddle1Y, _mm256_add_ps(paddle1ContactY, ballHeight), _CMP_LT_OQ), _mm256_cmp_ps(paddle1ContactY, _mm256_add_ps(paddle1Y, paddleHeight), _CMP_LT_OQ))));
+					hitTime = _mm256_blendv_ps(hitTime, paddle1Time, paddle1);
+					surface = _mm256_blendv_epi8(surface, paddle1Surface, _mm256_castps_si256(paddle1));
+
+					__m256 paddle2Time = _mm256_div_ps(_mm256_sub_ps(paddle2Face, x), velocityX);
+					__m256 paddle2ContactY = _mm256_add_ps(y, _mm256_mul_ps(velocityY, paddle2Time));
+					__m256 paddle2Y = _mm256_add_ps(paddle2StartY, _mm256_mul_ps(paddle2Travel, _mm256_div_ps(_mm256_add_ps(_mm256_sub_ps(elapsedTime, remainingTime), paddle2Time), elapsedTime)));
+					__m256 paddle2 = _mm256_and_ps(
+						_mm256_and_ps(_mm256_cmp_ps(velocityX, zero, _CMP_GT_OQ), _mm256_cmp_ps(x, paddle2Face, _CMP_LE_OQ)),
+						_mm256_and_ps(_mm256_cmp_ps(paddle2Time, hitTime, _CMP_LT_OQ),
+							_mm256_and_ps(_mm256_cmp_ps(paddle2Y, _mm256_add_ps(paddle2ContactY, ballHeight), _CMP_LT_OQ), _mm256_cmp_ps(paddle2ContactY, _mm256_add_ps(paddle2Y, paddleHeight), _CMP_LT_OQ))));
+					hitTime = _mm256_blendv_ps(hitTime, paddle2Time, paddle2);
+					surface = _mm256_blendv_epi8(surface, paddle2Surface, _mm256_castps_si256(paddle2));
+
+					x = _mm256_blendv_ps(x, _mm256_add_ps(x, _mm256_mul_ps(velocityX, hitTime)), active);
+					y = _mm256_blendv_ps(y, _mm256_add_ps(y, _mm256_mul_ps(velocityY, hitTime)), active);
+					remainingTime = _mm256_blendv_ps(remainingTime, _mm256_sub_ps(remainingTime, hitTime), active);
+
+					__m256 hitWall = _mm256_and_ps(active, _mm256_castsi256_ps(_mm256_cmpeq_epi32(surface, wallSurface)));
+					__m256 hitPaddle2 = _mm256_and_ps(active, _mm256_castsi256_ps(_mm256_cmpeq_epi32(surface, paddle2Surface)));
+					__m256 hitPaddle = _mm256_or_ps(_mm256_and_ps(active, _mm256_castsi256_ps(_mm256_cmpeq_epi32(surface, paddle1Surface))), hitPaddle2);
+					velocityY = _mm256_xor_ps(velocityY, _mm256_and_ps(hitWall, signMask));
+					velocityX = _mm256_xor_ps(velocityX, _mm256_and_ps(hitPaddle, signMask));
+					paddle2VelocityY = _mm256_blendv_ps(paddle2VelocityY, zero, hitPaddle2);
+					events = _mm256_or_si256(events, _mm256_and_si256(_mm256_castps_si256(hitWall), _mm256_set1_epi32(MatchEvents::WallHit)));
+					events = _mm256_or_si256(events, _mm256_and_si256(_mm256_castps_si256(hitPaddle), _mm256_set1_epi32(MatchEvents::PaddleHit)));
+
+					active = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(surface, _mm256_setzero_si256())), active);
+					if (_mm256_movemask_ps(active) == 0)
+					{
+						break;
+					}
+				}
+
+				_mm256_store_si256(reinterpret_cast<__m256i*>(args.Events + i), events);
+				_mm256_store_ps(args.Paddle2VelocityY + i, paddle2VelocityY);
+			}
+		}
+
+		size_t ResolveContactsAvx2(const BatchKernelArgs& args, uint32_t* pendingScores)
+		{
+			const __m256i playingState = _mm256_set1_epi32(static_cast<int32_t>(Gamestate::Playing));
+			const __m256i isIntersectingFlag = _mm256_set1_epi32(BallFlags::IsIntersecting);
+			const __m256i hitWallFlag = _mm256_set1_epi32(BallFlags::HitWall);
+			const __m256i scoredFlags = _mm256_set1_epi32(BallFlags::Player1Scored | BallFlags::Player2Scored);
+			const __m256i paddleHitEvent = _mm256_set1_epi32(MatchEvents::PaddleHit);
+			const __m256i wallHitEvent = _mm256_set1_epi32(MatchEvents::WallHit);
+			const __m256 ballWidth = _mm256_set1_ps(args.BallWidth);
+			const __m256 ballHeight = _mm256_set1_ps(args.BallHeight);
+			const __m256 paddleHeight = _mm256_set1_ps(args.PaddleHeight);
+			const __m256 paddle1Left = _mm256_set1_ps(args.Paddle1X);
+			const __m256 paddle1Right = _mm256_set1_ps(args.Paddle1X + args.PaddleWidth);
+			const __m256 paddle2Left = _mm256_set1_ps(args.Paddle2X);
+			const __m256 paddle2Right = _mm256_set1_ps(args.Paddle2X + args.PaddleWidth);
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			const __m256 paddleSpeed = _mm256_set1_ps(args.PaddleSpeed);
+			const __m256 negativePaddleSpeed = _mm256_set1_ps(-args.PaddleSpeed);
+			const __m256 aiIdle = _mm256_castsi256_ps(_mm256_set1_epi32(args.AIIdle ? -1 : 0));
+			size_t pendingCount = 0;
+
+			for (size_t i = 0; i < args.Count; i += 8)
+			{
+				__m256i playing = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(args.Gamestate + i)), playingState);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(args.Events + i), _mm256_setzero_si256());
+				if (_mm256_testz_si256(playing, playing))
+				{
+					continue;
+				}
+
+				__m256 ballX = _mm256_load_ps(args.BallX + i);
+				__m256 ballY = _mm256_load_ps(args.BallY + i);
+				__m256 paddle1Y = _mm256_load_ps(args.Paddle1Y + i);
+				__m256 paddle2Y = _mm256_load_ps(args.Paddle2Y + i);
+				__m256 ballRight = _mm256_add_ps(ballX, ballWidth);
+				__m256 ballBottom = _mm256_add_ps(ballY, ballHeight);
+				__m256 paddle2Bottom = _mm256_add_ps(paddle2Y, paddleHeight);
+
+				__m256 paddle1Intersects = _mm256_and_ps(
+					_mm256_and_ps(_mm256_cmp_ps(paddle1Left, ballRight, _CMP_LT_OQ), _mm256_cmp_ps(ballX, paddle1Right, _CMP_LT_OQ)),
+					_mm256_and_ps(_mm256_cmp_ps(paddle1Y, ballBottom, _CMP_LT_OQ), _mm256_cmp_ps(ballY, _mm256_add_ps(paddle1Y, paddleHeight), _CMP_LT_OQ)));
+				__m256 paddle2Intersects = _mm256_and_ps(
+					_mm256_and_ps(_mm256_cmp_ps(paddle2Left, ballRight, _CMP_LT_OQ), _mm256_cmp_ps(ballX, paddle2Right, _CMP_LT_OQ)),
+					_mm256_and_ps(_mm256_cmp_ps(paddle2Y, ballBottom, _CMP_LT_OQ), _mm256_cmp_ps(ballY, paddle2Bottom, _CMP_LT_OQ)));
+				// swept collision handles paddle contacts while the ball moves
+				__m256 discrete = _mm256_and_ps(_mm256_castsi256_ps(playing), args.Swept ? zero : _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+				paddle1Intersects = _mm256_and_ps(paddle1Intersects, discrete);
+				paddle2Intersects = _mm256_and_ps(paddle2Intersects, discrete);
+				__m256i hit = _mm256_castps_si256(_mm256_or_ps(paddle1Intersects, paddle2Intersects));
+
+				__m256 paddle2VelocityY = _mm256_load_ps(args.Paddle2VelocityY + i);
+				paddle2VelocityY = _mm256_blendv_ps(paddle2VelocityY, zero, paddle2Intersects);
+
+				// reverse the ball only on the first step of a contact
+				__m256i flags = _mm256_load_si256(reinterpret_cast<const __m256i*>(args.Flags + i));
+				__m256i flip = _mm256_andnot_si256(HasBits(flags, isIntersectingFlag), hit);
+				__m256 velocityX = _mm256_load_ps(args.BallVelocityX + i);
+				velocityX = _mm256_xor_ps(velocityX, _mm256_and_ps(_mm256_castsi256_ps(flip), signMask));
+				flags = _mm256_or_si256(flags, _mm256_and_si256(flip, isIntersectingFlag));
+				flags = _mm256_andnot_si256(_mm256_and_si256(_mm256_andnot_si256(hit, playing), isIntersectingFlag), flags);
+				__m256i events = _mm256_and_si256(flip, paddleHitEvent);
+
+				__m256i wall = _mm256_and_si256(HasBits(flags, hitWallFlag), playing);
+				flags = _mm256_andnot_si256(_mm256_and_si256(wall, hitWallFlag), flags);
+				events = _mm256_or_si256(events, _mm256_and_si256(wall, wallHitEvent));
+
+				// AdjustAIPaddleVelocity, with the branches resolved in reverse priority order
+				__m256 idle = _mm256_or_ps(_mm256_cmp_ps(velocityX, zero, _CMP_LT_OQ), aiIdle);
+				__m256 below = _mm256_and_ps(_mm256_cmp_ps(ballY, paddle2Bottom, _CMP_GT_OQ), _mm256_cmp_ps(paddle2VelocityY, zero, _CMP_LE_OQ));
+				__m256 above = _mm256_and_ps(_mm256_cmp_ps(ballBottom, paddle2Y, _CMP_LT_OQ), _mm256_cmp_ps(paddle2VelocityY, zero, _CMP_GE_OQ));
+				__m256 target = _mm256_blendv_ps(paddle2VelocityY, negativePaddleSpeed, above);
+				target = _mm256_blendv_ps(target, paddleSpeed, below);
+				target = _mm256_blendv_ps(target, zero, idle);
+				paddle2VelocityY = _mm256_blendv_ps(paddle2VelocityY, target, _mm256_castsi256_ps(playing));
+
+				_mm256_store_ps(args.BallVelocityX + i, velocityX);
+				_mm256_store_ps(args.Paddle2VelocityY + i, paddle2VelocityY);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(args.Flags + i), flags);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(args.Events + i), events);
+
+				int scored = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(HasBits(flags, scoredFlags), playing)));
+				for (int lane = 0; scored != 0; ++lane, scored >>= 1)
+				{
+					if (scored & 1)
+					{
+						pendingScores[pendingCount++] = static_cast<uint32_t>(i + lane);
+					}
+				}
+			}
+
+			return pendingCount;
+		}
+
+		void IntegrateAvx2(const BatchKernelArgs& args)
+		{
+			const __m256i allOnes = _mm256_set1_epi32(-1);
+			const __m256i player1ScoredFlag = _mm256_set1_epi32(BallFlags::Player1Scored);
+			const __m256i player2ScoredFlag = _mm256_set1_epi32(BallFlags::Player2Scored);
+			const __m256i hitWallFlag = _mm256_set1_epi32(BallFlags::HitWall);
+			const __m256 ballWidth = _mm256_set1_ps(args.BallWidth);
+			const __m256 ballHeight = _mm256_set1_ps(args.BallHeight);
+			const __m256 paddleHeight = _mm256_set1_ps(args.PaddleHeight);
+			const __m256 viewportWidth = _mm256_set1_ps(args.ViewportWidth);
+			const __m256 viewportHeight = _mm256_set1_ps(args.ViewportHeight);
+			const __m256 paddleFloor = _mm256_set1_ps(args.ViewportHeight - args.PaddleHeight);
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			const __m256 elapsedTime = _mm256_set1_ps(args.ElapsedTime);
+			const __m256 paddle1Face = _mm256_set1_ps(args.Paddle1X + args.PaddleWidth);
+			const __m256 paddle2Face = _mm256_set1_ps(args.Paddle2X - args.BallWidth);
+			const __m256i passedPaddle1Event = _mm256_set1_epi32(MatchEvents::PassedPaddle1);
+			const __m256i passedPaddle2Event = _mm256_set1_epi32(MatchEvents::PassedPaddle2);
+
+			for (size_t i = 0; i < args.Count; i += 8)
+			{
+				// paddles move first so a swept ball sees them during the step
+				__m256 paddle1StartY = _mm256_load_ps(args.Paddle1Y + i);
+				__m256 paddle1Y = paddle1StartY;
+				__m256 atBottomBoundary = _mm256_cmp_ps(_mm256_add_ps(paddle1Y, paddleHeight), viewportHeight, _CMP_GE_OQ);
+				__m256 atTopBoundary = _mm256_cmp_ps(paddle1Y, zero, _CMP_LE_OQ);
+				__m256 up = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(args.Player1Up + i)), _mm256_setzero_si256()), allOnes));
+				__m256 down = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(args.Player1Down + i)), _mm256_setzero_si256()), allOnes));
+				__m256 paddle1Delta = _mm256_mul_ps(_mm256_load_ps(args.Paddle1VelocityY + i), elapsedTime);
+				paddle1Y = _mm256_blendv_ps(paddle1Y, _mm256_sub_ps(paddle1Y, paddle1Delta), _mm256_andnot_ps(atTopBoundary, up));
+				paddle1Y = _mm256_blendv_ps(paddle1Y, _mm256_add_ps(paddle1Y, paddle1Delta), _mm256_andnot_ps(atBottomBoundary, down));
+				_mm256_store_ps(args.Paddle1Y + i, paddle1Y);
+
+				__m256 paddle2VelocityY = _mm256_load_ps(args.Paddle2VelocityY + i);
+				__m256 paddle2StartY = _mm256_load_ps(args.Paddle2Y + i);
+				__m256 paddle2Y = _mm256_add_ps(paddle2StartY, _mm256_mul_ps(paddle2VelocityY, elapsedTime));
+				__m256 clampBottom = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(paddle2Y, paddleHeight), viewportHeight, _CMP_GE_OQ), _mm256_cmp_ps(paddle2VelocityY, zero, _CMP_GT_OQ));
+				paddle2Y = _mm256_blendv_ps(paddle2Y, paddleFloor, clampBottom);
+				__m256 clampTop = _mm256_and_ps(_mm256_cmp_ps(paddle2Y, zero, _CMP_LE_OQ), _mm256_cmp_ps(paddle2VelocityY, zero, _CMP_LT_OQ));
+				paddle2Y = _mm256_blendv_ps(paddle2Y, zero, clampTop);
+				_mm256_store_ps(args.Paddle2Y + i, paddle2Y);
+
+				__m256 velocityX = _mm256_load_ps(args.BallVelocityX + i);
+				__m256 velocityY = _mm256_load_ps(args.BallVelocityY + i);
+				__m256 ballX = _mm256_load_ps(args.BallX + i);
+				__m256 ballY = _mm256_load_ps(args.BallY + i);
+				__m256 startX = ballX;
+				if (args.Swept)
+				{
+					SweepBall(args, i, paddle1StartY, paddle2StartY, ballX, ballY, velocityX, velocityY);
+				}
+				else
+				{
+					ballX = _mm256_add_ps(ballX, _mm256_mul_ps(velocityX, elapsedTime));
+					ballY = _mm256_add_ps(ballY, _mm256_mul_ps(velocityY, elapsedTime));
+				}
+
+				// a crossing is rare, so the events are only rewritten for lanes where one happened
+				__m256 passed1 = _mm256_and_ps(_mm256_cmp_ps(startX, paddle1Face, _CMP_GE_OQ), _mm256_cmp_ps(ballX, paddle1Face, _CMP_LT_OQ));
+				__m256 passed2 = _mm256_and_ps(_mm256_cmp_ps(startX, paddle2Face, _CMP_LT_OQ), _mm256_cmp_ps(ballX, paddle2Face, _CMP_GE_OQ));
+				if (_mm256_movemask_ps(_mm256_or_ps(passed1, passed2)) != 0)
+				{
+					__m256i events = _mm256_load_si256(reinterpret_cast<const __m256i*>(args.Events + i));
+					events = _mm256_or_si256(events, _mm256_and_si256(_mm256_castps_si256(passed1), passedPaddle1Event));
+					events = _mm256_or_si256(events, _mm256_and_si256(_mm256_castps_si256(passed2), passedPaddle2Event));
+					_mm256_store_si256(reinterpret_cast<__m256i*>(args.Events + i), events);
+				}
+
+				__m256i flags = _mm256_load_si256(reinterpret_cast<const __m256i*>(args.Flags + i));
+
+				__m256 player1Scored = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(ballX, ballWidth), viewportWidth, _CMP_GE_OQ), _mm256_cmp_ps(velocityX, zero, _CMP_GT_OQ));
+				__m256 player2Scored = _mm256_and_ps(_mm256_cmp_ps(ballX, zero, _CMP_LE_OQ), _mm256_cmp_ps(velocityX, zero, _CMP_LT_OQ));
+				flags = _mm256_or_si256(flags, _mm256_or_si256(_mm256_and_si256(_mm256_castps_si256(player1Scored), player1ScoredFlag), _mm256_and_si256(_mm256_castps_si256(player2Scored), player2ScoredFlag)));
+
+				__m256 bottomWall = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(ballY, ballHeight), viewportHeight, _CMP_GE_OQ), _mm256_cmp_ps(velocityY, zero, _CMP_GT_OQ));
+				velocityY = _mm256_xor_ps(velocityY, _mm256_and_ps(bottomWall, signMask));
+				__m256 topWall = _mm256_and_ps(_mm256_cmp_ps(ballY, zero, _CMP_LE_OQ), _mm256_cmp_ps(velocityY, zero, _CMP_LT_OQ));
+				velocityY = _mm256_xor_ps(velocityY, _mm256_and_ps(topWall, signMask));
+				flags = _mm256_or_si256(flags, _mm256_and_si256(_mm256_castps_si256(_mm256_or_ps(bottomWall, topWall)), hitWallFlag));
+
+				_mm256_store_ps(args.BallX + i, ballX);
+				_mm256_store_ps(args.BallY + i, ballY);
+				_mm256_store_ps(args.BallVelocityX + i, velocityX);
+				_mm256_store_ps(args.BallVelocityY + i, velocityY);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(args.Flags + i), flags);
+			}
+		}
+#else
+		size_t ResolveContactsAvx2(const BatchKernelArgs& args, uint32_t* pendingScores)
+		{
+			return ResolveContactsScalar(args, pendingScores);
+		}
+
+		void IntegrateAvx2(const BatchKernelArgs& args)
+		{
+			IntegrateScalar(args);
+		}
+#endif
+	}
+}
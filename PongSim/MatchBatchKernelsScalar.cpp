@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "MatchBatchKernels.h"
+#include "MatchBatch.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace BatchKernels
+	{
+		namespace
+		{
+			// Simulation::SweepBall on one lane, after the paddles have moved from their start positions
+			void SweepBall(const BatchKernelArgs& args, size_t i, float paddle1StartY, float paddle2StartY, float& x, float& y, float& velocityX, float& velocityY)
+			{
+				const float paddle1Face = args.Paddle1X + args.PaddleWidth;
+				const float paddle2Face = args.Paddle2X - args.BallWidth;
+				float remainingTime = args.ElapsedTime;
+				x = args.BallX[i];
+				y = args.BallY[i];
+
+				for (int32_t contact = 0; contact <= args.MaxSweepContacts; ++contact)
+				{
+					float hitTime = remainingTime;
+					int32_t surface = 0;
+
+					if (velocityY > 0.0f)
+					{
+						float time = max((args.ViewportHeight - args.BallHeight - y) / velocityY, 0.0f);
+						if (time < hitTime)
+						{
+							hitTime = time;
+							surface = 1;
+						}
+					}
+					else if (velocityY < 0.0f)
+					{
+						float time = max(-y / velocityY, 0.0f);
+						if (time < hitTime)
+						{
+							hitTime = time;
+							surface = 1;
+						}
+					}
+
+					if (velocityX < 0.0f)
+					{
+						if (x >= paddle1Face)
+						{
+							float time = (paddle1Face - x) / velocityX;
+							float contactY = y + velocityY * time;
+							float paddleY = paddle1StartY + (args.Paddle1Y[i] - paddle1StartY) * ((args.ElapsedTime - remainingTime + time) / args.ElapsedTime);
+							if (time < hitTime && paddleY < contactY + args.BallHeight && contactY < paddleY + args.PaddleHeight)
+							{
+								hitTime = time;
+								surface = 2;
+							}
+						}
+					}
+					else if (velocityX > 0.0f)
+					{
+						if (x <= paddle2Face)
+						{
+							float time = (paddle2Face - x) / velocityX;
+							float contactY = y + velocityY * time;
+							float paddleY = paddle2StartY + (args.Paddle2Y[i] - paddle2StartY) * ((args.ElapsedTime - remainingTime + time) / args.ElapsedTime);
+							if (time < hitTime && paddleY < contactY + args.BallHeight && contactY < paddleY + args.PaddleHeight)
+							{
+								hitTime = time;
+								surface = 3;
+							}
+						}
+					}
+
+					x = x + velocityX * hitTime;
+					y = y + velocityY * hitTime;
+					remainingTime -= hitTime;
+
+					if (surface == 0)
+					{
+						break;
+					}
+					else if (surface == 1)
+					{
+						velocityY *= -1;
+						args.Events[i] |= MatchEvents::WallHit;
+					}
+					else
+					{
+						velocityX *= -1;
+						args.Events[i] |= MatchEvents::PaddleHit;
+						if (surface == 3)
+						{
+							args.Paddle2VelocityY[i] = 0.0f;
+						}
+					}
+				}
+			}
+		}
+
+		size_t ResolveContactsScalar(const BatchKernelArgs& args, uint32_t* pendingScores)
+		{
+			const int32_t playing = static_cast<int32_t>(Gamestate::Playing);
+			size_t pendingCount = 0;
+
+			for (size_t i = 0; i < args.Count; ++i)
+			{
+				args.Events[i] = MatchEvents::None;
+				if (args.Gamestate[i] != playing)
+				{
+					continue;
+				}
+
+				float ballX = args.BallX[i];
+				float ballY = args.BallY[i];
+				float ballRight = ballX + args.BallWidth;
+				float ballBottom = ballY + args.BallHeight;
+
+				bool paddle1Intersects = !args.Swept && args.Paddle1X < ballRight && ballX < args.Paddle1X + args.PaddleWidth &&
+					args.Paddle1Y[i] < ballBottom && ballY < args.Paddle1Y[i] + args.PaddleHeight;
+				bool paddle2Intersects = !args.Swept && args.Paddle2X < ballRight && ballX < args.Paddle2X + args.PaddleWidth &&
+					args.Paddle2Y[i] < ballBottom && ballY < args.Paddle2Y[i] + args.PaddleHeight;
+
+				uint32_t flags = args.Flags[i];
+				uint32_t events = MatchEvents::None;
+				if (paddle1Intersects || paddle2Intersects)
+				{
+					if (paddle2Intersects)
+					{
+						args.Paddle2VelocityY[i] = 0.0f;
+					}
+
+					if ((flags & BallFlags::IsIntersecting) == 0)
+					{
+						args.BallVelocityX[i] *= -1.0f;
+						flags |= BallFlags::IsIntersecting;
+						events |= MatchEvents::PaddleHit;
+					}
+				}
+				else
+				{
+					flags &= ~BallFlags::IsIntersecting;
+				}
+
+				if (flags & BallFlags::HitWall)
+				{
+					flags &= ~BallFlags::HitWall;
+					events |= MatchEvents::WallHit;
+				}
+
+				float& paddle2VelocityY = args.Paddle2VelocityY[i];
+				if (args.BallVelocityX[i] < 0 || args.AIIdle)
+				{
+					paddle2VelocityY = 0.0f;
+				}
+				else if (ballY > args.Paddle2Y[i] + args.PaddleHeight && paddle2VelocityY <= 0)
+				{
+					paddle2VelocityY = args.PaddleSpeed;
+				}
+				else if (ballBottom < args.Paddle2Y[i] && paddle2VelocityY >= 0)
+				{
+					paddle2VelocityY = -args.PaddleSpeed;
+				}
+
+				args.Flags[i] = flags;
+				args.Events[i] = events;
+
+				if (flags & (BallFlags::Player1Scored | BallFlags::Player2Scored))
+				{
+					pendingScores[pendingCount++] = static_cast<uint32_t>(i);
+				}
+			}
+
+			return pendingCount;
+		}
+
+		void IntegrateScalar(const BatchKernelArgs& args)
+		{
+			const float paddle1Face = args.Paddle1X + args.PaddleWidth;
+			const float paddle2Face = args.Paddle2X - args.BallWidth;
+			for (size_t i = 0; i < args.Count; ++i)
+			{
+				// paddles move first so a swept ball sees them during the step
+				float paddle1StartY = args.Paddle1Y[i];
+				float paddle1Y = paddle1StartY;
+				bool atBottomBoundary = (paddle1Y + args.PaddleHeight >= args.ViewportHeight);
+				bool atTopBoundary = (paddle1Y <= 0);
+				float paddle1Delta = args.Paddle1VelocityY[i] * args.ElapsedTime;
+				if (args.Player1Up[i] && !atTopBoundary)
+				{
+					paddle1Y -= paddle1Delta;
+				}
+				if (args.Player1Down[i] && !atBottomBoundary)
+				{
+					paddle1Y += paddle1Delta;
+				}
+				args.Paddle1Y[i] = paddle1Y;
+
+				float paddle2VelocityY = args.Paddle2VelocityY[i];
+				float paddle2StartY = args.Paddle2Y[i];
+				float paddle2Y = paddle2StartY + paddle2VelocityY * args.ElapsedTime;
+				if (paddle2Y + args.PaddleHeight >= args.ViewportHeight && paddle2VelocityY > 0.0f)
+				{
+					paddle2Y = args.ViewportHeight - args.PaddleHeight;
+				}
+				if (paddle2Y <= 0 && paddle2VelocityY < 0.0f)
+				{
+					paddle2Y = 0.0f;
+				}
+				args.Paddle2Y[i] = paddle2Y;
+
+				float velocityX = args.BallVelocityX[i];
+				float velocityY = args.BallVelocityY[i];
+				float startX = args.BallX[i];
+				float ballX;
+				float ballY;
+				uint32_t flags = args.Flags[i];
+
+				if (args.Swept)
+				{
+					SweepBall(args, i, paddle1StartY, paddle2StartY, ballX, ballY, velocityX, velocityY);
+				}
+				else
+				{
+					ballX = startX + velocityX * args.ElapsedTime;
+					ballY = args.BallY[i] + velocityY * args.ElapsedTime;
+				}
+
+				if (startX >= paddle1Face && ballX < paddle1Face)
+				{
+					args.Events[i] |= MatchEvents::PassedPaddle1;
+				}
+				if (startX < paddle2Face && ballX >= paddle2Face)
+				{
+					args.Events[i] |= MatchEvents::PassedPaddle2;
+				}
+
+				if (ballX + args.BallWidth >= args.ViewportWidth && velocityX > 0.0f)
+				{
+					flags |= BallFlags::Player1Scored;
+				}
+				if (ballX <= 0 && velocityX < 0.0f)
+				{
+					flags |= BallFlags::Player2Scored;
+				}
+
+				if (ballY + args.BallHeight >= args.ViewportHeight && velocityY > 0.0f)
+				{
+					flags |= BallFlags::HitWall;
+					velocityY *= -1;
+				}
+				if (ballY <= 0 && velocityY < 0.0f)
+				{
+					flags |= BallFlags::HitWall;
+					velocityY *= -1;
+				}
+
+				args.BallX[i] = ballX;
+				args.BallY[i] = ballY;
+				args.BallVelocityX[i] = velocityX;
+				args.BallVelocityY[i] = velocityY;
+				args.Flags[i] = flags;
+			}
+		}
+	}
+}
@@ -0,0 +1,299 @@
+#include "pch.h"
+#include "MatchBatchKernels.h"
+#include "MatchBatch.h"
+
+#if defined(PONGSIM_X86_KERNELS)
+#include <smmintrin.h>
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+	namespace BatchKernels
+	{
+#if defined(PONGSIM_X86_KERNELS)
+		namespace
+		{
+			inline __m128i HasBits(__m128i value, __m128i bits)
+			{
+				return _mm_xor_si128(_mm_cmpeq_epi32(_mm_and_si128(value, bits), _mm_setzero_si128()), _mm_set1_epi32(-1));
+			}
+
+			// Simulation::SweepBall on eight lanes, after the paddles have moved from their start positions.
+			// Lanes leave the loop once they reach a step with no contact, exactly where the scalar loop breaks.
+			inline void SweepBall(const BatchKernelArgs& args, size_t i, __m128 paddle1StartY, __m128 paddle2StartY, __m128& x, __m128& y, __m128& velocityX, __m128& velocityY)
+			{
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 signMask = _mm_set1_ps(-0.0f);
+				const __m128 ballHeight = _mm_set1_ps(args.BallHeight);
+				const __m128 paddleHeight = _mm_set1_ps(args.PaddleHeight);
+				const __m128 floorY = _mm_set1_ps(args.ViewportHeight - args.BallHeight);
+				const __m128 paddle1Face = _mm_set1_ps(args.Paddle1X + args.PaddleWidth);
+				const __m128 paddle2Face = _mm_set1_ps(args.Paddle2X - args.BallWidth);
+				const __m128i wallSurface = _mm_set1_epi32(1);
+				const __m128i paddle1Surface = _mm_set1_epi32(2);
+				const __m128i paddle2Surface = _mm_set1_epi32(3);
+				const __m128 elapsedTime = _mm_set1_ps(args.ElapsedTime);
+				const __m128 paddle1Travel = _mm_sub_ps(_mm_load_ps(args.Paddle1Y + i), paddle1StartY);
+				const __m128 paddle2Travel = _mm_sub_ps(_mm_load_ps(args.Paddle2Y + i), paddle2StartY);
+				__m128 remainingTime = elapsedTime;
+				__m128 active = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				__m128i events = _mm_load_si128(reinterpret_cast<const __m128i*>(args.Events + i));
+				__m128 paddle2VelocityY = _mm_load_ps(args.Paddle2VelocityY + i);
+
+				for (int32_t contact = 0; contact <= args.MaxSweepContacts; ++contact)
+				{
+					__m128 hitTime = remainingTime;
+					__m128i surface = _mm_setzero_si128();
+
+					__m128 down = _mm_cmpgt_ps(velocityY, zero);
+					__m128 up = _mm_cmplt_ps(velocityY, zero);
+					// max(zero, time) keeps std::max's handling of -0.0f
+					__m128 downTime = _mm_max_ps(zero, _mm_div_ps(_mm_sub_ps(floorY, y), velocityY));
+					__m128 upTime = _mm_max_ps(zero, _mm_div_ps(_mm_xor_ps(y, signMask), velocityY));
+					__m128 wallTime = _mm_blendv_ps(upTime, downTime, down);
+					__m128 wall = _mm_and_ps(_mm_or_ps(down, up), _mm_cmplt_ps(wallTime, hitTime));
+					hitTime = _mm_blendv_ps(hitTime, wallTime, wall);
+					surface = _mm_blendv_epi8(surface, wallSurface, _mm_castps_si128(wall));
+
+					__m128 paddle1Time = _mm_div_ps(_mm_sub_ps(paddle1Face, x), velocityX);
+					__m128 paddle1ContactY = _mm_add_ps(y, _mm_mul_ps(velocityY, paddle1Time));
+					__m128 paddle1Y = _mm_add_ps(paddle1StartY, _mm_mul_ps(paddle1Travel, _mm_div_ps(_mm_add_ps(_mm_sub_ps(elapsedTime, remainingTime), paddle1Time), elapsedTime)));
+					__m128 paddle1 = _mm_and_ps(
+						_mm_and_ps(_mm_cmplt_ps(velocityX, zero), _mm_cmpge_ps(x, paddle1Face)),
+						_mm_and_ps(_mm_cmplt_ps(paddle1Time, hitTime),
+							_mm_and_ps(_mm_cmplt_ps(paddle1Y, _mm_add_ps(paddle1ContactY, ballHeight)), _mm_cmplt_ps(paddle1ContactY, _mm_add_ps(paddle1Y, paddleHeight)))));
+					hitTime = _mm_blendv_ps(hitTime, paddle1Time, paddle1);
+					surface = _mm_blendv_epi8(surface, paddle1Surface, _mm_castps_si128(paddle1));
+
+					__m128 paddle2Time = _mm_div_ps(_mm_sub_ps(paddle2Face, x), velocityX);
+					__m128 paddle2ContactY = _mm_add_ps(y, _mm_mul_ps(velocityY, paddle2Time));
+					__m128 paddle2Y = _mm_add_ps(paddle2StartY, _mm_mul_ps(paddle2Travel, _mm_div_ps(_mm_add_ps(_mm_sub_ps(elapsedTime, remainingTime), paddle2Time), elapsedTime)));
+					__m128 paddle2 = _mm_and_ps(
+						_mm_and_ps(_mm_cmpgt_ps(velocityX, zero), _mm_cmple_ps(x, paddle2Face)),
+						_mm_and_ps(_mm_cmplt_ps(paddle2Time, hitTime),
+							_mm_and_ps(_mm_cmplt_ps(paddle2Y, _mm_add_ps(paddle2ContactY, ballHeight)), _mm_cmplt_ps(paddle2ContactY, _mm_add_ps(paddle2Y, paddleHeight)))));
+					hitTime = _mm_blendv_ps(hitTime, paddle2Time, paddle2);
+					surface = _mm_blendv_epi8(surface, paddle2Surface, _mm_castps_si128(paddle2));
+
+					x = _mm_blendv_ps(x, _mm_add_ps(x, _mm_mul_ps(velocityX, hitTime)), active);
+					y = _mm_blendv_ps(y, _mm_add_ps(y, _mm_mul_ps(velocityY, hitTime)), active);
+					remainingTime = _mm_blendv_ps(remainingTime, _mm_sub_ps(remainingTime, hitTime), active);
+
+					__m128 hitWall = _mm_and_ps(active, _mm_castsi128_ps(_mm_cmpeq_epi32(surface, wallSurface)));
+					__m128 hitPaddle2 = _mm_and_ps(active, _mm_castsi128_ps(_mm_cmpeq_epi32(surface, paddle2Surface)));
+					__m128 hitPaddle = _mm_or_ps(_mm_and_ps(active, _mm_castsi128_ps(_mm_cmpeq_epi32(surface, paddle1Surface))), hitPaddle2);
+					velocityY = _mm_xor_ps(velocityY, _mm_and_ps(hitWall, signMask));
+					velocityX = _mm_xor_ps(velocityX, _mm_and_ps(hitPaddle, signMask));
+					paddle2VelocityY = _mm_blendv_ps(paddle2VelocityY, zero, hitPaddle2);
+					events = _mm_or_si128(events, _mm_and_si128(_mm_castps_si128(hitWall), _mm_set1_epi32(MatchEvents::WallHit)));
+					events = _mm_or_si128(events, _mm_and_si128(_mm_castps_si128(hitPaddle), _mm_set1_epi32(MatchEvents::PaddleHit)));
+
+					active = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(surface, _mm_setzero_si128())), active);
+					if (_mm_movemask_ps(active) == 0)
+					{
+						break;
+					}
+				}
+
+				_mm_store_si128(reinterpret_cast<__m128i*>(args.Events + i), events);
+				_mm_store_ps(args.Paddle2VelocityY + i, paddle2VelocityY);
+			}
+		}
+
+		size_t ResolveContactsSse41(const BatchKernelArgs& args, uint32_t* pendingScores)
+		{
+			const __m128i playingState = _mm_set1_epi32(static_cast<int32_t>(Gamestate::Playing));
+			const __m128i isIntersectingFlag = _mm_set1_epi32(BallFlags::IsIntersecting);
+			const __m128i hitWallFlag = _mm_set1_epi32(BallFlags::HitWall);
+			const __m128i scoredFlags = _mm_set1_epi32(BallFlags::Player1Scored | BallFlags::Player2Scored);
+			const __m128i paddleHitEvent = _mm_set1_epi32(MatchEvents::PaddleHit);
+			const __m128i wallHitEvent = _mm_set1_epi32(MatchEvents::WallHit);
+			const __m128 ballWidth = _mm_set1_ps(args.BallWidth);
+			const __m128 ballHeight = _mm_set1_ps(args.BallHeight);
+			const __m128 paddleHeight = _mm_set1_ps(args.PaddleHeight);
+			const __m128 paddle1Left = _mm_set1_ps(args.Paddle1X);
+			const __m128 paddle1Right = _mm_set1_ps(args.Paddle1X + args.PaddleWidth);
+			const __m128 paddle2Left = _mm_set1_ps(args.Paddle2X);
+			const __m128 paddle2Right = _mm_set1_ps(args.Paddle2X + args.PaddleWidth);
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			const __m128 paddleSpeed = _mm_set1_ps(args.PaddleSpeed);
+			const __m128 negativePaddleSpeed = _mm_set1_ps(-args.PaddleSpeed);
+			const __m128 aiIdle = _mm_castsi128_ps(_mm_set1_epi32(args.AIIdle ? -1 : 0));
+			size_t pendingCount = 0;
+
+			for (size_t i = 0; i < args.Count; i += 4)
+			{
+				__m128i playing = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(args.Gamestate + i)), playingState);
+				_mm_store_si128(reinterpret_cast<__m128i*>(args.Events + i), _mm_setzero_si128());
+				if (_mm_testz_si128(playing, playing))
+				{
+					continue;
+				}
+
+				__m128 ballX = _mm_load_ps(args.BallX + i);
+				__m128 ballY = _mm_load_ps(args.BallY + i);
+				__m128 paddle1Y = _mm_load_ps(args.Paddle1Y + i);
+				__m128 paddle2Y = _mm_load_ps(args.Paddle2Y + i);
+				__m128 ballRight = _mm_add_ps(ballX, ballWidth);
+				__m128 ballBottom = _mm_add_ps(ballY, ballHeight);
+				__m128 paddle2Bottom = _mm_add_ps(paddle2Y, paddleHeight);
+
+				__m128 paddle1Intersects = _mm_and_ps(
+					_mm_and_ps(_mm_cmplt_ps(paddle1Left, ballRight), _mm_cmplt_ps(ballX, paddle1Right)),
+					_mm_and_ps(_mm_cmplt_ps(paddle1Y, ballBottom), _mm_cmplt_ps(ballY, _mm_add_ps(paddle1Y, paddleHeight))));
+				__m128 paddle2Intersects = _mm_and_ps(
+					_mm_and_ps(_mm_cmplt_ps(paddle2Left, ballRight), _mm_cmplt_ps(ballX, paddle2Right)),
+					_mm_and_ps(_mm_cmplt_ps(paddle2Y, ballBottom), _mm_cmplt_ps(ballY, paddle2Bottom)));
+				// swept collision handles paddle contacts while the ball moves
+				__m128 discrete = _mm_and_ps(_mm_castsi128_ps(playing), args.Swept ? zero : _mm_castsi128_ps(_mm_set1_epi32(-1)));
+				paddle1Intersects = _mm_and_ps(paddle1Intersects, discrete);
+				paddle2Intersects = _mm_and_ps(paddle2Intersects, discrete);
+				__m128i hit = _mm_castps_si128(_mm_or_ps(paddle1Intersects, paddle2Intersects));
+
+				__m128 paddle2VelocityY = _mm_load_ps(args.Paddle2VelocityY + i);
+				paddle2VelocityY = _mm_blendv_ps(paddle2VelocityY, zero, paddle2Intersects);
+
+				// reverse the ball only on the first step of a contact
+				__m128i flags = _mm_load_si128(reinterpret_cast<const __m128i*>(args.Flags + i));
+				__m128i flip = _mm_andnot_si128(HasBits(flags, isIntersectingFlag), hit);
+				__m128 velocityX = _mm_load_ps(args.BallVelocityX + i);
+				velocityX = _mm_xor_ps(velocityX, _mm_and_ps(_mm_castsi128_ps(flip), signMask));
+				flags = _mm_or_si128(flags, _mm_and_si128(flip, isIntersectingFlag));
+				flags = _mm_andnot_si128(_mm_and_si128(_mm_andnot_si128(hit, playing), isIntersectingFlag), flags);
+				__m128i events = _mm_and_si128(flip, paddleHitEvent);
+
+				__m128i wall = _mm_and_si128(HasBits(flags, hitWallFlag), playing);
+				flags = _mm_andnot_si128(_mm_and_si128(wall, hitWallFlag), flags);
+				events = _mm_or_si128(events, _mm_and_si128(wall, wallHitEvent));
+
+				// AdjustAIPaddleVelocity, with the branches resolved in reverse priority order
+				__m128 idle = _mm_or_ps(_mm_cmplt_ps(velocityX, zero), aiIdle);
+				__m128 below = _mm_and_ps(_mm_cmpgt_ps(ballY, paddle2Bottom), _mm_cmple_ps(paddle2VelocityY, zero));
+				__m128 above = _mm_and_ps(_mm_cmplt_ps(ballBottom, paddle2Y), _mm_cmpge_ps(paddle2VelocityY, zero));
+				__m128 target = _mm_blendv_ps(paddle2VelocityY, negativePaddleSpeed, above);
+				target = _mm_blendv_ps(target, paddleSpeed, below);
+				target = _mm_blendv_ps(target, zero, idle);
+				paddle2VelocityY = _mm_blendv_ps(paddle2VelocityY, target, _mm_castsi128_ps(playing));
+
+				_mm_store_ps(args.BallVelocityX + i, velocityX);
+				_mm_store_ps(args.Paddle2VelocityY + i, paddle2VelocityY);
+				_mm_store_si128(reinterpret_cast<__m128i*>(args.Flags + i), flags);
+				_mm_store_si128(reinterpret_cast<__m128i*>(args.Events + i), events);
+
+				int scored = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(HasBits(flags, scoredFlags), playing)));
+				for (int lane = 0; scored != 0; ++lane, scored >>= 1)
+				{
+					if (scored & 1)
+					{
+						pendingScores[pendingCount++] = static_cast<uint32_t>(i + lane);
+					}
+				}
+			}
+
+			return pendingCount;
+		}
+
+		void IntegrateSse41(const BatchKernelArgs& args)
+		{
+			const __m128i allOnes = _mm_set1_epi32(-1);
+			const __m128i player1ScoredFlag = _mm_set1_epi32(BallFlags::Player1Scored);
+			const __m128i player2ScoredFlag = _mm_set1_epi32(BallFlags::Player2Scored);
+			const __m128i hitWallFlag = _mm_set1_epi32(BallFlags::HitWall);
+			const __m128 ballWidth = _mm_set1_ps(args.BallWidth);
+			const __m128 ballHeight = _mm_set1_ps(args.BallHeight);
+			const __m128 paddleHeight = _mm_set1_ps(args.PaddleHeight);
+			const __m128 viewportWidth = _mm_set1_ps(args.ViewportWidth);
+			const __m128 viewportHeight = _mm_set1_ps(args.ViewportHeight);
+			const __m128 paddleFloor = _mm_set1_ps(args.ViewportHeight - args.PaddleHeight);
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			const __m128 elapsedTime = _mm_set1_ps(args.ElapsedTime);
+			const __m128 paddle1Face = _mm_set1_ps(args.Paddle1X + args.PaddleWidth);
+			const __m128 paddle2Face = _mm_set1_ps(args.Paddle2X - args.BallWidth);
+			const __m128i passedPaddle1Event = _mm_set1_epi32(MatchEvents::PassedPaddle1);
+			const __m128i passedPaddle2Event = _mm_set1_epi32(MatchEvents::PassedPaddle2);
+
+			for (size_t i = 0; i < args.Count; i += 4)
+			{
+				// paddles move first so a swept ball sees them during the step
+				__m128 paddle1StartY = _mm_load_ps(args.Paddle1Y + i);
+				__m128 paddle1Y = paddle1StartY;
+				__m128 atBottomBoundary = _mm_cmpge_ps(_mm_add_ps(paddle1Y, paddleHeight), viewportHeight);
+				__m128 atTopBoundary = _mm_cmple_ps(paddle1Y, zero);
+				__m128 up = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(args.Player1Up + i)), _mm_setzero_si128()), allOnes));
+				__m128 down = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(args.Player1Down + i)), _mm_setzero_si128()), allOnes));
+				__m128 paddle1Delta = _mm_mul_ps(_mm_load_ps(args.Paddle1VelocityY + i), elapsedTime);
+				paddle1Y = _mm_blendv_ps(paddle1Y, _mm_sub_ps(paddle1Y, paddle1Delta), _mm_andnot_ps(atTopBoundary, up));
+				paddle1Y = _mm_blendv_ps(paddle1Y, _mm_add_ps(paddle1Y, paddle1Delta), _mm_andnot_ps(atBottomBoundary, down));
+				_mm_store_ps(args.Paddle1Y + i, paddle1Y);
+
+				__m128 paddle2VelocityY = _mm_load_ps(args.Paddle2VelocityY + i);
+				__m128 paddle2StartY = _mm_load_ps(args.Paddle2Y + i);
+				__m128 paddle2Y = _mm_add_ps(paddle2StartY, _mm_mul_ps(paddle2VelocityY, elapsedTime));
+				__m128 clampBottom = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(paddle2Y, paddleHeight), viewportHeight), _mm_cmpgt_ps(paddle2VelocityY, zero));
+				paddle2Y = _mm_blendv_ps(paddle2Y, paddleFloor, clampBottom);
+				__m128 clampTop = _mm_and_ps(_mm_cmple_ps(paddle2Y, zero), _mm_cmplt_ps(paddle2VelocityY, zero));
+				paddle2Y = _mm_blendv_ps(paddle2Y, zero, clampTop);
+				_mm_store_ps(args.Paddle2Y + i, paddle2Y);
+
+				__m128 velocityX = _mm_load_ps(args.BallVelocityX + i);
+				__m128 velocityY = _mm_load_ps(args.BallVelocityY + i);
+				__m128 ballX = _mm_load_ps(args.BallX + i);
+				__m128 ballY = _mm_load_ps(args.BallY + i);
+				__m128 startX = ballX;
+				if (args.Swept)
+				{
+					SweepBall(args, i, paddle1StartY, paddle2StartY, ballX, ballY, velocityX, velocityY);
+				}
+				else
+				{
+					ballX = _mm_add_ps(ballX, _mm_mul_ps(velocityX, elapsedTime));
+					ballY = _mm_add_ps(ballY, _mm_mul_ps(velocityY, elapsedTime));
+				}
+
+				// a crossing is rare, so the events are only rewritten for lanes where one happened
+				__m128 passed1 = _mm_and_ps(_mm_cmpge_ps(startX, paddle1Face), _mm_cmplt_ps(ballX, paddle1Face));
+				__m128 passed2 = _mm_and_ps(_mm_cmplt_ps(startX, paddle2Face), _mm_cmpge_ps(ballX, paddle2Face));
+				if (_mm_movemask_ps(_mm_or_ps(passed1, passed2)) != 0)
+				{
+					__m128i events = _mm_load_si128(reinterpret_cast<const __m128i*>(args.Events + i));
+					events = _mm_or_si128(events, _mm_and_si128(_mm_castps_si128(passed1), passedPaddle1Event));
+					events = _mm_or_si128(events, _mm_and_si128(_mm_castps_si128(passed2), passedPaddle2Event));
+					_mm_store_si128(reinterpret_cast<__m128i*>(args.Events + i), events);
+				}
+
+				__m128i flags = _mm_load_si128(reinterpret_cast<const __m128i*>(args.Flags + i));
+
+				__m128 player1Scored = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(ballX, ballWidth), viewportWidth), _mm_cmpgt_ps(velocityX, zero));
+				__m128 player2Scored = _mm_and_ps(_mm_cmple_ps(ballX, zero), _mm_cmplt_ps(velocityX, zero));
+				flags = _mm_or_si128(flags, _mm_or_si128(_mm_and_si128(_mm_castps_si128(player1Scored), player1ScoredFlag), _mm_and_si128(_mm_castps_si128(player2Scored), player2ScoredFlag)));
+
+				__m128 bottomWall = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(ballY, ballHeight), viewportHeight), _mm_cmpgt_ps(velocityY, zero));
+				velocityY = _mm_xor_ps(velocityY, _mm_and_ps(bottomWall, signMask));
+				__m128 topWall = _mm_and_ps(_mm_cmple_ps(ballY, zero), _mm_cmplt_ps(velocityY, zero));
+				velocityY = _mm_xor_ps(velocityY, _mm_and_ps(topWall, signMask));
+				flags = _mm_or_si128(flags, _mm_and_si128(_mm_castps_si128(_mm_or_ps(bottomWall, topWall)), hitWallFlag));
+
+				_mm_store_ps(args.BallX + i, ballX);
+				_mm_store_ps(args.BallY + i, ballY);
+				_mm_store_ps(args.BallVelocityX + i, velocityX);
+				_mm_store_ps(args.BallVelocityY + i, velocityY);
+				_mm_store_si128(reinterpret_cast<__m128i*>(args.Flags + i), flags);
+			}
+		}
+#else
+		size_t ResolveContactsSse41(const BatchKernelArgs& args, uint32_t* pendingScores)
+		{
+			return ResolveContactsScalar(args, pendingScores);
+		}
+
+		void IntegrateSse41(const BatchKernelArgs& args)
+		{
+			IntegrateScalar(args);
+		}
+#endif
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Pong
+{
+	enum class CollisionMode
+	{
+		Discrete = 0, // overlap test once per step, like the original game
+		Swept = 1, // time-of-impact sweep, safe for large timesteps
+	};
+
+	enum class PaddleControl
+	{
+		BuiltInAI = 0, // AdjustAIPaddleVelocity steers the paddle
+		Inputs = 1, // the paddle reads its MatchInputs like player 1
+	};
+
+	enum class AIMode
+	{
+		Reactive = 0, // chase the ball every step, like the original game
+		Predictive = 1, // head for the intercept planned each time the ball changes direction
+	};
+
+	enum class PhysicsMode
+	{
+		Float = 0, // floating point, like the original game
+		FixedPoint = 1, // Q16.16 integers, the same bits on every compiler and CPU
+	};
+
+	// Arena and tuning constants for a match. The defaults match the 800x600 window and the
+	// Ball.png/Paddle.png textures the game ships with.
+	struct MatchConfig final
+	{
+		float ViewportWidth = 800.0f;
+		float ViewportHeight = 600.0f;
+		float BallWidth = 16.0f;
+		float BallHeight = 16.0f;
+		float PaddleWidth = 16.0f;
+		float PaddleHeight = 80.0f;
+		float PaddleWallOffset = 100.0f;
+		int32_t MinBallSpeed = 200;
+		int32_t MaxBallSpeed = 300;
+		float PaddleSpeed = 450.0f;
+		int32_t MaxScore = 3;
+		int32_t AIDelay = 3; // this more or less dictates difficulty
+		CollisionMode Collision = CollisionMode::Discrete;
+		int32_t MaxSweepContacts = 4;
+		PaddleControl Player2Control = PaddleControl::BuiltInAI;
+		AIMode AI = AIMode::Reactive;
+		float AIError = 0.0f; // the predictive AI misjudges each intercept by up to this many pixels
+		PhysicsMode Physics = PhysicsMode::Float;
+	};
+}
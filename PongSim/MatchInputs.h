@@ -0,0 +1,18 @@
+#pragma once
+
+namespace Pong
+{
+	struct PaddleInputs final
+	{
+		bool Up = false;
+		bool Down = false;
+	};
+
+	// Everything the simulation reads from the outside world for one step.
+	struct MatchInputs final
+	{
+		PaddleInputs Player1;
+		PaddleInputs Player2; // only read when MatchConfig::Player2Control is Inputs
+		bool Start = false;
+	};
+}
@@ -0,0 +1,147 @@
+#include "pch.h"
+#include "MatchRandom.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const uint32_t Multiplier0 = 0xD2511F53;
+		const uint32_t Multiplier1 = 0xCD9E8D57;
+		const uint32_t KeyStep0 = 0x9E3779B9;
+		const uint32_t KeyStep1 = 0xBB67AE85;
+		const int32_t Rounds = 10;
+
+		// the block counter fills the low half of Philox's 128-bit counter
+		inline void Philox(uint32_t key0, uint32_t key1, uint64_t index, uint32_t& x0, uint32_t& x1, uint32_t& x2, uint32_t& x3)
+		{
+			x0 = static_cast<uint32_t>(index);
+			x1 = static_cast<uint32_t>(index >> 32);
+			x2 = 0;
+			x3 = 0;
+
+			for (int32_t round = 0; round < Rounds; ++round)
+			{
+				uint64_t product0 = static_cast<uint64_t>(Multiplier0) * x0;
+				uint64_t product1 = static_cast<uint64_t>(Multiplier1) * x2;
+				uint32_t y0 = static_cast<uint32_t>(product1 >> 32) ^ x1 ^ key0;
+				uint32_t y2 = static_cast<uint32_t>(product0 >> 32) ^ x3 ^ key1;
+				x1 = static_cast<uint32_t>(product1);
+				x3 = static_cast<uint32_t>(product0);
+				x0 = y0;
+				x2 = y2;
+				key0 += KeyStep0;
+				key1 += KeyStep1;
+			}
+		}
+	}
+
+	const size_t MatchRandom::BlockSize;
+
+	MatchRandom::MatchRandom() :
+		mSeed(0), mStream(0), mCounter(0)
+	{
+	}
+
+	MatchRandom::MatchRandom(uint32_t seed, uint32_t stream, uint64_t counter) :
+		mSeed(seed), mStream(stream), mCounter(counter)
+	{
+	}
+
+	uint32_t MatchRandom::Seed() const
+	{
+		return mSeed;
+	}
+
+	uint32_t MatchRandom::Stream() const
+	{
+		return mStream;
+	}
+
+	uint64_t MatchRandom::Counter() const
+	{
+		return mCounter;
+	}
+
+	uint32_t MatchRandom::operator()()
+	{
+		// no cached block to keep in sync, at the cost of a few multiplies per draw
+		uint32_t block[BlockSize];
+		Block(mSeed, mStream, mCounter / BlockSize, block);
+		return block[mCounter++ % BlockSize];
+	}
+
+	void MatchRandom::NextBlock(uint32_t (&block)[BlockSize])
+	{
+		Block(mSeed, mStream, TakeBlock(), block);
+	}
+
+	uint64_t MatchRandom::TakeBlock()
+	{
+		uint64_t index = (mCounter + BlockSize - 1) / BlockSize;
+		mCounter = (index + 1) * BlockSize;
+		return index;
+	}
+
+	bool MatchRandom::operator==(const MatchRandom& other) const
+	{
+		return mSeed == other.mSeed && mStream == other.mStream && mCounter == other.mCounter;
+	}
+
+	bool MatchRandom::operator!=(const MatchRandom& other) const
+	{
+		return !(*this == other);
+	}
+
+	void MatchRandom::Block(uint32_t seed, uint32_t stream, uint64_t index, uint32_t (&block)[BlockSize])
+	{
+		Philox(seed, stream, index, block[0], block[1], block[2], block[3]);
+	}
+
+	void MatchRandom::Blocks(size_t count, const uint32_t* seeds, const uint32_t* streams, const uint64_t* indices, uint32_t* const (&blocks)[BlockSize])
+	{
+		// a round at a time across a chunk of lanes, which is the loop the compiler can vectorize
+		const size_t ChunkSize = 16;
+		uint32_t x0[ChunkSize], x1[ChunkSize], x2[ChunkSize], x3[ChunkSize];
+		uint32_t key0[ChunkSize], key1[ChunkSize];
+
+		for (size_t first = 0; first < count; first += ChunkSize)
+		{
+			size_t lanes = std::min(ChunkSize, count - first);
+			for (size_t lane = 0; lane < ChunkSize; ++lane)
+			{
+				size_t i = first + std::min(lane, lanes - 1);
+				x0[lane] = static_cast<uint32_t>(indices[i]);
+				x1[lane] = static_cast<uint32_t>(indices[i] >> 32);
+				x2[lane] = 0;
+				x3[lane] = 0;
+				key0[lane] = seeds[i];
+				key1[lane] = streams[i];
+			}
+
+			for (int32_t round = 0; round < Rounds; ++round)
+			{
+				for (size_t lane = 0; lane < ChunkSize; ++lane)
+				{
+					uint64_t product0 = static_cast<uint64_t>(Multiplier0) * x0[lane];
+					uint64_t product1 = static_cast<uint64_t>(Multiplier1) * x2[lane];
+					x0[lane] = static_cast<uint32_t>(product1 >> 32) ^ x1[lane] ^ key0[lane];
+					x2[lane] = static_cast<uint32_t>(product0 >> 32) ^ x3[lane] ^ key1[lane];
+					x1[lane] = static_cast<uint32_t>(product1);
+					x3[lane] = static_cast<uint32_t>(product0);
+					key0[lane] += KeyStep0;
+					key1[lane] += KeyStep1;
+				}
+			}
+
+			for (size_t lane = 0; lane < lanes; ++lane)
+			{
+				blocks[0][first + lane] = x0[lane];
+				blocks[1][first + lane] = x1[lane];
+				blocks[2][first + lane] = x2[lane];
+				blocks[3][first + lane] = x3[lane];
+			}
+		}
+	}
+}
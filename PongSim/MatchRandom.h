@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pong
+{
+	// A match's own random numbers: Philox4x32-10, a counter-based generator keyed by the run's
+	// seed and the match's index in the run. Every draw is a pure function of (seed, stream,
+	// counter), so a match draws the same numbers whichever thread steps it and however the run is
+	// split up, no two streams overlap, and the whole state is three integers that replays and
+	// checksums store as they are. It also works as a UniformRandomBitGenerator with the standard
+	// distributions, though those differ between standard libraries.
+	class MatchRandom final
+	{
+	public:
+		typedef uint32_t result_type;
+		static const std::size_t BlockSize = 4;
+
+		MatchRandom();
+		MatchRandom(uint32_t seed, uint32_t stream, uint64_t counter = 0);
+
+		uint32_t Seed() const;
+		uint32_t Stream() const;
+		uint64_t Counter() const; // words drawn so far, block by block
+
+		uint32_t operator()();
+
+		// A whole block, skipping whatever is left of the current one. TakeBlock only moves past it
+		// and returns its index, for callers that draw many streams' blocks at once with Blocks.
+		void NextBlock(uint32_t (&block)[BlockSize]);
+		uint64_t TakeBlock();
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return UINT32_MAX; }
+
+		bool operator==(const MatchRandom& other) const;
+		bool operator!=(const MatchRandom& other) const;
+
+		static void Block(uint32_t seed, uint32_t stream, uint64_t index, uint32_t (&block)[BlockSize]);
+
+		// One block for each of count streams, over columns so the compiler can vectorize the
+		// rounds; lane i gets exactly what Block(seeds[i], streams[i], indices[i]) would.
+		static void Blocks(std::size_t count, const uint32_t* seeds, const uint32_t* streams, const uint64_t* indices, uint32_t* const (&blocks)[BlockSize]);
+
+	private:
+		uint32_t mSeed;
+		uint32_t mStream;
+		uint64_t mCounter;
+	};
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "FixedPoint.h"
+#include "MatchConfig.h"
+#include "MatchRandom.h"
+#include "Rect.h"
+#include "Vector2.h"
+#include <cstdint>
+
+namespace Pong
+{
+	enum class Gamestate
+	{
+		Initial = 1,
+		Playing = 2,
+		Gameover = 3,
+	};
+
+	enum class Players
+	{
+		Player1 = 1,
+		Player2 = 2,
+	};
+
+	// Side effects of a single step, for the caller to turn into sounds and text updates.
+	namespace MatchEvents
+	{
+		enum Flags : uint32_t
+		{
+			None = 0,
+			PaddleHit = 1 << 0,
+			WallHit = 1 << 1,
+			Player1Scored = 1 << 2,
+			Player2Scored = 1 << 3,
+			GameOver = 1 << 4,
+			GameStarted = 1 << 5,
+			PassedPaddle1 = 1 << 6, // the ball's leading edge went past paddle 1's face
+			PassedPaddle2 = 1 << 7, // the ball's leading edge went past paddle 2's face
+		};
+	}
+
+	struct BallState final
+	{
+		Rect Bounds;
+		Vector2 Velocity;
+		bool Player1Scored = false;
+		bool Player2Scored = false;
+		bool HitWall = false;
+	};
+
+	struct PaddleState final
+	{
+		Rect Bounds;
+		Vector2 Velocity;
+		Players Player = Players::Player1;
+	};
+
+	struct FixedBody final
+	{
+		Fixed X;
+		Fixed Y;
+		Fixed Width;
+		Fixed Height;
+		Fixed VelocityX;
+		Fixed VelocityY;
+	};
+
+	// The positions and velocities PhysicsMode::FixedPoint actually simulates. The float bounds
+	// and velocities are rounded from these after every step, for drawing and for controllers.
+	struct FixedMatchState final
+	{
+		FixedBody Ball;
+		FixedBody Paddle1;
+		FixedBody Paddle2;
+		int64_t TotalTime = 0; // Q16.16 seconds, wide enough not to wrap
+		Fixed AITargetY;
+	};
+
+	struct MatchState final
+	{
+		MatchConfig Config;
+		BallState Ball;
+		PaddleState Paddle1;
+		PaddleState Paddle2;
+		int32_t Player1Score = 0;
+		int32_t Player2Score = 0;
+		bool IsIntersecting = false;
+		Pong::Gamestate Gamestate = Pong::Gamestate::Initial;
+		double TotalTime = 0.0;
+		uint32_t Events = MatchEvents::None;
+		MatchRandom Generator;
+		float AITargetY = 0.0f; // where the predictive AI wants paddle 2's centre
+		int32_t AIPlanDirection = 0; // sign of the ball's X velocity when AITargetY was planned, 0 to replan
+		FixedMatchState FixedState; // only used under PhysicsMode::FixedPoint
+	};
+}
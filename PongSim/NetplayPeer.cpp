@@ -0,0 +1,238 @@
+#include "pch.h"
+#include "NetplayPeer.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		// every packet starts "PN", its type and the protocol version
+		const size_t HeaderSize = 4;
+		const size_t WelcomeSize = HeaderSize + 6;
+		const size_t InputsHeaderSize = HeaderSize + 9;
+
+		void WriteUint32(vector<uint8_t>& buffer, uint32_t value)
+		{
+			for (size_t i = 0; i < sizeof(value); ++i)
+			{
+				buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+			}
+		}
+
+		uint32_t ReadUint32(const uint8_t* data)
+		{
+			return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+		}
+	}
+
+	const uint8_t NetplayPeer::ProtocolVersion;
+
+	NetplayPeer::NetplayPeer(shared_ptr<PacketChannel> channel, NetplayRole role, const MatchConfig& config, uint32_t seed, const RollbackOptions& options) :
+		mChannel(move(channel)), mRole(role), mConfig(config), mSeed(seed), mOptions(options),
+		mPeerSeen(false), mAcknowledgedFrame(0), mPacketsSent(0), mPacketsReceived(0)
+	{
+		if (mChannel == nullptr)
+		{
+			throw invalid_argument("Netplay needs a channel to the other player.");
+		}
+
+		// both paddles are driven by players now
+		mConfig.Player2Control = PaddleControl::Inputs;
+
+		if (role == NetplayRole::Host)
+		{
+			mSession = make_unique<RollbackSession>(mConfig, mSeed, Players::Player1, mOptions);
+			mAcknowledgedFrame = mOptions.InputDelay;
+		}
+	}
+
+	NetplayRole NetplayPeer::Role() const
+	{
+		return mRole;
+	}
+
+	bool NetplayPeer::Connected() const
+	{
+		return mSession != nullptr && mPeerSeen;
+	}
+
+	RollbackSession& NetplayPeer::Session()
+	{
+		if (mSession == nullptr)
+		{
+			throw logic_error("The netplay session starts once the host welcomes the joiner.");
+		}
+
+		return *mSession;
+	}
+
+	const RollbackSession& NetplayPeer::Session() const
+	{
+		return const_cast<NetplayPeer*>(this)->Session();
+	}
+
+	uint64_t NetplayPeer::PacketsSent() const
+	{
+		return mPacketsSent;
+	}
+
+	uint64_t NetplayPeer::PacketsReceived() const
+	{
+		return mPacketsReceived;
+	}
+
+	bool NetplayPeer::Update(const PaddleInputs& inputs, bool start)
+	{
+		Receive();
+
+		bool advanced = false;
+		if (Connected())
+		{
+			if (mSession->NeedsLocalInput())
+			{
+				mSession->AddLocalInput(RollbackSession::PackButtons(inputs, start));
+			}
+			advanced = mSession->Advance();
+		}
+
+		SendHandshake();
+		SendInputs();
+
+		return advanced;
+	}
+
+	void NetplayPeer::Poll()
+	{
+		Receive();
+		if (mSession != nullptr)
+		{
+			mSession->Rollback();
+		}
+
+		SendHandshake();
+		SendInputs();
+	}
+
+	void NetplayPeer::Receive()
+	{
+		while (mChannel->Receive(mReceiveBuffer))
+		{
+			Handle(mReceiveBuffer);
+		}
+	}
+
+	void NetplayPeer::Handle(const vector<uint8_t>& packet)
+	{
+		// anything malformed or from another version is dropped like a lost packet
+		if (packet.size() < HeaderSize || packet[0] != 'P' || packet[1] != 'N' || packet[3] != ProtocolVersion)
+		{
+			return;
+		}
+		++mPacketsReceived;
+
+		switch (static_cast<PacketType>(packet[2]))
+		{
+		case PacketType::Hello:
+			if (mRole == NetplayRole::Host)
+			{
+				// answered every time, in case the last welcome was lost
+				mPeerSeen = true;
+				SendPacket(PacketType::Welcome);
+			}
+			break;
+
+		case PacketType::Welcome:
+			if (mRole == NetplayRole::Join && mSession == nullptr && packet.size() >= WelcomeSize)
+			{
+				uint32_t inputDelay = packet[HeaderSize];
+				uint32_t maxRollback = packet[HeaderSize + 1];
+				if (maxRollback == 0 || 2 * (inputDelay + maxRollback + 1) > RollbackSession::Capacity)
+				{
+					break;
+				}
+
+				mOptions.InputDelay = inputDelay;
+				mOptions.MaxRollback = maxRollback;
+				mSeed = ReadUint32(packet.data() + HeaderSize + 2);
+				mSession = make_unique<RollbackSession>(mConfig, mSeed, Players::Player2, mOptions);
+				mAcknowledgedFrame = mOptions.InputDelay;
+				mPeerSeen = true;
+			}
+			break;
+
+		case PacketType::Inputs:
+			if (mSession != nullptr && packet.size() >= InputsHeaderSize)
+			{
+				uint32_t acknowledged = ReadUint32(packet.data() + HeaderSize);
+				uint32_t firstFrame = ReadUint32(packet.data() + HeaderSize + 4);
+				size_t count = min<size_t>(packet[HeaderSize + 8], packet.size() - InputsHeaderSize);
+
+				mAcknowledgedFrame = max(mAcknowledgedFrame, min(acknowledged, mSession->LocalFrame()));
+				for (size_t i = 0; i < count; ++i)
+				{
+					mSession->AddRemoteInput(firstFrame + static_cast<uint32_t>(i), packet[InputsHeaderSize + i]);
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void NetplayPeer::SendHandshake()
+	{
+		if (mRole == NetplayRole::Join && mSession == nullptr)
+		{
+			SendPacket(PacketType::Hello);
+		}
+	}
+
+	void NetplayPeer::SendInputs()
+	{
+		if (Connected())
+		{
+			SendPacket(PacketType::Inputs);
+		}
+	}
+
+	void NetplayPeer::SendPacket(PacketType type)
+	{
+		mSendBuffer.clear();
+		mSendBuffer.push_back('P');
+		mSendBuffer.push_back('N');
+		mSendBuffer.push_back(static_cast<uint8_t>(type));
+		mSendBuffer.push_back(ProtocolVersion);
+
+		switch (type)
+		{
+		case PacketType::Hello:
+			break;
+
+		case PacketType::Welcome:
+			mSendBuffer.push_back(static_cast<uint8_t>(mOptions.InputDelay));
+			mSendBuffer.push_back(static_cast<uint8_t>(mOptions.MaxRollback));
+			WriteUint32(mSendBuffer, mSeed);
+			break;
+
+		case PacketType::Inputs:
+		{
+			// the rollback window keeps the unacknowledged inputs well under the ring's capacity
+			uint32_t firstFrame = mAcknowledgedFrame;
+			uint32_t count = mSession->LocalFrame() - firstFrame;
+			WriteUint32(mSendBuffer, mSession->RemoteFrame());
+			WriteUint32(mSendBuffer, firstFrame);
+			mSendBuffer.push_back(static_cast<uint8_t>(count));
+			for (uint32_t frame = firstFrame; frame < firstFrame + count; ++frame)
+			{
+				mSendBuffer.push_back(mSession->LocalButtons(frame));
+			}
+			break;
+		}
+		}
+
+		mChannel->Send(mSendBuffer.data(), mSendBuffer.size());
+		++mPacketsSent;
+	}
+}
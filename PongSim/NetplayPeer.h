@@ -0,0 +1,70 @@
+#pragma once
+
+#include "MatchConfig.h"
+#include "MatchInputs.h"
+#include "PacketChannel.h"
+#include "RollbackSession.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Pong
+{
+	enum class NetplayRole
+	{
+		Host, // plays player 1 and picks the seed and rollback options
+		Join, // plays player 2 with whatever the host picked
+	};
+
+	// One side of a two-player match over a PacketChannel. The joiner says hello until the host
+	// welcomes it with the match seed; from then on each side sends every local input the other
+	// hasn't acknowledged yet, so a lost packet is covered by the next one.
+	class NetplayPeer final
+	{
+	public:
+		static const uint8_t ProtocolVersion = 1;
+
+		// seed and options are only read by the host
+		NetplayPeer(std::shared_ptr<PacketChannel> channel, NetplayRole role, const MatchConfig& config, uint32_t seed, const RollbackOptions& options);
+
+		NetplayRole Role() const;
+		bool Connected() const;
+		RollbackSession& Session(); // throws std::logic_error before Connected
+		const RollbackSession& Session() const;
+		uint64_t PacketsSent() const;
+		uint64_t PacketsReceived() const;
+
+		// Call once per frame with the local player's keys. Returns whether the match advanced.
+		bool Update(const PaddleInputs& inputs, bool start);
+
+		// Handles what has arrived and resends what hasn't been acknowledged, without advancing.
+		void Poll();
+
+	private:
+		enum class PacketType : uint8_t
+		{
+			Hello = 1,
+			Welcome = 2,
+			Inputs = 3,
+		};
+
+		void Receive();
+		void Handle(const std::vector<uint8_t>& packet);
+		void SendHandshake();
+		void SendInputs();
+		void SendPacket(PacketType type);
+
+		std::shared_ptr<PacketChannel> mChannel;
+		NetplayRole mRole;
+		MatchConfig mConfig;
+		uint32_t mSeed;
+		RollbackOptions mOptions;
+		std::unique_ptr<RollbackSession> mSession;
+		bool mPeerSeen;
+		uint32_t mAcknowledgedFrame; // the first local frame the peer hasn't confirmed having
+		uint64_t mPacketsSent;
+		uint64_t mPacketsReceived;
+		std::vector<uint8_t> mSendBuffer;
+		std::vector<uint8_t> mReceiveBuffer;
+	};
+}
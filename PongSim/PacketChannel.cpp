@@ -0,0 +1,267 @@
+#include "pch.h"
+#include "PacketChannel.h"
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+#if defined(_WIN32)
+		typedef SOCKET SocketHandle;
+		const SocketHandle NoSocket = INVALID_SOCKET;
+
+		// Winsock has to be started once per process before any socket is made
+		struct WinsockSession final
+		{
+			WinsockSession()
+			{
+				WSADATA data;
+				if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+				{
+					throw runtime_error("Could not start Winsock.");
+				}
+			}
+
+			~WinsockSession()
+			{
+				WSACleanup();
+			}
+		};
+
+		void CloseSocket(SocketHandle socket)
+		{
+			closesocket(socket);
+		}
+
+		bool SetNonBlocking(SocketHandle socket)
+		{
+			u_long enabled = 1;
+			return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+		}
+
+		bool WouldBlock()
+		{
+			// a refused send shows up on the next receive on Windows; it isn't an error for UDP
+			int error = WSAGetLastError();
+			return error == WSAEWOULDBLOCK || error == WSAECONNRESET;
+		}
+#else
+		typedef int SocketHandle;
+		const SocketHandle NoSocket = -1;
+
+		void CloseSocket(SocketHandle socket)
+		{
+			close(socket);
+		}
+
+		bool SetNonBlocking(SocketHandle socket)
+		{
+			int flags = fcntl(socket, F_GETFL, 0);
+			return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+		}
+
+		bool WouldBlock()
+		{
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED;
+		}
+#endif
+
+		SocketHandle Handle(uintptr_t socket)
+		{
+			return static_cast<SocketHandle>(socket);
+		}
+	}
+
+	UdpChannel::UdpChannel(uint16_t localPort) :
+		mSocket(static_cast<uintptr_t>(NoSocket))
+	{
+#if defined(_WIN32)
+		static WinsockSession winsock;
+#endif
+
+		SocketHandle handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (handle == NoSocket)
+		{
+			throw runtime_error("Could not create a UDP socket.");
+		}
+
+		sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		address.sin_port = htons(localPort);
+
+		if (bind(handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || !SetNonBlocking(handle))
+		{
+			CloseSocket(handle);
+			throw runtime_error("Could not open UDP port " + to_string(localPort) + ".");
+		}
+
+		mSocket = static_cast<uintptr_t>(handle);
+	}
+
+	UdpChannel::~UdpChannel()
+	{
+		CloseSocket(Handle(mSocket));
+	}
+
+	void UdpChannel::Connect(const string& host, uint16_t port)
+	{
+		addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_DGRAM;
+
+		addrinfo* results = nullptr;
+		if (getaddrinfo(host.c_str(), nullptr, &hints, &results) != 0 || results == nullptr)
+		{
+			throw runtime_error("Could not find " + host + ".");
+		}
+
+		sockaddr_in address;
+		memcpy(&address, results->ai_addr, sizeof(address));
+		freeaddrinfo(results);
+		address.sin_port = htons(port);
+
+		mPeerAddress.resize(sizeof(address));
+		memcpy(mPeerAddress.data(), &address, sizeof(address));
+	}
+
+	uint16_t UdpChannel::LocalPort() const
+	{
+		sockaddr_in address;
+		socklen_t size = sizeof(address);
+		if (getsockname(Handle(mSocket), reinterpret_cast<sockaddr*>(&address), &size) != 0)
+		{
+			throw runtime_error("Could not read the local UDP port.");
+		}
+
+		return ntohs(address.sin_port);
+	}
+
+	bool UdpChannel::HasPeer() const
+	{
+		return !mPeerAddress.empty();
+	}
+
+	void UdpChannel::Send(const uint8_t* data, size_t size)
+	{
+		if (mPeerAddress.empty())
+		{
+			return;
+		}
+
+		// a full send buffer loses the packet like the network would, so the result doesn't matter
+		sendto(Handle(mSocket), reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+			reinterpret_cast<const sockaddr*>(mPeerAddress.data()), static_cast<socklen_t>(mPeerAddress.size()));
+	}
+
+	bool UdpChannel::Receive(vector<uint8_t>& packet)
+	{
+		packet.resize(MaxPacketSize);
+
+		for (;;)
+		{
+			sockaddr_in sender;
+			socklen_t senderSize = sizeof(sender);
+			auto received = recvfrom(Handle(mSocket), reinterpret_cast<char*>(packet.data()), static_cast<int>(packet.size()), 0,
+				reinterpret_cast<sockaddr*>(&sender), &senderSize);
+
+			if (received < 0)
+			{
+				if (WouldBlock())
+				{
+					packet.clear();
+					return false;
+				}
+				throw runtime_error("Could not receive from the UDP socket.");
+			}
+
+			if (mPeerAddress.empty())
+			{
+				mPeerAddress.resize(sizeof(sender));
+				memcpy(mPeerAddress.data(), &sender, sizeof(sender));
+			}
+
+			// anyone else sending to the port is ignored
+			const sockaddr_in* peer = reinterpret_cast<const sockaddr_in*>(mPeerAddress.data());
+			if (sender.sin_addr.s_addr == peer->sin_addr.s_addr && sender.sin_port == peer->sin_port)
+			{
+				packet.resize(static_cast<size_t>(received));
+				return true;
+			}
+		}
+	}
+
+	LossyChannel::LossyChannel(shared_ptr<PacketChannel> inner, const LinkConditions& conditions, uint32_t seed, function<double()> clock) :
+		mInner(move(inner)), mConditions(conditions), mGenerator(seed), mClock(move(clock)), mPacketsDropped(0)
+	{
+		if (mInner == nullptr || mClock == nullptr)
+		{
+			throw invalid_argument("A lossy channel needs a channel to wrap and a clock.");
+		}
+	}
+
+	void LossyChannel::Send(const uint8_t* data, size_t size)
+	{
+		uniform_real_distribution<double> distribution(0.0, 1.0);
+		if (distribution(mGenerator) < mConditions.LossRate)
+		{
+			++mPacketsDropped;
+		}
+		else
+		{
+			double dueTime = mClock() + mConditions.LatencySeconds + distribution(mGenerator) * mConditions.JitterSeconds;
+			mDelayed.push_back(DelayedPacket{ dueTime, vector<uint8_t>(data, data + size) });
+		}
+
+		Flush();
+	}
+
+	bool LossyChannel::Receive(vector<uint8_t>& packet)
+	{
+		Flush();
+		return mInner->Receive(packet);
+	}
+
+	uint64_t LossyChannel::PacketsDropped() const
+	{
+		return mPacketsDropped;
+	}
+
+	void LossyChannel::Flush()
+	{
+		// jitter means packets come due out of the order they were sent in
+		double now = mClock();
+		for (auto packet = mDelayed.begin(); packet != mDelayed.end();)
+		{
+			if (packet->DueTime <= now)
+			{
+				mInner->Send(packet->Data.data(), packet->Data.size());
+				packet = mDelayed.erase(packet);
+			}
+			else
+			{
+				++packet;
+			}
+		}
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	// Unreliable, unordered datagrams between two peers. Neither call blocks.
+	class PacketChannel
+	{
+	public:
+		virtual ~PacketChannel() = default;
+
+		virtual void Send(const uint8_t* data, std::size_t size) = 0;
+
+		// Replaces packet with the next one waiting; false when there isn't one.
+		virtual bool Receive(std::vector<uint8_t>& packet) = 0;
+	};
+
+	// A non-blocking UDP socket bound to localPort, zero for any. Until Connect names a peer, the
+	// first one to send a packet becomes it, which is all a listening host needs. Throws
+	// std::runtime_error when the socket can't be set up.
+	class UdpChannel final : public PacketChannel
+	{
+	public:
+		explicit UdpChannel(uint16_t localPort = 0);
+		~UdpChannel();
+
+		UdpChannel(const UdpChannel&) = delete;
+		UdpChannel& operator=(const UdpChannel&) = delete;
+
+		void Connect(const std::string& host, uint16_t port);
+		uint16_t LocalPort() const;
+		bool HasPeer() const;
+
+		void Send(const uint8_t* data, std::size_t size) override;
+		bool Receive(std::vector<uint8_t>& packet) override;
+
+	private:
+		static const std::size_t MaxPacketSize = 1500;
+
+		uintptr_t mSocket;
+		std::vector<uint8_t> mPeerAddress; // a sockaddr_in, empty without a peer
+	};
+
+	struct LinkConditions final
+	{
+		double LatencySeconds = 0.0; // one way
+		double JitterSeconds = 0.0; // added to the latency, uniformly up to this much
+		float LossRate = 0.0f; // chance each packet is dropped
+	};
+
+	// Wraps another channel to make it worse, for trying netplay over localhost. Sent packets are
+	// dropped or held back by the link conditions, so they can also arrive out of order. Time comes
+	// from clock, in seconds, so a test can run on a virtual one.
+	class LossyChannel final : public PacketChannel
+	{
+	public:
+		LossyChannel(std::shared_ptr<PacketChannel> inner, const LinkConditions& conditions, uint32_t seed, std::function<double()> clock);
+
+		void Send(const uint8_t* data, std::size_t size) override;
+		bool Receive(std::vector<uint8_t>& packet) override;
+
+		uint64_t PacketsDropped() const;
+
+	private:
+		struct DelayedPacket final
+		{
+			double DueTime;
+			std::vector<uint8_t> Data;
+		};
+
+		void Flush();
+
+		std::shared_ptr<PacketChannel> mInner;
+		LinkConditions mConditions;
+		std::minstd_rand mGenerator;
+		std::function<double()> mClock;
+		std::deque<DelayedPacket> mDelayed;
+		uint64_t mPacketsDropped;
+	};
+}
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "PaddleController.h"
+#include "Simulation.h"
+
+using namespace std;
+
+namespace Pong
+{
+	PaddleController::PaddleController(const string& name) :
+		mName(name)
+	{
+	}
+
+	const string& PaddleController::Name() const
+	{
+		return mName;
+	}
+
+	unique_ptr<PaddleController> PaddleController::Create(const string& spec)
+	{
+		size_t separator = spec.find(':');
+		string kind = spec.substr(0, separator);
+		string argument = (separator == string::npos ? string() : spec.substr(separator + 1));
+
+		try
+		{
+			if (kind == "track" && argument.empty())
+			{
+				return make_unique<TrackingController>();
+			}
+			else if (kind == "classic")
+			{
+				int32_t delay = (argument.empty() ? MatchConfig().AIDelay : stoi(argument));
+				if (delay > 0)
+				{
+					return make_unique<ClassicController>(delay);
+				}
+			}
+			else if (kind == "lazy")
+			{
+				float reactionDistance = (argument.empty() ? 200.0f : stof(argument));
+				if (reactionDistance > 0.0f)
+				{
+					return make_unique<LazyController>(reactionDistance);
+				}
+			}
+			else if (kind == "policy" && !argument.empty())
+			{
+				return make_unique<PolicyController>(spec, make_shared<PolicyNetwork>(argument));
+			}
+		}
+		catch (const logic_error&)
+		{
+			// stoi/stof reject the argument; reported below like any other bad spec
+		}
+
+		throw invalid_argument("Unknown paddle controller \"" + spec + "\".");
+	}
+
+	const PaddleState& PaddleController::ControlledPaddle(const MatchState& match, Players player)
+	{
+		return (player == Players::Player1 ? match.Paddle1 : match.Paddle2);
+	}
+
+	bool PaddleController::IsBallApproaching(const MatchState& match, Players player)
+	{
+		return (player == Players::Player1 ? match.Ball.Velocity.X < 0.0f : match.Ball.Velocity.X > 0.0f);
+	}
+
+	PaddleInputs PaddleController::FollowBall(const BallState& ball, const PaddleState& paddle)
+	{
+		PaddleInputs inputs;
+		inputs.Up = ball.Bounds.CenterY() < paddle.Bounds.Top();
+		inputs.Down = ball.Bounds.CenterY() > paddle.Bounds.Bottom();
+
+		return inputs;
+	}
+
+	TrackingController::TrackingController() :
+		PaddleController("track")
+	{
+	}
+
+	PaddleInputs TrackingController::Control(const MatchState& match, Players player) const
+	{
+		return FollowBall(match.Ball, ControlledPaddle(match, player));
+	}
+
+	ClassicController::ClassicController(int32_t delay) :
+		PaddleController("classic:" + to_string(delay)), mDelay(delay)
+	{
+	}
+
+	PaddleInputs ClassicController::Control(const MatchState& match, Players player) const
+	{
+		if (!IsBallApproaching(match, player) || static_cast<int32_t>(match.TotalTime) % mDelay == 0)
+		{
+			return PaddleInputs();
+		}
+
+		const PaddleState& paddle = ControlledPaddle(match, player);
+		PaddleInputs inputs;
+		inputs.Up = Simulation::IsBallAbovePaddle(match.Ball, paddle);
+		inputs.Down = Simulation::IsBallBelowPaddle(match.Ball, paddle);
+
+		return inputs;
+	}
+
+	LazyController::LazyController(float reactionDistance) :
+		PaddleController("lazy:" + to_string(static_cast<int32_t>(reactionDistance))), mReactionDistance(reactionDistance)
+	{
+	}
+
+	PaddleInputs LazyController::Control(const MatchState& match, Players player) const
+	{
+		const PaddleState& paddle = ControlledPaddle(match, player);
+		if (!IsBallApproaching(match, player) || fabs(match.Ball.Bounds.CenterX() - paddle.Bounds.CenterX()) > mReactionDistance)
+		{
+			return PaddleInputs();
+		}
+
+		return FollowBall(match.Ball, paddle);
+	}
+
+	PolicyController::PolicyController(const string& name, shared_ptr<const PolicyNetwork> network) :
+		PaddleController(name), mNetwork(move(network))
+	{
+	}
+
+	PaddleInputs PolicyController::Control(const MatchState& match, Players player) const
+	{
+		float features[PolicyNetwork::FeatureCount];
+		PolicyNetwork::Features(match, player, features);
+
+		return PolicyNetwork::Inputs(mNetwork->Decide(features));
+	}
+}
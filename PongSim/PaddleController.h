@@ -0,0 +1,84 @@
+#pragma once
+
+#include "MatchInputs.h"
+#include "MatchState.h"
+#include "PolicyNetwork.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Pong
+{
+	// Decides one paddle's inputs from the match it is playing. Controllers keep no per-match
+	// state, so one instance can drive any number of matches on any number of threads.
+	class PaddleController
+	{
+	public:
+		virtual ~PaddleController() = default;
+
+		PaddleController(const PaddleController&) = delete;
+		PaddleController& operator=(const PaddleController&) = delete;
+
+		const std::string& Name() const;
+		virtual PaddleInputs Control(const MatchState& match, Players player) const = 0;
+
+		// "track", "classic:<delay seconds>", "lazy:<reaction distance>" or "policy:<network file>"
+		static std::unique_ptr<PaddleController> Create(const std::string& spec);
+
+	protected:
+		explicit PaddleController(const std::string& name);
+
+		static const PaddleState& ControlledPaddle(const MatchState& match, Players player);
+		static bool IsBallApproaching(const MatchState& match, Players player);
+		static PaddleInputs FollowBall(const BallState& ball, const PaddleState& paddle);
+
+	private:
+		std::string mName;
+	};
+
+	// Chases the ball whenever it leaves the paddle's span. The bot PongSimDriver plays with.
+	class TrackingController final : public PaddleController
+	{
+	public:
+		TrackingController();
+
+		PaddleInputs Control(const MatchState& match, Players player) const override;
+	};
+
+	// The game's built-in opponent: follows only an approaching ball and sits out every second
+	// whose whole number is a multiple of the delay.
+	class ClassicController final : public PaddleController
+	{
+	public:
+		explicit ClassicController(int32_t delay);
+
+		PaddleInputs Control(const MatchState& match, Players player) const override;
+
+	private:
+		int32_t mDelay;
+	};
+
+	// Follows an approaching ball once it is within the reaction distance of the paddle.
+	class LazyController final : public PaddleController
+	{
+	public:
+		explicit LazyController(float reactionDistance);
+
+		PaddleInputs Control(const MatchState& match, Players player) const override;
+
+	private:
+		float mReactionDistance;
+	};
+
+	// Asks a learned PolicyNetwork what to do each step.
+	class PolicyController final : public PaddleController
+	{
+	public:
+		PolicyController(const std::string& name, std::shared_ptr<const PolicyNetwork> network);
+
+		PaddleInputs Control(const MatchState& match, Players player) const override;
+
+	private:
+		std::shared_ptr<const PolicyNetwork> mNetwork;
+	};
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pong
+{
+	struct PolicyLayer;
+
+	// Everything PolicyNetwork::Evaluate hands to a kernel. Feature k of paddle i is
+	// Features[k * Stride + i]; the SIMD kernels only take whole vectors of paddles.
+	struct PolicyKernelArgs final
+	{
+		const PolicyLayer* Layers;
+		std::size_t LayerCount;
+		const float* Features;
+		std::size_t Stride;
+		std::size_t Count;
+		int32_t* Actions;
+	};
+
+	// Every path adds the same products in the same order without fused multiply-adds, so all of
+	// them pick the same action for the same features.
+	namespace PolicyKernels
+	{
+		void EvaluateScalar(const PolicyKernelArgs& args);
+		void EvaluateSse41(const PolicyKernelArgs& args);
+		void EvaluateAvx2(const PolicyKernelArgs& args);
+	}
+}
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "PolicyKernels.h"
+#include "MatchBatchKernels.h"
+#include "PolicyNetwork.h"
+
+#if defined(PONGSIM_X86_KERNELS)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+	namespace PolicyKernels
+	{
+#if defined(PONGSIM_X86_KERNELS)
+		// Eight paddles per vector. Four outputs are summed side by side so the adds don't wait on
+		// each other, while each output still adds its products in the scalar order.
+		void EvaluateAvx2(const PolicyKernelArgs& args)
+		{
+			__m256 buffers[2][PolicyNetwork::MaxLayerWidth];
+			const __m256 zero = _mm256_setzero_ps();
+
+			for (size_t i = 0; i < args.Count; i += 8)
+			{
+				__m256* input = buffers[0];
+				for (uint32_t k = 0; k < PolicyNetwork::FeatureCount; ++k)
+				{
+					input[k] = _mm256_loadu_ps(args.Features + k * args.Stride + i);
+				}
+
+				for (size_t l = 0; l < args.LayerCount; ++l)
+				{
+					const PolicyLayer& layer = args.Layers[l];
+					const float* weights = layer.Weights.data();
+					const uint32_t inputCount = layer.InputCount;
+					bool hidden = (l + 1 < args.LayerCount);
+					__m256* output = (input == buffers[0] ? buffers[1] : buffers[0]);
+
+					uint32_t o = 0;
+					for (; o + 4 <= layer.OutputCount; o += 4)
+					{
+						const float* row = weights + static_cast<size_t>(o) * inputCount;
+						__m256 sum0 = _mm256_set1_ps(layer.Biases[o]);
+						__m256 sum1 = _mm256_set1_ps(layer.Biases[o + 1]);
+						__m256 sum2 = _mm256_set1_ps(layer.Biases[o + 2]);
+						__m256 sum3 = _mm256_set1_ps(layer.Biases[o + 3]);
+						for (uint32_t j = 0; j < inputCount; ++j)
+						{
+							__m256 x = input[j];
+							sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_set1_ps(row[j]), x));
+							sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_set1_ps(row[inputCount + j]), x));
+							sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(_mm256_set1_ps(row[2 * inputCount + j]), x));
+							sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(_mm256_set1_ps(row[3 * inputCount + j]), x));
+						}
+
+						output[o] = (hidden ? _mm256_max_ps(sum0, zero) : sum0);
+						output[o + 1] = (hidden ? _mm256_max_ps(sum1, zero) : sum1);
+						output[o + 2] = (hidden ? _mm256_max_ps(sum2, zero) : sum2);
+						output[o + 3] = (hidden ? _mm256_max_ps(sum3, zero) : sum3);
+					}
+
+					for (; o < layer.OutputCount; ++o)
+					{
+						const float* row = weights + static_cast<size_t>(o) * inputCount;
+						__m256 sum = _mm256_set1_ps(layer.Biases[o]);
+						for (uint32_t j = 0; j < inputCount; ++j)
+						{
+							sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(row[j]), input[j]));
+						}
+						output[o] = (hidden ? _mm256_max_ps(sum, zero) : sum);
+					}
+
+					input = output;
+				}
+
+				// the first of equal outputs wins
+				__m256 best = input[0];
+				__m256i action = _mm256_setzero_si256();
+				for (uint32_t a = 1; a < PolicyNetwork::ActionCount; ++a)
+				{
+					__m256 better = _mm256_cmp_ps(input[a], best, _CMP_GT_OQ);
+					best = _mm256_blendv_ps(best, input[a], better);
+					action = _mm256_blendv_epi8(action, _mm256_set1_epi32(static_cast<int32_t>(a)), _mm256_castps_si256(better));
+				}
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(args.Actions + i), action);
+			}
+		}
+#else
+		void EvaluateAvx2(const PolicyKernelArgs& args)
+		{
+			EvaluateScalar(args);
+		}
+#endif
+	}
+}
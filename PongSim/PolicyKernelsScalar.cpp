@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "PolicyKernels.h"
+#include "PolicyNetwork.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace PolicyKernels
+	{
+		void EvaluateScalar(const PolicyKernelArgs& args)
+		{
+			float buffers[2][PolicyNetwork::MaxLayerWidth];
+
+			for (size_t i = 0; i < args.Count; ++i)
+			{
+				float* input = buffers[0];
+				for (uint32_t k = 0; k < PolicyNetwork::FeatureCount; ++k)
+				{
+					input[k] = args.Features[k * args.Stride + i];
+				}
+
+				for (size_t l = 0; l < args.LayerCount; ++l)
+				{
+					const PolicyLayer& layer = args.Layers[l];
+					bool hidden = (l + 1 < args.LayerCount);
+					float* output = (input == buffers[0] ? buffers[1] : buffers[0]);
+
+					for (uint32_t o = 0; o < layer.OutputCount; ++o)
+					{
+						const float* row = layer.Weights.data() + static_cast<size_t>(o) * layer.InputCount;
+						float sum = layer.Biases[o];
+						for (uint32_t j = 0; j < layer.InputCount; ++j)
+						{
+							sum += row[j] * input[j];
+						}
+
+						// written like maxps so -0.0f comes out as 0.0f on every path
+						output[o] = (hidden && !(sum > 0.0f) ? 0.0f : sum);
+					}
+
+					input = output;
+				}
+
+				// the first of equal outputs wins
+				int32_t action = 0;
+				for (uint32_t a = 1; a < PolicyNetwork::ActionCount; ++a)
+				{
+					if (input[a] > input[action])
+					{
+						action = static_cast<int32_t>(a);
+					}
+				}
+				args.Actions[i] = action;
+			}
+		}
+	}
+}
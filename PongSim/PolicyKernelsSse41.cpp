@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "PolicyKernels.h"
+#include "MatchBatchKernels.h"
+#include "PolicyNetwork.h"
+
+#if defined(PONGSIM_X86_KERNELS)
+#include <smmintrin.h>
+#endif
+
+using namespace std;
+
+namespace Pong
+{
+	namespace PolicyKernels
+	{
+#if defined(PONGSIM_X86_KERNELS)
+		// Four paddles per vector. Four outputs are summed side by side so the adds don't wait on
+		// each other, while each output still adds its products in the scalar order.
+		void EvaluateSse41(const PolicyKernelArgs& args)
+		{
+			__m128 buffers[2][PolicyNetwork::MaxLayerWidth];
+			const __m128 zero = _mm_setzero_ps();
+
+			for (size_t i = 0; i < args.Count; i += 4)
+			{
+				__m128* input = buffers[0];
+				for (uint32_t k = 0; k < PolicyNetwork::FeatureCount; ++k)
+				{
+					input[k] = _mm_loadu_ps(args.Features + k * args.Stride + i);
+				}
+
+				for (size_t l = 0; l < args.LayerCount; ++l)
+				{
+					const PolicyLayer& layer = args.Layers[l];
+					const float* weights = layer.Weights.data();
+					const uint32_t inputCount = layer.InputCount;
+					bool hidden = (l + 1 < args.LayerCount);
+					__m128* output = (input == buffers[0] ? buffers[1] : buffers[0]);
+
+					uint32_t o = 0;
+					for (; o + 4 <= layer.OutputCount; o += 4)
+					{
+						const float* row = weights + static_cast<size_t>(o) * inputCount;
+						__m128 sum0 = _mm_set1_ps(layer.Biases[o]);
+						__m128 sum1 = _mm_set1_ps(layer.Biases[o + 1]);
+						__m128 sum2 = _mm_set1_ps(layer.Biases[o + 2]);
+						__m128 sum3 = _mm_set1_ps(layer.Biases[o + 3]);
+						for (uint32_t j = 0; j < inputCount; ++j)
+						{
+							__m128 x = input[j];
+							sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_set1_ps(row[j]), x));
+							sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_set1_ps(row[inputCount + j]), x));
+							sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_set1_ps(row[2 * inputCount + j]), x));
+							sum3 = _mm_add_ps(sum3, _mm_mul_ps(_mm_set1_ps(row[3 * inputCount + j]), x));
+						}
+
+						output[o] = (hidden ? _mm_max_ps(sum0, zero) : sum0);
+						output[o + 1] = (hidden ? _mm_max_ps(sum1, zero) : sum1);
+						output[o + 2] = (hidden ? _mm_max_ps(sum2, zero) : sum2);
+						output[o + 3] = (hidden ? _mm_max_ps(sum3, zero) : sum3);
+					}
+
+					for (; o < layer.OutputCount; ++o)
+					{
+						const float* row = weights + static_cast<size_t>(o) * inputCount;
+						__m128 sum = _mm_set1_ps(layer.Biases[o]);
+						for (uint32_t j = 0; j < inputCount; ++j)
+						{
+							sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[j]), input[j]));
+						}
+						output[o] = (hidden ? _mm_max_ps(sum, zero) : sum);
+					}
+
+					input = output;
+				}
+
+				// the first of equal outputs wins
+				__m128 best = input[0];
+				__m128i action = _mm_setzero_si128();
+				for (uint32_t a = 1; a < PolicyNetwork::ActionCount; ++a)
+				{
+					__m128 better = _mm_cmpgt_ps(input[a], best);
+					best = _mm_blendv_ps(best, input[a], better);
+					action = _mm_blendv_epi8(action, _mm_set1_epi32(static_cast<int32_t>(a)), _mm_castps_si128(better));
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(args.Actions + i), action);
+			}
+		}
+#else
+		void EvaluateSse41(const PolicyKernelArgs& args)
+		{
+			EvaluateScalar(args);
+		}
+#endif
+	}
+}
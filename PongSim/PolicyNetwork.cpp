@@ -0,0 +1,278 @@
+#include "pch.h"
+#include "PolicyNetwork.h"
+#include "MappedFile.h"
+#include "PolicyKernels.h"
+#include "Profiler.h"
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const uint8_t Magic[4] = { 'P', 'P', 'O', 'L' };
+		const uint32_t FormatVersion = 1;
+
+		void WriteUint32(ofstream& stream, uint32_t value)
+		{
+			uint8_t bytes[4] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24) };
+			stream.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+		}
+
+		void WriteFloats(ofstream& stream, const vector<float>& values)
+		{
+			for (float value : values)
+			{
+				uint32_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+				WriteUint32(stream, bits);
+			}
+		}
+
+		struct FileReader final
+		{
+			const uint8_t* Position;
+			const uint8_t* End;
+			const string& Path;
+
+			uint32_t Uint32()
+			{
+				if (End - Position < 4)
+				{
+					throw runtime_error(Path + " is truncated.");
+				}
+
+				uint32_t value = Position[0] | (Position[1] << 8) | (Position[2] << 16) | (static_cast<uint32_t>(Position[3]) << 24);
+				Position += 4;
+				return value;
+			}
+
+			void Floats(vector<float>& values, size_t count)
+			{
+				values.resize(count);
+				for (float& value : values)
+				{
+					uint32_t bits = Uint32();
+					memcpy(&value, &bits, sizeof(value));
+				}
+			}
+		};
+
+		// ballX, ballY and paddleY are top edges; side is 1 for player 1 and -1 for player 2
+		void WriteFeatures(const MatchConfig& config, float side, float ballX, float ballY, float velocityX, float velocityY, float paddleY, float* features, size_t stride)
+		{
+			float ballCenterX = ballX + config.BallWidth / 2;
+			float ballCenterY = ballY + config.BallHeight / 2;
+			float paddleCenterX = (side > 0.0f ? config.PaddleWallOffset : config.ViewportWidth - config.PaddleWallOffset) + config.PaddleWidth / 2;
+			float paddleCenterY = paddleY + config.PaddleHeight / 2;
+			float maxSpeed = static_cast<float>(config.MaxBallSpeed);
+
+			features[0 * stride] = side * (ballCenterX - paddleCenterX) / config.ViewportWidth;
+			features[1 * stride] = -side * velocityX / maxSpeed; // positive while the ball approaches
+			features[2 * stride] = (ballCenterY - paddleCenterY) / config.ViewportHeight;
+			features[3 * stride] = velocityY / maxSpeed;
+			features[4 * stride] = paddleCenterY / config.ViewportHeight - 0.5f;
+			features[5 * stride] = ballCenterY / config.ViewportHeight - 0.5f;
+		}
+	}
+
+	PolicyNetwork::PolicyNetwork(const string& path)
+	{
+		MappedFile file(path);
+		FileReader reader{ file.Data(), file.Data() + file.Size(), path };
+
+		if (file.Size() < sizeof(Magic) || memcmp(file.Data(), Magic, sizeof(Magic)) != 0)
+		{
+			throw runtime_error(path + " is not a policy network.");
+		}
+		reader.Position += sizeof(Magic);
+
+		if (reader.Uint32() != FormatVersion)
+		{
+			throw runtime_error(path + " was written by a different policy version.");
+		}
+
+		uint32_t layerCount = reader.Uint32();
+		if (layerCount == 0 || layerCount > 16)
+		{
+			throw runtime_error(path + " has an unsupported number of layers.");
+		}
+
+		mLayers.resize(layerCount);
+		for (PolicyLayer& layer : mLayers)
+		{
+			layer.InputCount = reader.Uint32();
+			layer.OutputCount = reader.Uint32();
+			if (layer.InputCount == 0 || layer.InputCount > MaxLayerWidth || layer.OutputCount == 0 || layer.OutputCount > MaxLayerWidth)
+			{
+				throw runtime_error(path + " has a layer wider than " + to_string(MaxLayerWidth) + ".");
+			}
+
+			reader.Floats(layer.Weights, static_cast<size_t>(layer.InputCount) * layer.OutputCount);
+			reader.Floats(layer.Biases, layer.OutputCount);
+		}
+
+		Validate(path);
+	}
+
+	PolicyNetwork::PolicyNetwork(const vector<uint32_t>& hiddenWidths, uint32_t seed)
+	{
+		minstd_rand generator(seed);
+
+		uint32_t inputCount = FeatureCount;
+		for (size_t i = 0; i <= hiddenWidths.size(); ++i)
+		{
+			PolicyLayer layer;
+			layer.InputCount = inputCount;
+			layer.OutputCount = (i < hiddenWidths.size() ? hiddenWidths[i] : ActionCount);
+			layer.Weights.resize(static_cast<size_t>(layer.InputCount) * layer.OutputCount);
+			layer.Biases.assign(layer.OutputCount, 0.0f);
+
+			// He initialization, drawn straight from the generator so every standard library agrees
+			float limit = sqrt(6.0f / static_cast<float>(layer.InputCount));
+			for (float& weight : layer.Weights)
+			{
+				float unit = static_cast<float>(generator() - minstd_rand::min()) / static_cast<float>(minstd_rand::max() - minstd_rand::min());
+				weight = limit * (2.0f * unit - 1.0f);
+			}
+
+			inputCount = layer.OutputCount;
+			mLayers.push_back(move(layer));
+		}
+
+		Validate("A policy network");
+	}
+
+	const vector<PolicyLayer>& PolicyNetwork::Layers() const
+	{
+		return mLayers;
+	}
+
+	vector<PolicyLayer>& PolicyNetwork::Layers()
+	{
+		return mLayers;
+	}
+
+	void PolicyNetwork::Save(const string& path) const
+	{
+		ofstream stream(path, ios::binary | ios::trunc);
+		if (!stream)
+		{
+			throw runtime_error("Could not create " + path + ".");
+		}
+
+		stream.write(reinterpret_cast<const char*>(Magic), sizeof(Magic));
+		WriteUint32(stream, FormatVersion);
+		WriteUint32(stream, static_cast<uint32_t>(mLayers.size()));
+		for (const PolicyLayer& layer : mLayers)
+		{
+			WriteUint32(stream, layer.InputCount);
+			WriteUint32(stream, layer.OutputCount);
+			WriteFloats(stream, layer.Weights);
+			WriteFloats(stream, layer.Biases);
+		}
+
+		if (!stream.flush())
+		{
+			throw runtime_error("Could not write " + path + ".");
+		}
+	}
+
+	void PolicyNetwork::Features(const MatchState& match, Players player, float* features)
+	{
+		const PaddleState& paddle = (player == Players::Player1 ? match.Paddle1 : match.Paddle2);
+		const BallState& ball = match.Ball;
+		float side = (player == Players::Player1 ? 1.0f : -1.0f);
+
+		WriteFeatures(match.Config, side, ball.Bounds.X, ball.Bounds.Y, ball.Velocity.X, ball.Velocity.Y, paddle.Bounds.Y, features, 1);
+	}
+
+	void PolicyNetwork::BatchFeatures(const MatchBatch& batch, float* features, size_t stride)
+	{
+		// the batch only takes inputs for player 1
+		const MatchConfig& config = batch.Config();
+		const float* ballX = batch.BallX();
+		const float* ballY = batch.BallY();
+		const float* velocityX = batch.BallVelocityX();
+		const float* velocityY = batch.BallVelocityY();
+		const float* paddleY = batch.Paddle1Y();
+
+		for (size_t i = 0; i < batch.Size(); ++i)
+		{
+			WriteFeatures(config, 1.0f, ballX[i], ballY[i], velocityX[i], velocityY[i], paddleY[i], features + i, stride);
+		}
+	}
+
+	PaddleInputs PolicyNetwork::Inputs(PolicyAction action)
+	{
+		PaddleInputs inputs;
+		inputs.Up = (action == PolicyAction::Up);
+		inputs.Down = (action == PolicyAction::Down);
+
+		return inputs;
+	}
+
+	PolicyAction PolicyNetwork::Decide(const float* features) const
+	{
+		int32_t action;
+		PolicyKernelArgs args{ mLayers.data(), mLayers.size(), features, 1, 1, &action };
+		PolicyKernels::EvaluateScalar(args);
+
+		return static_cast<PolicyAction>(action);
+	}
+
+	void PolicyNetwork::Evaluate(const float* features, size_t stride, size_t count, int32_t* actions, KernelPath path) const
+	{
+		PONG_PROFILE_SCOPE("PolicyNetwork::Evaluate");
+		assert(MatchBatch::IsKernelPathSupported(path));
+
+		PolicyKernelArgs args{ mLayers.data(), mLayers.size(), features, stride, count, actions };
+		size_t width = (path == KernelPath::Avx2 ? 8 : (path == KernelPath::Sse41 ? 4 : 1));
+		args.Count = count / width * width;
+
+		switch (path)
+		{
+		case KernelPath::Avx2:
+			PolicyKernels::EvaluateAvx2(args);
+			break;
+
+		case KernelPath::Sse41:
+			PolicyKernels::EvaluateSse41(args);
+			break;
+
+		default:
+			PolicyKernels::EvaluateScalar(args);
+			break;
+		}
+
+		// whatever doesn't fill a whole vector
+		if (args.Count < count)
+		{
+			args.Features = features + args.Count;
+			args.Actions = actions + args.Count;
+			args.Count = count - args.Count;
+			PolicyKernels::EvaluateScalar(args);
+		}
+	}
+
+	void PolicyNetwork::Validate(const string& name) const
+	{
+		uint32_t inputCount = FeatureCount;
+		for (const PolicyLayer& layer : mLayers)
+		{
+			if (layer.InputCount != inputCount || layer.OutputCount == 0 || layer.OutputCount > MaxLayerWidth ||
+				layer.Weights.size() != static_cast<size_t>(layer.InputCount) * layer.OutputCount || layer.Biases.size() != layer.OutputCount)
+			{
+				throw runtime_error(name + " has layers that don't fit together.");
+			}
+			inputCount = layer.OutputCount;
+		}
+
+		if (mLayers.empty() || inputCount != ActionCount)
+		{
+			throw runtime_error(name + " doesn't end in " + to_string(ActionCount) + " actions.");
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "MatchBatch.h"
+#include "MatchInputs.h"
+#include "MatchState.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	// What a paddle does for one step, in the order of the network's outputs.
+	enum class PolicyAction : int32_t
+	{
+		Up = 0,
+		Stay = 1,
+		Down = 2,
+	};
+
+	struct PolicyLayer final
+	{
+		uint32_t InputCount = 0;
+		uint32_t OutputCount = 0;
+		std::vector<float> Weights; // OutputCount rows of InputCount
+		std::vector<float> Biases;
+	};
+
+	// A small multilayer perceptron that picks a PolicyAction from one paddle's view of the match.
+	// Hidden layers use ReLU and the action is the largest output. Features are measured from the
+	// controlled paddle's side of the court, so a network trained as player 1 can play player 2.
+	//
+	// File layout: "PPOL", version, layer count, then each layer's input and output counts, its
+	// weights row by row and its biases, all little-endian.
+	class PolicyNetwork final
+	{
+	public:
+		static const uint32_t FeatureCount = 6;
+		static const uint32_t ActionCount = 3;
+		static const uint32_t MaxLayerWidth = 64;
+
+		explicit PolicyNetwork(const std::string& path);
+		PolicyNetwork(const std::vector<uint32_t>& hiddenWidths, uint32_t seed);
+
+		const std::vector<PolicyLayer>& Layers() const;
+		std::vector<PolicyLayer>& Layers();
+		void Save(const std::string& path) const;
+
+		static void Features(const MatchState& match, Players player, float* features);
+		static void BatchFeatures(const MatchBatch& batch, float* features, std::size_t stride);
+		static PaddleInputs Inputs(PolicyAction action);
+
+		PolicyAction Decide(const float* features) const;
+
+		// Decides count paddles at once. Feature k of paddle i is features[k * stride + i].
+		void Evaluate(const float* features, std::size_t stride, std::size_t count, int32_t* actions, KernelPath path) const;
+
+	private:
+		void Validate(const std::string& name) const;
+
+		std::vector<PolicyLayer> mLayers;
+	};
+}
@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		uint32_t CurrentThread()
+		{
+			static atomic<uint32_t> sNextThread(1);
+			thread_local uint32_t tThread = sNextThread++;
+			return tThread;
+		}
+
+		double Milliseconds(uint64_t nanoseconds)
+		{
+			return nanoseconds / 1e6;
+		}
+	}
+
+	const size_t Profiler::Capacity = 1 << 16;
+
+	Profiler::Profiler() :
+		mSlots(new Slot[Capacity]), mNextSlot(0)
+	{
+		for (size_t i = 0; i < Capacity; ++i)
+		{
+			mSlots[i].Sequence.store(0, memory_order_relaxed);
+			mSlots[i].Name.store(nullptr, memory_order_relaxed);
+			mSlots[i].Thread.store(0, memory_order_relaxed);
+			mSlots[i].Start.store(0, memory_order_relaxed);
+			mSlots[i].Duration.store(0, memory_order_relaxed);
+		}
+	}
+
+	Profiler& Profiler::Instance()
+	{
+		static Profiler sInstance;
+		return sInstance;
+	}
+
+	uint64_t Profiler::Now()
+	{
+		return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	void Profiler::Record(const char* name, uint64_t startNanoseconds, uint64_t durationNanoseconds)
+	{
+		uint64_t index = mNextSlot.fetch_add(1, memory_order_relaxed);
+		Slot& slot = mSlots[index & (Capacity - 1)];
+
+		// odd while the slot is being written; readers only trust a slot whose sequence is the same
+		// even number before and after they copy it
+		slot.Sequence.store(index * 2 + 1, memory_order_relaxed);
+		atomic_thread_fence(memory_order_release);
+		slot.Name.store(name, memory_order_relaxed);
+		slot.Thread.store(CurrentThread(), memory_order_relaxed);
+		slot.Start.store(startNanoseconds, memory_order_relaxed);
+		slot.Duration.store(durationNanoseconds, memory_order_relaxed);
+		slot.Sequence.store(index * 2 + 2, memory_order_release);
+	}
+
+	vector<ProfileSample> Profiler::Samples() const
+	{
+		uint64_t end = mNextSlot.load(memory_order_acquire);
+		uint64_t begin = (end > Capacity ? end - Capacity : 0);
+
+		vector<ProfileSample> samples;
+		samples.reserve(static_cast<size_t>(end - begin));
+		for (uint64_t index = begin; index < end; ++index)
+		{
+			const Slot& slot = mSlots[index & (Capacity - 1)];
+			uint64_t sequence = index * 2 + 2;
+			if (slot.Sequence.load(memory_order_acquire) != sequence)
+			{
+				continue;
+			}
+
+			ProfileSample sample;
+			sample.Name = slot.Name.load(memory_order_relaxed);
+			sample.Thread = slot.Thread.load(memory_order_relaxed);
+			sample.StartNanoseconds = slot.Start.load(memory_order_relaxed);
+			sample.DurationNanoseconds = slot.Duration.load(memory_order_relaxed);
+
+			atomic_thread_fence(memory_order_acquire);
+			if (slot.Sequence.load(memory_order_relaxed) == sequence)
+			{
+				samples.push_back(sample);
+			}
+		}
+
+		return samples;
+	}
+
+	vector<PhaseSummary> Profiler::Summarize() const
+	{
+		// the same literal can have different addresses in different translation units
+		vector<pair<const char*, vector<uint64_t>>> phases;
+		for (const ProfileSample& sample : Samples())
+		{
+			auto phase = find_if(phases.begin(), phases.end(), [&sample](const pair<const char*, vector<uint64_t>>& entry)
+			{
+				return entry.first == sample.Name || strcmp(entry.first, sample.Name) == 0;
+			});
+
+			if (phase == phases.end())
+			{
+				phases.emplace_back(sample.Name, vector<uint64_t>());
+				phase = phases.end() - 1;
+			}
+			phase->second.push_back(sample.DurationNanoseconds);
+		}
+
+		vector<PhaseSummary> summaries;
+		summaries.reserve(phases.size());
+		for (auto& phase : phases)
+		{
+			vector<uint64_t>& durations = phase.second;
+			sort(durations.begin(), durations.end());
+
+			PhaseSummary summary;
+			summary.Name = phase.first;
+			summary.Count = durations.size();
+			summary.P50Milliseconds = Milliseconds(durations[(durations.size() - 1) * 50 / 100]);
+			summary.P99Milliseconds = Milliseconds(durations[(durations.size() - 1) * 99 / 100]);
+			summary.MaxMilliseconds = Milliseconds(durations.back());
+			summaries.push_back(summary);
+		}
+
+		return summaries;
+	}
+
+	void Profiler::WriteChromeTrace(ostream& stream) const
+	{
+		vector<ProfileSample> samples = Samples();
+
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		for (size_t i = 0; i < samples.size(); ++i)
+		{
+			const ProfileSample& sample = samples[i];
+			stream << (i == 0 ? "" : ",") << "\n{\"name\":\"";
+			for (const char* character = sample.Name; *character != '\0'; ++character)
+			{
+				if (*character == '"' || *character == '\\')
+				{
+					stream << '\\';
+				}
+				stream << *character;
+			}
+
+			// trace-event times are in microseconds
+			stream << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << sample.Thread << ",\"ts\":" << sample.StartNanoseconds / 1000
+				<< "." << setfill('0') << setw(3) << sample.StartNanoseconds % 1000 << ",\"dur\":" << sample.DurationNanoseconds / 1000
+				<< "." << setw(3) << sample.DurationNanoseconds % 1000 << setfill(' ') << "}";
+		}
+		stream << "\n]}\n";
+	}
+}
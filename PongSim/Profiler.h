@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// PONG_PROFILE_SCOPE("Name") times the rest of the enclosing block. Without PONG_PROFILE defined it
+// expands to nothing, so shipping builds pay nothing for the instrumentation.
+#if defined(PONG_PROFILE)
+#define PONG_PROFILE_CONCAT_INNER(left, right) left##right
+#define PONG_PROFILE_CONCAT(left, right) PONG_PROFILE_CONCAT_INNER(left, right)
+#define PONG_PROFILE_SCOPE(name) ::Pong::ProfileScope PONG_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PONG_PROFILE_SCOPE(name) static_cast<void>(0)
+#endif
+
+namespace Pong
+{
+	struct ProfileSample final
+	{
+		const char* Name = nullptr;
+		uint32_t Thread = 0;
+		uint64_t StartNanoseconds = 0;
+		uint64_t DurationNanoseconds = 0;
+	};
+
+	struct PhaseSummary final
+	{
+		const char* Name = nullptr;
+		size_t Count = 0;
+		double P50Milliseconds = 0.0;
+		double P99Milliseconds = 0.0;
+		double MaxMilliseconds = 0.0;
+	};
+
+	// Keeps the most recent samples from every thread in a fixed ring. Writers claim a slot with
+	// one atomic increment and publish it with a sequence number, so recording never blocks;
+	// readers skip any slot that is mid-write. Phase names must be string literals.
+	class Profiler final
+	{
+	public:
+		static const size_t Capacity;
+
+		static Profiler& Instance();
+		static uint64_t Now();
+
+		Profiler(const Profiler&) = delete;
+		Profiler& operator=(const Profiler&) = delete;
+
+		void Record(const char* name, uint64_t startNanoseconds, uint64_t durationNanoseconds);
+
+		// oldest first
+		std::vector<ProfileSample> Samples() const;
+
+		// per phase, in order of first appearance
+		std::vector<PhaseSummary> Summarize() const;
+
+		// Chrome trace-event JSON, for chrome://tracing or Perfetto
+		void WriteChromeTrace(std::ostream& stream) const;
+
+	private:
+		struct Slot final
+		{
+			std::atomic<uint64_t> Sequence;
+			std::atomic<const char*> Name;
+			std::atomic<uint32_t> Thread;
+			std::atomic<uint64_t> Start;
+			std::atomic<uint64_t> Duration;
+		};
+
+		Profiler();
+
+		std::unique_ptr<Slot[]> mSlots;
+		std::atomic<uint64_t> mNextSlot;
+	};
+
+	class ProfileScope final
+	{
+	public:
+		explicit ProfileScope(const char* name) : mName(name), mStart(Profiler::Now()) { }
+		~ProfileScope() { Profiler::Instance().Record(mName, mStart, Profiler::Now() - mStart); }
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		const char* mName;
+		uint64_t mStart;
+	};
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+namespace Pong
+{
+	// Sub-pixel rectangle with the same edge semantics as Library::Rectangle, so the simulation
+	// keeps the bounds tests the game components used to do themselves.
+	struct Rect final
+	{
+		float X;
+		float Y;
+		float Width;
+		float Height;
+
+		Rect() : X(0.0f), Y(0.0f), Width(0.0f), Height(0.0f) { }
+		Rect(float x, float y, float width, float height) : X(x), Y(y), Width(width), Height(height) { }
+
+		float Left() const { return X; }
+		float Right() const { return X + Width; }
+		float Top() const { return Y; }
+		float Bottom() const { return Y + Height; }
+		float CenterX() const { return X + Width / 2; }
+		float CenterY() const { return Y + Height / 2; }
+
+		static Rect Lerp(const Rect& from, const Rect& to, float amount)
+		{
+			return Rect(from.X + (to.X - from.X) * amount, from.Y + (to.Y - from.Y) * amount, to.Width, to.Height);
+		}
+
+		bool Intersects(const Rect& other) const
+		{
+			return other.Left() < Right() && Left() < other.Right() && other.Top() < Bottom() && Top() < other.Bottom();
+		}
+	};
+}
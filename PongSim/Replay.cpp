@@ -0,0 +1,655 @@
+#include "pch.h"
+#include "Replay.h"
+#include "Simulation.h"
+#include <cstring>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const uint8_t HeaderMagic[4] = { 'P', 'R', 'P', 'L' };
+		const uint8_t FooterMagic[4] = { 'P', 'R', 'I', 'X' };
+		const uint64_t FormatVersion = 4;
+		const size_t FooterSize = 8 + sizeof(FooterMagic);
+		const size_t FlushThreshold = 64 * 1024;
+		const uint64_t NoMismatch = UINT64_MAX;
+
+		namespace Buttons
+		{
+			enum Flags : uint32_t
+			{
+				Player1Up = 1 << 0,
+				Player1Down = 1 << 1,
+				Player2Up = 1 << 2,
+				Player2Down = 1 << 3,
+				Start = 1 << 4,
+			};
+
+			const uint32_t Bits = 5;
+		}
+
+		void WriteVarint(vector<uint8_t>& buffer, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				buffer.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			buffer.push_back(static_cast<uint8_t>(value));
+		}
+
+		void WriteSigned(vector<uint8_t>& buffer, int64_t value)
+		{
+			// zigzag, so small negative numbers stay small
+			WriteVarint(buffer, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+		}
+
+		void WriteFixed(vector<uint8_t>& buffer, uint64_t value, size_t bytes)
+		{
+			for (size_t i = 0; i < bytes; ++i)
+			{
+				buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+			}
+		}
+
+		void WriteFloat(vector<uint8_t>& buffer, float value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			WriteFixed(buffer, bits, sizeof(bits));
+		}
+
+		void WriteDouble(vector<uint8_t>& buffer, double value)
+		{
+			uint64_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			WriteFixed(buffer, bits, sizeof(bits));
+		}
+
+		void WriteRect(vector<uint8_t>& buffer, const Rect& rect)
+		{
+			WriteFloat(buffer, rect.X);
+			WriteFloat(buffer, rect.Y);
+			WriteFloat(buffer, rect.Width);
+			WriteFloat(buffer, rect.Height);
+		}
+
+		void WriteVector(vector<uint8_t>& buffer, const Vector2& vector)
+		{
+			WriteFloat(buffer, vector.X);
+			WriteFloat(buffer, vector.Y);
+		}
+
+		struct ByteReader final
+		{
+			const uint8_t* Position;
+			const uint8_t* End;
+
+			ByteReader(const uint8_t* position, const uint8_t* end) : Position(position), End(end) { }
+
+			void Require(size_t bytes) const
+			{
+				if (static_cast<size_t>(End - Position) < bytes)
+				{
+					throw runtime_error("Replay is truncated or corrupt.");
+				}
+			}
+
+			uint64_t Varint()
+			{
+				uint64_t value = 0;
+				for (uint32_t shift = 0; shift < 64; shift += 7)
+				{
+					Require(1);
+					uint8_t byte = *Position++;
+					value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+					if ((byte & 0x80) == 0)
+					{
+						return value;
+					}
+				}
+
+				throw runtime_error("Replay is truncated or corrupt.");
+			}
+
+			int64_t Signed()
+			{
+				uint64_t value = Varint();
+				return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+			}
+
+			uint64_t Fixed(size_t bytes)
+			{
+				Require(bytes);
+				uint64_t value = 0;
+				for (size_t i = 0; i < bytes; ++i)
+				{
+					value |= static_cast<uint64_t>(*Position++) << (8 * i);
+				}
+
+				return value;
+			}
+
+			float Float()
+			{
+				uint32_t bits = static_cast<uint32_t>(Fixed(sizeof(bits)));
+				float value;
+				memcpy(&value, &bits, sizeof(value));
+				return value;
+			}
+
+			double Double()
+			{
+				uint64_t bits = Fixed(sizeof(bits));
+				double value;
+				memcpy(&value, &bits, sizeof(value));
+				return value;
+			}
+
+			Rect ReadRect()
+			{
+				Rect rect;
+				rect.X = Float();
+				rect.Y = Float();
+				rect.Width = Float();
+				rect.Height = Float();
+				return rect;
+			}
+
+			Vector2 ReadVector()
+			{
+				Vector2 vector;
+				vector.X = Float();
+				vector.Y = Float();
+				return vector;
+			}
+		};
+
+		void WriteConfig(vector<uint8_t>& buffer, const MatchConfig& config)
+		{
+			WriteFloat(buffer, config.ViewportWidth);
+			WriteFloat(buffer, config.ViewportHeight);
+			WriteFloat(buffer, config.BallWidth);
+			WriteFloat(buffer, config.BallHeight);
+			WriteFloat(buffer, config.PaddleWidth);
+			WriteFloat(buffer, config.PaddleHeight);
+			WriteFloat(buffer, config.PaddleWallOffset);
+			WriteSigned(buffer, config.MinBallSpeed);
+			WriteSigned(buffer, config.MaxBallSpeed);
+			WriteFloat(buffer, config.PaddleSpeed);
+			WriteSigned(buffer, config.MaxScore);
+			WriteSigned(buffer, config.AIDelay);
+			WriteVarint(buffer, static_cast<uint64_t>(config.Collision));
+			WriteSigned(buffer, config.MaxSweepContacts);
+			WriteVarint(buffer, static_cast<uint64_t>(config.Player2Control));
+			WriteVarint(buffer, static_cast<uint64_t>(config.AI));
+			WriteFloat(buffer, config.AIError);
+			WriteVarint(buffer, static_cast<uint64_t>(config.Physics));
+		}
+
+		MatchConfig ReadConfig(ByteReader& reader)
+		{
+			MatchConfig config;
+			config.ViewportWidth = reader.Float();
+			config.ViewportHeight = reader.Float();
+			config.BallWidth = reader.Float();
+			config.BallHeight = reader.Float();
+			config.PaddleWidth = reader.Float();
+			config.PaddleHeight = reader.Float();
+			config.PaddleWallOffset = reader.Float();
+			config.MinBallSpeed = static_cast<int32_t>(reader.Signed());
+			config.MaxBallSpeed = static_cast<int32_t>(reader.Signed());
+			config.PaddleSpeed = reader.Float();
+			config.MaxScore = static_cast<int32_t>(reader.Signed());
+			config.AIDelay = static_cast<int32_t>(reader.Signed());
+			config.Collision = static_cast<CollisionMode>(reader.Varint());
+			config.MaxSweepContacts = static_cast<int32_t>(reader.Signed());
+			config.Player2Control = static_cast<PaddleControl>(reader.Varint());
+			config.AI = static_cast<AIMode>(reader.Varint());
+			config.AIError = reader.Float();
+			config.Physics = static_cast<PhysicsMode>(reader.Varint());
+
+			return config;
+		}
+
+		void WriteBody(vector<uint8_t>& buffer, const FixedBody& body)
+		{
+			WriteSigned(buffer, body.X.Raw);
+			WriteSigned(buffer, body.Y.Raw);
+			WriteSigned(buffer, body.Width.Raw);
+			WriteSigned(buffer, body.Height.Raw);
+			WriteSigned(buffer, body.VelocityX.Raw);
+			WriteSigned(buffer, body.VelocityY.Raw);
+		}
+
+		FixedBody ReadBody(ByteReader& reader)
+		{
+			FixedBody body;
+			body.X = Fixed::FromRaw(static_cast<int32_t>(reader.Signed()));
+			body.Y = Fixed::FromRaw(static_cast<int32_t>(reader.Signed()));
+			body.Width = Fixed::FromRaw(static_cast<int32_t>(reader.Signed()));
+			body.Height = Fixed::FromRaw(static_cast<int32_t>(reader.Signed()));
+			body.VelocityX = Fixed::FromRaw(static_cast<int32_t>(reader.Signed()));
+			body.VelocityY = Fixed::FromRaw(static_cast<int32_t>(reader.Signed()));
+			return body;
+		}
+
+		void WriteState(vector<uint8_t>& buffer, const MatchState& match)
+		{
+			uint32_t flags = (match.Ball.Player1Scored ? 1 : 0) | (match.Ball.Player2Scored ? 2 : 0) | (match.Ball.HitWall ? 4 : 0) | (match.IsIntersecting ? 8 : 0);
+
+			WriteRect(buffer, match.Ball.Bounds);
+			WriteVector(buffer, match.Ball.Velocity);
+			WriteRect(buffer, match.Paddle1.Bounds);
+			WriteVector(buffer, match.Paddle1.Velocity);
+			WriteRect(buffer, match.Paddle2.Bounds);
+			WriteVector(buffer, match.Paddle2.Velocity);
+			WriteVarint(buffer, flags);
+			WriteSigned(buffer, match.Player1Score);
+			WriteSigned(buffer, match.Player2Score);
+			WriteVarint(buffer, static_cast<uint64_t>(match.Gamestate));
+			WriteDouble(buffer, match.TotalTime);
+			WriteVarint(buffer, match.Events);
+			WriteVarint(buffer, match.Generator.Seed());
+			WriteVarint(buffer, match.Generator.Stream());
+			WriteVarint(buffer, match.Generator.Counter());
+			WriteFloat(buffer, match.AITargetY);
+			WriteSigned(buffer, match.AIPlanDirection);
+
+			// the float copies are rounded from these, so they're what the keyframe has to restore
+			if (match.Config.Physics == PhysicsMode::FixedPoint)
+			{
+				WriteBody(buffer, match.FixedState.Ball);
+				WriteBody(buffer, match.FixedState.Paddle1);
+				WriteBody(buffer, match.FixedState.Paddle2);
+				WriteSigned(buffer, match.FixedState.TotalTime);
+				WriteSigned(buffer, match.FixedState.AITargetY.Raw);
+			}
+		}
+
+		void ReadState(ByteReader& reader, MatchState& match)
+		{
+			match.Ball.Bounds = reader.ReadRect();
+			match.Ball.Velocity = reader.ReadVector();
+			match.Paddle1.Bounds = reader.ReadRect();
+			match.Paddle1.Velocity = reader.ReadVector();
+			match.Paddle2.Bounds = reader.ReadRect();
+			match.Paddle2.Velocity = reader.ReadVector();
+
+			uint64_t flags = reader.Varint();
+			match.Ball.Player1Scored = (flags & 1) != 0;
+			match.Ball.Player2Scored = (flags & 2) != 0;
+			match.Ball.HitWall = (flags & 4) != 0;
+			match.IsIntersecting = (flags & 8) != 0;
+
+			match.Player1Score = static_cast<int32_t>(reader.Signed());
+			match.Player2Score = static_cast<int32_t>(reader.Signed());
+			match.Gamestate = static_cast<Gamestate>(reader.Varint());
+			match.TotalTime = reader.Double();
+			match.Events = static_cast<uint32_t>(reader.Varint());
+
+			uint32_t seed = static_cast<uint32_t>(reader.Varint());
+			uint32_t stream = static_cast<uint32_t>(reader.Varint());
+			match.Generator = MatchRandom(seed, stream, reader.Varint());
+			match.AITargetY = reader.Float();
+			match.AIPlanDirection = static_cast<int32_t>(reader.Signed());
+
+			if (match.Config.Physics == PhysicsMode::FixedPoint)
+			{
+				match.FixedState.Ball = ReadBody(reader);
+				match.FixedState.Paddle1 = ReadBody(reader);
+				match.FixedState.Paddle2 = ReadBody(reader);
+				match.FixedState.TotalTime = reader.Signed();
+				match.FixedState.AITargetY = Fixed::FromRaw(static_cast<int32_t>(reader.Signed()));
+			}
+		}
+
+		uint32_t PackInputs(const MatchInputs& inputs)
+		{
+			uint32_t buttons = 0;
+			buttons |= (inputs.Player1.Up ? static_cast<uint32_t>(Buttons::Player1Up) : 0);
+			buttons |= (inputs.Player1.Down ? static_cast<uint32_t>(Buttons::Player1Down) : 0);
+			buttons |= (inputs.Player2.Up ? static_cast<uint32_t>(Buttons::Player2Up) : 0);
+			buttons |= (inputs.Player2.Down ? static_cast<uint32_t>(Buttons::Player2Down) : 0);
+			buttons |= (inputs.Start ? static_cast<uint32_t>(Buttons::Start) : 0);
+
+			return buttons;
+		}
+
+		MatchInputs UnpackInputs(uint32_t buttons)
+		{
+			MatchInputs inputs;
+			inputs.Player1.Up = (buttons & Buttons::Player1Up) != 0;
+			inputs.Player1.Down = (buttons & Buttons::Player1Down) != 0;
+			inputs.Player2.Up = (buttons & Buttons::Player2Up) != 0;
+			inputs.Player2.Down = (buttons & Buttons::Player2Down) != 0;
+			inputs.Start = (buttons & Buttons::Start) != 0;
+
+			return inputs;
+		}
+	}
+
+	const uint32_t ReplayWriter::DefaultKeyframeInterval = 600;
+
+	ReplayWriter::ReplayWriter(const string& path, const MatchConfig& config, uint32_t seed, float stepSeconds, uint32_t keyframeInterval) :
+		mStream(path, ios::binary | ios::trunc), mBufferOffset(0), mKeyframeInterval(keyframeInterval), mFrameCount(0),
+		mRunButtons(0), mRunLength(0), mFinished(false)
+	{
+		if (keyframeInterval == 0)
+		{
+			throw invalid_argument("Replays need a keyframe at least every so many frames.");
+		}
+
+		if (!mStream)
+		{
+			throw runtime_error("Could not create " + path + ".");
+		}
+
+		mBuffer.insert(mBuffer.end(), begin(HeaderMagic), end(HeaderMagic));
+		WriteVarint(mBuffer, FormatVersion);
+		WriteConfig(mBuffer, config);
+		WriteVarint(mBuffer, seed);
+		WriteFloat(mBuffer, stepSeconds);
+		WriteVarint(mBuffer, keyframeInterval);
+	}
+
+	ReplayWriter::~ReplayWriter()
+	{
+		try
+		{
+			Finish();
+		}
+		catch (...)
+		{
+			// a destructor can't report a failed write; call Finish to find out
+		}
+	}
+
+	void ReplayWriter::Record(const MatchState& match, const MatchInputs& inputs)
+	{
+		if (mFinished)
+		{
+			throw logic_error("Can't record into a finished replay.");
+		}
+
+		if (mFrameCount % mKeyframeInterval == 0)
+		{
+			// runs never cross a keyframe, so each chunk decodes on its own
+			FlushRun();
+			if (mBuffer.size() >= FlushThreshold)
+			{
+				FlushBuffer();
+			}
+
+			mKeyframeOffsets.push_back(mBufferOffset + mBuffer.size());
+			WriteState(mBuffer, match);
+		}
+
+		uint32_t buttons = PackInputs(inputs);
+		if (mRunLength > 0 && buttons == mRunButtons)
+		{
+			++mRunLength;
+		}
+		else
+		{
+			FlushRun();
+			mRunButtons = buttons;
+			mRunLength = 1;
+		}
+
+		++mFrameCount;
+	}
+
+	void ReplayWriter::Finish()
+	{
+		if (mFinished)
+		{
+			return;
+		}
+		mFinished = true;
+
+		FlushRun();
+		uint64_t indexOffset = mBufferOffset + mBuffer.size();
+
+		uint64_t previousFrame = 0;
+		uint64_t previousOffset = 0;
+		WriteVarint(mBuffer, mKeyframeOffsets.size());
+		for (size_t i = 0; i < mKeyframeOffsets.size(); ++i)
+		{
+			uint64_t frame = i * mKeyframeInterval;
+			WriteVarint(mBuffer, frame - previousFrame);
+			WriteVarint(mBuffer, mKeyframeOffsets[i] - previousOffset);
+			previousFrame = frame;
+			previousOffset = mKeyframeOffsets[i];
+		}
+		WriteVarint(mBuffer, mFrameCount);
+
+		WriteFixed(mBuffer, indexOffset, 8);
+		mBuffer.insert(mBuffer.end(), begin(FooterMagic), end(FooterMagic));
+		FlushBuffer();
+
+		mStream.close();
+		if (!mStream)
+		{
+			throw runtime_error("Could not finish writing the replay.");
+		}
+	}
+
+	uint64_t ReplayWriter::FrameCount() const
+	{
+		return mFrameCount;
+	}
+
+	void ReplayWriter::FlushRun()
+	{
+		if (mRunLength > 0)
+		{
+			WriteVarint(mBuffer, (static_cast<uint64_t>(mRunLength - 1) << Buttons::Bits) | mRunButtons);
+			mRunLength = 0;
+		}
+	}
+
+	void ReplayWriter::FlushBuffer()
+	{
+		mStream.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size());
+		mBufferOffset += mBuffer.size();
+		mBuffer.clear();
+	}
+
+	ReplayCursor::ReplayCursor(const ReplayReader& reader) :
+		mReader(&reader), mFrame(0), mNextKeyframe(0), mPosition(nullptr), mRunRemaining(0), mMismatchFrame(NoMismatch)
+	{
+	}
+
+	uint64_t ReplayCursor::Frame() const
+	{
+		return mFrame;
+	}
+
+	bool ReplayCursor::AtEnd() const
+	{
+		return mFrame >= mReader->FrameCount();
+	}
+
+	const MatchState& ReplayCursor::Match() const
+	{
+		return mMatch;
+	}
+
+	const MatchInputs& ReplayCursor::Inputs() const
+	{
+		return mInputs;
+	}
+
+	void ReplayCursor::Step()
+	{
+		if (AtEnd())
+		{
+			return;
+		}
+
+		Simulation::Step(mMatch, mInputs, mReader->mHeader.StepSeconds);
+		++mFrame;
+		--mRunRemaining;
+
+		if (mNextKeyframe < mReader->mKeyframes.size() && mReader->mKeyframes[mNextKeyframe].Frame == mFrame)
+		{
+			// the recorded state must match what the rules just produced, byte for byte
+			vector<uint8_t> simulated;
+			WriteState(simulated, mMatch);
+
+			ByteReader reader(mReader->ChunkStart(mNextKeyframe), mReader->mFile.Data() + mReader->mIndexOffset);
+			MatchState recorded = mMatch;
+			ReadState(reader, recorded);
+			if (mRunRemaining != 0 || static_cast<size_t>(reader.Position - mReader->ChunkStart(mNextKeyframe)) != simulated.size() ||
+				memcmp(simulated.data(), mReader->ChunkStart(mNextKeyframe), simulated.size()) != 0)
+			{
+				mMismatchFrame = min(mMismatchFrame, mFrame);
+			}
+
+			mPosition = reader.Position;
+			mRunRemaining = 0;
+			++mNextKeyframe;
+		}
+
+		ReadInputs();
+	}
+
+	bool ReplayCursor::MatchesKeyframes() const
+	{
+		return mMismatchFrame == NoMismatch;
+	}
+
+	uint64_t ReplayCursor::MismatchFrame() const
+	{
+		return mMismatchFrame;
+	}
+
+	void ReplayCursor::ReadInputs()
+	{
+		if (AtEnd())
+		{
+			mInputs = MatchInputs();
+			return;
+		}
+
+		if (mRunRemaining == 0)
+		{
+			ByteReader reader(mPosition, mReader->mFile.Data() + mReader->mIndexOffset);
+			uint64_t run = reader.Varint();
+			mPosition = reader.Position;
+			mRunRemaining = static_cast<uint32_t>(run >> Buttons::Bits) + 1;
+			mInputs = UnpackInputs(static_cast<uint32_t>(run & ((1u << Buttons::Bits) - 1)));
+		}
+	}
+
+	ReplayReader::ReplayReader(const string& path) :
+		mFile(path), mFrameCount(0), mIndexOffset(0)
+	{
+		const uint8_t* data = mFile.Data();
+		size_t size = mFile.Size();
+		if (size < sizeof(HeaderMagic) + FooterSize || memcmp(data, HeaderMagic, sizeof(HeaderMagic)) != 0 ||
+			memcmp(data + size - sizeof(FooterMagic), FooterMagic, sizeof(FooterMagic)) != 0)
+		{
+			throw runtime_error(path + " is not a finished replay.");
+		}
+
+		ByteReader header(data + sizeof(HeaderMagic), data + size - FooterSize);
+		if (header.Varint() != FormatVersion)
+		{
+			throw runtime_error(path + " was written by a different replay version.");
+		}
+		mHeader.Config = ReadConfig(header);
+		mHeader.Seed = static_cast<uint32_t>(header.Varint());
+		mHeader.StepSeconds = header.Float();
+		mHeader.KeyframeInterval = static_cast<uint32_t>(header.Varint());
+
+		ByteReader footer(data + size - FooterSize, data + size);
+		mIndexOffset = footer.Fixed(8);
+		if (mIndexOffset < static_cast<uint64_t>(header.Position - data) || mIndexOffset > size - FooterSize)
+		{
+			throw runtime_error("Replay is truncated or corrupt.");
+		}
+
+		ByteReader index(data + mIndexOffset, data + size - FooterSize);
+		uint64_t keyframeCount = index.Varint();
+		Keyframe keyframe = { 0, 0 };
+		for (uint64_t i = 0; i < keyframeCount; ++i)
+		{
+			keyframe.Frame += index.Varint();
+			keyframe.Offset += index.Varint();
+			if (keyframe.Offset >= mIndexOffset)
+			{
+				throw runtime_error("Replay is truncated or corrupt.");
+			}
+			mKeyframes.push_back(keyframe);
+		}
+		mFrameCount = index.Varint();
+
+		if ((mKeyframes.empty() && mFrameCount > 0) || (!mKeyframes.empty() && mKeyframes.front().Frame != 0))
+		{
+			throw runtime_error("Replay is truncated or corrupt.");
+		}
+	}
+
+	const ReplayHeader& ReplayReader::Header() const
+	{
+		return mHeader;
+	}
+
+	uint64_t ReplayReader::FrameCount() const
+	{
+		return mFrameCount;
+	}
+
+	size_t ReplayReader::KeyframeCount() const
+	{
+		return mKeyframes.size();
+	}
+
+	size_t ReplayReader::FileSize() const
+	{
+		return mFile.Size();
+	}
+
+	ReplayCursor ReplayReader::Seek(uint64_t frame) const
+	{
+		if (frame > mFrameCount)
+		{
+			throw out_of_range("Frame " + to_string(frame) + " is past the end of the replay.");
+		}
+
+		ReplayCursor cursor(*this);
+		cursor.mMatch = Simulation::CreateMatch(mHeader.Config, mHeader.Seed);
+		if (mKeyframes.empty())
+		{
+			return cursor;
+		}
+
+		auto keyframe = upper_bound(mKeyframes.begin(), mKeyframes.end(), frame, [](uint64_t value, const Keyframe& entry)
+		{
+			return value < entry.Frame;
+		}) - 1;
+
+		ByteReader reader(ChunkStart(keyframe - mKeyframes.begin()), mFile.Data() + mIndexOffset);
+		ReadState(reader, cursor.mMatch);
+		cursor.mFrame = keyframe->Frame;
+		cursor.mNextKeyframe = (keyframe - mKeyframes.begin()) + 1;
+		cursor.mPosition = reader.Position;
+		cursor.ReadInputs();
+
+		while (cursor.mFrame < frame)
+		{
+			cursor.Step();
+		}
+
+		return cursor;
+	}
+
+	const uint8_t* ReplayReader::ChunkStart(size_t keyframe) const
+	{
+		return mFile.Data() + mKeyframes[keyframe].Offset;
+	}
+}
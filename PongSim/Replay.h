@@ -0,0 +1,130 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "MatchInputs.h"
+#include "MatchState.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+	// Everything needed to rebuild a recorded match: it starts as Simulation::CreateMatch(Config, Seed)
+	// and every frame is one Simulation::Step of StepSeconds.
+	struct ReplayHeader final
+	{
+		MatchConfig Config;
+		uint32_t Seed = 0;
+		float StepSeconds = 0.0f;
+		uint32_t KeyframeInterval = 0;
+	};
+
+	// Replay layout:
+	//   header   magic, version, ReplayHeader
+	//   chunks   one per keyframe: the full match state, then that chunk's frame inputs as varint
+	//            runs of (length, buttons), so a held key costs a byte or two however long it's held
+	//   index    keyframe count, then (frame, offset) pairs delta encoded as varints
+	//   footer   index offset and end magic
+	class ReplayWriter final
+	{
+	public:
+		static const uint32_t DefaultKeyframeInterval;
+
+		ReplayWriter(const std::string& path, const MatchConfig& config, uint32_t seed, float stepSeconds, uint32_t keyframeInterval = DefaultKeyframeInterval);
+		~ReplayWriter();
+
+		ReplayWriter(const ReplayWriter&) = delete;
+		ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+		// match is the state before the inputs are stepped
+		void Record(const MatchState& match, const MatchInputs& inputs);
+		void Finish();
+
+		uint64_t FrameCount() const;
+
+	private:
+		void FlushRun();
+		void FlushBuffer();
+
+		std::ofstream mStream;
+		std::vector<uint8_t> mBuffer;
+		uint64_t mBufferOffset;
+		uint32_t mKeyframeInterval;
+		uint64_t mFrameCount;
+		uint32_t mRunButtons;
+		uint32_t mRunLength;
+		std::vector<uint64_t> mKeyframeOffsets;
+		bool mFinished;
+	};
+
+	class ReplayReader;
+
+	// Walks a replay one frame at a time from wherever ReplayReader::Seek put it.
+	class ReplayCursor final
+	{
+	public:
+		uint64_t Frame() const;
+		bool AtEnd() const;
+
+		// the match before this frame is stepped, and the inputs that step it
+		const MatchState& Match() const;
+		const MatchInputs& Inputs() const;
+
+		void Step();
+
+		// false once a recorded keyframe disagrees with the re-simulated match
+		bool MatchesKeyframes() const;
+		uint64_t MismatchFrame() const;
+
+	private:
+		friend class ReplayReader;
+
+		explicit ReplayCursor(const ReplayReader& reader);
+		void ReadInputs();
+
+		const ReplayReader* mReader;
+		MatchState mMatch;
+		MatchInputs mInputs;
+		uint64_t mFrame;
+		size_t mNextKeyframe;
+		const uint8_t* mPosition;
+		uint32_t mRunRemaining;
+		uint64_t mMismatchFrame;
+	};
+
+	// Reads a replay through a memory mapping. Seeking binary searches the keyframe index for the
+	// last keyframe at or before the frame, then re-simulates the few frames in between.
+	class ReplayReader final
+	{
+	public:
+		explicit ReplayReader(const std::string& path);
+
+		ReplayReader(const ReplayReader&) = delete;
+		ReplayReader& operator=(const ReplayReader&) = delete;
+
+		const ReplayHeader& Header() const;
+		uint64_t FrameCount() const;
+		size_t KeyframeCount() const;
+		size_t FileSize() const;
+
+		ReplayCursor Seek(uint64_t frame) const;
+
+	private:
+		friend class ReplayCursor;
+
+		struct Keyframe final
+		{
+			uint64_t Frame;
+			uint64_t Offset;
+		};
+
+		const uint8_t* ChunkStart(size_t keyframe) const;
+
+		MappedFile mFile;
+		ReplayHeader mHeader;
+		std::vector<Keyframe> mKeyframes;
+		uint64_t mFrameCount;
+		uint64_t mIndexOffset;
+	};
+}
@@ -0,0 +1,258 @@
+#include "pch.h"
+#include "RollbackSession.h"
+#include "Profiler.h"
+#include "FixedSimulation.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		namespace Buttons
+		{
+			enum Flags : uint8_t
+			{
+				Up = 1 << 0,
+				Down = 1 << 1,
+				Start = 1 << 2,
+			};
+		}
+
+		// FNV-1a, over the raw bits so -0.0f and 0.0f still count as different
+		struct Hasher final
+		{
+			uint64_t Value = 14695981039346656037ull;
+
+			void Add(const void* data, size_t size)
+			{
+				const uint8_t* bytes = static_cast<const uint8_t*>(data);
+				for (size_t i = 0; i < size; ++i)
+				{
+					Value = (Value ^ bytes[i]) * 1099511628211ull;
+				}
+			}
+
+			void Add(float value)
+			{
+				uint32_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+				Add(&bits, sizeof(bits));
+			}
+
+			void Add(const Rect& rect)
+			{
+				Add(rect.X);
+				Add(rect.Y);
+			}
+
+			void Add(const Vector2& vector)
+			{
+				Add(vector.X);
+				Add(vector.Y);
+			}
+		};
+	}
+
+	const uint32_t RollbackSession::Capacity;
+
+	RollbackSession::RollbackSession(const MatchConfig& config, uint32_t seed, Players localPlayer, const RollbackOptions& options) :
+		mOptions(options), mLocalPlayer(localPlayer), mMatch(Simulation::CreateMatch(config, seed)),
+		mFrame(0), mLocalFrame(options.InputDelay), mRemoteFrame(options.InputDelay), mRollbackFrame(NoRollback),
+		mLocalButtons(Capacity), mRemoteButtons(Capacity), mPredictedButtons(Capacity), mSnapshots(Capacity)
+	{
+		// inputs in flight and the snapshots they may roll back to have to fit in the rings together
+		if (2 * (options.InputDelay + options.MaxRollback + 1) > Capacity || options.MaxRollback == 0)
+		{
+			throw invalid_argument("Rollback needs between 1 and " + to_string(Capacity / 2 - 1 - options.InputDelay) + " frames of prediction.");
+		}
+
+		if (config.Player2Control != PaddleControl::Inputs)
+		{
+			throw invalid_argument("Both paddles of a network match take inputs.");
+		}
+	}
+
+	const RollbackOptions& RollbackSession::Options() const
+	{
+		return mOptions;
+	}
+
+	Players RollbackSession::LocalPlayer() const
+	{
+		return mLocalPlayer;
+	}
+
+	const MatchState& RollbackSession::Match() const
+	{
+		return mMatch;
+	}
+
+	const RollbackStats& RollbackSession::Stats() const
+	{
+		return mStats;
+	}
+
+	uint32_t RollbackSession::Frame() const
+	{
+		return mFrame;
+	}
+
+	uint32_t RollbackSession::LocalFrame() const
+	{
+		return mLocalFrame;
+	}
+
+	uint32_t RollbackSession::RemoteFrame() const
+	{
+		return mRemoteFrame;
+	}
+
+	uint8_t RollbackSession::LocalButtons(uint32_t frame) const
+	{
+		assert(frame < mLocalFrame && mLocalFrame - frame <= Capacity);
+		return mLocalButtons[frame % Capacity];
+	}
+
+	bool RollbackSession::NeedsLocalInput() const
+	{
+		return mLocalFrame <= mFrame + mOptions.InputDelay;
+	}
+
+	void RollbackSession::AddLocalInput(uint8_t buttons)
+	{
+		if (!NeedsLocalInput())
+		{
+			throw logic_error("Local inputs can only be InputDelay frames ahead of the match.");
+		}
+
+		mLocalButtons[mLocalFrame % Capacity] = buttons;
+		++mLocalFrame;
+	}
+
+	void RollbackSession::AddRemoteInput(uint32_t frame, uint8_t buttons)
+	{
+		// past the window the ring could be overwriting frames still needed for a rollback
+		if (frame != mRemoteFrame || frame >= mFrame + Capacity - mOptions.MaxRollback - 1)
+		{
+			return;
+		}
+
+		mRemoteButtons[frame % Capacity] = buttons;
+		++mRemoteFrame;
+
+		if (frame < mFrame && mPredictedButtons[frame % Capacity] != buttons)
+		{
+			mRollbackFrame = min(mRollbackFrame, frame);
+		}
+	}
+
+	bool RollbackSession::Advance()
+	{
+		if (mFrame >= mLocalFrame || mFrame >= mRemoteFrame + mOptions.MaxRollback)
+		{
+			++mStats.Stalls;
+			return false;
+		}
+
+		Rollback();
+
+		SimulateFrame(mFrame);
+		++mFrame;
+		++mStats.FramesAdvanced;
+
+		return true;
+	}
+
+	void RollbackSession::Rollback()
+	{
+		if (mRollbackFrame == NoRollback)
+		{
+			return;
+		}
+
+		PONG_PROFILE_SCOPE("Rollback");
+		auto startTime = chrono::steady_clock::now();
+
+		uint32_t depth = mFrame - mRollbackFrame;
+		mMatch = mSnapshots[mRollbackFrame % Capacity];
+		for (uint32_t frame = mRollbackFrame; frame < mFrame; ++frame)
+		{
+			SimulateFrame(frame);
+		}
+		mRollbackFrame = NoRollback;
+
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+		++mStats.Rollbacks;
+		mStats.ResimulatedFrames += depth;
+		mStats.MaxRollbackDepth = max(mStats.MaxRollbackDepth, depth);
+		mStats.ResimulationSeconds += elapsed.count();
+		mStats.MaxResimulationSeconds = max(mStats.MaxResimulationSeconds, elapsed.count());
+	}
+
+	void RollbackSession::SimulateFrame(uint32_t frame)
+	{
+		mSnapshots[frame % Capacity] = mMatch;
+
+		// until the real one arrives, the remote player is assumed to still hold what they last sent
+		uint8_t remote = (frame < mRemoteFrame ? mRemoteButtons[frame % Capacity] : (mRemoteFrame > 0 ? mRemoteButtons[(mRemoteFrame - 1) % Capacity] : 0));
+		mPredictedButtons[frame % Capacity] = remote;
+
+		uint8_t local = mLocalButtons[frame % Capacity];
+		uint8_t player1 = (mLocalPlayer == Players::Player1 ? local : remote);
+		uint8_t player2 = (mLocalPlayer == Players::Player1 ? remote : local);
+
+		MatchInputs inputs;
+		inputs.Player1 = UnpackButtons(player1);
+		inputs.Player2 = UnpackButtons(player2);
+		inputs.Start = ((player1 | player2) & Buttons::Start) != 0;
+
+		Simulation::Step(mMatch, inputs, mOptions.StepSeconds);
+	}
+
+	uint8_t RollbackSession::PackButtons(const PaddleInputs& inputs, bool start)
+	{
+		return static_cast<uint8_t>((inputs.Up ? Buttons::Up : 0) | (inputs.Down ? Buttons::Down : 0) | (start ? Buttons::Start : 0));
+	}
+
+	PaddleInputs RollbackSession::UnpackButtons(uint8_t buttons)
+	{
+		PaddleInputs inputs;
+		inputs.Up = (buttons & Buttons::Up) != 0;
+		inputs.Down = (buttons & Buttons::Down) != 0;
+
+		return inputs;
+	}
+
+	uint64_t RollbackSession::Checksum(const MatchState& match)
+	{
+		if (match.Config.Physics == PhysicsMode::FixedPoint)
+		{
+			return FixedSimulation::StateHash(match);
+		}
+
+		Hasher hasher;
+		hasher.Add(match.Ball.Bounds);
+		hasher.Add(match.Ball.Velocity);
+		hasher.Add(match.Paddle1.Bounds);
+		hasher.Add(match.Paddle1.Velocity);
+		hasher.Add(match.Paddle2.Bounds);
+		hasher.Add(match.Paddle2.Velocity);
+
+		int32_t values[] = { match.Player1Score, match.Player2Score, static_cast<int32_t>(match.Gamestate), match.IsIntersecting,
+			match.Ball.Player1Scored, match.Ball.Player2Scored, match.Ball.HitWall, match.AIPlanDirection };
+		hasher.Add(values, sizeof(values));
+		hasher.Add(match.AITargetY);
+		hasher.Add(&match.TotalTime, sizeof(match.TotalTime));
+
+		uint32_t key[] = { match.Generator.Seed(), match.Generator.Stream() };
+		uint64_t counter = match.Generator.Counter();
+		hasher.Add(key, sizeof(key));
+		hasher.Add(&counter, sizeof(counter));
+
+		return hasher.Value;
+	}
+}
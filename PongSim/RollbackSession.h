@@ -0,0 +1,91 @@
+#pragma once
+
+#include "FixedTimestep.h"
+#include "MatchInputs.h"
+#include "MatchState.h"
+#include <cstdint>
+#include <vector>
+
+namespace Pong
+{
+	struct RollbackOptions final
+	{
+		uint32_t InputDelay = 2; // frames between pressing a key and the simulation seeing it
+		uint32_t MaxRollback = 8; // how far the match may run ahead of the remote player's inputs
+		float StepSeconds = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+	};
+
+	struct RollbackStats final
+	{
+		uint64_t FramesAdvanced = 0;
+		uint64_t Stalls = 0; // Advance calls that had to wait for the remote player
+		uint64_t Rollbacks = 0;
+		uint64_t ResimulatedFrames = 0;
+		uint32_t MaxRollbackDepth = 0;
+		double ResimulationSeconds = 0.0;
+		double MaxResimulationSeconds = 0.0;
+	};
+
+	// Two-player match kept in step with a remote peer, GGPO style. Local inputs take effect
+	// InputDelay frames after they're added. Missing remote inputs are predicted by repeating the
+	// last one received, and when a real input turns out different the match restores the snapshot
+	// from that frame and simulates forward again. Snapshots are plain MatchState copies kept in a
+	// ring, so saving and restoring cost the same whatever happens in the match.
+	//
+	// Inputs travel as one byte per player per frame, made by PackButtons.
+	class RollbackSession final
+	{
+	public:
+		static const uint32_t Capacity = 64; // frames of inputs and snapshots kept
+
+		RollbackSession(const MatchConfig& config, uint32_t seed, Players localPlayer, const RollbackOptions& options);
+
+		const RollbackOptions& Options() const;
+		Players LocalPlayer() const;
+		const MatchState& Match() const;
+		const RollbackStats& Stats() const;
+
+		uint32_t Frame() const; // the next frame Advance simulates
+		uint32_t LocalFrame() const; // the next frame AddLocalInput fills
+		uint32_t RemoteFrame() const; // the first frame without the remote player's input
+		uint8_t LocalButtons(uint32_t frame) const;
+
+		bool NeedsLocalInput() const;
+		void AddLocalInput(uint8_t buttons);
+
+		// Remote inputs must arrive in frame order; duplicates and anything past a gap are ignored,
+		// since the peer keeps resending until acknowledged.
+		void AddRemoteInput(uint32_t frame, uint8_t buttons);
+
+		// Rolls back if a prediction was wrong, then simulates one frame. Returns false, and does
+		// nothing, when the match is as far ahead of the remote player as MaxRollback allows.
+		bool Advance();
+
+		// Restores and resimulates from the first mispredicted frame, if there is one, without
+		// simulating a new frame.
+		void Rollback();
+
+		static uint8_t PackButtons(const PaddleInputs& inputs, bool start);
+		static PaddleInputs UnpackButtons(uint8_t buttons);
+		static uint64_t Checksum(const MatchState& match);
+
+	private:
+		static const uint32_t NoRollback = UINT32_MAX;
+
+		void SimulateFrame(uint32_t frame);
+
+		RollbackOptions mOptions;
+		Players mLocalPlayer;
+		MatchState mMatch;
+		RollbackStats mStats;
+
+		uint32_t mFrame;
+		uint32_t mLocalFrame;
+		uint32_t mRemoteFrame;
+		uint32_t mRollbackFrame;
+		std::vector<uint8_t> mLocalButtons;
+		std::vector<uint8_t> mRemoteButtons;
+		std::vector<uint8_t> mPredictedButtons; // the remote input each simulated frame used
+		std::vector<MatchState> mSnapshots; // the match at the start of each frame
+	};
+}
@@ -0,0 +1,545 @@
+#include "pch.h"
+#include "Simulation.h"
+#include "FixedSimulation.h"
+#include "Profiler.h"
+
+using namespace std;
+
+namespace Pong
+{
+	MatchState Simulation::CreateMatch(const MatchConfig& config, uint32_t seed, uint32_t stream)
+	{
+		MatchState match;
+		match.Config = config;
+		match.Generator = MatchRandom(seed, stream);
+
+		match.Ball.Bounds = Rect(0, 0, config.BallWidth, config.BallHeight);
+		match.Paddle1.Bounds = Rect(0, 0, config.PaddleWidth, config.PaddleHeight);
+		match.Paddle1.Player = Players::Player1;
+		match.Paddle2.Bounds = Rect(0, 0, config.PaddleWidth, config.PaddleHeight);
+		match.Paddle2.Player = Players::Player2;
+
+		if (config.Physics == PhysicsMode::FixedPoint)
+		{
+			// the serve can't come from a standard library distribution
+			FixedSimulation::Reset(match);
+			return match;
+		}
+
+		ResetBall(match);
+		ResetPaddle(config, match.Paddle1);
+		ResetPaddle(config, match.Paddle2);
+		FreezeMotion(match);
+
+		return match;
+	}
+
+	void Simulation::Step(MatchState& match, const MatchInputs& inputs, float elapsedTime)
+	{
+		if (match.Config.Physics == PhysicsMode::FixedPoint)
+		{
+			FixedSimulation::Step(match, inputs, elapsedTime);
+			return;
+		}
+
+		PONG_PROFILE_SCOPE("Simulation::Step");
+		match.Events = MatchEvents::None;
+		match.TotalTime += elapsedTime;
+
+		if (match.Gamestate != Gamestate::Playing && inputs.Start)
+		{
+			ChangeGamestate(match, Gamestate::Playing);
+		}
+
+		if (match.Gamestate == Gamestate::Playing)
+		{
+			HandleBallPhysics(match);
+			if (IsAIPaddle(match.Config, match.Paddle2))
+			{
+				if (match.Config.AI == AIMode::Predictive)
+				{
+					AdjustPredictiveAIPaddleVelocity(match);
+				}
+				else
+				{
+					AdjustAIPaddleVelocity(match);
+				}
+			}
+			UpdatePlayerScores(match);
+		}
+
+		float startX = match.Ball.Bounds.X;
+		if (match.Config.Collision == CollisionMode::Swept)
+		{
+			// paddles move first so the ball is swept against where they are during the step
+			Rect paddle1Start = match.Paddle1.Bounds;
+			Rect paddle2Start = match.Paddle2.Bounds;
+			UpdateHumanPaddle(match.Config, match.Paddle1, inputs.Player1, elapsedTime);
+			UpdatePaddle2(match, inputs, elapsedTime);
+			SweepBall(match, elapsedTime, paddle1Start, paddle2Start);
+			CheckBallBounds(match);
+		}
+		else
+		{
+			UpdateBall(match, elapsedTime);
+			UpdateHumanPaddle(match.Config, match.Paddle1, inputs.Player1, elapsedTime);
+			UpdatePaddle2(match, inputs, elapsedTime);
+		}
+
+		// raised for a hit too, since discrete collision only notices the paddle once the ball is past its face
+		float paddle1Face = match.Paddle1.Bounds.Right();
+		float paddle2Face = match.Paddle2.Bounds.X - match.Ball.Bounds.Width;
+		if (startX >= paddle1Face && match.Ball.Bounds.X < paddle1Face)
+		{
+			match.Events |= MatchEvents::PassedPaddle1;
+		}
+		if (startX < paddle2Face && match.Ball.Bounds.X >= paddle2Face)
+		{
+			match.Events |= MatchEvents::PassedPaddle2;
+		}
+	}
+
+	void Simulation::ChangeGamestate(MatchState& match, Gamestate newGamestate)
+	{
+		if (match.Gamestate == Gamestate::Initial || match.Gamestate == Gamestate::Gameover)
+		{
+			// transitioning to playing
+			ResetBall(match);
+			ResetPaddle(match.Config, match.Paddle1);
+			ResetPaddle(match.Config, match.Paddle2);
+			match.Player1Score = 0;
+			match.Player2Score = 0;
+			match.Events |= MatchEvents::GameStarted;
+		}
+		else if (match.Gamestate == Gamestate::Playing)
+		{
+			// transitioning to gameover
+			FreezeMotion(match);
+			match.Events |= MatchEvents::GameOver;
+		}
+
+		match.Gamestate = newGamestate;
+	}
+
+	void Simulation::ResetBall(MatchState& match)
+	{
+		const MatchConfig& config = match.Config;
+		BallState& ball = match.Ball;
+
+		ball.Player1Scored = false;
+		ball.Player2Scored = false;
+		ball.Bounds.X = config.ViewportWidth / 2 - config.BallWidth / 2;
+		ball.Bounds.Y = config.ViewportHeight / 2 - config.BallHeight / 2;
+
+		ball.Velocity = ServeVelocity(config, match.Generator);
+		match.AIPlanDirection = 0;
+	}
+
+	Vector2 Simulation::ServeVelocity(const MatchConfig& config, MatchRandom& generator)
+	{
+		uint32_t block[MatchRandom::BlockSize];
+		generator.NextBlock(block);
+		return ServeVelocity(config, block);
+	}
+
+	Vector2 Simulation::ServeVelocity(const MatchConfig& config, const uint32_t (&block)[MatchRandom::BlockSize])
+	{
+		// one block per serve, scaled rather than taken through a distribution so every standard
+		// library and every batch of serves agrees on it
+		uint64_t range = static_cast<uint64_t>(config.MaxBallSpeed - config.MinBallSpeed) + 1;
+		int32_t speedX = config.MinBallSpeed + static_cast<int32_t>((block[0] * range) >> 32);
+		int32_t signX = (block[1] >> 31) ? 1 : -1;
+		int32_t speedY = config.MinBallSpeed + static_cast<int32_t>((block[2] * range) >> 32);
+		int32_t signY = (block[3] >> 31) ? 1 : -1;
+
+		return Vector2(static_cast<float>(speedX * signX), static_cast<float>(speedY * signY));
+	}
+
+	void Simulation::ResetPaddle(const MatchConfig& config, PaddleState& paddle)
+	{
+		// input driven paddles move at a fixed speed, the AI sets its own velocity
+		paddle.Velocity = (IsAIPaddle(config, paddle) ? Vector2() : Vector2(0.0f, config.PaddleSpeed));
+		paddle.Bounds.X = (paddle.Player == Players::Player1 ? config.PaddleWallOffset : config.ViewportWidth - config.PaddleWallOffset);
+
+		paddle.Bounds.Y = config.ViewportHeight / 2 - config.PaddleHeight / 2;
+	}
+
+	void Simulation::FreezeMotion(MatchState& match)
+	{
+		match.Paddle1.Velocity = Vector2();
+		match.Paddle2.Velocity = Vector2();
+		match.Ball.Velocity = Vector2();
+	}
+
+	bool Simulation::SameState(const MatchState& left, const MatchState& right)
+	{
+		return left.Ball.Bounds.X == right.Ball.Bounds.X && left.Ball.Bounds.Y == right.Ball.Bounds.Y &&
+			left.Ball.Velocity.X == right.Ball.Velocity.X && left.Ball.Velocity.Y == right.Ball.Velocity.Y &&
+			left.Ball.Player1Scored == right.Ball.Player1Scored && left.Ball.Player2Scored == right.Ball.Player2Scored &&
+			left.Ball.HitWall == right.Ball.HitWall &&
+			left.Paddle1.Bounds.Y == right.Paddle1.Bounds.Y && left.Paddle1.Velocity.Y == right.Paddle1.Velocity.Y &&
+			left.Paddle2.Bounds.Y == right.Paddle2.Bounds.Y && left.Paddle2.Velocity.Y == right.Paddle2.Velocity.Y &&
+			left.Player1Score == right.Player1Score && left.Player2Score == right.Player2Score &&
+			left.IsIntersecting == right.IsIntersecting && left.Gamestate == right.Gamestate && left.Events == right.Events &&
+			left.TotalTime == right.TotalTime && left.Generator == right.Generator &&
+			left.AITargetY == right.AITargetY && left.AIPlanDirection == right.AIPlanDirection &&
+			(left.Config.Physics != PhysicsMode::FixedPoint || FixedSimulation::StateHash(left) == FixedSimulation::StateHash(right));
+	}
+
+	void Simulation::HandleBallPhysics(MatchState& match)
+	{
+		PONG_PROFILE_SCOPE("HandleBallPhysics");
+		// swept collision handles paddle contacts while the ball moves
+		bool discrete = (match.Config.Collision == CollisionMode::Discrete);
+		bool paddle1Intersects = discrete && match.Ball.Bounds.Intersects(match.Paddle1.Bounds);
+		bool paddle2Intersects = discrete && match.Ball.Bounds.Intersects(match.Paddle2.Bounds);
+
+		// Did the ball hit a paddle?
+		if (paddle1Intersects || paddle2Intersects)
+		{
+			if (paddle2Intersects && IsAIPaddle(match.Config, match.Paddle2))
+			{
+				match.Paddle2.Velocity.Y = 0.0f;
+			}
+
+			if (!match.IsIntersecting)
+			{
+				match.Ball.Velocity.X *= -1.0f;
+
+				// this makes it so velocity only changes the one time
+				match.IsIntersecting = true;
+
+				match.Events |= MatchEvents::PaddleHit;
+			}
+		}
+		else
+		{
+			match.IsIntersecting = false;
+		}
+
+		// Did the ball hit a wall?
+		if (match.Ball.HitWall)
+		{
+			match.Ball.HitWall = false;
+			match.Events |= MatchEvents::WallHit;
+		}
+	}
+
+	void Simulation::AdjustAIPaddleVelocity(MatchState& match)
+	{
+		PONG_PROFILE_SCOPE("AdjustAIPaddleVelocity");
+		PaddleState& paddle = match.Paddle2;
+
+		// don't attempt to follow if the ball is going the other way
+		if (match.Ball.Velocity.X < 0 || static_cast<int32_t>(match.TotalTime) % match.Config.AIDelay == 0)
+		{
+			paddle.Velocity.Y = 0.0f;
+		}
+		else if (IsBallBelowPaddle(match.Ball, paddle) && paddle.Velocity.Y <= 0)
+		{
+			paddle.Velocity.Y = match.Config.PaddleSpeed;
+		}
+		else if (IsBallAbovePaddle(match.Ball, paddle) && paddle.Velocity.Y >= 0)
+		{
+			paddle.Velocity.Y = -match.Config.PaddleSpeed;
+		}
+	}
+
+	void Simulation::AdjustPredictiveAIPaddleVelocity(MatchState& match)
+	{
+		PONG_PROFILE_SCOPE("AdjustPredictiveAIPaddleVelocity");
+
+		// the ball flies straight between contacts, so one plan lasts until it turns around
+		int32_t direction = BallDirection(match.Ball.Velocity.X);
+		if (direction != match.AIPlanDirection)
+		{
+			match.AITargetY = PlanAITarget(match.Config, match.Ball, match.Generator);
+			match.AIPlanDirection = direction;
+		}
+
+		match.Paddle2.Velocity.Y = SteerAIPaddle(match.Config, match.Paddle2.Bounds.Y, match.AITargetY);
+	}
+
+	float Simulation::PlanAITarget(const MatchConfig& config, const BallState& ball, MatchRandom& generator)
+	{
+		// wait in the middle while the ball is heading for the other player
+		if (ball.Velocity.X <= 0.0f)
+		{
+			return config.ViewportHeight / 2;
+		}
+
+		float planeX = config.ViewportWidth - config.PaddleWallOffset - config.BallWidth;
+		float targetY = PredictInterceptY(config, ball, planeX) + config.BallHeight / 2;
+
+		if (config.AIError > 0.0f)
+		{
+			// drawn straight from the generator so every standard library agrees on the error
+			float unit = static_cast<float>(generator()) / static_cast<float>(MatchRandom::max());
+			targetY += config.AIError * (2.0f * unit - 1.0f);
+		}
+
+		return targetY;
+	}
+
+	float Simulation::PredictInterceptY(const MatchConfig& config, const BallState& ball, float planeX)
+	{
+		float time = (ball.Velocity.X != 0.0f ? (planeX - ball.Bounds.X) / ball.Velocity.X : 0.0f);
+		float y = ball.Bounds.Y + ball.Velocity.Y * max(time, 0.0f);
+
+		// bouncing between the walls makes y a triangle wave, so fold it back into the span
+		float span = config.ViewportHeight - config.BallHeight;
+		float phase = fmod(y, 2.0f * span);
+		if (phase < 0.0f)
+		{
+			phase += 2.0f * span;
+		}
+
+		return (phase > span ? 2.0f * span - phase : phase);
+	}
+
+	float Simulation::SteerAIPaddle(const MatchConfig& config, float paddleY, float targetY)
+	{
+		// anywhere in the middle half of the paddle is close enough, which keeps it from dithering
+		float offset = targetY - (paddleY + config.PaddleHeight / 2);
+		float tolerance = config.PaddleHeight / 4;
+
+		if (offset > tolerance)
+		{
+			return config.PaddleSpeed;
+		}
+		else if (offset < -tolerance)
+		{
+			return -config.PaddleSpeed;
+		}
+
+		return 0.0f;
+	}
+
+	int32_t Simulation::BallDirection(float velocityX)
+	{
+		return (velocityX > 0.0f) - (velocityX < 0.0f);
+	}
+
+	void Simulation::UpdatePlayerScores(MatchState& match)
+	{
+		PONG_PROFILE_SCOPE("Simulation::UpdatePlayerScores");
+		// did a player score?
+		if (match.Ball.Player1Scored)
+		{
+			match.Events |= MatchEvents::Player1Scored;
+			match.Player1Score++;
+			if (match.Player1Score < match.Config.MaxScore)
+			{
+				ResetBall(match);
+			}
+			else
+			{
+				ChangeGamestate(match, Gamestate::Gameover);
+			}
+		}
+		else if (match.Ball.Player2Scored)
+		{
+			match.Events |= MatchEvents::Player2Scored;
+			match.Player2Score++;
+			if (match.Player2Score < match.Config.MaxScore)
+			{
+				ResetBall(match);
+			}
+			else
+			{
+				ChangeGamestate(match, Gamestate::Gameover);
+			}
+		}
+	}
+
+	void Simulation::UpdateBall(MatchState& match, float elapsedTime)
+	{
+		PONG_PROFILE_SCOPE("UpdateBall");
+		BallState& ball = match.Ball;
+
+		Vector2 positionDelta(ball.Velocity.X * elapsedTime, ball.Velocity.Y * elapsedTime);
+		ball.Bounds.X += positionDelta.X;
+		ball.Bounds.Y += positionDelta.Y;
+
+		CheckBallBounds(match);
+	}
+
+	void Simulation::CheckBallBounds(MatchState& match)
+	{
+		const MatchConfig& config = match.Config;
+		BallState& ball = match.Ball;
+
+		if (ball.Bounds.Right() >= config.ViewportWidth && ball.Velocity.X > 0.0f)
+		{
+			ball.Player1Scored = true;
+		}
+		if (ball.Bounds.X <= 0 && ball.Velocity.X < 0.0f)
+		{
+			ball.Player2Scored = true;
+		}
+
+		if (ball.Bounds.Bottom() >= config.ViewportHeight && ball.Velocity.Y > 0.0f)
+		{
+			ball.HitWall = true;
+			ball.Velocity.Y *= -1;
+		}
+		if (ball.Bounds.Y <= 0 && ball.Velocity.Y < 0.0f)
+		{
+			ball.HitWall = true;
+			ball.Velocity.Y *= -1;
+		}
+	}
+
+	void Simulation::SweepBall(MatchState& match, float elapsedTime, const Rect& paddle1Start, const Rect& paddle2Start)
+	{
+		PONG_PROFILE_SCOPE("SweepBall");
+		const MatchConfig& config = match.Config;
+		BallState& ball = match.Ball;
+		const Rect& paddle1 = match.Paddle1.Bounds;
+		const Rect& paddle2 = match.Paddle2.Bounds;
+		float remainingTime = elapsedTime;
+
+		// Move to the earliest contact, reflect, and repeat with the time that is left. Paddles are
+		// only hit on the face that looks at the center, which is the only side a serve can reach,
+		// and are taken to move linearly from their start-of-step position during the step.
+		for (int32_t contact = 0; contact <= config.MaxSweepContacts; ++contact)
+		{
+			float x = ball.Bounds.X;
+			float y = ball.Bounds.Y;
+			float velocityX = ball.Velocity.X;
+			float velocityY = ball.Velocity.Y;
+			float hitTime = remainingTime;
+			int32_t surface = 0; // 1 wall, 2 paddle 1, 3 paddle 2
+
+			if (velocityY > 0.0f)
+			{
+				float time = max((config.ViewportHeight - ball.Bounds.Height - y) / velocityY, 0.0f);
+				if (time < hitTime)
+				{
+					hitTime = time;
+					surface = 1;
+				}
+			}
+			else if (velocityY < 0.0f)
+			{
+				float time = max(-y / velocityY, 0.0f);
+				if (time < hitTime)
+				{
+					hitTime = time;
+					surface = 1;
+				}
+			}
+
+			if (velocityX < 0.0f)
+			{
+				float face = paddle1.Right();
+				if (x >= face)
+				{
+					float time = (face - x) / velocityX;
+					float contactY = y + velocityY * time;
+					float paddleY = paddle1Start.Y + (paddle1.Y - paddle1Start.Y) * ((elapsedTime - remainingTime + time) / elapsedTime);
+					if (time < hitTime && paddleY < contactY + ball.Bounds.Height && contactY < paddleY + paddle1.Height)
+					{
+						hitTime = time;
+						surface = 2;
+					}
+				}
+			}
+			else if (velocityX > 0.0f)
+			{
+				float face = paddle2.Left() - ball.Bounds.Width;
+				if (x <= face)
+				{
+					float time = (face - x) / velocityX;
+					float contactY = y + velocityY * time;
+					float paddleY = paddle2Start.Y + (paddle2.Y - paddle2Start.Y) * ((elapsedTime - remainingTime + time) / elapsedTime);
+					if (time < hitTime && paddleY < contactY + ball.Bounds.Height && contactY < paddleY + paddle2.Height)
+					{
+						hitTime = time;
+						surface = 3;
+					}
+				}
+			}
+
+			ball.Bounds.X = x + velocityX * hitTime;
+			ball.Bounds.Y = y + velocityY * hitTime;
+			remainingTime -= hitTime;
+
+			if (surface == 0)
+			{
+				break;
+			}
+			else if (surface == 1)
+			{
+				ball.Velocity.Y *= -1;
+				match.Events |= MatchEvents::WallHit;
+			}
+			else
+			{
+				ball.Velocity.X *= -1;
+				match.Events |= MatchEvents::PaddleHit;
+				if (surface == 3 && IsAIPaddle(config, match.Paddle2))
+				{
+					match.Paddle2.Velocity.Y = 0.0f;
+				}
+			}
+		}
+	}
+
+	void Simulation::UpdateHumanPaddle(const MatchConfig& config, PaddleState& paddle, const PaddleInputs& inputs, float elapsedTime)
+	{
+		// determine if the paddle is at the edge.
+		bool atBottomBoundary = (paddle.Bounds.Bottom() >= config.ViewportHeight);
+		bool atTopBoundary = (paddle.Bounds.Y <= 0);
+
+		if (inputs.Up && !atTopBoundary)
+		{
+			paddle.Bounds.Y -= paddle.Velocity.Y * elapsedTime;
+		}
+		if (inputs.Down && !atBottomBoundary)
+		{
+			paddle.Bounds.Y += paddle.Velocity.Y * elapsedTime;
+		}
+	}
+
+	void Simulation::UpdateAIPaddle(const MatchConfig& config, PaddleState& paddle, float elapsedTime)
+	{
+		paddle.Bounds.Y += paddle.Velocity.Y * elapsedTime;
+
+		if (paddle.Bounds.Bottom() >= config.ViewportHeight && paddle.Velocity.Y > 0.0f)
+		{
+			paddle.Bounds.Y = config.ViewportHeight - paddle.Bounds.Height;
+		}
+		if (paddle.Bounds.Y <= 0 && paddle.Velocity.Y < 0.0f)
+		{
+			paddle.Bounds.Y = 0;
+		}
+	}
+
+	void Simulation::UpdatePaddle2(MatchState& match, const MatchInputs& inputs, float elapsedTime)
+	{
+		if (IsAIPaddle(match.Config, match.Paddle2))
+		{
+			UpdateAIPaddle(match.Config, match.Paddle2, elapsedTime);
+		}
+		else
+		{
+			UpdateHumanPaddle(match.Config, match.Paddle2, inputs.Player2, elapsedTime);
+		}
+	}
+
+	bool Simulation::IsAIPaddle(const MatchConfig& config, const PaddleState& paddle)
+	{
+		return paddle.Player == Players::Player2 && config.Player2Control == PaddleControl::BuiltInAI;
+	}
+
+	bool Simulation::IsBallAbovePaddle(const BallState& ball, const PaddleState& paddle)
+	{
+		return ball.Bounds.Bottom() < paddle.Bounds.Top();
+	}
+
+	bool Simulation::IsBallBelowPaddle(const BallState& ball, const PaddleState& paddle)
+	{
+		return ball.Bounds.Top() > paddle.Bounds.Bottom();
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "MatchState.h"
+#include "MatchInputs.h"
+
+namespace Pong
+{
+	// Headless Pong rules. Everything the game used to do inside Ball, Paddle and PongGame's
+	// update methods, expressed as plain functions over a MatchState.
+	class Simulation final
+	{
+	public:
+		Simulation() = delete;
+		Simulation(const Simulation&) = delete;
+		Simulation& operator=(const Simulation&) = delete;
+
+		// stream tells apart the matches of one run, which all share its seed
+		static MatchState CreateMatch(const MatchConfig& config, uint32_t seed, uint32_t stream = 0);
+		static void Step(MatchState& match, const MatchInputs& inputs, float elapsedTime);
+
+		static void ChangeGamestate(MatchState& match, Gamestate newGamestate);
+		static void ResetBall(MatchState& match);
+		static Vector2 ServeVelocity(const MatchConfig& config, MatchRandom& generator);
+		static Vector2 ServeVelocity(const MatchConfig& config, const uint32_t (&block)[MatchRandom::BlockSize]);
+		static void ResetPaddle(const MatchConfig& config, PaddleState& paddle);
+		static void FreezeMotion(MatchState& match);
+
+		// every field a step reads or writes, including the random stream and the clock, for
+		// checking one way of stepping a match against another
+		static bool SameState(const MatchState& left, const MatchState& right);
+
+		static void HandleBallPhysics(MatchState& match);
+		static void AdjustAIPaddleVelocity(MatchState& match);
+		static void AdjustPredictiveAIPaddleVelocity(MatchState& match);
+		static float PlanAITarget(const MatchConfig& config, const BallState& ball, MatchRandom& generator);
+		static float PredictInterceptY(const MatchConfig& config, const BallState& ball, float planeX);
+		static float SteerAIPaddle(const MatchConfig& config, float paddleY, float targetY);
+		static int32_t BallDirection(float velocityX);
+		static void UpdatePlayerScores(MatchState& match);
+
+		static void UpdateBall(MatchState& match, float elapsedTime);
+		static void SweepBall(MatchState& match, float elapsedTime, const Rect& paddle1Start, const Rect& paddle2Start);
+		static void CheckBallBounds(MatchState& match);
+		static void UpdateHumanPaddle(const MatchConfig& config, PaddleState& paddle, const PaddleInputs& inputs, float elapsedTime);
+		static void UpdateAIPaddle(const MatchConfig& config, PaddleState& paddle, float elapsedTime);
+		static void UpdatePaddle2(MatchState& match, const MatchInputs& inputs, float elapsedTime);
+
+		static bool IsAIPaddle(const MatchConfig& config, const PaddleState& paddle);
+		static bool IsBallAbovePaddle(const BallState& ball, const PaddleState& paddle);
+		static bool IsBallBelowPaddle(const BallState& ball, const PaddleState& paddle);
+	};
+}
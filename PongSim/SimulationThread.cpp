@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "SimulationThread.h"
+#include "Profiler.h"
+#include "Simulation.h"
+
+using namespace std;
+
+namespace Pong
+{
+	const uint32_t SimulationThread::MaxCatchUpSteps;
+
+	SimulationThread::SimulationThread(const MatchState& match, float stepSeconds, InputSource inputs, StepObserver observer) :
+		mMatch(match), mStepSeconds(stepSeconds), mInputs(move(inputs)), mObserver(move(observer)), mStep(0),
+		mStartTime(chrono::steady_clock::now()), mRunning(false)
+	{
+		if (!(stepSeconds > 0.0f) || mInputs == nullptr)
+		{
+			throw invalid_argument("A simulation thread needs a step length and somewhere to read inputs from.");
+		}
+
+		// the renderer has the starting match to draw before the first step
+		Publish(mMatch, MatchInputs(), 0.0);
+	}
+
+	SimulationThread::~SimulationThread()
+	{
+		Stop();
+	}
+
+	void SimulationThread::Start()
+	{
+		if (!mRunning.exchange(true))
+		{
+			mThread = thread([this]() { Run(); });
+		}
+	}
+
+	void SimulationThread::Stop()
+	{
+		if (mRunning.exchange(false))
+		{
+			mThread.join();
+		}
+	}
+
+	float SimulationThread::StepSeconds() const
+	{
+		return mStepSeconds;
+	}
+
+	double SimulationThread::Now() const
+	{
+		return chrono::duration<double>(chrono::steady_clock::now() - mStartTime).count();
+	}
+
+	bool SimulationThread::Acquire()
+	{
+		return mSnapshots.Acquire();
+	}
+
+	const SimulationSnapshot& SimulationThread::Snapshot() const
+	{
+		return mSnapshots.ReadSlot();
+	}
+
+	float SimulationThread::Alpha() const
+	{
+		float alpha = static_cast<float>((Now() - Snapshot().PublishTime) / mStepSeconds);
+		return min(max(alpha, 0.0f), 1.0f);
+	}
+
+	void SimulationThread::Run()
+	{
+		const chrono::duration<double> step(mStepSeconds);
+		const chrono::milliseconds SpinTime(1);
+		auto dueTime = chrono::steady_clock::now();
+		double lastStepTime = -1.0;
+
+		while (mRunning.load(memory_order_relaxed))
+		{
+			// sleeping is only good to a millisecond or so, so the last of the wait is spent yielding
+			auto now = chrono::steady_clock::now();
+			if (now < dueTime)
+			{
+				if (dueTime - now > SpinTime)
+				{
+					this_thread::sleep_for(dueTime - now - SpinTime);
+				}
+				else
+				{
+					this_thread::yield();
+				}
+				continue;
+			}
+
+			mStats.LateSteps += (now - dueTime > step / 2);
+			uint64_t behind = static_cast<uint64_t>(chrono::duration<double>(now - dueTime) / step);
+			if (behind > MaxCatchUpSteps)
+			{
+				mStats.DroppedSteps += behind;
+				dueTime = now;
+			}
+
+			PONG_PROFILE_SCOPE("SimulationThread::Step");
+			double inputTime = Now();
+			MatchInputs inputs = mInputs(mMatch);
+			MatchState previous = mMatch;
+			Simulation::Step(mMatch, inputs, mStepSeconds);
+			if (mObserver != nullptr)
+			{
+				mObserver(previous, inputs, mMatch);
+			}
+
+			double stepTime = Now();
+			if (lastStepTime >= 0.0)
+			{
+				double interval = stepTime - lastStepTime;
+				mStats.StepIntervalSum += interval;
+				mStats.StepIntervalSquares += interval * interval;
+				mStats.MaxStepInterval = max(mStats.MaxStepInterval, interval);
+			}
+			lastStepTime = stepTime;
+			++mStats.Steps;
+			++mStep;
+
+			Publish(previous, inputs, inputTime);
+			dueTime += chrono::duration_cast<chrono::steady_clock::duration>(step);
+		}
+	}
+
+	void SimulationThread::Publish(const MatchState& previous, const MatchInputs& inputs, double inputTime)
+	{
+		SimulationSnapshot& snapshot = mSnapshots.WriteSlot();
+		snapshot.Previous = previous;
+		snapshot.Match = mMatch;
+		snapshot.Inputs = inputs;
+		snapshot.Step = mStep;
+		snapshot.InputTime = inputTime;
+		snapshot.PublishTime = Now();
+
+		if (mStep > 0)
+		{
+			double latency = snapshot.PublishTime - inputTime;
+			mStats.InputLatencySum += latency;
+			mStats.MaxInputLatency = max(mStats.MaxInputLatency, latency);
+		}
+		snapshot.Stats = mStats;
+
+		mSnapshots.Publish();
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "MatchInputs.h"
+#include "MatchState.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+namespace Pong
+{
+	struct SimulationThreadStats final
+	{
+		uint64_t Steps = 0;
+		uint64_t LateSteps = 0; // started more than half a step after they were due
+		uint64_t DroppedSteps = 0; // skipped after falling too far behind to catch up
+		double StepIntervalSum = 0.0;
+		double StepIntervalSquares = 0.0;
+		double MaxStepInterval = 0.0;
+		double InputLatencySum = 0.0; // from sampling a step's inputs to publishing its result
+		double MaxInputLatency = 0.0;
+	};
+
+	// What the simulation thread publishes after every step. Times are seconds on the thread's
+	// clock, which starts with the thread.
+	struct SimulationSnapshot final
+	{
+		MatchState Previous;
+		MatchState Match;
+		MatchInputs Inputs;
+		uint64_t Step = 0;
+		double InputTime = 0.0;
+		double PublishTime = 0.0;
+		SimulationThreadStats Stats;
+	};
+
+	// Runs a match at a fixed rate on its own thread, so a renderer blocked on vsync or a slow
+	// frame doesn't hold up input or gameplay. Each step samples the inputs, simulates, tells the
+	// observer, and publishes a snapshot through a TripleBuffer; the render thread picks up the
+	// newest one whenever it is ready to draw. Neither thread ever waits on the other.
+	//
+	// The thread sleeps to within a millisecond of each step and yields for the rest. After
+	// falling more than MaxCatchUpSteps behind it drops the missed steps rather than racing
+	// through them.
+	class SimulationThread final
+	{
+	public:
+		// both are called on the simulation thread
+		using InputSource = std::function<MatchInputs(const MatchState& match)>;
+		using StepObserver = std::function<void(const MatchState& previous, const MatchInputs& inputs, const MatchState& match)>;
+
+		static const uint32_t MaxCatchUpSteps = 8;
+
+		SimulationThread(const MatchState& match, float stepSeconds, InputSource inputs, StepObserver observer = nullptr);
+		~SimulationThread();
+
+		SimulationThread(const SimulationThread&) = delete;
+		SimulationThread& operator=(const SimulationThread&) = delete;
+
+		void Start();
+		void Stop();
+
+		float StepSeconds() const;
+		double Now() const;
+
+		// render thread only: true when a newer snapshot has replaced Snapshot
+		bool Acquire();
+		const SimulationSnapshot& Snapshot() const;
+
+		// how far the render thread is from the snapshot's Previous to its Match, for drawing between them
+		float Alpha() const;
+
+	private:
+		void Run();
+		void Publish(const MatchState& previous, const MatchInputs& inputs, double inputTime);
+
+		MatchState mMatch;
+		float mStepSeconds;
+		InputSource mInputs;
+		StepObserver mObserver;
+		SimulationThreadStats mStats;
+		uint64_t mStep;
+
+		std::chrono::steady_clock::time_point mStartTime;
+		TripleBuffer<SimulationSnapshot> mSnapshots;
+		std::atomic<bool> mRunning;
+		std::thread mThread;
+	};
+}
@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "SpatialGrid.h"
+
+using namespace std;
+
+namespace Pong
+{
+	SpatialGrid::SpatialGrid(float width, float height, float cellSize) :
+		mColumnCount(0), mRowCount(0), mCellSize(cellSize), mInverseCellSize(0.0f)
+	{
+		if (!(width > 0.0f && height > 0.0f && cellSize > 0.0f))
+		{
+			throw invalid_argument("A spatial grid needs a positive size and cell size.");
+		}
+
+		mColumnCount = static_cast<uint32_t>(ceil(width / cellSize));
+		mRowCount = static_cast<uint32_t>(ceil(height / cellSize));
+		mInverseCellSize = 1.0f / cellSize;
+		mCellStarts.resize(static_cast<size_t>(mColumnCount) * mRowCount + 1);
+	}
+
+	uint32_t SpatialGrid::ColumnCount() const
+	{
+		return mColumnCount;
+	}
+
+	uint32_t SpatialGrid::RowCount() const
+	{
+		return mRowCount;
+	}
+
+	float SpatialGrid::CellSize() const
+	{
+		return mCellSize;
+	}
+
+	uint32_t SpatialGrid::Column(float x) const
+	{
+		// anything outside the arena is filed in the border cells
+		float column = x * mInverseCellSize;
+		return (column <= 0.0f ? 0 : min(static_cast<uint32_t>(column), mColumnCount - 1));
+	}
+
+	uint32_t SpatialGrid::Row(float y) const
+	{
+		float row = y * mInverseCellSize;
+		return (row <= 0.0f ? 0 : min(static_cast<uint32_t>(row), mRowCount - 1));
+	}
+
+	void SpatialGrid::Build(const float* x, const float* y, size_t count)
+	{
+		mEntries.resize(count);
+		mEntityCells.resize(count);
+		fill(mCellStarts.begin(), mCellStarts.end(), 0);
+
+		// count each cell's entities, offset by one so the prefix sum below gives each cell's start
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint32_t cell = Row(y[i]) * mColumnCount + Column(x[i]);
+			mEntityCells[i] = cell;
+			++mCellStarts[cell + 1];
+		}
+
+		for (size_t cell = 1; cell < mCellStarts.size(); ++cell)
+		{
+			mCellStarts[cell] += mCellStarts[cell - 1];
+		}
+
+		// scatter in index order, so each cell lists its entities in the order they were given
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint32_t& start = mCellStarts[mEntityCells[i]];
+			mEntries[start++] = static_cast<uint32_t>(i);
+		}
+
+		// the scatter moved every start up to where the next cell begins
+		for (size_t cell = mCellStarts.size() - 1; cell > 0; --cell)
+		{
+			mCellStarts[cell] = mCellStarts[cell - 1];
+		}
+		mCellStarts[0] = 0;
+	}
+
+	const uint32_t* SpatialGrid::CellBegin(uint32_t column, uint32_t row) const
+	{
+		assert(column < mColumnCount && row < mRowCount);
+		return mEntries.data() + mCellStarts[row * mColumnCount + column];
+	}
+
+	const uint32_t* SpatialGrid::CellEnd(uint32_t column, uint32_t row) const
+	{
+		assert(column < mColumnCount && row < mRowCount);
+		return mEntries.data() + mCellStarts[row * mColumnCount + column + 1];
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pong
+{
+	// Uniform grid over the arena, rebuilt from scratch every step. Each entity is filed under the
+	// cell holding its top-left corner, and the cells' entries are counting-sorted into one
+	// contiguous array, so building never allocates after the first time and a cell's entities
+	// are read in one pass. With cells at least as big as the largest entity, anything overlapping
+	// an entity is filed in its own cell or one of the eight around it.
+	class SpatialGrid final
+	{
+	public:
+		SpatialGrid(float width, float height, float cellSize);
+
+		uint32_t ColumnCount() const;
+		uint32_t RowCount() const;
+		float CellSize() const;
+
+		uint32_t Column(float x) const;
+		uint32_t Row(float y) const;
+
+		void Build(const float* x, const float* y, std::size_t count);
+
+		// the entities filed in a cell, by index into what Build was given
+		const uint32_t* CellBegin(uint32_t column, uint32_t row) const;
+		const uint32_t* CellEnd(uint32_t column, uint32_t row) const;
+
+	private:
+		uint32_t mColumnCount;
+		uint32_t mRowCount;
+		float mCellSize;
+		float mInverseCellSize;
+		std::vector<uint32_t> mCellStarts; // one more than there are cells, the last being the count
+		std::vector<uint32_t> mEntries;
+		std::vector<uint32_t> mEntityCells;
+	};
+}
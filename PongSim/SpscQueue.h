@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace Pong
+{
+	// Bounded queue for exactly one producer thread and one consumer thread. Neither side ever
+	// locks or allocates after construction: each owns one index and only reads the other's. The
+	// indices sit on separate cache lines so the two threads don't fight over one.
+	template <typename T>
+	class SpscQueue final
+	{
+	public:
+		// capacity has to be a power of two
+		explicit SpscQueue(size_t capacity);
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		size_t Capacity() const;
+
+		// producer only; false when the queue is full
+		bool TryPush(const T& item);
+
+		// consumer only; false when the queue is empty
+		bool TryPop(T& item);
+
+	private:
+		static const size_t CacheLineSize = 64;
+
+		// padding rather than alignas, so the queue can live in anything without over-aligned new
+		std::vector<T> mItems;
+		size_t mMask;
+		char mHeadPadding[CacheLineSize];
+		std::atomic<size_t> mHead;
+		char mTailPadding[CacheLineSize];
+		std::atomic<size_t> mTail;
+		char mEndPadding[CacheLineSize];
+	};
+
+	template <typename T>
+	SpscQueue<T>::SpscQueue(size_t capacity) :
+		mItems(capacity), mMask(capacity - 1), mHeadPadding(), mHead(0), mTailPadding(), mTail(0), mEndPadding()
+	{
+		if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+		{
+			throw std::invalid_argument("SpscQueue capacity must be a power of two.");
+		}
+	}
+
+	template <typename T>
+	size_t SpscQueue<T>::Capacity() const
+	{
+		return mItems.size();
+	}
+
+	template <typename T>
+	bool SpscQueue<T>::TryPush(const T& item)
+	{
+		size_t tail = mTail.load(std::memory_order_relaxed);
+		if (tail - mHead.load(std::memory_order_acquire) == mItems.size())
+		{
+			return false;
+		}
+
+		mItems[tail & mMask] = item;
+		mTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <typename T>
+	bool SpscQueue<T>::TryPop(T& item)
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+		if (head == mTail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		item = mItems[head & mMask];
+		mHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+}
@@ -0,0 +1,187 @@
+#include "pch.h"
+#include "TaskPool.h"
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		// lets Submit find the worker it is being called from
+		thread_local const TaskPool* tCurrentPool = nullptr;
+		thread_local uint32_t tWorkerIndex = 0;
+	}
+
+	TaskPool::TaskPool(uint32_t threadCount) :
+		mNextQueue(0), mQueuedTasks(0), mUnfinishedTasks(0), mStopping(false)
+	{
+		if (threadCount == 0)
+		{
+			threadCount = max(thread::hardware_concurrency(), 1u);
+		}
+
+		mQueues.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i)
+		{
+			mQueues.push_back(make_unique<WorkerQueue>());
+		}
+
+		mThreads.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i)
+		{
+			mThreads.emplace_back(&TaskPool::WorkerLoop, this, i);
+		}
+	}
+
+	TaskPool::~TaskPool()
+	{
+		{
+			lock_guard<mutex> lock(mSleepMutex);
+			mStopping = true;
+		}
+		mWorkAvailable.notify_all();
+
+		for (thread& worker : mThreads)
+		{
+			worker.join();
+		}
+	}
+
+	uint32_t TaskPool::ThreadCount() const
+	{
+		return static_cast<uint32_t>(mThreads.size());
+	}
+
+	void TaskPool::Submit(Task task)
+	{
+		uint32_t queueCount = static_cast<uint32_t>(mQueues.size());
+		uint32_t index = (tCurrentPool == this ? tWorkerIndex : mNextQueue++ % queueCount);
+
+		// counted before it is visible so Wait can never see zero while it is queued, and so a
+		// worker that pops it straight away can't take mQueuedTasks below zero
+		++mUnfinishedTasks;
+		{
+			lock_guard<mutex> lock(mQueues[index]->Mutex);
+			++mQueuedTasks;
+			mQueues[index]->Tasks.push_back(move(task));
+		}
+
+		{
+			lock_guard<mutex> lock(mSleepMutex);
+		}
+		mWorkAvailable.notify_one();
+	}
+
+	void TaskPool::Wait()
+	{
+		while (TryRunTask(static_cast<uint32_t>(mQueues.size())))
+		{
+		}
+
+		unique_lock<mutex> lock(mSleepMutex);
+		mAllFinished.wait(lock, [this] { return mUnfinishedTasks == 0; });
+
+		if (mFirstException)
+		{
+			exception_ptr exception = mFirstException;
+			mFirstException = nullptr;
+			rethrow_exception(exception);
+		}
+	}
+
+	void TaskPool::WorkerLoop(uint32_t index)
+	{
+		tCurrentPool = this;
+		tWorkerIndex = index;
+
+		while (true)
+		{
+			if (TryRunTask(index))
+			{
+				continue;
+			}
+
+			unique_lock<mutex> lock(mSleepMutex);
+			mWorkAvailable.wait(lock, [this] { return mStopping || mQueuedTasks > 0; });
+			if (mStopping && mQueuedTasks == 0)
+			{
+				return;
+			}
+		}
+	}
+
+	bool TaskPool::TryRunTask(uint32_t index)
+	{
+		// the calling thread passes an index past the last queue, so it only steals
+		Task task;
+		if ((index < mQueues.size() && TryPop(index, task)) || TrySteal(index, task))
+		{
+			RunTask(task);
+			return true;
+		}
+
+		return false;
+	}
+
+	bool TaskPool::TryPop(uint32_t index, Task& task)
+	{
+		WorkerQueue& queue = *mQueues[index];
+		lock_guard<mutex> lock(queue.Mutex);
+		if (queue.Tasks.empty())
+		{
+			return false;
+		}
+
+		task = move(queue.Tasks.back());
+		queue.Tasks.pop_back();
+		--mQueuedTasks;
+		return true;
+	}
+
+	bool TaskPool::TrySteal(uint32_t thief, Task& task)
+	{
+		uint32_t queueCount = static_cast<uint32_t>(mQueues.size());
+		for (uint32_t offset = 1; offset <= queueCount && mQueuedTasks > 0; ++offset)
+		{
+			uint32_t victim = (thief + offset) % queueCount;
+			if (victim == thief)
+			{
+				continue;
+			}
+
+			WorkerQueue& queue = *mQueues[victim];
+			lock_guard<mutex> lock(queue.Mutex);
+			if (!queue.Tasks.empty())
+			{
+				task = move(queue.Tasks.front());
+				queue.Tasks.pop_front();
+				--mQueuedTasks;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void TaskPool::RunTask(Task& task)
+	{
+		try
+		{
+			task();
+		}
+		catch (...)
+		{
+			lock_guard<mutex> lock(mSleepMutex);
+			if (!mFirstException)
+			{
+				mFirstException = current_exception();
+			}
+		}
+
+		if (mUnfinishedTasks.fetch_sub(1) == 1)
+		{
+			lock_guard<mutex> lock(mSleepMutex);
+			mAllFinished.notify_all();
+		}
+	}
+}
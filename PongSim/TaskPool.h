@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Pong
+{
+	// Fixed set of worker threads, each with its own task deque. A worker runs its newest task
+	// first and, once its deque is empty, steals the oldest task from another worker, so uneven
+	// tasks spread out without every thread contending on one shared queue.
+	class TaskPool final
+	{
+	public:
+		using Task = std::function<void()>;
+
+		// zero threads means one per hardware thread
+		explicit TaskPool(uint32_t threadCount = 0);
+		~TaskPool();
+
+		TaskPool(const TaskPool&) = delete;
+		TaskPool& operator=(const TaskPool&) = delete;
+
+		uint32_t ThreadCount() const;
+
+		// Tasks submitted from a worker go to that worker's deque; everything else is dealt out
+		// round-robin.
+		void Submit(Task task);
+
+		// Helps run queued tasks on the calling thread, then blocks until every submitted task has
+		// finished. Rethrows the first exception a task threw.
+		void Wait();
+
+	private:
+		struct WorkerQueue final
+		{
+			std::mutex Mutex;
+			std::deque<Task> Tasks;
+		};
+
+		void WorkerLoop(uint32_t index);
+		bool TryRunTask(uint32_t index);
+		bool TryPop(uint32_t index, Task& task);
+		bool TrySteal(uint32_t thief, Task& task);
+		void RunTask(Task& task);
+
+		std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+		std::vector<std::thread> mThreads;
+		std::atomic<uint32_t> mNextQueue;
+		std::atomic<size_t> mQueuedTasks;
+		std::atomic<size_t> mUnfinishedTasks;
+		std::mutex mSleepMutex;
+		std::condition_variable mWorkAvailable;
+		std::condition_variable mAllFinished;
+		std::exception_ptr mFirstException;
+		bool mStopping;
+	};
+}
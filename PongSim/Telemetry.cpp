@@ -0,0 +1,726 @@
+#include "pch.h"
+#include "Telemetry.h"
+#include "MappedFile.h"
+#include "MatchBatch.h"
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const uint8_t HeaderMagic[4] = { 'P', 'T', 'E', 'L' };
+		const uint64_t FormatVersion = 1;
+		const float DegreesPerRadian = 57.2957795f;
+
+		void WriteVarint(vector<uint8_t>& buffer, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				buffer.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			buffer.push_back(static_cast<uint8_t>(value));
+		}
+
+		void WriteSigned(vector<uint8_t>& buffer, int64_t value)
+		{
+			// zigzag, so small negative numbers stay small
+			WriteVarint(buffer, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+		}
+
+		void WriteFloat(vector<uint8_t>& buffer, float value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			for (size_t i = 0; i < sizeof(bits); ++i)
+			{
+				buffer.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+			}
+		}
+
+		// events from one match mostly follow each other, so the ids and frames barely move
+		void WriteDeltas(vector<uint8_t>& buffer, const vector<TelemetryEvent>& rows, uint32_t TelemetryEvent::*field)
+		{
+			int64_t previous = 0;
+			for (const TelemetryEvent& row : rows)
+			{
+				int64_t value = row.*field;
+				WriteSigned(buffer, value - previous);
+				previous = value;
+			}
+		}
+
+		// a block only ever holds a handful of kinds and players, so each row needs two or three bits
+		template <typename Field>
+		void WriteDictionary(vector<uint8_t>& buffer, const vector<TelemetryEvent>& rows, Field field)
+		{
+			int32_t indices[256];
+			fill(begin(indices), end(indices), -1);
+			vector<uint8_t> entries;
+			for (const TelemetryEvent& row : rows)
+			{
+				uint8_t value = field(row);
+				if (indices[value] < 0)
+				{
+					indices[value] = static_cast<int32_t>(entries.size());
+					entries.push_back(value);
+				}
+			}
+
+			WriteVarint(buffer, entries.size());
+			buffer.insert(buffer.end(), entries.begin(), entries.end());
+
+			uint32_t bits = 0;
+			while ((size_t(1) << bits) < entries.size())
+			{
+				++bits;
+			}
+
+			uint64_t pending = 0;
+			uint32_t pendingBits = 0;
+			for (const TelemetryEvent& row : rows)
+			{
+				pending |= static_cast<uint64_t>(indices[field(row)]) << pendingBits;
+				pendingBits += bits;
+				while (pendingBits >= 8)
+				{
+					buffer.push_back(static_cast<uint8_t>(pending));
+					pending >>= 8;
+					pendingBits -= 8;
+				}
+			}
+			if (pendingBits > 0)
+			{
+				buffer.push_back(static_cast<uint8_t>(pending));
+			}
+		}
+
+		struct ByteReader final
+		{
+			const uint8_t* Position;
+			const uint8_t* End;
+
+			ByteReader(const uint8_t* position, const uint8_t* end) : Position(position), End(end) { }
+
+			void Require(size_t bytes) const
+			{
+				if (static_cast<size_t>(End - Position) < bytes)
+				{
+					throw runtime_error("Telemetry log is truncated or corrupt.");
+				}
+			}
+
+			uint8_t Byte()
+			{
+				Require(1);
+				return *Position++;
+			}
+
+			uint64_t Varint()
+			{
+				uint64_t value = 0;
+				for (uint32_t shift = 0; shift < 64; shift += 7)
+				{
+					uint8_t byte = Byte();
+					value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+					if ((byte & 0x80) == 0)
+					{
+						return value;
+					}
+				}
+				throw runtime_error("Telemetry log is truncated or corrupt.");
+			}
+
+			int64_t Signed()
+			{
+				uint64_t value = Varint();
+				return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+			}
+
+			float Float()
+			{
+				Require(4);
+				uint32_t bits = static_cast<uint32_t>(Position[0]) | static_cast<uint32_t>(Position[1]) << 8 | static_cast<uint32_t>(Position[2]) << 16 | static_cast<uint32_t>(Position[3]) << 24;
+				Position += 4;
+				float value;
+				memcpy(&value, &bits, sizeof(value));
+				return value;
+			}
+		};
+
+		void ReadDeltas(ByteReader& reader, TelemetryEvent* rows, size_t count, uint32_t TelemetryEvent::*field)
+		{
+			int64_t previous = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				previous += reader.Signed();
+				rows[i].*field = static_cast<uint32_t>(previous);
+			}
+		}
+
+		vector<uint8_t> ReadDictionary(ByteReader& reader, size_t count)
+		{
+			uint64_t entryCount = reader.Varint();
+			if (entryCount == 0 || entryCount > 256)
+			{
+				throw runtime_error("Telemetry log is truncated or corrupt.");
+			}
+
+			vector<uint8_t> entries(static_cast<size_t>(entryCount));
+			for (uint8_t& entry : entries)
+			{
+				entry = reader.Byte();
+			}
+
+			uint32_t bits = 0;
+			while ((size_t(1) << bits) < entries.size())
+			{
+				++bits;
+			}
+
+			vector<uint8_t> values(count);
+			uint64_t pending = 0;
+			uint32_t pendingBits = 0;
+			for (uint8_t& value : values)
+			{
+				while (pendingBits < bits)
+				{
+					pending |= static_cast<uint64_t>(reader.Byte()) << pendingBits;
+					pendingBits += 8;
+				}
+				size_t index = static_cast<size_t>(pending & ((uint64_t(1) << bits) - 1));
+				pending >>= bits;
+				pendingBits -= bits;
+				if (index >= entries.size())
+				{
+					throw runtime_error("Telemetry log is truncated or corrupt.");
+				}
+				value = entries[index];
+			}
+
+			return values;
+		}
+
+		// where the ball's left edge is when its leading edge reaches paddle 2's face
+		float Paddle2Face(const MatchConfig& config)
+		{
+			return config.ViewportWidth - config.PaddleWallOffset - config.BallWidth;
+		}
+
+		// the ball's centre less a paddle's, in pixels
+		float Offset(const MatchConfig& config, float ballY, float paddleY)
+		{
+			return (ballY + config.BallHeight / 2) - (paddleY + config.PaddleHeight / 2);
+		}
+
+		// where the ball was the given seconds before the end of the step
+		float BallYBefore(const MatchConfig& config, const TelemetryStep& now, float time)
+		{
+			float floorY = config.ViewportHeight - config.BallHeight;
+			if (config.Collision == CollisionMode::Discrete)
+			{
+				// a discrete step leaves the ball past the wall it bounced off, already heading back
+				bool bounced = (now.BallY >= floorY && now.BallVelocityY < 0.0f) || (now.BallY <= 0.0f && now.BallVelocityY > 0.0f);
+				return now.BallY - (bounced ? -now.BallVelocityY : now.BallVelocityY) * time;
+			}
+
+			// a swept one leaves it inside, so winding back past a wall undoes the bounce
+			float y = now.BallY - now.BallVelocityY * time;
+			return (y < 0.0f ? -y : (y > floorY ? 2 * floorY - y : y));
+		}
+
+		// where paddle 2 was the given seconds before the end of the step; it never leaves the arena
+		float Paddle2YBefore(const MatchConfig& config, const TelemetryStep& now, float time)
+		{
+			return max(0.0f, min(now.Paddle2Y - now.Paddle2VelocityY * time, config.ViewportHeight - config.PaddleHeight));
+		}
+
+		// The rules both observers share, for a step with at least one event.
+		void RecordStep(const MatchConfig& config, uint32_t matchId, uint32_t frame, float elapsedTime, const TelemetryStep& now,
+			TelemetryTrack& track, TelemetryStream& stream)
+		{
+			auto record = [&](TelemetryKind kind, uint8_t player, float value)
+			{
+				TelemetryEvent event;
+				event.Match = matchId;
+				event.Frame = frame;
+				event.Value = value;
+				event.Rally = track.Rally;
+				event.Kind = kind;
+				event.Player = player;
+				stream.Record(event);
+			};
+
+			uint32_t events = now.Events;
+			bool started = (events & MatchEvents::GameStarted) != 0;
+			bool aiPaddle2 = (config.Player2Control == PaddleControl::BuiltInAI);
+			if (started)
+			{
+				track.GameStart = now.TotalTime;
+			}
+
+			// a miss is judged where the ball passed the paddle, not at the edge of the arena after
+			// the paddle has spent a few more steps chasing it
+			if (aiPaddle2 && (events & MatchEvents::PassedPaddle2))
+			{
+				float time = (now.BallVelocityX > 0.0f ? (now.BallX - Paddle2Face(config)) / now.BallVelocityX : 0.0f);
+				track.MissOffset = Offset(config, BallYBefore(config, now, time), Paddle2YBefore(config, now, time));
+			}
+
+			// player 1's paddle follows inputs the observer never sees, so it can't be wound back; a
+			// discrete hit is usually found the step after the ball passes its face, where this leaves it
+			if (events & MatchEvents::PassedPaddle1)
+			{
+				track.Paddle1Offset = Offset(config, now.BallY, now.Paddle1Y);
+				track.Paddle1Frame = frame;
+			}
+
+			if (events & MatchEvents::PaddleHit)
+			{
+				// discrete collision finds the contact where the last step left everything, swept during this one
+				bool discrete = (config.Collision == CollisionMode::Discrete);
+				uint8_t player = (now.BallVelocityX > 0.0f ? 1 : 2);
+				float time = (discrete ? elapsedTime : 0.0f);
+				float ballY = BallYBefore(config, now, time);
+				float offset;
+				if (player == 2)
+				{
+					offset = Offset(config, ballY, Paddle2YBefore(config, now, time));
+				}
+				else if (discrete && track.Paddle1Frame + 1 == frame)
+				{
+					offset = track.Paddle1Offset;
+				}
+				else
+				{
+					// otherwise the paddle caught up with the ball later, and it's taken where it stopped
+					offset = Offset(config, ballY, now.Paddle1Y);
+				}
+				float reach = (config.BallHeight + config.PaddleHeight) / 2;
+
+				// paddle 2 can knock the ball on behind itself, and then it never crosses the face again
+				if (aiPaddle2 && player == 1 && now.BallX >= Paddle2Face(config))
+				{
+					track.MissOffset = Offset(config, ballY, Paddle2YBefore(config, now, time));
+				}
+
+				if (track.Rally < UINT16_MAX)
+				{
+					++track.Rally;
+				}
+				record(TelemetryKind::PaddleHit, player, max(-1.0f, min(offset / reach, 1.0f)));
+				if (player == 2 && aiPaddle2)
+				{
+					record(TelemetryKind::AIReaction, 2, offset);
+				}
+			}
+
+			if (events & MatchEvents::WallHit)
+			{
+				record(TelemetryKind::WallHit, 0, (now.BallX + config.BallWidth / 2) / config.ViewportWidth);
+			}
+
+			bool scored = (events & (MatchEvents::Player1Scored | MatchEvents::Player2Scored)) != 0;
+			if (scored)
+			{
+				// the ball has already gone back to the centre, so this is where it last got past the paddle
+				uint8_t player = ((events & MatchEvents::Player1Scored) ? 1 : 2);
+				if (player == 1 && aiPaddle2)
+				{
+					record(TelemetryKind::AIReaction, 2, track.MissOffset);
+				}
+				record(TelemetryKind::Score, player, static_cast<float>(now.TotalTime - track.ServeTime));
+			}
+
+			if (events & MatchEvents::GameOver)
+			{
+				record(TelemetryKind::GameOver, (now.Player1Score > now.Player2Score ? 1 : 2), static_cast<float>(now.TotalTime - track.GameStart));
+			}
+			else if (started || scored)
+			{
+				track.Rally = 0;
+				track.ServeTime = now.TotalTime;
+				record(TelemetryKind::Serve, (now.BallVelocityX > 0.0f ? 2 : 1), DegreesPerRadian * atan2(now.BallVelocityY, fabs(now.BallVelocityX)));
+			}
+		}
+	}
+
+	const double TelemetryLog::PollSeconds = 0.01;
+	const double TelemetryLog::FlushSeconds = 1.0;
+
+	TelemetryStream::TelemetryStream(size_t capacity, TelemetryOverflow overflow) :
+		mEvents(capacity), mOverflow(overflow), mDropped(0)
+	{
+	}
+
+	void TelemetryStream::Record(const TelemetryEvent& event)
+	{
+		if (mEvents.TryPush(event))
+		{
+			return;
+		}
+
+		if (mOverflow == TelemetryOverflow::Drop)
+		{
+			// only this thread writes the count
+			mDropped.store(mDropped.load(memory_order_relaxed) + 1, memory_order_relaxed);
+			return;
+		}
+
+		while (!mEvents.TryPush(event))
+		{
+			this_thread::yield();
+		}
+	}
+
+	bool TelemetryStream::TryTake(TelemetryEvent& event)
+	{
+		return mEvents.TryPop(event);
+	}
+
+	uint64_t TelemetryStream::Dropped() const
+	{
+		return mDropped.load(memory_order_relaxed);
+	}
+
+	TelemetryObserver::TelemetryObserver(const MatchState& match, uint32_t matchId) :
+		mMatch(matchId), mFrame(0)
+	{
+		mTrack.ServeTime = match.TotalTime;
+		mTrack.GameStart = match.TotalTime;
+	}
+
+	void TelemetryObserver::RecordEvents(const MatchState& match, float elapsedTime, TelemetryStream& stream)
+	{
+		TelemetryStep now;
+		now.Events = match.Events;
+		now.BallX = match.Ball.Bounds.X;
+		now.BallY = match.Ball.Bounds.Y;
+		now.BallVelocityX = match.Ball.Velocity.X;
+		now.BallVelocityY = match.Ball.Velocity.Y;
+		now.Paddle1Y = match.Paddle1.Bounds.Y;
+		now.Paddle2Y = match.Paddle2.Bounds.Y;
+		now.Paddle2VelocityY = match.Paddle2.Velocity.Y;
+		now.Player1Score = match.Player1Score;
+		now.Player2Score = match.Player2Score;
+		now.TotalTime = match.TotalTime;
+
+		RecordStep(match.Config, mMatch, mFrame, elapsedTime, now, mTrack, stream);
+	}
+
+	BatchTelemetryObserver::BatchTelemetryObserver(const MatchBatch& batch, uint32_t firstMatchId) :
+		mFirstMatch(firstMatchId), mFrame(0), mTracks(batch.Size())
+	{
+		for (TelemetryTrack& track : mTracks)
+		{
+			track.ServeTime = batch.TotalTime();
+			track.GameStart = batch.TotalTime();
+		}
+	}
+
+	void BatchTelemetryObserver::Observe(const MatchBatch& batch, float elapsedTime, TelemetryStream& stream)
+	{
+		size_t size = batch.Size();
+		const uint32_t* events = batch.Events();
+		const float* ballX = batch.BallX();
+		const float* ballY = batch.BallY();
+		const float* ballVelocityX = batch.BallVelocityX();
+		const float* ballVelocityY = batch.BallVelocityY();
+		const float* paddle1Y = batch.Paddle1Y();
+		const float* paddle2Y = batch.Paddle2Y();
+		const float* paddle2VelocityY = batch.Paddle2VelocityY();
+		const int32_t* player1Score = batch.Player1Score();
+		const int32_t* player2Score = batch.Player2Score();
+		auto recordLane = [&](size_t lane)
+		{
+			TelemetryStep now;
+			now.Events = events[lane];
+			now.BallX = ballX[lane];
+			now.BallY = ballY[lane];
+			now.BallVelocityX = ballVelocityX[lane];
+			now.BallVelocityY = ballVelocityY[lane];
+			now.Paddle1Y = paddle1Y[lane];
+			now.Paddle2Y = paddle2Y[lane];
+			now.Paddle2VelocityY = paddle2VelocityY[lane];
+			now.Player1Score = player1Score[lane];
+			now.Player2Score = player2Score[lane];
+			now.TotalTime = batch.TotalTime();
+
+			RecordStep(batch.Config(), mFirstMatch + static_cast<uint32_t>(lane), mFrame, elapsedTime, now, mTracks[lane], stream);
+		};
+
+		// almost every lane is quiet, so look closer only where eight lanes in a row weren't all quiet
+		size_t whole = size - size % 8;
+		for (size_t base = 0; base < whole; base += 8)
+		{
+			uint32_t any = 0;
+			for (size_t i = 0; i < 8; ++i)
+			{
+				any |= events[base + i];
+			}
+			for (size_t i = base; any != 0 && i < base + 8; ++i)
+			{
+				if (events[i] != MatchEvents::None)
+				{
+					recordLane(i);
+				}
+			}
+		}
+		for (size_t i = whole; i < size; ++i)
+		{
+			if (events[i] != MatchEvents::None)
+			{
+				recordLane(i);
+			}
+		}
+		++mFrame;
+	}
+
+	TelemetryLog::TelemetryLog(const string& path, TelemetryOverflow overflow, size_t streamCapacity) :
+		mFile(path, ios::binary | ios::trunc), mOverflow(overflow), mStreamCapacity(streamCapacity), mWriteFailed(false),
+		mEventsWritten(0), mBytesWritten(0), mClosing(false), mClosed(false)
+	{
+		if (!mFile)
+		{
+			throw runtime_error("Could not create " + path + ".");
+		}
+
+		vector<uint8_t> header(begin(HeaderMagic), end(HeaderMagic));
+		WriteVarint(header, FormatVersion);
+		mFile.write(reinterpret_cast<const char*>(header.data()), header.size());
+		mBytesWritten = header.size();
+
+		mBlock.reserve(BlockRows);
+		mWriter = thread(&TelemetryLog::Run, this);
+	}
+
+	TelemetryLog::~TelemetryLog()
+	{
+		try
+		{
+			Close();
+		}
+		catch (...)
+		{
+			// a destructor can't report a failed write; call Close to find out
+		}
+	}
+
+	TelemetryStream& TelemetryLog::OpenStream()
+	{
+		lock_guard<mutex> lock(mStreamsMutex);
+		mStreams.push_back(make_unique<TelemetryStream>(mStreamCapacity, mOverflow));
+		return *mStreams.back();
+	}
+
+	void TelemetryLog::Close()
+	{
+		if (mClosed)
+		{
+			return;
+		}
+		mClosed = true;
+
+		{
+			lock_guard<mutex> lock(mWakeMutex);
+			mClosing = true;
+		}
+		mWake.notify_one();
+		mWriter.join();
+
+		mBuffer.clear();
+		WriteVarint(mBuffer, 0);
+		WriteVarint(mBuffer, Dropped());
+		mFile.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size());
+		mBytesWritten += mBuffer.size();
+
+		mFile.close();
+		if (mWriteFailed || !mFile)
+		{
+			throw runtime_error("Could not finish writing the telemetry log.");
+		}
+	}
+
+	uint64_t TelemetryLog::EventsWritten() const
+	{
+		return mEventsWritten.load(memory_order_relaxed);
+	}
+
+	uint64_t TelemetryLog::BytesWritten() const
+	{
+		return mBytesWritten.load(memory_order_relaxed);
+	}
+
+	uint64_t TelemetryLog::Dropped() const
+	{
+		lock_guard<mutex> lock(mStreamsMutex);
+		uint64_t dropped = 0;
+		for (const unique_ptr<TelemetryStream>& stream : mStreams)
+		{
+			dropped += stream->Dropped();
+		}
+		return dropped;
+	}
+
+	void TelemetryLog::Run()
+	{
+		// the writer looks again after PollSeconds, which a default ring covers up to a few million
+		// events a second; a ring it finds half full is drained again straight away
+		auto poll = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(PollSeconds));
+		auto lastBlock = chrono::steady_clock::now();
+		for (;;)
+		{
+			// read before draining, so once it's set an empty pass means every event has been taken
+			bool closing;
+			{
+				lock_guard<mutex> lock(mWakeMutex);
+				closing = mClosing;
+			}
+			size_t took = Drain();
+
+			auto now = chrono::steady_clock::now();
+			if (!mBlock.empty() && chrono::duration<double>(now - lastBlock).count() >= FlushSeconds)
+			{
+				WriteBlock();
+			}
+			if (mBlock.empty())
+			{
+				lastBlock = now;
+			}
+
+			if (closing && took == 0)
+			{
+				break;
+			}
+			if (took < mStreamCapacity / 2)
+			{
+				unique_lock<mutex> lock(mWakeMutex);
+				mWake.wait_for(lock, poll, [this] { return mClosing; });
+			}
+		}
+
+		if (!mBlock.empty())
+		{
+			WriteBlock();
+		}
+	}
+
+	size_t TelemetryLog::Drain()
+	{
+		size_t most = 0;
+		lock_guard<mutex> lock(mStreamsMutex);
+		for (const unique_ptr<TelemetryStream>& stream : mStreams)
+		{
+			// at most a ring's worth each, so one busy stream can't starve the others
+			TelemetryEvent event;
+			size_t taken = 0;
+			for (; taken < mStreamCapacity && stream->TryTake(event); ++taken)
+			{
+				mBlock.push_back(event);
+				if (mBlock.size() == BlockRows)
+				{
+					WriteBlock();
+				}
+			}
+			most = max(most, taken);
+		}
+		return most;
+	}
+
+	void TelemetryLog::WriteBlock()
+	{
+		mBuffer.clear();
+		WriteDeltas(mBuffer, mBlock, &TelemetryEvent::Match);
+		WriteDeltas(mBuffer, mBlock, &TelemetryEvent::Frame);
+		WriteDictionary(mBuffer, mBlock, [](const TelemetryEvent& row) { return static_cast<uint8_t>(row.Kind); });
+		WriteDictionary(mBuffer, mBlock, [](const TelemetryEvent& row) { return row.Player; });
+		for (const TelemetryEvent& row : mBlock)
+		{
+			WriteVarint(mBuffer, row.Rally);
+		}
+		for (const TelemetryEvent& row : mBlock)
+		{
+			WriteFloat(mBuffer, row.Value);
+		}
+
+		vector<uint8_t> header;
+		WriteVarint(header, mBlock.size());
+		WriteVarint(header, mBuffer.size());
+		mFile.write(reinterpret_cast<const char*>(header.data()), header.size());
+		mFile.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size());
+		if (!mFile)
+		{
+			mWriteFailed = true;
+		}
+
+		mEventsWritten += mBlock.size();
+		mBytesWritten += header.size() + mBuffer.size();
+		mBlock.clear();
+	}
+
+	TelemetryFile ReadTelemetry(const string& path)
+	{
+		MappedFile file(path);
+		ByteReader reader(file.Data(), file.Data() + file.Size());
+
+		reader.Require(sizeof(HeaderMagic));
+		if (memcmp(reader.Position, HeaderMagic, sizeof(HeaderMagic)) != 0)
+		{
+			throw runtime_error(path + " is not a telemetry log.");
+		}
+		reader.Position += sizeof(HeaderMagic);
+		if (reader.Varint() != FormatVersion)
+		{
+			throw runtime_error(path + " was written by a different telemetry version.");
+		}
+
+		TelemetryFile telemetry;
+		for (;;)
+		{
+			size_t count = static_cast<size_t>(reader.Varint());
+			if (count == 0)
+			{
+				telemetry.Dropped = reader.Varint();
+				break;
+			}
+
+			size_t size = static_cast<size_t>(reader.Varint());
+			reader.Require(size);
+			ByteReader block(reader.Position, reader.Position + size);
+			reader.Position += size;
+
+			size_t first = telemetry.Events.size();
+			telemetry.Events.resize(first + count);
+			TelemetryEvent* rows = telemetry.Events.data() + first;
+
+			ReadDeltas(block, rows, count, &TelemetryEvent::Match);
+			ReadDeltas(block, rows, count, &TelemetryEvent::Frame);
+			vector<uint8_t> kinds = ReadDictionary(block, count);
+			vector<uint8_t> players = ReadDictionary(block, count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (kinds[i] > static_cast<uint8_t>(TelemetryKind::GameOver))
+				{
+					throw runtime_error("Telemetry log is truncated or corrupt.");
+				}
+				rows[i].Kind = static_cast<TelemetryKind>(kinds[i]);
+				rows[i].Player = players[i];
+				rows[i].Rally = static_cast<uint16_t>(block.Varint());
+			}
+			for (size_t i = 0; i < count; ++i)
+			{
+				rows[i].Value = block.Float();
+			}
+
+			if (block.Position != block.End)
+			{
+				throw runtime_error("Telemetry log is truncated or corrupt.");
+			}
+		}
+
+		return telemetry;
+	}
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "MatchState.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Pong
+{
+	enum class TelemetryKind : uint8_t
+	{
+		Serve = 0, // Value is the angle off horizontal in degrees, positive downward; Player receives
+		PaddleHit = 1, // Value is where the ball met the paddle, -1 at the top edge to 1 at the bottom
+		WallHit = 2, // Value is how far across the arena the ball was, 0 at player 1's wall to 1 at player 2's
+		Score = 3, // Value is the seconds from the serve; Rally is the paddle hits before the point
+		AIReaction = 4, // Value is the ball's centre less the AI paddle's, in pixels, at the contact or where the ball passed the paddle's face
+		GameOver = 5, // Value is the game's length in seconds; Player won
+	};
+
+	// One gameplay event. Player is 1 or 2, or 0 when the event has none, and Rally counts the
+	// paddle hits since the serve.
+	struct TelemetryEvent final
+	{
+		uint32_t Match = 0;
+		uint32_t Frame = 0;
+		float Value = 0.0f;
+		uint16_t Rally = 0;
+		TelemetryKind Kind = TelemetryKind::Serve;
+		uint8_t Player = 0;
+	};
+
+	// What happens when a stream's ring is full because the writer has fallen behind.
+	enum class TelemetryOverflow
+	{
+		Drop, // the event is lost and counted, so a frame never waits on the disk
+		Wait, // the producer yields until there's room, for headless runs that want every event
+	};
+
+	// One producer thread's ring. Only the thread that opened it may record into it.
+	class TelemetryStream final
+	{
+	public:
+		TelemetryStream(size_t capacity, TelemetryOverflow overflow);
+
+		TelemetryStream(const TelemetryStream&) = delete;
+		TelemetryStream& operator=(const TelemetryStream&) = delete;
+
+		void Record(const TelemetryEvent& event);
+		bool TryTake(TelemetryEvent& event);
+		uint64_t Dropped() const;
+
+	private:
+		SpscQueue<TelemetryEvent> mEvents;
+		TelemetryOverflow mOverflow;
+		std::atomic<uint64_t> mDropped;
+	};
+
+	// The end of a step as the observers see it, whether it came from a MatchState or a MatchBatch lane.
+	struct TelemetryStep final
+	{
+		uint32_t Events = MatchEvents::None;
+		float BallX = 0.0f;
+		float BallY = 0.0f;
+		float BallVelocityX = 0.0f;
+		float BallVelocityY = 0.0f;
+		float Paddle1Y = 0.0f;
+		float Paddle2Y = 0.0f;
+		float Paddle2VelocityY = 0.0f;
+		int32_t Player1Score = 0;
+		int32_t Player2Score = 0;
+		double TotalTime = 0.0;
+	};
+
+	// What an observer remembers of one match's rally and game between events.
+	struct TelemetryTrack final
+	{
+		uint16_t Rally = 0;
+		float MissOffset = 0.0f; // where the ball last passed paddle 2's face
+		float Paddle1Offset = 0.0f; // where the ball last passed paddle 1's face
+		uint32_t Paddle1Frame = UINT32_MAX; // and the step it did
+		double ServeTime = 0.0;
+		double GameStart = 0.0;
+	};
+
+	// Turns the steps of one match into TelemetryEvents. Observe has to see every step, in order,
+	// starting from the match CreateMatch returned, along with the elapsedTime it was stepped by.
+	// The simulation raises an event for everything worth recording, the ball passing a paddle's
+	// face included, and the observer winds positions back along their velocities when it needs
+	// them earlier in the step, so a step with nothing to record costs one compare.
+	class TelemetryObserver final
+	{
+	public:
+		TelemetryObserver(const MatchState& match, uint32_t matchId);
+
+		// in the header, since it runs after every step and almost every step has nothing to say
+		void Observe(const MatchState& match, float elapsedTime, TelemetryStream& stream)
+		{
+			if (match.Events != MatchEvents::None)
+			{
+				RecordEvents(match, elapsedTime, stream);
+			}
+			++mFrame;
+		}
+
+	private:
+		void RecordEvents(const MatchState& match, float elapsedTime, TelemetryStream& stream);
+
+		uint32_t mMatch;
+		uint32_t mFrame;
+		TelemetryTrack mTrack;
+	};
+
+	class MatchBatch;
+
+	// TelemetryObserver for every lane of a MatchBatch, reading its columns directly. A step scans
+	// only the event column, and reads the others just for the few lanes with anything to record.
+	class BatchTelemetryObserver final
+	{
+	public:
+		BatchTelemetryObserver(const MatchBatch& batch, uint32_t firstMatchId);
+
+		// after every MatchBatch::Step, with the same elapsedTime
+		void Observe(const MatchBatch& batch, float elapsedTime, TelemetryStream& stream);
+
+	private:
+		uint32_t mFirstMatch;
+		uint32_t mFrame;
+		std::vector<TelemetryTrack> mTracks;
+	};
+
+	// Telemetry file layout:
+	//   header   magic, version
+	//   blocks   row count, byte size, then each column in turn: Match and Frame as zigzag varint
+	//            deltas from the row before, Kind and Player as a dictionary of the values in the
+	//            block followed by bit-packed indices, Rally as varints, and Value as raw floats
+	//   footer   a zero row count, then how many events the streams dropped
+	//
+	// Every producer thread opens its own stream and records into it without locking. A writer
+	// thread drains the streams every PollSeconds into blocks of BlockRows events, and writes a
+	// shorter block after FlushSeconds so a long quiet session still reaches the disk.
+	class TelemetryLog final
+	{
+	public:
+		static const size_t DefaultStreamCapacity = 1 << 16;
+		static const size_t BlockRows = 1 << 16;
+		static const double PollSeconds;
+		static const double FlushSeconds;
+
+		TelemetryLog(const std::string& path, TelemetryOverflow overflow, size_t streamCapacity = DefaultStreamCapacity);
+		~TelemetryLog();
+
+		TelemetryLog(const TelemetryLog&) = delete;
+		TelemetryLog& operator=(const TelemetryLog&) = delete;
+
+		// once per producer thread; the stream lives as long as the log
+		TelemetryStream& OpenStream();
+
+		// every producer has to have stopped recording; writes what's left and the footer
+		void Close();
+
+		uint64_t EventsWritten() const;
+		uint64_t BytesWritten() const;
+		uint64_t Dropped() const;
+
+	private:
+		void Run();
+		// the most events any one stream gave up
+		size_t Drain();
+		void WriteBlock();
+
+		std::ofstream mFile;
+		TelemetryOverflow mOverflow;
+		size_t mStreamCapacity;
+
+		mutable std::mutex mStreamsMutex;
+		std::vector<std::unique_ptr<TelemetryStream>> mStreams;
+
+		// writer thread only, until it has been joined
+		std::vector<TelemetryEvent> mBlock;
+		std::vector<uint8_t> mBuffer;
+		bool mWriteFailed;
+
+		std::atomic<uint64_t> mEventsWritten;
+		std::atomic<uint64_t> mBytesWritten;
+
+		// only Close wakes the writer early; producers never touch it
+		std::mutex mWakeMutex;
+		std::condition_variable mWake;
+		bool mClosing;
+		std::thread mWriter;
+		bool mClosed;
+	};
+
+	struct TelemetryFile final
+	{
+		std::vector<TelemetryEvent> Events;
+		uint64_t Dropped = 0;
+	};
+
+	// Throws std::runtime_error when the file isn't a finished telemetry log.
+	TelemetryFile ReadTelemetry(const std::string& path);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Pong
+{
+	// Hands the latest value from exactly one writer thread to exactly one reader thread without
+	// either ever waiting. The writer fills its own slot and swaps it with the spare; the reader
+	// swaps the spare for its own slot only when something new was published. Values the reader
+	// doesn't get to in time are simply overwritten, so a slow reader never holds up the writer.
+	template <typename T>
+	class TripleBuffer final
+	{
+	public:
+		TripleBuffer();
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		// writer only: fill this in, then Publish it
+		T& WriteSlot();
+		void Publish();
+
+		// reader only: true when a newer value has replaced ReadSlot
+		bool Acquire();
+		const T& ReadSlot() const;
+
+	private:
+		// the spare slot's index, with this bit set while it holds a value the reader hasn't taken
+		static const uint32_t FreshBit = 4;
+
+		T mSlots[3];
+		uint32_t mWriteIndex;
+		std::atomic<uint32_t> mSpare;
+		uint32_t mReadIndex;
+	};
+
+	template <typename T>
+	TripleBuffer<T>::TripleBuffer() :
+		mSlots(), mWriteIndex(0), mSpare(1), mReadIndex(2)
+	{
+	}
+
+	template <typename T>
+	T& TripleBuffer<T>::WriteSlot()
+	{
+		return mSlots[mWriteIndex];
+	}
+
+	template <typename T>
+	void TripleBuffer<T>::Publish()
+	{
+		// release so the reader sees the slot's contents; acquire so the slot handed back is done with
+		uint32_t previous = mSpare.exchange(mWriteIndex | FreshBit, std::memory_order_acq_rel);
+		mWriteIndex = previous & ~FreshBit;
+	}
+
+	template <typename T>
+	bool TripleBuffer<T>::Acquire()
+	{
+		if ((mSpare.load(std::memory_order_relaxed) & FreshBit) == 0)
+		{
+			return false;
+		}
+
+		uint32_t previous = mSpare.exchange(mReadIndex, std::memory_order_acq_rel);
+		mReadIndex = previous & ~FreshBit;
+		return true;
+	}
+
+	template <typename T>
+	const T& TripleBuffer<T>::ReadSlot() const
+	{
+		return mSlots[mReadIndex];
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace Pong
+{
+	struct Vector2 final
+	{
+		float X;
+		float Y;
+
+		Vector2() : X(0.0f), Y(0.0f) { }
+		Vector2(float x, float y) : X(x), Y(y) { }
+	};
+}
@@ -0,0 +1,130 @@
+#include "pch.h"
+#include "VectorEnvironment.h"
+#include "Profiler.h"
+#include "Simulation.h"
+
+using namespace std;
+
+namespace Pong
+{
+	VectorEnvironment::VectorEnvironment(const EnvironmentOptions& options, size_t count, shared_ptr<const PaddleController> opponent) :
+		mOptions(options), mOpponent(move(opponent)), mMatches(count), mEpisodeFrames(count), mNextSeeds(count), mChunkSize(count), mBuffers()
+	{
+		if (count == 0 || options.FrameSkip == 0)
+		{
+			throw invalid_argument("An environment needs at least one match and one frame per step.");
+		}
+
+		// the opponent presses player 2's keys; without one the built-in AI plays
+		mOptions.Config.Player2Control = (mOpponent != nullptr ? PaddleControl::Inputs : PaddleControl::BuiltInAI);
+
+		if (options.ThreadCount != 1)
+		{
+			mPool = make_unique<TaskPool>(options.ThreadCount);
+
+			// a few chunks per thread so a slow one doesn't hold up the step
+			size_t chunkCount = static_cast<size_t>(mPool->ThreadCount()) * 4;
+			mChunkSize = max<size_t>((count + chunkCount - 1) / chunkCount, 16);
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			ResetMatch(i, static_cast<uint32_t>(i));
+		}
+	}
+
+	size_t VectorEnvironment::Count() const
+	{
+		return mMatches.size();
+	}
+
+	const EnvironmentOptions& VectorEnvironment::Options() const
+	{
+		return mOptions;
+	}
+
+	const MatchState& VectorEnvironment::Match(size_t index) const
+	{
+		assert(index < mMatches.size());
+		return mMatches[index];
+	}
+
+	void VectorEnvironment::Reset(const uint32_t* seeds, float* observations)
+	{
+		for (size_t i = 0; i < mMatches.size(); ++i)
+		{
+			ResetMatch(i, seeds[i]);
+			PolicyNetwork::Features(mMatches[i], Players::Player1, observations + i * ObservationSize);
+		}
+	}
+
+	void VectorEnvironment::Step(const int32_t* actions, float* observations, float* rewards, uint8_t* terminated, uint8_t* truncated)
+	{
+		PONG_PROFILE_SCOPE("VectorEnvironment::Step");
+		mBuffers = StepBuffers{ actions, observations, rewards, terminated, truncated };
+
+		if (mPool == nullptr)
+		{
+			StepRange(0, mMatches.size());
+			return;
+		}
+
+		// every match is independent, so the chunks need no locking
+		for (size_t begin = 0; begin < mMatches.size(); begin += mChunkSize)
+		{
+			size_t end = min(begin + mChunkSize, mMatches.size());
+			mPool->Submit([this, begin, end]
+			{
+				StepRange(begin, end);
+			});
+		}
+		mPool->Wait();
+	}
+
+	void VectorEnvironment::ResetMatch(size_t index, uint32_t seed)
+	{
+		MatchState& match = mMatches[index];
+		match = Simulation::CreateMatch(mOptions.Config, seed, static_cast<uint32_t>(index));
+		Simulation::ChangeGamestate(match, Gamestate::Playing);
+		mEpisodeFrames[index] = 0;
+		mNextSeeds[index] = seed + static_cast<uint32_t>(mMatches.size());
+	}
+
+	void VectorEnvironment::StepRange(size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			MatchState& match = mMatches[i];
+			int32_t player1Score = match.Player1Score;
+			int32_t player2Score = match.Player2Score;
+
+			MatchInputs inputs;
+			inputs.Player1 = PolicyNetwork::Inputs(static_cast<PolicyAction>(mBuffers.Actions[i]));
+
+			bool gameOver = (match.Gamestate != Gamestate::Playing);
+			for (uint32_t frame = 0; frame < mOptions.FrameSkip && !gameOver; ++frame)
+			{
+				if (mOpponent != nullptr)
+				{
+					inputs.Player2 = mOpponent->Control(match, Players::Player2);
+				}
+
+				Simulation::Step(match, inputs, mOptions.ElapsedTime);
+				gameOver = (match.Events & MatchEvents::GameOver) != 0;
+				++mEpisodeFrames[i];
+			}
+
+			bool truncated = !gameOver && mOptions.MaxEpisodeFrames != 0 && mEpisodeFrames[i] >= mOptions.MaxEpisodeFrames;
+			mBuffers.Rewards[i] = static_cast<float>((match.Player1Score - player1Score) - (match.Player2Score - player2Score));
+			mBuffers.Terminated[i] = gameOver;
+			mBuffers.Truncated[i] = truncated;
+
+			if ((gameOver || truncated) && mOptions.AutoReset)
+			{
+				ResetMatch(i, mNextSeeds[i]);
+			}
+
+			PolicyNetwork::Features(match, Players::Player1, mBuffers.Observations + i * ObservationSize);
+		}
+	}
+}
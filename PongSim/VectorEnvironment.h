@@ -0,0 +1,77 @@
+#pragma once
+
+#include "FixedTimestep.h"
+#include "MatchConfig.h"
+#include "MatchState.h"
+#include "PaddleController.h"
+#include "PolicyNetwork.h"
+#include "TaskPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Pong
+{
+	struct EnvironmentOptions final
+	{
+		MatchConfig Config;
+		float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		uint32_t FrameSkip = 1; // simulation steps per action, each repeating it
+		uint32_t MaxEpisodeFrames = 0; // truncates longer episodes; zero never does
+		bool AutoReset = true; // a finished match starts its next episode inside the same Step
+		uint32_t ThreadCount = 1; // zero means one per hardware thread
+	};
+
+	// Many independent matches stepped together for reinforcement learning. The agent plays
+	// player 1; player 2 is the built-in AI unless an opponent controller is given. Every buffer
+	// belongs to the caller and is written in place, one contiguous row per match, so a binding
+	// can hand numpy arrays straight through.
+	//
+	// Observations are PolicyNetwork's features, so a network trained here can play the game.
+	// Actions are PolicyAction values; anything else stays put. The reward is the change in
+	// player 1's lead over the step. With AutoReset, a match that ends writes the first
+	// observation of its next episode, seeded Count() higher than the one that ended.
+	class VectorEnvironment final
+	{
+	public:
+		static const uint32_t ObservationSize = PolicyNetwork::FeatureCount;
+
+		VectorEnvironment(const EnvironmentOptions& options, std::size_t count, std::shared_ptr<const PaddleController> opponent = nullptr);
+
+		VectorEnvironment(const VectorEnvironment&) = delete;
+		VectorEnvironment& operator=(const VectorEnvironment&) = delete;
+
+		std::size_t Count() const;
+		const EnvironmentOptions& Options() const;
+		const MatchState& Match(std::size_t index) const;
+
+		// seeds has Count() entries; observations Count() * ObservationSize
+		void Reset(const uint32_t* seeds, float* observations);
+
+		// actions, rewards, terminated and truncated have Count() entries each
+		void Step(const int32_t* actions, float* observations, float* rewards, uint8_t* terminated, uint8_t* truncated);
+
+	private:
+		struct StepBuffers final
+		{
+			const int32_t* Actions;
+			float* Observations;
+			float* Rewards;
+			uint8_t* Terminated;
+			uint8_t* Truncated;
+		};
+
+		void ResetMatch(std::size_t index, uint32_t seed);
+		void StepRange(std::size_t begin, std::size_t end);
+
+		EnvironmentOptions mOptions;
+		std::shared_ptr<const PaddleController> mOpponent;
+		std::vector<MatchState> mMatches;
+		std::vector<uint32_t> mEpisodeFrames;
+		std::vector<uint32_t> mNextSeeds;
+		std::unique_ptr<TaskPool> mPool;
+		std::size_t mChunkSize;
+		StepBuffers mBuffers;
+	};
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+// Standard
+#include <exception>
+#include <stdexcept>
+#include <cassert>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <random>
@@ -0,0 +1,240 @@
+#include "FixedTimestep.h"
+#include "PaddleController.h"
+#include "Profiler.h"
+#include "Simulation.h"
+#include "Telemetry.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct DriverOptions
+	{
+		uint32_t Matches = 1000;
+		uint32_t Frames = 10000;
+		float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		uint32_t Seed = 1;
+		CollisionMode Collision = CollisionMode::Discrete;
+		AIMode AI = AIMode::Reactive;
+		float AIError = 0.0f;
+		PhysicsMode Physics = PhysicsMode::Float;
+		string TracePath;
+		string TelemetryPath;
+	};
+
+	DriverOptions ParseOptions(int argc, char* argv[])
+	{
+		DriverOptions options;
+
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--matches") == 0)
+			{
+				options.Matches = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--dt") == 0)
+			{
+				options.ElapsedTime = static_cast<float>(atof(argv[i + 1]));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--collision") == 0)
+			{
+				if (strcmp(argv[i + 1], "discrete") == 0)
+				{
+					options.Collision = CollisionMode::Discrete;
+				}
+				else if (strcmp(argv[i + 1], "swept") == 0)
+				{
+					options.Collision = CollisionMode::Swept;
+				}
+				else
+				{
+					cerr << "Unknown value for --collision: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--ai") == 0)
+			{
+				if (strcmp(argv[i + 1], "reactive") == 0)
+				{
+					options.AI = AIMode::Reactive;
+				}
+				else if (strcmp(argv[i + 1], "predictive") == 0)
+				{
+					options.AI = AIMode::Predictive;
+				}
+				else
+				{
+					cerr << "Unknown value for --ai: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--ai-error") == 0)
+			{
+				options.AIError = static_cast<float>(atof(argv[i + 1]));
+			}
+			else if (strcmp(argv[i], "--physics") == 0)
+			{
+				if (strcmp(argv[i + 1], "float") == 0)
+				{
+					options.Physics = PhysicsMode::Float;
+				}
+				else if (strcmp(argv[i + 1], "fixed") == 0)
+				{
+					options.Physics = PhysicsMode::FixedPoint;
+				}
+				else
+				{
+					cerr << "Unknown value for --physics: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--trace") == 0)
+			{
+				options.TracePath = argv[i + 1];
+			}
+			else if (strcmp(argv[i], "--telemetry") == 0)
+			{
+				options.TelemetryPath = argv[i + 1];
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	// the ring only holds the most recent samples, so the table describes the end of the run
+	void ReportProfile(const string& tracePath)
+	{
+#if defined(PONG_PROFILE)
+		const Profiler& profiler = Profiler::Instance();
+
+		cout << "Phase                           Samples    p50 ms    p99 ms    max ms" << endl;
+		cout << fixed << setprecision(4);
+		for (const PhaseSummary& phase : profiler.Summarize())
+		{
+			cout << left << setw(30) << phase.Name << right << setw(10) << phase.Count << setw(10) << phase.P50Milliseconds
+				<< setw(10) << phase.P99Milliseconds << setw(10) << phase.MaxMilliseconds << endl;
+		}
+
+		if (!tracePath.empty())
+		{
+			ofstream trace(tracePath);
+			profiler.WriteChromeTrace(trace);
+			cout << "Wrote a trace of the last " << profiler.Samples().size() << " samples to " << tracePath << endl;
+		}
+#else
+		if (!tracePath.empty())
+		{
+			cerr << "--trace needs a build configured with -DPONG_PROFILE=ON" << endl;
+		}
+#endif
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	DriverOptions options = ParseOptions(argc, argv);
+
+	MatchConfig config;
+	config.Collision = options.Collision;
+	config.AI = options.AI;
+	config.AIError = options.AIError;
+	config.Physics = options.Physics;
+	vector<MatchState> matches;
+	matches.reserve(options.Matches);
+	for (uint32_t i = 0; i < options.Matches; ++i)
+	{
+		matches.push_back(Simulation::CreateMatch(config, options.Seed, i));
+	}
+
+	// stands in for the keyboard, pressing SPACEBAR whenever a match is over
+	TrackingController player1;
+	MatchInputs inputs;
+
+	uint64_t gamesCompleted = 0;
+	uint64_t player1Wins = 0;
+
+	// every event is kept, so the run waits on the writer rather than losing any
+	unique_ptr<TelemetryLog> telemetry;
+	TelemetryStream* telemetryStream = nullptr;
+	if (!options.TelemetryPath.empty())
+	{
+		telemetry = make_unique<TelemetryLog>(options.TelemetryPath, TelemetryOverflow::Wait);
+		telemetryStream = &telemetry->OpenStream();
+	}
+
+	auto startTime = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < options.Matches; ++i)
+	{
+		MatchState& match = matches[i];
+		TelemetryObserver observer(match, i);
+		for (uint32_t frame = 0; frame < options.Frames; ++frame)
+		{
+			inputs.Start = (match.Gamestate != Gamestate::Playing);
+			inputs.Player1 = player1.Control(match, Players::Player1);
+			Simulation::Step(match, inputs, options.ElapsedTime);
+			if (telemetryStream != nullptr)
+			{
+				observer.Observe(match, options.ElapsedTime, *telemetryStream);
+			}
+
+			if (match.Events & MatchEvents::GameOver)
+			{
+				++gamesCompleted;
+				if (match.Player1Score > match.Player2Score)
+				{
+					++player1Wins;
+				}
+			}
+		}
+	}
+	if (telemetry != nullptr)
+	{
+		// the writer's last block is part of the run's cost
+		telemetry->Close();
+	}
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+	uint64_t totalFrames = static_cast<uint64_t>(options.Matches) * options.Frames;
+	cout << "Simulated " << totalFrames << " frames across " << options.Matches << " matches in " << elapsed.count() << " s" << endl;
+	cout << "Frames per second: " << static_cast<uint64_t>(totalFrames / elapsed.count()) << endl;
+	cout << "Games completed: " << gamesCompleted << " (player 1 won " << player1Wins << ")" << endl;
+	if (telemetry != nullptr)
+	{
+		cout << "Telemetry: " << telemetry->EventsWritten() << " events in " << telemetry->BytesWritten() << " bytes ("
+			<< static_cast<uint64_t>(telemetry->EventsWritten() / elapsed.count()) << " events per second), " << telemetry->Dropped()
+			<< " dropped, written to " << options.TelemetryPath << endl;
+	}
+
+	ReportProfile(options.TracePath);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,264 @@
+#include "FixedTimestep.h"
+#include "Simulation.h"
+#include "SimulationThread.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct StallOptions
+	{
+		double Seconds = 5.0;
+		double RefreshRate = 60.0;
+		double StallMilliseconds = 100.0;
+		uint32_t StallEvery = 20; // frames
+		uint32_t Seed = 1;
+	};
+
+	StallOptions ParseOptions(int argc, char* argv[])
+	{
+		StallOptions options;
+
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--seconds") == 0)
+			{
+				options.Seconds = atof(argv[i + 1]);
+			}
+			else if (strcmp(argv[i], "--refresh") == 0)
+			{
+				options.RefreshRate = atof(argv[i + 1]);
+			}
+			else if (strcmp(argv[i], "--stall-ms") == 0)
+			{
+				options.StallMilliseconds = atof(argv[i + 1]);
+			}
+			else if (strcmp(argv[i], "--stall-every") == 0)
+			{
+				options.StallEvery = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	// A player tapping Up at irregular times, so there is a known moment each press happened.
+	class ScriptedPlayer final
+	{
+	public:
+		ScriptedPlayer(double seconds, uint32_t seed)
+		{
+			minstd_rand generator(seed);
+			uniform_real_distribution<double> gap(0.05, 0.25);
+			for (double time = gap(generator); time < seconds + 1.0; time += gap(generator))
+			{
+				mToggleTimes.push_back(time);
+			}
+		}
+
+		// whether Up is held at a time, and since when it has been held or released
+		bool IsPressed(double time, double& since) const
+		{
+			auto next = upper_bound(mToggleTimes.begin(), mToggleTimes.end(), time);
+			size_t toggles = static_cast<size_t>(next - mToggleTimes.begin());
+			since = (toggles > 0 ? mToggleTimes[toggles - 1] : 0.0);
+			return toggles % 2 == 1;
+		}
+
+	private:
+		vector<double> mToggleTimes;
+	};
+
+	// Measures the steps as they run, the same way for both threading modes.
+	struct StepRecorder final
+	{
+		const ScriptedPlayer* Player = nullptr;
+		double Now = 0.0;
+		double LastStepTime = -1.0;
+		bool LastPressed = false;
+		double PressTime = 0.0; // when the key the current inputs saw changed
+		uint64_t Steps = 0;
+		vector<double> Intervals;
+		vector<double> Latencies;
+
+		MatchInputs Sample(double time)
+		{
+			MatchInputs inputs;
+			inputs.Player1.Up = Player->IsPressed(time, PressTime);
+			inputs.Start = true;
+			return inputs;
+		}
+
+		void Record(const MatchInputs& inputs, double time)
+		{
+			if (LastStepTime >= 0.0)
+			{
+				Intervals.push_back(time - LastStepTime);
+			}
+			LastStepTime = time;
+
+			// latency is from the key changing to the first step that has seen it
+			if (inputs.Player1.Up != LastPressed)
+			{
+				Latencies.push_back(time - PressTime);
+				LastPressed = inputs.Player1.Up;
+			}
+			++Steps;
+		}
+	};
+
+	void PrintResult(const string& mode, const StepRecorder& recorder, double seconds, float stepSeconds)
+	{
+		double intervalSum = 0.0;
+		double intervalSquares = 0.0;
+		for (double interval : recorder.Intervals)
+		{
+			intervalSum += interval;
+			intervalSquares += interval * interval;
+		}
+		double count = static_cast<double>(max<size_t>(recorder.Intervals.size(), 1));
+		double mean = intervalSum / count;
+		double deviation = sqrt(max(intervalSquares / count - mean * mean, 0.0));
+		double maxInterval = (recorder.Intervals.empty() ? 0.0 : *max_element(recorder.Intervals.begin(), recorder.Intervals.end()));
+
+		vector<double> latencies = recorder.Latencies;
+		sort(latencies.begin(), latencies.end());
+		double latencySum = 0.0;
+		for (double latency : latencies)
+		{
+			latencySum += latency;
+		}
+		double meanLatency = latencySum / max<size_t>(latencies.size(), 1);
+		double p99Latency = (latencies.empty() ? 0.0 : latencies[min(latencies.size() - 1, latencies.size() * 99 / 100)]);
+
+		int64_t expectedSteps = static_cast<int64_t>(seconds / stepSeconds);
+		cout << left << setw(10) << mode << right << fixed << setprecision(1) << setw(9) << recorder.Steps / seconds
+			<< setw(8) << max<int64_t>(expectedSteps - static_cast<int64_t>(recorder.Steps), 0)
+			<< setprecision(2) << setw(10) << 1000.0 * mean << setw(10) << 1000.0 * deviation << setw(10) << 1000.0 * maxInterval
+			<< setw(10) << 1000.0 * meanLatency << setw(10) << 1000.0 * p99Latency << endl;
+	}
+
+	// Stands in for Draw: waits for the next vertical blank like Present(1, 0), and every so often
+	// takes far longer, like a shader compile or a window drag.
+	void PresentFrame(chrono::steady_clock::time_point startTime, uint64_t frame, const StallOptions& options)
+	{
+		this_thread::sleep_until(startTime + chrono::duration<double>((frame + 1) / options.RefreshRate));
+		if (options.StallEvery > 0 && frame % options.StallEvery == options.StallEvery - 1)
+		{
+			this_thread::sleep_for(chrono::duration<double>(options.StallMilliseconds / 1000.0));
+		}
+	}
+
+	// The game's single-threaded loop: sample inputs, catch the simulation up, then draw.
+	StepRecorder RunSingleThreaded(const StallOptions& options, const ScriptedPlayer& player, MatchState match)
+	{
+		StepRecorder recorder;
+		recorder.Player = &player;
+		FixedTimestep timestep;
+		auto startTime = chrono::steady_clock::now();
+		auto now = [&]() { return chrono::duration<double>(chrono::steady_clock::now() - startTime).count(); };
+
+		double lastFrameTime = 0.0;
+		for (uint64_t frame = 0; now() < options.Seconds; ++frame)
+		{
+			double frameTime = now();
+			MatchInputs inputs = recorder.Sample(frameTime);
+			uint32_t steps = timestep.Advance(static_cast<float>(frameTime - lastFrameTime));
+			lastFrameTime = frameTime;
+
+			for (uint32_t step = 0; step < steps; ++step)
+			{
+				Simulation::Step(match, inputs, timestep.StepSeconds());
+				recorder.Record(inputs, now());
+			}
+
+			PresentFrame(startTime, frame, options);
+		}
+
+		return recorder;
+	}
+
+	// The same frames with the simulation on its own thread; the render loop only picks up snapshots.
+	StepRecorder RunThreaded(const StallOptions& options, const ScriptedPlayer& player, const MatchState& match, SimulationThreadStats& stats)
+	{
+		StepRecorder recorder;
+		recorder.Player = &player;
+		float stepSeconds = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+
+		SimulationThread* running = nullptr;
+		SimulationThread simulation(match, stepSeconds,
+			[&](const MatchState&) { return recorder.Sample(running->Now()); },
+			[&](const MatchState&, const MatchInputs& inputs, const MatchState&) { recorder.Record(inputs, running->Now()); });
+		running = &simulation;
+
+		auto startTime = chrono::steady_clock::now();
+		simulation.Start();
+		uint64_t frames = 0;
+		for (; chrono::steady_clock::now() - startTime < chrono::duration<double>(options.Seconds); ++frames)
+		{
+			simulation.Acquire();
+			PresentFrame(startTime, frames, options);
+		}
+		simulation.Stop();
+
+		simulation.Acquire();
+		stats = simulation.Snapshot().Stats;
+		return recorder;
+	}
+}
+
+// Plays the same scripted key presses through the single-threaded game loop and the threaded one
+// while the renderer stalls, and compares how steadily each simulates and how soon each sees a key.
+int main(int argc, char* argv[])
+{
+	StallOptions options = ParseOptions(argc, argv);
+	ScriptedPlayer player(options.Seconds, options.Seed);
+	MatchConfig config;
+	config.Player2Control = PaddleControl::BuiltInAI;
+	MatchState match = Simulation::CreateMatch(config, options.Seed);
+	float stepSeconds = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+
+	cout << "Simulating " << options.Seconds << " s at " << FixedTimestep::DefaultStepsPerSecond << " Hz, presenting at " << options.RefreshRate << " Hz with a "
+		<< options.StallMilliseconds << " ms stall every " << options.StallEvery << " frames" << endl;
+	cout << left << setw(10) << "mode" << right << setw(9) << "steps/s" << setw(8) << "missed" << setw(10) << "mean ms" << setw(10) << "stddev"
+		<< setw(10) << "max ms" << setw(10) << "input ms" << setw(10) << "p99 ms" << endl;
+
+	StepRecorder single = RunSingleThreaded(options, player, match);
+	PrintResult("single", single, options.Seconds, stepSeconds);
+
+	SimulationThreadStats stats;
+	StepRecorder threaded = RunThreaded(options, player, match, stats);
+	PrintResult("threaded", threaded, options.Seconds, stepSeconds);
+
+	cout << "Simulation thread: " << stats.Steps << " steps, " << stats.LateSteps << " late, " << stats.DroppedSteps << " dropped, "
+		<< setprecision(3) << 1000.0 * stats.InputLatencySum / max<uint64_t>(stats.Steps, 1) << " ms from sampling to publishing on average" << endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,436 @@
+#include "FixedTimestep.h"
+#include "MatchBatch.h"
+#include "Telemetry.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	const int32_t HitBins = 10;
+
+	struct ThroughputOptions
+	{
+		uint32_t Matches = 4096;
+		uint32_t Frames = 2000;
+		uint32_t Rounds = 5;
+		uint32_t Threads = 1;
+		uint64_t Events = 1 << 24;
+		uint32_t Seed = 1;
+	};
+
+	struct Spread
+	{
+		vector<float> Values;
+
+		void Add(float value)
+		{
+			Values.push_back(value);
+		}
+
+		double Mean() const
+		{
+			double sum = 0.0;
+			for (float value : Values)
+			{
+				sum += value;
+			}
+			return (Values.empty() ? 0.0 : sum / Values.size());
+		}
+
+		double MeanAbsolute() const
+		{
+			double sum = 0.0;
+			for (float value : Values)
+			{
+				sum += fabs(value);
+			}
+			return (Values.empty() ? 0.0 : sum / Values.size());
+		}
+
+		float Median()
+		{
+			if (Values.empty())
+			{
+				return 0.0f;
+			}
+			nth_element(Values.begin(), Values.begin() + Values.size() / 2, Values.end());
+			return Values[Values.size() / 2];
+		}
+
+		float Max() const
+		{
+			return (Values.empty() ? 0.0f : *max_element(Values.begin(), Values.end()));
+		}
+	};
+
+	void PrintUsage()
+	{
+		cerr << "Usage: PongTelemetry summary <file>" << endl;
+		cerr << "       PongTelemetry dump <file>" << endl;
+		cerr << "       PongTelemetry throughput <file> [--matches N] [--frames N] [--rounds N] [--threads N] [--events N] [--seed N]" << endl;
+	}
+
+	const char* KindName(TelemetryKind kind)
+	{
+		switch (kind)
+		{
+		case TelemetryKind::Serve:
+			return "serve";
+		case TelemetryKind::PaddleHit:
+			return "paddle-hit";
+		case TelemetryKind::WallHit:
+			return "wall-hit";
+		case TelemetryKind::Score:
+			return "score";
+		case TelemetryKind::AIReaction:
+			return "ai-reaction";
+		default:
+			return "game-over";
+		}
+	}
+
+	int Summary(const string& path)
+	{
+		TelemetryFile telemetry = ReadTelemetry(path);
+
+		uint64_t counts[static_cast<size_t>(TelemetryKind::GameOver) + 1] = { };
+		Spread rallies;
+		Spread timesToScore;
+		Spread serveAngles;
+		Spread aiHits;
+		Spread aiMisses;
+		Spread gameLengths;
+		uint64_t hitBins[2][HitBins] = { };
+
+		// an AI reaction straight after its paddle's hit was a save; otherwise the point follows it
+		unordered_map<uint32_t, TelemetryEvent> lastByMatch;
+		for (const TelemetryEvent& event : telemetry.Events)
+		{
+			++counts[static_cast<size_t>(event.Kind)];
+			switch (event.Kind)
+			{
+			case TelemetryKind::Serve:
+				serveAngles.Add(event.Value);
+				break;
+			case TelemetryKind::PaddleHit:
+				if (event.Player == 1 || event.Player == 2)
+				{
+					int32_t bin = static_cast<int32_t>((event.Value + 1.0f) / 2.0f * HitBins);
+					++hitBins[event.Player - 1][max(0, min(bin, HitBins - 1))];
+				}
+				break;
+			case TelemetryKind::Score:
+				rallies.Add(event.Rally);
+				timesToScore.Add(event.Value);
+				break;
+			case TelemetryKind::AIReaction:
+			{
+				auto last = lastByMatch.find(event.Match);
+				bool saved = (last != lastByMatch.end() && last->second.Kind == TelemetryKind::PaddleHit && last->second.Frame == event.Frame);
+				(saved ? aiHits : aiMisses).Add(event.Value);
+				break;
+			}
+			case TelemetryKind::GameOver:
+				gameLengths.Add(event.Value);
+				break;
+			default:
+				break;
+			}
+			lastByMatch[event.Match] = event;
+		}
+
+		cout << telemetry.Events.size() << " events from " << lastByMatch.size() << " matches, " << telemetry.Dropped << " dropped" << endl;
+		for (size_t kind = 0; kind < sizeof(counts) / sizeof(counts[0]); ++kind)
+		{
+			cout << "  " << left << setw(14) << KindName(static_cast<TelemetryKind>(kind)) << right << setw(12) << counts[kind] << endl;
+		}
+
+		cout << fixed << setprecision(2);
+		cout << "Rally length: mean " << rallies.Mean() << ", median " << rallies.Median() << ", longest " << rallies.Max() << " hits" << endl;
+		cout << "Time to score: mean " << timesToScore.Mean() << " s, median " << timesToScore.Median() << " s" << endl;
+		cout << "Serve angle: mean " << serveAngles.MeanAbsolute() << " degrees off horizontal, steepest " << max(serveAngles.Max(), 0.0f) << endl;
+		cout << "Game length: mean " << gameLengths.Mean() << " s over " << gameLengths.Values.size() << " games" << endl;
+
+		if (!aiHits.Values.empty() || !aiMisses.Values.empty())
+		{
+			cout << "AI reaction error: " << aiHits.Values.size() << " saves, mean " << aiHits.MeanAbsolute() << " px off centre; "
+				<< aiMisses.Values.size() << " misses, mean " << aiMisses.MeanAbsolute() << " px off centre" << endl;
+		}
+
+		cout << "Paddle hit position, top to bottom:" << endl;
+		for (int32_t player = 0; player < 2; ++player)
+		{
+			cout << "  player " << player + 1 << " ";
+			for (int32_t bin = 0; bin < HitBins; ++bin)
+			{
+				cout << setw(8) << hitBins[player][bin];
+			}
+			cout << endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	// one row per event, for a spreadsheet or a notebook
+	int Dump(const string& path)
+	{
+		TelemetryFile telemetry = ReadTelemetry(path);
+
+		cout << "match,frame,kind,player,rally,value" << endl;
+		cout << setprecision(9);
+		for (const TelemetryEvent& event : telemetry.Events)
+		{
+			cout << event.Match << ',' << event.Frame << ',' << KindName(event.Kind) << ',' << static_cast<uint32_t>(event.Player) << ','
+				<< event.Rally << ',' << event.Value << '\n';
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	// Same stand-in player as PongSimDriver, written against the batch columns.
+	void TrackBall(MatchBatch& batch)
+	{
+		const MatchConfig& config = batch.Config();
+		const float* ballY = batch.BallY();
+		const float* paddle1Y = batch.Paddle1Y();
+		const int32_t* gamestates = batch.Gamestates();
+		int32_t* up = batch.Player1Up();
+		int32_t* down = batch.Player1Down();
+		int32_t* start = batch.Start();
+
+		for (size_t i = 0; i < batch.Size(); ++i)
+		{
+			float ballCenterY = ballY[i] + config.BallHeight / 2;
+			up[i] = ballCenterY < paddle1Y[i];
+			down[i] = ballCenterY > paddle1Y[i] + config.PaddleHeight;
+			start[i] = gamestates[i] != static_cast<int32_t>(Gamestate::Playing);
+		}
+	}
+
+	// Seconds to step a fresh batch, with the observer and a log when path isn't empty. Only the
+	// steps, the observer and the final Close are timed; the writer thread runs throughout.
+	double RunBatch(const ThroughputOptions& options, const string& path, uint64_t& events)
+	{
+		const float elapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		MatchBatch batch(MatchConfig(), options.Matches, options.Seed);
+
+		unique_ptr<TelemetryLog> log;
+		unique_ptr<BatchTelemetryObserver> observer;
+		TelemetryStream* stream = nullptr;
+		if (!path.empty())
+		{
+			log = make_unique<TelemetryLog>(path, TelemetryOverflow::Wait);
+			stream = &log->OpenStream();
+			observer = make_unique<BatchTelemetryObserver>(batch, 0);
+		}
+
+		chrono::duration<double> elapsed(0.0);
+		for (uint32_t frame = 0; frame < options.Frames; ++frame)
+		{
+			TrackBall(batch);
+
+			auto startTime = chrono::steady_clock::now();
+			batch.Step(elapsedTime);
+			if (observer)
+			{
+				observer->Observe(batch, elapsedTime, *stream);
+			}
+			elapsed += chrono::steady_clock::now() - startTime;
+		}
+
+		events = 0;
+		if (log)
+		{
+			auto startTime = chrono::steady_clock::now();
+			log->Close();
+			elapsed += chrono::steady_clock::now() - startTime;
+			events = log->EventsWritten();
+		}
+
+		return elapsed.count();
+	}
+
+	double Median(vector<double> values)
+	{
+		nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+		return values[values.size() / 2];
+	}
+
+	// How fast the log takes events, and what it costs a batched simulation to produce them.
+	int Throughput(const string& path, const ThroughputOptions& options)
+	{
+		// made-up events shaped like a batch's: many matches, a handful of kinds, rising frames
+		uint64_t perThread = options.Events / options.Threads;
+		auto writeStart = chrono::steady_clock::now();
+		uint64_t bytes;
+		{
+			TelemetryLog log(path, TelemetryOverflow::Wait);
+			vector<thread> producers;
+			for (uint32_t t = 0; t < options.Threads; ++t)
+			{
+				TelemetryStream& stream = log.OpenStream();
+				producers.emplace_back([&stream, t, perThread, &options]
+				{
+					TelemetryEvent event;
+					for (uint64_t i = 0; i < perThread; ++i)
+					{
+						event.Match = t * options.Matches + static_cast<uint32_t>(i % options.Matches);
+						event.Frame = static_cast<uint32_t>(i / 64);
+						event.Kind = static_cast<TelemetryKind>(i % 3);
+						event.Player = static_cast<uint8_t>(i % 3);
+						event.Rally = static_cast<uint16_t>(i % 7);
+						event.Value = static_cast<float>(i % 1000) / 1000.0f;
+						stream.Record(event);
+					}
+				});
+			}
+			for (thread& producer : producers)
+			{
+				producer.join();
+			}
+			log.Close();
+			bytes = log.BytesWritten();
+		}
+		double writeSeconds = chrono::duration<double>(chrono::steady_clock::now() - writeStart).count();
+		uint64_t written = perThread * options.Threads;
+
+		cout << fixed << setprecision(1);
+		cout << "Writer: " << written << " events from " << options.Threads << " threads in " << setprecision(3) << writeSeconds << " s, "
+			<< setprecision(1) << written / writeSeconds / 1e6 << "M events per second, " << setprecision(2) << static_cast<double>(bytes) / written << " bytes per event" << endl;
+
+		// alternate the runs so drift on the machine lands on both
+		vector<double> plain;
+		vector<double> observed;
+		uint64_t events = 0;
+		for (uint32_t round = 0; round < options.Rounds; ++round)
+		{
+			uint64_t unused;
+			plain.push_back(RunBatch(options, string(), unused));
+			observed.push_back(RunBatch(options, path, events));
+		}
+
+		double steps = static_cast<double>(options.Matches) * options.Frames;
+		double plainSeconds = Median(plain);
+		double observedSeconds = Median(observed);
+		cout << "Batch: " << options.Matches << " matches for " << options.Frames << " frames, median of " << options.Rounds << " rounds" << endl;
+		cout << setprecision(1);
+		cout << "  without telemetry  " << setw(8) << steps / plainSeconds / 1e6 << "M match-steps/s" << endl;
+		cout << "  with telemetry     " << setw(8) << steps / observedSeconds / 1e6 << "M match-steps/s, " << setprecision(2)
+			<< (observedSeconds / plainSeconds - 1.0) * 100.0 << "% slower, " << setprecision(1) << events / observedSeconds / 1e6 << "M events per second ("
+			<< events << " events)" << endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	bool ParseThroughputOptions(int argc, char* argv[], ThroughputOptions& options)
+	{
+		for (int i = 3; i < argc; ++i)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				return false;
+			}
+
+			const char* value = argv[++i];
+			if (strcmp(argv[i - 1], "--matches") == 0)
+			{
+				options.Matches = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--rounds") == 0)
+			{
+				options.Rounds = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--threads") == 0)
+			{
+				options.Threads = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else if (strcmp(argv[i - 1], "--events") == 0)
+			{
+				options.Events = strtoull(value, nullptr, 10);
+			}
+			else if (strcmp(argv[i - 1], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i - 1] << endl;
+				return false;
+			}
+		}
+
+		if (options.Matches == 0 || options.Frames == 0 || options.Rounds == 0 || options.Threads == 0 || options.Events < options.Threads)
+		{
+			cerr << "--matches, --frames, --rounds and --threads have to be at least 1, and --events at least --threads" << endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc >= 3 && strcmp(argv[1], "throughput") == 0)
+	{
+		ThroughputOptions options;
+		if (!ParseThroughputOptions(argc, argv, options))
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+
+		try
+		{
+			return Throughput(argv[2], options);
+		}
+		catch (const exception& error)
+		{
+			cerr << error.what() << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (argc != 3)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		if (strcmp(argv[1], "summary") == 0)
+		{
+			return Summary(argv[2]);
+		}
+		else if (strcmp(argv[1], "dump") == 0)
+		{
+			return Dump(argv[2]);
+		}
+	}
+	catch (const exception& error)
+	{
+		cerr << error.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	PrintUsage();
+	return EXIT_FAILURE;
+}
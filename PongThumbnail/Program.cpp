@@ -0,0 +1,244 @@
+#include "AssetArchive.h"
+#include "ChaosMatch.h"
+#include "FixedTimestep.h"
+#include "MatchScene.h"
+#include "PaddleController.h"
+#include "Png.h"
+#include "Simulation.h"
+#include "SoftwareRenderer.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct ThumbnailOptions
+	{
+		string ContentDirectory = PONG_CONTENT_DIRECTORY;
+		string ArchivePath;
+		uint32_t Width = 800;
+		uint32_t Height = 600;
+		uint32_t Frames = 600;
+		uint32_t Seed = 1;
+		uint32_t BenchmarkFrames = 0;
+		uint32_t ChaosBalls = 0; // renders multi-ball instead of a normal match
+		string OutputPath;
+		string GoldenPath;
+	};
+
+	ThumbnailOptions ParseOptions(int argc, char* argv[])
+	{
+		ThumbnailOptions options;
+
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--content") == 0)
+			{
+				options.ContentDirectory = argv[i + 1];
+			}
+			else if (strcmp(argv[i], "--archive") == 0)
+			{
+				options.ArchivePath = argv[i + 1];
+			}
+			else if (strcmp(argv[i], "--width") == 0)
+			{
+				options.Width = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--height") == 0)
+			{
+				options.Height = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--frames") == 0)
+			{
+				options.Frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				options.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--benchmark") == 0)
+			{
+				options.BenchmarkFrames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--chaos") == 0)
+			{
+				options.ChaosBalls = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--out") == 0)
+			{
+				options.OutputPath = argv[i + 1];
+			}
+			else if (strcmp(argv[i], "--golden") == 0)
+			{
+				options.GoldenPath = argv[i + 1];
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	// counts differing pixels; a size mismatch counts every pixel
+	uint64_t CompareImages(const Image& expected, const Image& actual)
+	{
+		if (expected.Width != actual.Width || expected.Height != actual.Height)
+		{
+			return max<uint64_t>(expected.Pixels.size(), actual.Pixels.size());
+		}
+
+		uint64_t differences = 0;
+		for (size_t i = 0; i < expected.Pixels.size(); ++i)
+		{
+			if (expected.Pixels[i] != actual.Pixels[i])
+			{
+				++differences;
+			}
+		}
+		return differences;
+	}
+
+	// Plays the tracking bot against the built-in AI for a while, then renders the last frame.
+	int Run(const ThumbnailOptions& options)
+	{
+		SoftwareRenderer renderer(options.Width, options.Height);
+
+		// loose files decode their PNGs and BC2 fonts here; an archive only copies out of the mapping
+		auto loadStartTime = chrono::steady_clock::now();
+		unique_ptr<AssetArchive> archive;
+		unique_ptr<MatchScene> loadedScene;
+		if (options.ArchivePath.empty())
+		{
+			loadedScene = make_unique<MatchScene>(renderer, options.ContentDirectory);
+		}
+		else
+		{
+			archive = make_unique<AssetArchive>(options.ArchivePath);
+			loadedScene = make_unique<MatchScene>(renderer, *archive);
+		}
+		MatchScene& scene = *loadedScene;
+		chrono::duration<double> loadTime = chrono::steady_clock::now() - loadStartTime;
+		cout << "Loaded content from " << (archive != nullptr ? options.ArchivePath : options.ContentDirectory) << " in " << loadTime.count() * 1000.0 << " ms" << endl;
+
+		MatchConfig config;
+		config.ViewportWidth = static_cast<float>(options.Width);
+		config.ViewportHeight = static_cast<float>(options.Height);
+		config.BallWidth = scene.BallSize().X;
+		config.BallHeight = scene.BallSize().Y;
+		config.PaddleWidth = scene.PaddleSize().X;
+		config.PaddleHeight = scene.PaddleSize().Y;
+
+		MatchState match = Simulation::CreateMatch(config, options.Seed);
+		MatchState previousMatch = match;
+		TrackingController player1;
+		MatchInputs inputs;
+		const float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		for (uint32_t frame = 0; frame < options.Frames; ++frame)
+		{
+			previousMatch = match;
+			inputs.Start = (match.Gamestate != Gamestate::Playing);
+			inputs.Player1 = player1.Control(match, Players::Player1);
+			Simulation::Step(match, inputs, ElapsedTime);
+		}
+
+		// the game starts the ball's colour cycle at 0.5 and advances it by real time
+		Color ballTint = MatchScene::BallTint(static_cast<float>(fmod(0.5 + match.TotalTime, 1.0)));
+		const Color BackgroundColor(0.274509817f, 0.509803951f, 0.705882370f, 1.0f);
+		const float Alpha = 0.5f;
+
+		unique_ptr<ChaosMatch> chaos;
+		if (options.ChaosBalls > 0)
+		{
+			ChaosConfig chaosConfig;
+			chaosConfig.Match = config;
+			chaosConfig.BallCount = options.ChaosBalls;
+			chaosConfig.Player1Control = PaddleControl::BuiltInAI;
+			chaos = make_unique<ChaosMatch>(chaosConfig, options.Seed);
+			for (uint32_t frame = 0; frame < options.Frames; ++frame)
+			{
+				chaos->Step(inputs, ElapsedTime);
+			}
+
+			// the hud shows multi-ball's scores
+			match.Gamestate = Gamestate::Playing;
+			match.Player1Score = chaos->Player1Score();
+			match.Player2Score = chaos->Player2Score();
+		}
+
+		auto render = [&]()
+		{
+			renderer.Clear(BackgroundColor);
+			if (chaos != nullptr)
+			{
+				scene.DrawChaos(*chaos, Alpha, 0.5f);
+				scene.UpdateHud(match, config.ViewportWidth, config.ViewportHeight);
+				scene.DrawHud(match);
+			}
+			else
+			{
+				scene.Draw(previousMatch, match, Alpha, ballTint, config.ViewportWidth, config.ViewportHeight);
+			}
+		};
+		render();
+
+		if (options.BenchmarkFrames > 0)
+		{
+			auto startTime = chrono::steady_clock::now();
+			for (uint32_t frame = 0; frame < options.BenchmarkFrames; ++frame)
+			{
+				render();
+			}
+			chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+			cout << "Rendered " << options.BenchmarkFrames << " frames at " << options.Width << "x" << options.Height << " in " << elapsed.count() << " s ("
+				<< static_cast<uint64_t>(options.BenchmarkFrames / elapsed.count()) << " frames per second)" << endl;
+		}
+
+		if (!options.OutputPath.empty())
+		{
+			Png::Save(options.OutputPath, renderer.Framebuffer());
+			cout << "Wrote frame " << options.Frames << " (score " << match.Player1Score << "-" << match.Player2Score << ") to " << options.OutputPath << endl;
+		}
+
+		if (!options.GoldenPath.empty())
+		{
+			uint64_t differences = CompareImages(Png::Load(options.GoldenPath), renderer.Framebuffer());
+			if (differences != 0)
+			{
+				cerr << differences << " pixels differ from " << options.GoldenPath << endl;
+				return EXIT_FAILURE;
+			}
+			cout << "Matches " << options.GoldenPath << endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return Run(ParseOptions(argc, argv));
+	}
+	catch (const exception& error)
+	{
+		cerr << error.what() << endl;
+		return EXIT_FAILURE;
+	}
+}
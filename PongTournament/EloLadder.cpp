@@ -0,0 +1,38 @@
+#include "EloLadder.h"
+#include <cmath>
+
+using namespace std;
+
+namespace Pong
+{
+	const double EloLadder::DefaultRating = 1500.0;
+	const double EloLadder::DefaultK = 16.0;
+
+	EloLadder::EloLadder(size_t players, double initialRating, double k) :
+		mRatings(players, initialRating), mK(k)
+	{
+	}
+
+	size_t EloLadder::Size() const
+	{
+		return mRatings.size();
+	}
+
+	double EloLadder::Rating(size_t player) const
+	{
+		return mRatings[player];
+	}
+
+	void EloLadder::Record(size_t first, size_t second, double firstScore)
+	{
+		double firstExpected = ExpectedScore(mRatings[first], mRatings[second]);
+		double change = mK * (firstScore - firstExpected);
+		mRatings[first] += change;
+		mRatings[second] -= change;
+	}
+
+	double EloLadder::ExpectedScore(double rating, double opponentRating)
+	{
+		return 1.0 / (1.0 + pow(10.0, (opponentRating - rating) / 400.0));
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Pong
+{
+	// Classic Elo ratings: every game moves both players by K times how surprising the result was.
+	class EloLadder final
+	{
+	public:
+		static const double DefaultRating;
+		static const double DefaultK;
+
+		explicit EloLadder(size_t players, double initialRating = DefaultRating, double k = DefaultK);
+
+		size_t Size() const;
+		double Rating(size_t player) const;
+
+		// firstScore is 1 for a win, 0.5 for a draw and 0 for a loss
+		void Record(size_t first, size_t second, double firstScore);
+
+		static double ExpectedScore(double rating, double opponentRating);
+
+	private:
+		std::vector<double> mRatings;
+		double mK;
+	};
+}
@@ -0,0 +1,193 @@
+#include "Tournament.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Pong;
+using namespace std;
+
+namespace
+{
+	struct ProgramOptions
+	{
+		vector<string> Controllers = { "track", "classic:2", "classic:3", "classic:5", "lazy:150", "lazy:300" };
+		uint32_t Threads = 0;
+		TournamentOptions Tournament;
+	};
+
+	vector<string> SplitList(const string& list)
+	{
+		vector<string> items;
+		stringstream stream(list);
+		string item;
+		while (getline(stream, item, ','))
+		{
+			if (!item.empty())
+			{
+				items.push_back(item);
+			}
+		}
+
+		return items;
+	}
+
+	ProgramOptions ParseOptions(int argc, char* argv[])
+	{
+		ProgramOptions options;
+		TournamentOptions& tournament = options.Tournament;
+
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (i + 1 >= argc)
+			{
+				cerr << "Missing a value for " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+
+			if (strcmp(argv[i], "--controllers") == 0)
+			{
+				options.Controllers = SplitList(argv[i + 1]);
+			}
+			else if (strcmp(argv[i], "--format") == 0)
+			{
+				if (strcmp(argv[i + 1], "round-robin") == 0)
+				{
+					tournament.Format = PairingFormat::RoundRobin;
+				}
+				else if (strcmp(argv[i + 1], "swiss") == 0)
+				{
+					tournament.Format = PairingFormat::Swiss;
+				}
+				else
+				{
+					cerr << "Unknown value for --format: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else if (strcmp(argv[i], "--rounds") == 0)
+			{
+				tournament.Rounds = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--games") == 0)
+			{
+				tournament.GamesPerPairing = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--games-per-task") == 0)
+			{
+				tournament.GamesPerTask = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--threads") == 0)
+			{
+				options.Threads = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--frames") == 0)
+			{
+				tournament.MaxFramesPerGame = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--dt") == 0)
+			{
+				tournament.ElapsedTime = static_cast<float>(atof(argv[i + 1]));
+			}
+			else if (strcmp(argv[i], "--seed") == 0)
+			{
+				tournament.Seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+			}
+			else if (strcmp(argv[i], "--collision") == 0)
+			{
+				if (strcmp(argv[i + 1], "discrete") == 0)
+				{
+					tournament.Config.Collision = CollisionMode::Discrete;
+				}
+				else if (strcmp(argv[i + 1], "swept") == 0)
+				{
+					tournament.Config.Collision = CollisionMode::Swept;
+				}
+				else
+				{
+					cerr << "Unknown value for --collision: " << argv[i + 1] << endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			else
+			{
+				cerr << "Unknown option " << argv[i] << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		return options;
+	}
+
+	void PrintStandings(const Tournament& tournament)
+	{
+		cout << left << setw(6) << "Rank" << setw(14) << "Controller" << right << setw(8) << "Elo" << setw(10) << "Score"
+			<< setw(8) << "Won" << setw(8) << "Drawn" << setw(8) << "Lost" << endl;
+
+		vector<Standing> standings = tournament.Standings();
+		for (size_t rank = 0; rank < standings.size(); ++rank)
+		{
+			const Standing& standing = standings[rank];
+			cout << left << setw(6) << rank + 1 << setw(14) << tournament.Controller(standing.Controller).Name() << right << fixed
+				<< setprecision(0) << setw(8) << standing.Rating << setprecision(1) << setw(10) << standing.Score
+				<< setw(8) << standing.Wins << setw(8) << standing.Draws << setw(8) << standing.Losses << endl;
+		}
+	}
+
+	void PrintPairings(const Tournament& tournament, float elapsedTime)
+	{
+		cout << left << setw(28) << "Pairing" << right << setw(8) << "Games" << setw(8) << "Won" << setw(8) << "Drawn"
+			<< setw(8) << "Lost" << setw(12) << "Points" << setw(12) << "Avg game s" << endl;
+
+		for (const PairingStats& stats : tournament.Pairings())
+		{
+			string pairing = tournament.Controller(stats.First).Name() + " v " + tournament.Controller(stats.Second).Name();
+			string points = to_string(stats.FirstPoints) + "-" + to_string(stats.SecondPoints);
+			double averageSeconds = static_cast<double>(stats.Frames) * elapsedTime / stats.Games;
+			cout << left << setw(28) << pairing << right << setw(8) << stats.Games << setw(8) << stats.FirstWins << setw(8) << stats.Draws
+				<< setw(8) << stats.SecondWins << setw(12) << points << fixed << setprecision(1) << setw(12) << averageSeconds << endl;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	ProgramOptions options = ParseOptions(argc, argv);
+
+	try
+	{
+		vector<unique_ptr<PaddleController>> controllers;
+		for (const string& spec : options.Controllers)
+		{
+			controllers.push_back(PaddleController::Create(spec));
+		}
+
+		Tournament tournament(move(controllers), options.Tournament);
+		TaskPool pool(options.Threads);
+
+		auto startTime = chrono::steady_clock::now();
+		tournament.Run(pool);
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+		PrintStandings(tournament);
+		cout << endl;
+		PrintPairings(tournament, options.Tournament.ElapsedTime);
+		cout << endl;
+
+		cout << "Played " << tournament.GamesPlayed() << " matches (" << tournament.FramesSimulated() << " frames) in "
+			<< setprecision(3) << elapsed.count() << " s on " << pool.ThreadCount() << " threads" << endl;
+		cout << "Matches per second: " << setprecision(1) << tournament.GamesPlayed() / elapsed.count() << endl;
+		cout << "Frames per second: " << setprecision(0) << tournament.FramesSimulated() / elapsed.count() << endl;
+	}
+	catch (const exception& error)
+	{
+		cerr << error.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,289 @@
+#include "Tournament.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Pong
+{
+	namespace
+	{
+		const size_t NoPairing = static_cast<size_t>(-1);
+	}
+
+	Tournament::Tournament(vector<unique_ptr<PaddleController>> controllers, const TournamentOptions& options) :
+		mControllers(move(controllers)), mOptions(options), mLadder(mControllers.size()),
+		mPairingIndices(mControllers.size() * mControllers.size(), NoPairing), mScores(mControllers.size()),
+		mHadBye(mControllers.size()), mGamesPlayed(0), mFramesSimulated(0)
+	{
+		if (mControllers.size() < 2)
+		{
+			throw invalid_argument("A tournament needs at least two controllers.");
+		}
+
+		if (mOptions.GamesPerPairing == 0 || mOptions.MaxFramesPerGame == 0)
+		{
+			throw invalid_argument("A tournament needs at least one game per pairing and one frame per game.");
+		}
+
+		mOptions.GamesPerTask = max(mOptions.GamesPerTask, 1u);
+	}
+
+	void Tournament::Run(TaskPool& pool)
+	{
+		if (mOptions.Format == PairingFormat::RoundRobin)
+		{
+			PlayRound(pool, RoundRobinPairings());
+			return;
+		}
+
+		uint32_t rounds = mOptions.Rounds;
+		if (rounds == 0)
+		{
+			rounds = max(static_cast<uint32_t>(ceil(log2(static_cast<double>(mControllers.size())))), 1u);
+		}
+
+		for (uint32_t round = 0; round < rounds; ++round)
+		{
+			PlayRound(pool, SwissPairings());
+		}
+	}
+
+	const PaddleController& Tournament::Controller(size_t index) const
+	{
+		return *mControllers[index];
+	}
+
+	const vector<PairingStats>& Tournament::Pairings() const
+	{
+		return mPairings;
+	}
+
+	vector<Standing> Tournament::Standings() const
+	{
+		vector<Standing> standings(mControllers.size());
+		for (size_t i = 0; i < standings.size(); ++i)
+		{
+			standings[i].Controller = i;
+			standings[i].Rating = mLadder.Rating(i);
+			standings[i].Score = mScores[i];
+		}
+
+		for (const PairingStats& stats : mPairings)
+		{
+			standings[stats.First].Wins += stats.FirstWins;
+			standings[stats.First].Losses += stats.SecondWins;
+			standings[stats.First].Draws += stats.Draws;
+			standings[stats.Second].Wins += stats.SecondWins;
+			standings[stats.Second].Losses += stats.FirstWins;
+			standings[stats.Second].Draws += stats.Draws;
+		}
+
+		stable_sort(standings.begin(), standings.end(), [](const Standing& left, const Standing& right)
+		{
+			return left.Rating > right.Rating;
+		});
+
+		return standings;
+	}
+
+	uint64_t Tournament::GamesPlayed() const
+	{
+		return mGamesPlayed;
+	}
+
+	uint64_t Tournament::FramesSimulated() const
+	{
+		return mFramesSimulated;
+	}
+
+	GameResult Tournament::PlayGame(const TournamentOptions& options, const PaddleController& player1, const PaddleController& player2, uint32_t game)
+	{
+		MatchConfig config = options.Config;
+		config.Player2Control = PaddleControl::Inputs;
+		MatchState match = Simulation::CreateMatch(config, options.Seed, game);
+
+		MatchInputs inputs;
+		inputs.Start = true;
+
+		GameResult result;
+		while (result.Frames < options.MaxFramesPerGame)
+		{
+			inputs.Player1 = player1.Control(match, Players::Player1);
+			inputs.Player2 = player2.Control(match, Players::Player2);
+			Simulation::Step(match, inputs, options.ElapsedTime);
+			inputs.Start = false;
+			++result.Frames;
+
+			if (match.Events & MatchEvents::GameOver)
+			{
+				break;
+			}
+		}
+
+		result.Player1Score = match.Player1Score;
+		result.Player2Score = match.Player2Score;
+
+		return result;
+	}
+
+	vector<Tournament::Pairing> Tournament::RoundRobinPairings() const
+	{
+		vector<Pairing> pairings;
+		for (size_t first = 0; first < mControllers.size(); ++first)
+		{
+			for (size_t second = first + 1; second < mControllers.size(); ++second)
+			{
+				pairings.emplace_back(first, second);
+			}
+		}
+
+		return pairings;
+	}
+
+	vector<Tournament::Pairing> Tournament::SwissPairings()
+	{
+		size_t count = mControllers.size();
+		vector<size_t> order(count);
+		iota(order.begin(), order.end(), 0);
+		stable_sort(order.begin(), order.end(), [this](size_t left, size_t right)
+		{
+			return mScores[left] != mScores[right] ? mScores[left] > mScores[right] : mLadder.Rating(left) > mLadder.Rating(right);
+		});
+
+		vector<bool> paired(count);
+		if (count % 2 != 0)
+		{
+			// the lowest placed player who has not sat out yet takes the bye
+			auto bye = find_if(order.rbegin(), order.rend(), [this](size_t player) { return !mHadBye[player]; });
+			size_t player = (bye != order.rend() ? *bye : order.back());
+			paired[player] = true;
+			mHadBye[player] = true;
+		}
+
+		vector<Pairing> pairings;
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t first = order[i];
+			if (paired[first])
+			{
+				continue;
+			}
+
+			// the next player down who has not met this one, or a rematch if everyone has
+			size_t opponent = NoPairing;
+			for (size_t j = i + 1; j < count; ++j)
+			{
+				size_t second = order[j];
+				if (!paired[second])
+				{
+					if (opponent == NoPairing)
+					{
+						opponent = second;
+					}
+
+					if (mPairingIndices[first * count + second] == NoPairing)
+					{
+						opponent = second;
+						break;
+					}
+				}
+			}
+
+			paired[first] = true;
+			paired[opponent] = true;
+			pairings.emplace_back(min(first, opponent), max(first, opponent));
+		}
+
+		return pairings;
+	}
+
+	void Tournament::PlayRound(TaskPool& pool, const vector<Pairing>& pairings)
+	{
+		const uint32_t games = mOptions.GamesPerPairing;
+		const uint64_t firstGame = mGamesPlayed;
+		mRoundResults.assign(pairings.size() * games, GameResult());
+
+		for (size_t pairing = 0; pairing < pairings.size(); ++pairing)
+		{
+			for (uint32_t begin = 0; begin < games; begin += mOptions.GamesPerTask)
+			{
+				uint32_t end = min(begin + mOptions.GamesPerTask, games);
+				pool.Submit([this, &pairings, pairing, begin, end, firstGame]
+				{
+					const PaddleController& first = *mControllers[pairings[pairing].first];
+					const PaddleController& second = *mControllers[pairings[pairing].second];
+					for (uint32_t game = begin; game < end; ++game)
+					{
+						size_t slot = pairing * mOptions.GamesPerPairing + game;
+						uint32_t stream = static_cast<uint32_t>(firstGame + slot);
+						mRoundResults[slot] = (game % 2 == 0 ? PlayGame(mOptions, first, second, stream) : PlayGame(mOptions, second, first, stream));
+					}
+				});
+			}
+		}
+		pool.Wait();
+
+		// fold the results in schedule order so the ratings never depend on which thread finished first
+		for (uint32_t game = 0; game < games; ++game)
+		{
+			for (size_t pairing = 0; pairing < pairings.size(); ++pairing)
+			{
+				const GameResult& result = mRoundResults[pairing * games + game];
+				int32_t firstPoints = (game % 2 == 0 ? result.Player1Score : result.Player2Score);
+				int32_t secondPoints = (game % 2 == 0 ? result.Player2Score : result.Player1Score);
+
+				size_t first = pairings[pairing].first;
+				size_t second = pairings[pairing].second;
+				PairingStats& stats = Stats(first, second);
+				++stats.Games;
+				stats.FirstPoints += firstPoints;
+				stats.SecondPoints += secondPoints;
+				stats.Frames += result.Frames;
+
+				double firstScore = 0.5;
+				if (firstPoints > secondPoints)
+				{
+					firstScore = 1.0;
+					++stats.FirstWins;
+				}
+				else if (firstPoints < secondPoints)
+				{
+					firstScore = 0.0;
+					++stats.SecondWins;
+				}
+				else
+				{
+					++stats.Draws;
+				}
+
+				mScores[first] += firstScore;
+				mScores[second] += 1.0 - firstScore;
+				mLadder.Record(first, second, firstScore);
+				++mGamesPlayed;
+				mFramesSimulated += result.Frames;
+			}
+		}
+	}
+
+	PairingStats& Tournament::Stats(size_t first, size_t second)
+	{
+		size_t count = mControllers.size();
+		size_t& index = mPairingIndices[first * count + second];
+		if (index == NoPairing)
+		{
+			index = mPairings.size();
+			mPairingIndices[second * count + first] = index;
+
+			PairingStats stats;
+			stats.First = first;
+			stats.Second = second;
+			mPairings.push_back(stats);
+		}
+
+		return mPairings[index];
+	}
+}
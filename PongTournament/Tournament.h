@@ -0,0 +1,105 @@
+#pragma once
+
+#include "EloLadder.h"
+#include "FixedTimestep.h"
+#include "MatchConfig.h"
+#include "PaddleController.h"
+#include "TaskPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Pong
+{
+	enum class PairingFormat
+	{
+		RoundRobin = 0, // everyone plays everyone once
+		Swiss = 1, // each round pairs players on equal points who have not met yet
+	};
+
+	struct TournamentOptions final
+	{
+		PairingFormat Format = PairingFormat::RoundRobin;
+		uint32_t Rounds = 0; // Swiss only; zero plays enough rounds to separate the field
+		uint32_t GamesPerPairing = 100; // sides alternate every game
+		uint32_t GamesPerTask = 8;
+		uint32_t MaxFramesPerGame = 120 * 60 * 5; // a game still running after this ends on the current score
+		float ElapsedTime = 1.0f / FixedTimestep::DefaultStepsPerSecond;
+		uint32_t Seed = 1;
+		MatchConfig Config;
+	};
+
+	struct GameResult final
+	{
+		int32_t Player1Score = 0;
+		int32_t Player2Score = 0;
+		uint32_t Frames = 0;
+	};
+
+	// Results between two controllers, from First's point of view.
+	struct PairingStats final
+	{
+		size_t First = 0;
+		size_t Second = 0;
+		uint32_t Games = 0;
+		uint32_t FirstWins = 0;
+		uint32_t SecondWins = 0;
+		uint32_t Draws = 0;
+		uint64_t FirstPoints = 0;
+		uint64_t SecondPoints = 0;
+		uint64_t Frames = 0;
+	};
+
+	struct Standing final
+	{
+		size_t Controller = 0;
+		double Rating = 0.0;
+		double Score = 0.0; // a point per win and half per draw
+		uint32_t Wins = 0;
+		uint32_t Draws = 0;
+		uint32_t Losses = 0;
+	};
+
+	// Plays paddle controllers against each other in headless matches. Each round's games are
+	// split into tasks for a TaskPool, and every game is seeded from its place in the schedule,
+	// so the results are the same however many threads run them.
+	class Tournament final
+	{
+	public:
+		Tournament(std::vector<std::unique_ptr<PaddleController>> controllers, const TournamentOptions& options);
+
+		Tournament(const Tournament&) = delete;
+		Tournament& operator=(const Tournament&) = delete;
+
+		void Run(TaskPool& pool);
+
+		const PaddleController& Controller(size_t index) const;
+		const std::vector<PairingStats>& Pairings() const;
+		std::vector<Standing> Standings() const;
+		uint64_t GamesPlayed() const;
+		uint64_t FramesSimulated() const;
+
+		static GameResult PlayGame(const TournamentOptions& options, const PaddleController& player1, const PaddleController& player2, uint32_t game);
+
+	private:
+		using Pairing = std::pair<size_t, size_t>;
+
+		std::vector<Pairing> RoundRobinPairings() const;
+		std::vector<Pairing> SwissPairings();
+		void PlayRound(TaskPool& pool, const std::vector<Pairing>& pairings);
+		PairingStats& Stats(size_t first, size_t second);
+
+		std::vector<std::unique_ptr<PaddleController>> mControllers;
+		TournamentOptions mOptions;
+		EloLadder mLadder;
+		std::vector<PairingStats> mPairings;
+		std::vector<size_t> mPairingIndices; // controller pair -> mPairings, npos until they meet
+		std::vector<double> mScores;
+		std::vector<bool> mHadBye;
+		std::vector<GameResult> mRoundResults;
+		uint64_t mGamesPlayed;
+		uint64_t mFramesSimulated;
+	};
+}